@@ -7,12 +7,15 @@
 #define BOOST_FIBERS_ALGORITHM_H
 
 #include <boost/assert.hpp>
+#include <boost/chrono/system_clocks.hpp>
 #include <boost/config.hpp>
 #include <boost/move/move.hpp>
 #include <boost/thread/locks.hpp>
 #include <boost/utility.hpp>
 
 #include <boost/fiber/detail/config.hpp>
+#include <boost/fiber/detail/epoll_reactor.hpp>
+#include <boost/fiber/detail/io_uring.hpp>
 #include <boost/fiber/detail/notify.hpp>
 #include <boost/fiber/detail/spinlock.hpp>
 #include <boost/fiber/fiber.hpp>
@@ -37,16 +40,34 @@ struct BOOST_FIBERS_DECL algorithm : private noncopyable
 
     virtual void join( detail::fiber_base::ptr_t const&) = 0;
 
-    virtual detail::fiber_base::ptr_t active() = 0;
+    // returned by reference (no reference counting per call) - an
+    // algorithm written against the by-value signature must be updated
+    virtual detail::fiber_base::ptr_t const& active() = 0;
 
     virtual bool run() = 0;
 
     virtual void wait( unique_lock< detail::spinlock > &) = 0;
 
+    // returns false if the deadline woke the fiber, true if it was
+    // notified (even if it was resumed after the deadline)
+    virtual bool wait_until( unique_lock< detail::spinlock > &,
+                             chrono::system_clock::time_point const&) = 0;
+
     virtual void yield() = 0;
 
     virtual detail::notify::ptr_t notifier() = 0;
 
+    // suspends the active fiber until fd is ready for op
+    virtual void wait_io( int fd, detail::io_op op) = 0;
+
+    // called before fd is closed
+    virtual void deregister_io( int fd) = 0;
+
+    // suspends the active fiber until req has completed, returns false
+    // if the algorithm cannot complete req (readiness based I/O is
+    // used instead)
+    virtual bool wait_completion( detail::io_request & req) = 0;
+
     virtual ~algorithm() {}
 };
 
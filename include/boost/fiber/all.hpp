@@ -8,16 +8,33 @@
 #define BOOST_FIBERS_H
 
 #include <boost/fiber/algorithm.hpp>
+#include <boost/fiber/auto_reset_event.hpp>
 #include <boost/fiber/barrier.hpp>
 #include <boost/fiber/bounded_channel.hpp>
+#include <boost/fiber/broadcast_channel.hpp>
+#include <boost/fiber/channel_statistics.hpp>
 #include <boost/fiber/condition.hpp>
+#include <boost/fiber/counting_semaphore.hpp>
 #include <boost/fiber/exceptions.hpp>
+#include <boost/fiber/executor.hpp>
 #include <boost/fiber/fiber.hpp>
+#include <boost/fiber/fiber_specific_ptr.hpp>
 #include <boost/fiber/future.hpp>
 #include <boost/fiber/interruption.hpp>
+#include <boost/fiber/io.hpp>
+#include <boost/fiber/latch.hpp>
+#include <boost/fiber/manual_reset_event.hpp>
+#include <boost/fiber/mpmc_channel.hpp>
 #include <boost/fiber/mutex.hpp>
+#include <boost/fiber/offload.hpp>
+#include <boost/fiber/rendezvous_channel.hpp>
 #include <boost/fiber/operations.hpp>
+#include <boost/fiber/parallel.hpp>
 #include <boost/fiber/round_robin.hpp>
+#include <boost/fiber/selector.hpp>
+#include <boost/fiber/spsc_channel.hpp>
+#include <boost/fiber/task_graph.hpp>
 #include <boost/fiber/unbounded_channel.hpp>
+#include <boost/fiber/wait_group.hpp>
 
 #endif // BOOST_FIBERS_H
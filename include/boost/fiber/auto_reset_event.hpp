@@ -0,0 +1,73 @@
+//          Copyright Oliver Kowalke 2009.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_FIBERS_AUTO_RESET_EVENT_H
+#define BOOST_FIBERS_AUTO_RESET_EVENT_H
+
+#include <cstddef>
+#include <deque>
+
+#include <boost/atomic.hpp>
+#include <boost/config.hpp>
+#include <boost/utility.hpp>
+
+#include <boost/fiber/detail/config.hpp>
+#include <boost/fiber/detail/notify.hpp>
+#include <boost/fiber/detail/spinlock.hpp>
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+# if defined(BOOST_MSVC)
+# pragma warning(push)
+# pragma warning(disable:4355 4251 4275)
+# endif
+
+namespace boost {
+namespace fibers {
+
+class BOOST_FIBERS_DECL auto_reset_event : private noncopyable
+{
+private:
+    // bit 0 of state_ holds the signal, the remaining bits
+    // count the fibers registered in waiting_
+    // set() and wait() touch waiting_mtx_ only if the
+    // signal can not be exchanged via state_ alone
+    enum
+    {
+        SET     = 1,
+        WAITER  = 2
+    };
+
+    atomic< std::size_t >           state_;
+    detail::spinlock                waiting_mtx_;
+    std::deque<
+        detail::notify::ptr_t
+    >                               waiting_;
+
+public:
+    auto_reset_event( bool isset = false);
+
+    ~auto_reset_event();
+
+    void set();
+
+    void wait();
+
+    bool try_wait();
+};
+
+}}
+
+# if defined(BOOST_MSVC)
+# pragma warning(pop)
+# endif
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
+
+#endif // BOOST_FIBERS_AUTO_RESET_EVENT_H
@@ -8,13 +8,15 @@
 #define BOOST_FIBERS_BARRIER_H
 
 #include <cstddef>
+#include <vector>
 
+#include <boost/atomic.hpp>
 #include <boost/config.hpp>
 #include <boost/utility.hpp>
 
 #include <boost/fiber/detail/config.hpp>
-#include <boost/fiber/condition.hpp>
-#include <boost/fiber/mutex.hpp>
+#include <boost/fiber/detail/notify.hpp>
+#include <boost/fiber/detail/spinlock.hpp>
 
 #ifdef BOOST_HAS_ABI_HEADERS
 #  include BOOST_ABI_PREFIX
@@ -22,7 +24,7 @@
 
 # if defined(BOOST_MSVC)
 # pragma warning(push)
-# pragma warning(disable:4275)
+# pragma warning(disable:4251 4275)
 # endif
 
 namespace boost {
@@ -31,15 +33,42 @@ namespace fibers {
 class BOOST_FIBERS_DECL barrier : private noncopyable
 {
 private:
-	std::size_t		initial_;
-	std::size_t		current_;
-	bool			cycle_;
-	mutex			mtx_;
-	condition		cond_;
+    enum
+    {
+        // number of waiter groups - fibers of one scheduler
+        // (thread) always wait in the same group
+        GROUPS          = 16
+    };
+
+    // waiters are kept separated by the sense (phase & 1) they
+    // are waiting for - fibers arriving for the next phase do not
+    // interfere with the release of the current phase
+    struct group
+    {
+        detail::spinlock                        mtx;
+        std::vector< detail::notify::ptr_t >    waiting[2];
+        char                                    pad[BOOST_FIBERS_CACHELINE_SIZE];
+
+        group() :
+            mtx(), pad()
+        {}
+    };
+
+	std::size_t		        initial_;
+    atomic< std::size_t >   current_;
+    char                    pad_[BOOST_FIBERS_CACHELINE_SIZE];
+    atomic< std::size_t >   phase_;
+    group                   groups_[GROUPS];
+
+    group & group_of_this_thread_();
+
+    void release_( std::size_t);
 
 public:
 	barrier( std::size_t);
 
+    ~barrier();
+
 	bool wait();
 };
 
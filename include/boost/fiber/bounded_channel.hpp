@@ -3,12 +3,11 @@
 // Distributed under the Boost Software License, Version 1.0.
 //    (See accompanying file LICENSE_1_0.txt or copy at
 //          http://www.boost.org/LICENSE_1_0.txt)
-//
-//  idea of node-base locking from 'C++ Concurrency in Action', Anthony Williams
 
 #ifndef BOOST_FIBERS_BOUNDED_CHANNEL_H
 #define BOOST_FIBERS_BOUNDED_CHANNEL_H
 
+#include <algorithm>
 #include <cstddef>
 #include <stdexcept>
 
@@ -16,11 +15,15 @@
 #include <boost/chrono/system_clocks.hpp>
 #include <boost/config.hpp>
 #include <boost/exception/all.hpp>
-#include <boost/intrusive_ptr.hpp>
+#include <boost/move/move.hpp>
 #include <boost/optional.hpp>
+#include <boost/scoped_array.hpp>
 #include <boost/system/error_code.hpp>
 #include <boost/utility.hpp>
 
+#include <boost/fiber/channel_statistics.hpp>
+#include <boost/fiber/detail/config.hpp>
+#include <boost/fiber/detail/select_queue.hpp>
 #include <boost/fiber/exceptions.hpp>
 #include <boost/fiber/condition.hpp>
 #include <boost/fiber/mutex.hpp>
@@ -31,47 +34,19 @@
 
 namespace boost {
 namespace fibers {
-namespace detail {
 
-template< typename T >
-struct bounded_channel_node
-{
-    typedef intrusive_ptr< bounded_channel_node >   ptr;
-
-    std::size_t use_count;
-    T           va;
-    ptr         next;
-
-    bounded_channel_node() :
-        use_count( 0),
-        va(),
-        next()
-    {}
-};
-
-template< typename T >
-void intrusive_ptr_add_ref( bounded_channel_node< T > * p)
-{ ++p->use_count; }
-
-template< typename T >
-void intrusive_ptr_release( bounded_channel_node< T > * p)
-{ if ( 0 == --p->use_count) delete p; }
+class selector;
 
-}
-
-template< typename T >
+// Statistics is a policy counting items and blocked time, see
+// channel_statistics - the default null_channel_statistics is empty
+template< typename T, typename Statistics = null_channel_statistics >
 class bounded_channel : private noncopyable
 {
 public:
     typedef optional< T >   value_type;
 
 private:
-    typedef detail::bounded_channel_node< value_type >      node_type;  
-
-    template< typename X >
-    friend void intrusive_ptr_add_ref( bounded_channel< X > * p);
-    template< typename X >
-    friend void intrusive_ptr_release( bounded_channel< X > * p);
+    friend class selector;
 
     enum state
     {
@@ -79,16 +54,27 @@ private:
         DEACTIVE
     };
 
-    atomic< state >             state_;
-    atomic< std::size_t >       count_;
-    typename node_type::ptr     head_;
-    mutable mutex               head_mtx_;
-    typename node_type::ptr     tail_;
-    mutable mutex               tail_mtx_;
-    condition                   not_empty_cond_;
-    condition                   not_full_cond_;
-    unsigned int                hwm_;
-    unsigned int                lwm_;
+    // ring-buffer with hwm_ preallocated slots - producers
+    // (tail) and consumers (head) are serialized by separate
+    // mutexes and access only their own cache-line
+    atomic< state >                 state_;
+    atomic< std::size_t >           count_;
+    std::size_t                     hwm_;
+    std::size_t                     lwm_;
+    scoped_array< value_type >      slots_;
+    char                            pad1_[BOOST_FIBERS_CACHELINE_SIZE];
+    std::size_t                     head_idx_;
+    atomic< std::size_t >           consumers_waiting_;
+    mutable mutex                   head_mtx_;
+    condition                       not_empty_cond_;
+    detail::select_queue            select_readable_;
+    char                            pad2_[BOOST_FIBERS_CACHELINE_SIZE];
+    std::size_t                     tail_idx_;
+    atomic< std::size_t >           producers_waiting_;
+    mutable mutex                   tail_mtx_;
+    condition                       not_full_cond_;
+    detail::select_queue            select_writeable_;
+    Statistics                      stats_;
 
     bool active_() const
     { return ACTIVE == state_; }
@@ -100,24 +86,228 @@ private:
     { return count_; }
 
     bool empty_() const
-    { return head_ == get_tail_(); }
+    { return 0 == size_(); }
 
     bool full_() const
     { return size_() >= hwm_; }
 
-    typename node_type::ptr get_tail_() const
+    std::size_t increment_( std::size_t idx) const
+    { return hwm_ == ++idx ? 0 : idx; }
+
+    // size at which waiting producers are notified
+    std::size_t threshold_() const
+    { return lwm_ == hwm_ ? hwm_ - 1 : lwm_; }
+
+    // the slot at tail_idx_ was assigned, returns the size
+    // before the item was added
+    std::size_t tail_pushed_()
+    {
+        tail_idx_ = increment_( tail_idx_);
+        stats_.on_put( 1);
+        return count_.fetch_add( 1);
+    }
+
+    std::size_t push_tail_( T const& t)
+    {
+        slots_[tail_idx_] = t;
+        return tail_pushed_();
+    }
+
+#ifndef BOOST_NO_RVALUE_REFERENCES
+    std::size_t push_tail_( BOOST_RV_REF( T) t)
+    {
+        slots_[tail_idx_] = boost::move( t);
+        return tail_pushed_();
+    }
+#endif
+
+    // returns the size after the item was removed
+    std::size_t pop_head_( value_type & va)
+    {
+        swap( va, slots_[head_idx_]);
+        slots_[head_idx_] = none;
+        head_idx_ = increment_( head_idx_);
+        stats_.on_take( 1);
+        return count_.fetch_sub( 1) - 1;
+    }
+
+    // moves n items to out, returns the size after the items were removed
+    template< typename OutputIterator >
+    std::size_t pop_head_n_( OutputIterator & out, std::size_t n)
+    {
+        for ( std::size_t i = 0; i < n; ++i)
+        {
+            * out = boost::move( * slots_[head_idx_]);
+            ++out;
+            slots_[head_idx_] = none;
+            head_idx_ = increment_( head_idx_);
+        }
+        stats_.on_take( n);
+        return count_.fetch_sub( n) - n;
+    }
+
+    // size crossed the boundary waiting producers are notified at
+    bool below_threshold_( std::size_t size, std::size_t removed) const
+    { return size <= threshold_() && threshold_() < size + removed; }
+
+    // notifications are sent only if the size crosses the boundary a
+    // fiber is waiting for (empty, threshold_()) - a woken fiber passes
+    // the notification on to the next waiting fiber
+    // a waiting fiber registers itself in consumers_waiting_/producers_waiting_
+    // before it checks the channel state - the notifier has to acquire the
+    // mutex of the waiting side because the waiting fiber might be
+    // between its check and the registration at the condition
+    // selectors are notified at the same boundaries
+    void notify_not_empty_()
+    {
+        select_readable_.notify_all();
+        if ( 0 == consumers_waiting_) return;
+        { mutex::scoped_lock lk( head_mtx_); }
+        not_empty_cond_.notify_one();
+    }
+
+    void notify_not_full_()
+    {
+        select_writeable_.notify_all();
+        if ( 0 == producers_waiting_) return;
+        { mutex::scoped_lock lk( tail_mtx_); }
+        if ( lwm_ == hwm_)
+            not_full_cond_.notify_one();
+        else
+            // more than one producer could be waiting
+            // for submiting an action object
+            not_full_cond_.notify_all();
+    }
+
+    // lk must be locked on tail_mtx_, returns false if abs_time
+    // has expired
+    bool wait_not_full_( mutex::scoped_lock & lk,
+                         chrono::system_clock::time_point const* abs_time)
+    {
+        bool expired = false;
+        chrono::high_resolution_clock::time_point start;
+        if ( Statistics::enabled)
+            start = chrono::high_resolution_clock::now();
+        ++producers_waiting_;
+        try
+        {
+            while ( active_() && full_() && ! expired)
+            {
+                if ( abs_time)
+                    expired = ! not_full_cond_.timed_wait( lk, * abs_time);
+                else
+                    not_full_cond_.wait( lk);
+            }
+        }
+        catch (...)
+        {
+            --producers_waiting_;
+            // pass a notification on
+            if ( ! full_() ) notify_not_full_();
+            throw;
+        }
+        --producers_waiting_;
+        if ( Statistics::enabled)
+            stats_.on_producer_wait( chrono::high_resolution_clock::now() - start);
+        return ! active_() || ! full_();
+    }
+
+    // lk must be locked on head_mtx_, returns false if the
+    // fiber was interrupted or abs_time has expired
+    bool wait_not_empty_( mutex::scoped_lock & lk,
+                          chrono::system_clock::time_point const* abs_time)
+    {
+        bool expired = false;
+        chrono::high_resolution_clock::time_point start;
+        if ( Statistics::enabled)
+            start = chrono::high_resolution_clock::now();
+        ++consumers_waiting_;
+        try
+        {
+            while ( active_() && empty_() && ! expired)
+            {
+                if ( abs_time)
+                    expired = ! not_empty_cond_.timed_wait( lk, * abs_time);
+                else
+                    not_empty_cond_.wait( lk);
+            }
+        }
+        catch ( fiber_interrupted const&)
+        {
+            --consumers_waiting_;
+            // pass a notification on
+            if ( ! empty_() ) notify_not_empty_();
+            return false;
+        }
+        --consumers_waiting_;
+        if ( Statistics::enabled)
+            stats_.on_consumer_wait( chrono::high_resolution_clock::now() - start);
+        return ! active_() || ! empty_();
+    }
+
+    // lk must be locked on tail_mtx_, waits until a slot is free,
+    // returns false if abs_time has expired
+    bool wait_free_slot_( mutex::scoped_lock & lk, bool & waited,
+                          chrono::system_clock::time_point const* abs_time = 0)
     {
-        mutex::scoped_lock lk( tail_mtx_);  
-        typename node_type::ptr tmp = tail_;
-        return tmp;
+        if ( full_() )
+        {
+            waited = true;
+            if ( ! wait_not_full_( lk, abs_time) )
+                return false;
+        }
+
+        if ( ! active_() )
+            boost::throw_exception( fiber_resource_error() );
+        return true;
     }
 
-    typename node_type::ptr pop_head_()
+    bool take_( value_type & va, chrono::system_clock::time_point const* abs_time)
     {
-        typename node_type::ptr old_head = head_;
-        head_ = old_head->next;
-        --count_;
-        return old_head;
+        bool waited = false;
+        mutex::scoped_lock lk( head_mtx_);
+        bool empty = empty_();
+        if ( ! active_() && empty)
+            return false;
+        if ( empty)
+        {
+            waited = true;
+            if ( ! wait_not_empty_( lk, abs_time) )
+                return false;
+        }
+        if ( ! active_() && empty_() )
+            return false;
+        std::size_t size = pop_head_( va);
+        lk.unlock();
+        if ( threshold_() == size)
+            notify_not_full_();
+        if ( waited && 0 < size)
+            notify_not_empty_();
+        return va;
+    }
+
+    // tail_mtx_ must not be held
+    void pushed_( std::size_t previous, bool waited)
+    {
+        if ( 0 == previous)
+            notify_not_empty_();
+        if ( waited && lwm_ == hwm_ && ! full_() )
+            notify_not_full_();
+    }
+
+    void init_()
+    {
+        if ( 0 == hwm_)
+            boost::throw_exception(
+                invalid_argument(
+                    system::errc::invalid_argument,
+                    "boost fiber: zero high-watermark for bounded_channel") );
+        if ( hwm_ < lwm_)
+            boost::throw_exception(
+                invalid_argument(
+                    system::errc::invalid_argument,
+                    "boost fiber: high-watermark is less than low-watermark for bounded_channel") );
+        slots_.reset( new value_type[hwm_]);
     }
 
 public:
@@ -126,34 +316,47 @@ public:
             std::size_t lwm) :
         state_( ACTIVE),
         count_( 0),
-        head_( new node_type() ),
+        hwm_( hwm),
+        lwm_( lwm),
+        slots_(),
+        pad1_(),
+        head_idx_( 0),
+        consumers_waiting_( 0),
         head_mtx_(),
-        tail_( head_),
-        tail_mtx_(),
         not_empty_cond_(),
+        select_readable_(),
+        pad2_(),
+        tail_idx_( 0),
+        producers_waiting_( 0),
+        tail_mtx_(),
         not_full_cond_(),
-        hwm_( hwm),
-        lwm_( lwm)
-    {
-        if ( hwm_ < lwm_)
-            boost::throw_exception(
-                invalid_argument(
-                    system::errc::invalid_argument,
-                    "boost fiber: high-watermark is less than low-watermark for bounded_channel") );
-    }
+        select_writeable_(),
+        stats_()
+    { init_(); }
 
     bounded_channel( std::size_t wm) :
         state_( ACTIVE),
         count_( 0),
-        head_( new node_type() ),
+        hwm_( wm),
+        lwm_( wm),
+        slots_(),
+        pad1_(),
+        head_idx_( 0),
+        consumers_waiting_( 0),
         head_mtx_(),
-        tail_( head_),
-        tail_mtx_(),
         not_empty_cond_(),
+        select_readable_(),
+        pad2_(),
+        tail_idx_( 0),
+        producers_waiting_( 0),
+        tail_mtx_(),
         not_full_cond_(),
-        hwm_( wm),
-        lwm_( wm)
-    {}
+        select_writeable_(),
+        stats_()
+    { init_(); }
+
+    Statistics const& statistics() const
+    { return stats_; }
 
     std::size_t upper_bound() const
     { return hwm_; }
@@ -171,154 +374,222 @@ public:
         deactivate_();
         not_empty_cond_.notify_all();
         not_full_cond_.notify_all();
+        select_readable_.notify_all();
+        select_writeable_.notify_all();
     }
 
     bool empty() const
     { return empty_(); }
 
-    void put( T const& t)
+    // returns false if the channel is full
+    bool try_put( T const& t)
     {
-        typename node_type::ptr new_node( new node_type() );
+        std::size_t previous = 0;
         {
             mutex::scoped_lock lk( tail_mtx_);
-
-            if ( full_() )
-            {
-                while ( active_() && full_() )
-                    not_full_cond_.wait( lk);
-            }
-
             if ( ! active_() )
                 boost::throw_exception( fiber_resource_error() );
+            if ( full_() )
+                return false;
+            previous = push_tail_( t);
+        }
+        pushed_( previous, false);
+        return true;
+    }
 
-            tail_->va = t;
-            tail_->next = new_node;
-            tail_ = new_node;
-            ++count_;
+    void put( T const& t)
+    {
+        std::size_t previous = 0;
+        bool waited = false;
+        {
+            mutex::scoped_lock lk( tail_mtx_);
+            wait_free_slot_( lk, waited);
+            previous = push_tail_( t);
         }
-        not_empty_cond_.notify_one();
+        pushed_( previous, waited);
     }
-#if 0
-    template< typename TimeDuration >
-    bool put( T const& t, TimeDuration const& dt)
-    { return put( t, chrono::system_clock::now() + dt); }
 
-    bool put( T const& t, chrono::system_clock::time_point const& abs_time)
+#ifndef BOOST_NO_RVALUE_REFERENCES
+    void put( BOOST_RV_REF( T) t)
     {
-        typename node_type::ptr new_node( new node_type() );
+        std::size_t previous = 0;
+        bool waited = false;
         {
             mutex::scoped_lock lk( tail_mtx_);
+            wait_free_slot_( lk, waited);
+            previous = push_tail_( boost::move( t) );
+        }
+        pushed_( previous, waited);
+    }
 
-            if ( full_() )
+#ifndef BOOST_NO_VARIADIC_TEMPLATES
+    // constructs the item in its slot
+    template< typename ... Args >
+    void emplace( Args && ... args)
+    {
+        std::size_t previous = 0;
+        bool waited = false;
+        {
+            mutex::scoped_lock lk( tail_mtx_);
+            wait_free_slot_( lk, waited);
+            slots_[tail_idx_].emplace( boost::forward< Args >( args) ... );
+            previous = tail_pushed_();
+        }
+        pushed_( previous, waited);
+    }
+#endif
+#endif
+
+    // the free slots are filled under one lock acquisition and
+    // consumers are notified at most once per filled chunk - items
+    // of other producers might be interleaved only if the channel
+    // becomes full
+    template< typename InputIterator >
+    void put_n( InputIterator first, InputIterator last)
+    {
+        bool waited = false;
+        while ( first != last)
+        {
+            std::size_t previous = 0;
             {
-                while ( active_() && full_() )
+                mutex::scoped_lock lk( tail_mtx_);
+
+                wait_free_slot_( lk, waited);
+
+                std::size_t n = 0;
+                for ( std::size_t free = hwm_ - size_(); first != last && n < free; ++first, ++n)
                 {
-                    if ( ! not_full_cond_.timed_wait( lk, abs_time) )
-                        return false;
+                    slots_[tail_idx_] = * first;
+                    tail_idx_ = increment_( tail_idx_);
                 }
+                stats_.on_put( n);
+                previous = count_.fetch_add( n);
             }
+            // tail_mtx_ must not be held - deactivate() locks head_mtx_ first
+            if ( 0 == previous)
+                notify_not_empty_();
+        }
+        if ( waited && lwm_ == hwm_ && ! full_() )
+            notify_not_full_();
+    }
 
-            if ( ! active_() )
-                boost::throw_exception( fiber_resource_error() );
+    // returns false if abs_time has expired before a slot became free
+    bool put_until( T const& t, chrono::system_clock::time_point const& abs_time)
+    {
+        std::size_t previous = 0;
+        bool waited = false;
+        {
+            mutex::scoped_lock lk( tail_mtx_);
+            if ( ! wait_free_slot_( lk, waited, & abs_time) )
+                return false;
+            previous = push_tail_( t);
+        }
+        pushed_( previous, waited);
+        return true;
+    }
+
+    template< typename TimeDuration >
+    bool put_for( T const& t, TimeDuration const& dt)
+    { return put_until( t, chrono::system_clock::now() + dt); }
 
-            tail_->va = t;
-            tail_->next = new_node;
-            tail_ = new_node;
-            ++count_;
+#ifndef BOOST_NO_RVALUE_REFERENCES
+    bool put_until( BOOST_RV_REF( T) t, chrono::system_clock::time_point const& abs_time)
+    {
+        std::size_t previous = 0;
+        bool waited = false;
+        {
+            mutex::scoped_lock lk( tail_mtx_);
+            if ( ! wait_free_slot_( lk, waited, & abs_time) )
+                return false;
+            previous = push_tail_( boost::move( t) );
         }
-        not_empty_cond_.notify_one();
+        pushed_( previous, waited);
         return true;
     }
+
+    template< typename TimeDuration >
+    bool put_for( BOOST_RV_REF( T) t, TimeDuration const& dt)
+    { return put_until( boost::move( t), chrono::system_clock::now() + dt); }
 #endif
+
     bool take( value_type & va)
+    { return take_( va, 0); }
+
+    // returns an empty value if the channel was deactivated
+    // or the fiber interrupted
+    value_type take()
     {
-        mutex::scoped_lock lk( head_mtx_);
-        bool empty = empty_();
-        if ( ! active_() && empty)
-            return false;
-        if ( empty)
-        {
-            try
-            {
-                while ( active_() && empty_() )
-                    not_empty_cond_.wait( lk);
-            }
-            catch ( fiber_interrupted const&)
-            { return false; }
-        }
-        if ( ! active_() && empty_() )
-            return false;
-        swap( va, head_->va);
-        pop_head_();
-        if ( size_() <= lwm_)
-        {
-            if ( lwm_ == hwm_)
-                not_full_cond_.notify_one();
-            else
-                // more than one producer could be waiting
-                // for submiting an action object
-                not_full_cond_.notify_all();
-        }
+        value_type va;
+        take( va);
         return va;
     }
-#if 0
-    template< typename TimeDuration >
-    bool take( value_type & va, TimeDuration const& dt)
-    { return take( va, chrono::system_clock::now() + dt); }
 
-    bool take( value_type & va, chrono::system_clock::time_point const& abs_time)
+    // waits until at least one item is available and moves up to
+    // max items to out under one lock acquisition, returns the
+    // number of items taken (zero if the channel was deactivated
+    // or the fiber interrupted)
+    template< typename OutputIterator >
+    std::size_t take_n( OutputIterator out, std::size_t max)
     {
+        if ( 0 == max) return 0;
+        bool waited = false;
         mutex::scoped_lock lk( head_mtx_);
         bool empty = empty_();
         if ( ! active_() && empty)
-            return false;
+            return 0;
         if ( empty)
         {
-            try
-            {
-                while ( active_() && empty_() )
-                {
-                    if ( ! not_empty_cond_.timed_wait( lk, abs_time) )
-                        return false;
-                }
-            }
-            catch ( fiber_interrupted const&)
-            { return false; }
+            waited = true;
+            if ( ! wait_not_empty_( lk, 0) )
+                return 0;
         }
         if ( ! active_() && empty_() )
-            return false;
-        swap( va, head_->va);
-        pop_head_();
-        if ( size_() <= lwm_)
-        {
-            if ( lwm_ == hwm_)
-                not_full_cond_.notify_one();
-            else
-                // more than one producer could be waiting
-                // for submiting an action object
-                not_full_cond_.notify_all();
-        }
-        return va;
+            return 0;
+        std::size_t n = (std::min)( max, size_() );
+        std::size_t size = pop_head_n_( out, n);
+        lk.unlock();
+        if ( below_threshold_( size, n) )
+            notify_not_full_();
+        if ( waited && 0 < size)
+            notify_not_empty_();
+        return n;
     }
-#endif
+
+    // moves all items currently in the channel to out without
+    // waiting, returns the number of items taken
+    template< typename OutputIterator >
+    std::size_t drain( OutputIterator out)
+    {
+        mutex::scoped_lock lk( head_mtx_);
+        std::size_t n = size_();
+        if ( 0 == n)
+            return 0;
+        std::size_t size = pop_head_n_( out, n);
+        lk.unlock();
+        if ( below_threshold_( size, n) )
+            notify_not_full_();
+        return n;
+    }
+
+    // returns false if abs_time has expired before an item became
+    // available (or the channel was deactivated, the fiber interrupted)
+    bool take_until( value_type & va, chrono::system_clock::time_point const& abs_time)
+    { return take_( va, & abs_time); }
+
+    template< typename TimeDuration >
+    bool take_for( value_type & va, TimeDuration const& dt)
+    { return take_until( va, chrono::system_clock::now() + dt); }
+
     bool try_take( value_type & va)
     {
         mutex::scoped_lock lk( head_mtx_);
         if ( empty_() )
             return false;
-        swap( va, head_->va);
-        pop_head_();
-        bool valid = va;
-        if ( valid && size_() <= lwm_)
-        {
-            if ( lwm_ == hwm_)
-                not_full_cond_.notify_one();
-            else
-                // more than one producer could be waiting
-                // in order to submit an task
-                not_full_cond_.notify_all();
-        }
-        return valid;
+        std::size_t size = pop_head_( va);
+        lk.unlock();
+        if ( threshold_() == size)
+            notify_not_full_();
+        return va;
     }
 };
 
@@ -0,0 +1,444 @@
+//          Copyright Oliver Kowalke 2009.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_FIBERS_BROADCAST_CHANNEL_H
+#define BOOST_FIBERS_BROADCAST_CHANNEL_H
+
+#include <algorithm>
+#include <cstddef>
+#include <deque>
+#include <vector>
+
+#include <boost/assert.hpp>
+#include <boost/atomic.hpp>
+#include <boost/config.hpp>
+#include <boost/cstdint.hpp>
+#include <boost/exception/all.hpp>
+#include <boost/foreach.hpp>
+#include <boost/make_shared.hpp>
+#include <boost/move/move.hpp>
+#include <boost/scoped_array.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/system/error_code.hpp>
+#include <boost/thread/locks.hpp>
+#include <boost/utility.hpp>
+
+#include <boost/fiber/detail/config.hpp>
+#include <boost/fiber/detail/notify.hpp>
+#include <boost/fiber/detail/scheduler.hpp>
+#include <boost/fiber/detail/spinlock.hpp>
+#include <boost/fiber/exceptions.hpp>
+#include <boost/fiber/interruption.hpp>
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+namespace boost {
+namespace fibers {
+
+// what happens if a subscriber falls more than capacity()
+// messages behind the publisher
+enum lag_policy_t
+{
+    // the oldest messages are overwritten, the subscriber
+    // skips them (counted by subscriber::missed())
+    drop_oldest = 0,
+    // the subscriber is disconnected, take() returns false
+    disconnect_lagging,
+    // the publisher waits for the slowest subscriber
+    block_publisher
+};
+
+// each message is appended once to a ring shared by all subscribers,
+// every subscriber has its own read cursor - the payload is shared
+// (reference counted), not copied per subscriber
+template< typename T >
+class broadcast_channel : private noncopyable
+{
+public:
+    typedef shared_ptr< T const >   value_type;
+
+    class subscriber;
+
+private:
+    enum state
+    {
+        ACTIVE = 0,
+        DEACTIVE
+    };
+
+    friend class subscriber;
+
+    atomic< state >                         state_;
+    lag_policy_t                            policy_;
+    std::size_t                             mask_;
+    scoped_array< value_type >              slots_;
+    mutable detail::spinlock                mtx_;
+    // sequence number of the next message
+    boost::uint64_t                         tail_;
+    // lower bound of the subscriber cursors (block_publisher)
+    boost::uint64_t                         min_cursor_;
+    std::vector< subscriber * >             subscribers_;
+    std::vector< subscriber * >             waiting_;
+    std::deque< detail::notify::ptr_t >     publishers_;
+
+    static std::size_t round_up_( std::size_t capacity)
+    {
+        std::size_t size = 1;
+        while ( size < capacity) size <<= 1;
+        return size;
+    }
+
+    bool active_() const
+    { return ACTIVE == state_; }
+
+    // mtx_ must be locked
+    void update_min_cursor_()
+    {
+        boost::uint64_t min = tail_;
+        BOOST_FOREACH( subscriber * s, subscribers_)
+        { if ( s->connected_ && s->cursor_ < min) min = s->cursor_; }
+        min_cursor_ = min;
+    }
+
+    // mtx_ must be locked, waits until the slowest subscriber
+    // has left the slot of the next message
+    void wait_not_full_( unique_lock< detail::spinlock > & lk)
+    {
+        if ( tail_ - min_cursor_ <= mask_) return;
+        update_min_cursor_();
+        if ( tail_ - min_cursor_ <= mask_) return;
+
+        detail::notify::ptr_t n( detail::scheduler::instance().active() );
+        bool is_fiber = n ? true : false;
+        if ( ! is_fiber)
+            // notifier for main-fiber
+            n = detail::scheduler::instance().notifier();
+
+        try
+        {
+            while ( active_() && tail_ - min_cursor_ > mask_)
+            {
+                publishers_.push_back( n);
+                if ( is_fiber)
+                {
+                    // suspend this fiber
+                    detail::scheduler::instance().wait( lk);
+                    lk.lock();
+                }
+                else
+                {
+                    lk.unlock();
+                    while ( ! n->is_ready() )
+                        // run scheduler
+                        detail::scheduler::instance().run();
+                    lk.lock();
+                }
+                remove_publisher_( n);
+                // check if fiber was interrupted
+                if ( is_fiber) this_fiber::interruption_point();
+                update_min_cursor_();
+            }
+        }
+        catch (...)
+        {
+            if ( ! lk.owns_lock() ) lk.lock();
+            remove_publisher_( n);
+            throw;
+        }
+    }
+
+    // mtx_ must be locked
+    void remove_publisher_( detail::notify::ptr_t const& n)
+    {
+        std::deque< detail::notify::ptr_t >::iterator i(
+            std::find( publishers_.begin(), publishers_.end(), n) );
+        if ( publishers_.end() != i) publishers_.erase( i);
+    }
+
+    // mtx_ must be locked, lk is released
+    void notify_publishers_( unique_lock< detail::spinlock > & lk)
+    {
+        std::deque< detail::notify::ptr_t > publishers;
+        publishers.swap( publishers_);
+        lk.unlock();
+
+        BOOST_FOREACH( detail::notify::ptr_t const& n, publishers)
+        { n->set_ready(); }
+    }
+
+    void put_( value_type const& va)
+    {
+        std::vector< detail::notify::ptr_t > ready;
+
+        unique_lock< detail::spinlock > lk( mtx_);
+        if ( ! active_() )
+            boost::throw_exception( fiber_resource_error() );
+        if ( block_publisher == policy_)
+        {
+            wait_not_full_( lk);
+            if ( ! active_() )
+                boost::throw_exception( fiber_resource_error() );
+        }
+
+        // a message overwritten by this put is released after lk
+        value_type old( va);
+        slots_[tail_ & mask_].swap( old);
+        ++tail_;
+
+        ready.reserve( waiting_.size() );
+        BOOST_FOREACH( subscriber * s, waiting_)
+        {
+            s->waiting_ = false;
+            ready.push_back( s->n_);
+        }
+        waiting_.clear();
+        lk.unlock();
+
+        BOOST_FOREACH( detail::notify::ptr_t const& n, ready)
+        { n->set_ready(); }
+    }
+
+public:
+    // a subscriber receives the messages put after its construction,
+    // it must be destroyed before the channel
+    class subscriber : private noncopyable
+    {
+    private:
+        friend class broadcast_channel;
+
+        broadcast_channel       &   ch_;
+        boost::uint64_t             cursor_;
+        std::size_t                 missed_;
+        bool                        connected_;
+        bool                        waiting_;
+        detail::notify::ptr_t       n_;
+
+        // ch_.mtx_ must be locked, returns false if no message
+        // is available or the subscriber was disconnected
+        bool try_take_( unique_lock< detail::spinlock > & lk, value_type & va)
+        {
+            if ( ! connected_ || cursor_ == ch_.tail_)
+                return false;
+
+            if ( ch_.tail_ - cursor_ > ch_.mask_ + 1)
+            {
+                // the messages at cursor_ were overwritten
+                if ( disconnect_lagging == ch_.policy_)
+                {
+                    connected_ = false;
+                    return false;
+                }
+                boost::uint64_t first = ch_.tail_ - ch_.mask_ - 1;
+                missed_ += static_cast< std::size_t >( first - cursor_);
+                cursor_ = first;
+            }
+
+            va = ch_.slots_[cursor_ & ch_.mask_];
+            if ( ch_.min_cursor_ == cursor_++ && ! ch_.publishers_.empty() )
+                // this subscriber might have blocked the publishers
+                ch_.notify_publishers_( lk);
+            return true;
+        }
+
+        // ch_.mtx_ must be locked
+        void remove_waiting_()
+        {
+            if ( ! waiting_) return;
+            typename std::vector< subscriber * >::iterator i(
+                std::find( ch_.waiting_.begin(), ch_.waiting_.end(), this) );
+            BOOST_ASSERT( ch_.waiting_.end() != i);
+            std::swap( * i, ch_.waiting_.back() );
+            ch_.waiting_.pop_back();
+            waiting_ = false;
+        }
+
+    public:
+        explicit subscriber( broadcast_channel & ch) :
+            ch_( ch),
+            cursor_( 0),
+            missed_( 0),
+            connected_( true),
+            waiting_( false),
+            n_()
+        {
+            unique_lock< detail::spinlock > lk( ch_.mtx_);
+            cursor_ = ch_.tail_;
+            ch_.subscribers_.push_back( this);
+        }
+
+        ~subscriber()
+        {
+            unique_lock< detail::spinlock > lk( ch_.mtx_);
+            BOOST_ASSERT( ! waiting_);
+            typename std::vector< subscriber * >::iterator i(
+                std::find( ch_.subscribers_.begin(), ch_.subscribers_.end(), this) );
+            BOOST_ASSERT( ch_.subscribers_.end() != i);
+            ch_.subscribers_.erase( i);
+            if ( ! ch_.publishers_.empty() )
+                // this subscriber might have blocked the publishers
+                ch_.notify_publishers_( lk);
+        }
+
+        // false if the subscriber fell behind with policy disconnect_lagging
+        bool connected() const
+        { return connected_; }
+
+        // number of messages skipped with policy drop_oldest
+        std::size_t missed() const
+        { return missed_; }
+
+        // returns false if no message is available
+        bool try_take( value_type & va)
+        {
+            unique_lock< detail::spinlock > lk( ch_.mtx_);
+            return try_take_( lk, va);
+        }
+
+        // returns false if the channel was deactivated (and all
+        // messages were taken), the subscriber disconnected or the
+        // fiber interrupted
+        bool take( value_type & va)
+        {
+            unique_lock< detail::spinlock > lk( ch_.mtx_);
+            if ( try_take_( lk, va) ) return true;
+            if ( ! connected_ || ! ch_.active_() ) return false;
+
+            n_ = detail::scheduler::instance().active();
+            bool is_fiber = n_ ? true : false;
+            if ( ! is_fiber)
+                // notifier for main-fiber
+                n_ = detail::scheduler::instance().notifier();
+            detail::notify::ptr_t n( n_);
+
+            try
+            {
+                do
+                {
+                    // registered until the next put()
+                    waiting_ = true;
+                    ch_.waiting_.push_back( this);
+                    if ( is_fiber)
+                    {
+                        // suspend this fiber
+                        detail::scheduler::instance().wait( lk);
+                        lk.lock();
+                        // woken up by an interruption request
+                        remove_waiting_();
+                        // check if fiber was interrupted
+                        this_fiber::interruption_point();
+                    }
+                    else
+                    {
+                        lk.unlock();
+                        while ( ! n->is_ready() )
+                            // run scheduler
+                            detail::scheduler::instance().run();
+                        // notifier of main-fiber might have been set
+                        // by a previous wait
+                        lk.lock();
+                        remove_waiting_();
+                    }
+                    if ( try_take_( lk, va) ) return true;
+                }
+                while ( connected_ && ch_.active_() );
+            }
+            catch ( fiber_interrupted const&)
+            {
+                if ( ! lk.owns_lock() ) lk.lock();
+                remove_waiting_();
+            }
+            return false;
+        }
+
+        value_type take()
+        {
+            value_type va;
+            take( va);
+            return va;
+        }
+    };
+
+    explicit broadcast_channel( std::size_t capacity = 1024,
+                                lag_policy_t policy = drop_oldest) :
+        state_( ACTIVE),
+        policy_( policy),
+        mask_( round_up_( capacity) - 1),
+        slots_(),
+        mtx_(),
+        tail_( 0),
+        min_cursor_( 0),
+        subscribers_(),
+        waiting_(),
+        publishers_()
+    {
+        if ( 0 == capacity)
+            boost::throw_exception(
+                invalid_argument(
+                    system::errc::invalid_argument,
+                    "boost fiber: zero capacity for broadcast_channel") );
+        slots_.reset( new value_type[mask_ + 1]);
+    }
+
+    ~broadcast_channel()
+    { BOOST_ASSERT( subscribers_.empty() ); }
+
+    std::size_t capacity() const
+    { return mask_ + 1; }
+
+    lag_policy_t policy() const
+    { return policy_; }
+
+    bool active() const
+    { return active_(); }
+
+    std::size_t subscribers() const
+    {
+        unique_lock< detail::spinlock > lk( mtx_);
+        return subscribers_.size();
+    }
+
+    // waiting subscribers return false after all messages are taken,
+    // waiting publishers throw fiber_resource_error
+    void deactivate()
+    {
+        std::vector< detail::notify::ptr_t > ready;
+
+        unique_lock< detail::spinlock > lk( mtx_);
+        state_ = DEACTIVE;
+        BOOST_FOREACH( subscriber * s, waiting_)
+        {
+            s->waiting_ = false;
+            ready.push_back( s->n_);
+        }
+        waiting_.clear();
+        notify_publishers_( lk);
+
+        BOOST_FOREACH( detail::notify::ptr_t const& n, ready)
+        { n->set_ready(); }
+    }
+
+    // the message is shared by all subscribers without copying
+    void put( value_type const& va)
+    { put_( va); }
+
+    // copies t once into the shared message
+    void put( T const& t)
+    { put_( boost::make_shared< T const >( t) ); }
+
+#ifndef BOOST_NO_RVALUE_REFERENCES
+    void put( BOOST_RV_REF( T) t)
+    { put_( boost::make_shared< T const >( boost::move( t) ) ); }
+#endif
+};
+
+}}
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
+
+#endif // BOOST_FIBERS_BROADCAST_CHANNEL_H
@@ -0,0 +1,176 @@
+//          Copyright Oliver Kowalke 2009.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_FIBERS_CHANNEL_STATISTICS_H
+#define BOOST_FIBERS_CHANNEL_STATISTICS_H
+
+#include <cstddef>
+
+#include <boost/atomic.hpp>
+#include <boost/chrono/duration.hpp>
+#include <boost/config.hpp>
+#include <boost/cstdint.hpp>
+#include <boost/utility.hpp>
+
+#include <boost/fiber/detail/config.hpp>
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+namespace boost {
+namespace fibers {
+
+// default statistics policy of the channels - all hooks are empty
+// and the channels do not read the clock (enabled == false)
+struct null_channel_statistics
+{
+    static const bool enabled = false;
+
+    void on_put( std::size_t) {}
+
+    void on_take( std::size_t) {}
+
+    void on_producer_wait( chrono::nanoseconds const&) {}
+
+    void on_consumer_wait( chrono::nanoseconds const&) {}
+};
+
+// counts items and the time fibers were blocked in a channel,
+// the counters are updated with relaxed atomics - producers and
+// consumers update separate cache-lines
+class channel_statistics : private noncopyable
+{
+public:
+    static const bool enabled = true;
+
+    // bucket i counts waits shorter than 2^i microseconds,
+    // the last bucket all longer waits
+    static const std::size_t histogram_size = 20;
+
+    struct wait_snapshot
+    {
+        boost::uint64_t         count;
+        chrono::nanoseconds     total;
+        chrono::nanoseconds     max;
+        boost::uint64_t         histogram[histogram_size];
+
+        wait_snapshot() :
+            count( 0), total( 0), max( 0)
+        { for ( std::size_t i = 0; i < histogram_size; ++i) histogram[i] = 0; }
+    };
+
+    struct snapshot
+    {
+        std::size_t             depth;
+        std::size_t             max_depth;
+        boost::uint64_t         puts;
+        boost::uint64_t         takes;
+        // time producers spent blocked on a full channel
+        wait_snapshot           producers;
+        // time consumers spent blocked on an empty channel
+        wait_snapshot           consumers;
+
+        snapshot() :
+            depth( 0), max_depth( 0), puts( 0), takes( 0),
+            producers(), consumers()
+        {}
+    };
+
+private:
+    struct wait_counters
+    {
+        atomic< boost::uint64_t >   count;
+        atomic< boost::uint64_t >   total;
+        atomic< boost::uint64_t >   max;
+        atomic< boost::uint64_t >   histogram[histogram_size];
+
+        wait_counters() :
+            count( 0), total( 0), max( 0)
+        {
+            for ( std::size_t i = 0; i < histogram_size; ++i)
+                histogram[i].store( 0, memory_order_relaxed);
+        }
+
+        void add( chrono::nanoseconds const& ns)
+        {
+            boost::uint64_t t = ns.count() > 0 ? static_cast< boost::uint64_t >( ns.count() ) : 0;
+            count.fetch_add( 1, memory_order_relaxed);
+            total.fetch_add( t, memory_order_relaxed);
+            boost::uint64_t m = max.load( memory_order_relaxed);
+            while ( m < t && ! max.compare_exchange_weak( m, t, memory_order_relaxed) );
+
+            std::size_t i = 0;
+            for ( boost::uint64_t us = t / 1000; 0 != us && i < histogram_size - 1; us >>= 1)
+                ++i;
+            histogram[i].fetch_add( 1, memory_order_relaxed);
+        }
+
+        void load( wait_snapshot & s) const
+        {
+            s.count = count.load( memory_order_relaxed);
+            s.total = chrono::nanoseconds( total.load( memory_order_relaxed) );
+            s.max = chrono::nanoseconds( max.load( memory_order_relaxed) );
+            for ( std::size_t i = 0; i < histogram_size; ++i)
+                s.histogram[i] = histogram[i].load( memory_order_relaxed);
+        }
+    };
+
+    // producer side
+    atomic< boost::uint64_t >       puts_;
+    atomic< std::size_t >           max_depth_;
+    wait_counters                   producers_;
+    char                            pad_[BOOST_FIBERS_CACHELINE_SIZE];
+    // consumer side
+    atomic< boost::uint64_t >       takes_;
+    wait_counters                   consumers_;
+
+public:
+    channel_statistics() :
+        puts_( 0), max_depth_( 0), producers_(), pad_(),
+        takes_( 0), consumers_()
+    {}
+
+    void on_put( std::size_t n)
+    {
+        boost::uint64_t puts = puts_.fetch_add( n, memory_order_relaxed) + n;
+        // approximation - a concurrent take might not be counted yet
+        std::size_t depth = static_cast< std::size_t >(
+            puts - takes_.load( memory_order_relaxed) );
+        std::size_t m = max_depth_.load( memory_order_relaxed);
+        while ( m < depth && ! max_depth_.compare_exchange_weak( m, depth, memory_order_relaxed) );
+    }
+
+    void on_take( std::size_t n)
+    { takes_.fetch_add( n, memory_order_relaxed); }
+
+    void on_producer_wait( chrono::nanoseconds const& ns)
+    { producers_.add( ns); }
+
+    void on_consumer_wait( chrono::nanoseconds const& ns)
+    { consumers_.add( ns); }
+
+    // the counters are read one by one, the snapshot is consistent
+    // only if the channel is quiescent
+    snapshot get_snapshot() const
+    {
+        snapshot s;
+        s.takes = takes_.load( memory_order_relaxed);
+        s.puts = puts_.load( memory_order_relaxed);
+        s.depth = s.puts > s.takes ? static_cast< std::size_t >( s.puts - s.takes) : 0;
+        s.max_depth = max_depth_.load( memory_order_relaxed);
+        producers_.load( s.producers);
+        consumers_.load( s.consumers);
+        return s;
+    }
+};
+
+}}
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
+
+#endif // BOOST_FIBERS_CHANNEL_STATISTICS_H
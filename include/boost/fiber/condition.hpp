@@ -115,6 +115,100 @@ public:
         // lock external again before returning
         lt.lock();
     }
+
+    // returns false if abs_time has expired before the fiber was notified
+    // the deadline is registered at the scheduler (no polling)
+    template< typename LockType >
+    bool timed_wait( LockType & lt, chrono::system_clock::time_point const& abs_time)
+    {
+        detail::notify::ptr_t n( detail::scheduler::instance().active() );
+        bool is_fiber = n ? true : false;
+        // the main-fiber consumed the notification
+        bool woken = false;
+        try
+        {
+            if ( is_fiber)
+            {
+                // store this fiber in order to be notified later
+                unique_lock< detail::spinlock > lk( waiting_mtx_);
+                waiting_.push_back( n);
+                lt.unlock();
+
+                // suspend fiber until notified or abs_time has expired
+                detail::scheduler::instance().wait_until( lk, abs_time);
+
+                // check if fiber was interrupted
+                this_fiber::interruption_point();
+            }
+            else
+            {
+                // notifier for main-fiber
+                n = detail::scheduler::instance().notifier();
+                // store this fiber in order to be notified later
+                unique_lock< detail::spinlock > lk( waiting_mtx_);
+                waiting_.push_back( n);
+
+                lk.unlock();
+                lt.unlock();
+                while ( ! ( woken = n->is_ready() ) && chrono::system_clock::now() < abs_time)
+                    // run scheduler
+                    detail::scheduler::instance().run();
+            }
+        }
+        catch (...)
+        {
+            // remove fiber from waiting_
+            unique_lock< detail::spinlock > lk( waiting_mtx_);
+            std::deque< detail::notify::ptr_t >::iterator i(
+                std::find( waiting_.begin(), waiting_.end(), n) );
+            if ( waiting_.end() != i) waiting_.erase( i);
+            throw;
+        }
+
+        // a fiber still in waiting_ was not notified - the deadline
+        // has expired or the fiber was woken up by an interruption
+        // request, a notification racing with the deadline wins
+        bool notified = true;
+        {
+            unique_lock< detail::spinlock > lk( waiting_mtx_);
+            std::deque< detail::notify::ptr_t >::iterator i(
+                std::find( waiting_.begin(), waiting_.end(), n) );
+            if ( waiting_.end() != i)
+            {
+                waiting_.erase( i);
+                notified = false;
+            }
+        }
+        // a notification after the loop timed out sets the flag of the
+        // main-fiber notifier shared by all primitives - consume it (the
+        // notifier sets the flag after removing n from waiting_)
+        if ( notified && ! is_fiber && ! woken)
+            while ( ! n->is_ready() )
+                detail::scheduler::instance().run();
+
+        // lock external again before returning
+        lt.lock();
+        return notified || chrono::system_clock::now() < abs_time;
+    }
+
+    template< typename LockType, typename Pred >
+    bool timed_wait( LockType & lt, chrono::system_clock::time_point const& abs_time, Pred pred)
+    {
+        while ( ! pred() )
+        {
+            if ( ! timed_wait( lt, abs_time) )
+                return pred();
+        }
+        return true;
+    }
+
+    template< typename LockType, typename TimeDuration >
+    bool timed_wait( LockType & lt, TimeDuration const& dt)
+    { return timed_wait( lt, chrono::system_clock::now() + dt); }
+
+    template< typename LockType, typename TimeDuration, typename Pred >
+    bool timed_wait( LockType & lt, TimeDuration const& dt, Pred pred)
+    { return timed_wait( lt, chrono::system_clock::now() + dt, pred); }
 };
 
 typedef condition condition_variable;
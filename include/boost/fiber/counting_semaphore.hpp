@@ -0,0 +1,78 @@
+//          Copyright Oliver Kowalke 2009.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_FIBERS_COUNTING_SEMAPHORE_H
+#define BOOST_FIBERS_COUNTING_SEMAPHORE_H
+
+#include <cstddef>
+#include <deque>
+
+#include <boost/atomic.hpp>
+#include <boost/chrono/system_clocks.hpp>
+#include <boost/config.hpp>
+#include <boost/utility.hpp>
+
+#include <boost/fiber/detail/config.hpp>
+#include <boost/fiber/detail/notify.hpp>
+#include <boost/fiber/detail/spinlock.hpp>
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+# if defined(BOOST_MSVC)
+# pragma warning(push)
+# pragma warning(disable:4355 4251 4275)
+# endif
+
+namespace boost {
+namespace fibers {
+
+class BOOST_FIBERS_DECL counting_semaphore : private noncopyable
+{
+private:
+    // permits are taken from permits_ without locking as long as
+    // permits are available; waiting_mtx_ is acquired only if a fiber
+    // has to wait or release() finds waiters_ != 0
+    atomic< std::size_t >           permits_;
+    atomic< std::size_t >           waiters_;
+    detail::spinlock                waiting_mtx_;
+    std::deque<
+        detail::notify::ptr_t
+    >                               waiting_;
+
+    void notify_( std::size_t);
+
+    bool wait_( chrono::system_clock::time_point const&);
+
+public:
+    explicit counting_semaphore( std::size_t initial = 0);
+
+    ~counting_semaphore();
+
+    void acquire();
+
+    bool try_acquire();
+
+    template< typename TimeDuration >
+    bool try_acquire_for( TimeDuration const& dt)
+    { return try_acquire_until( chrono::system_clock::now() + dt); }
+
+    bool try_acquire_until( chrono::system_clock::time_point const&);
+
+    void release( std::size_t n = 1);
+};
+
+}}
+
+# if defined(BOOST_MSVC)
+# pragma warning(pop)
+# endif
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
+
+#endif // BOOST_FIBERS_COUNTING_SEMAPHORE_H
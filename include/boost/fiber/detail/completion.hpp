@@ -0,0 +1,67 @@
+//          Copyright Oliver Kowalke 2009.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_FIBERS_DETAIL_COMPLETION_H
+#define BOOST_FIBERS_DETAIL_COMPLETION_H
+
+#include <boost/assert.hpp>
+#include <boost/config.hpp>
+#include <boost/utility.hpp>
+
+#include <boost/fiber/detail/config.hpp>
+#include <boost/fiber/detail/notify.hpp>
+#include <boost/fiber/detail/spinlock.hpp>
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+# if defined(BOOST_MSVC)
+# pragma warning(push)
+# pragma warning(disable:4251 4275)
+# endif
+
+namespace boost {
+namespace fibers {
+namespace detail {
+
+// a done flag set by one context and waited for by one other context
+// (parallel_task, task_graph)
+class BOOST_FIBERS_DECL completion : private noncopyable
+{
+private:
+    spinlock            mtx_;
+    bool                done_;
+    notify::ptr_t       waiter_;
+
+public:
+    explicit completion( bool done = false);
+
+    ~completion()
+    { BOOST_ASSERT( ! waiter_); }
+
+    // not called while a context waits
+    void reset();
+
+    // the owner of this object might be destroyed
+    // by the waiter as soon as set() has released mtx_
+    void set();
+
+    // a fiber is suspended, the main fiber runs the other fibers until
+    // its notifier is ready, a thread without scheduler yields
+    void wait();
+};
+
+}}}
+
+# if defined(BOOST_MSVC)
+# pragma warning(pop)
+# endif
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
+
+#endif // BOOST_FIBERS_DETAIL_COMPLETION_H
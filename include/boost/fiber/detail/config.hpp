@@ -39,6 +39,27 @@
 # include <boost/config/auto_link.hpp>
 #endif
 
+// size of a cache-line, used to separate data accessed by
+// different fibers/threads
+#if ! defined BOOST_FIBERS_CACHELINE_SIZE
+# define BOOST_FIBERS_CACHELINE_SIZE 64
+#endif
+
+// EPOLL - the fiber I/O functions (io.hpp) wait in an epoll reactor
+#if defined(__linux__) && ! defined BOOST_FIBERS_NO_EPOLL
+# define BOOST_FIBERS_HAS_EPOLL
+#endif
+
+// IO_URING - the fiber I/O functions submit their operations to an
+// io_uring instance if the kernel supports it (the epoll reactor otherwise)
+#if defined(BOOST_FIBERS_HAS_EPOLL) && ! defined BOOST_FIBERS_NO_IO_URING
+# if defined(__has_include)
+#  if __has_include(<linux/io_uring.h>)
+#   define BOOST_FIBERS_HAS_IO_URING
+#  endif
+# endif
+#endif
+
 // FUTURE_INVALID_AFTER_GET
 #if ! defined BOOST_FIBERS_PROVIDES_FUTURE_INVALID_AFTER_GET \
  && ! defined BOOST_FIBERS_DONT_PROVIDE_FUTURE_INVALID_AFTER_GET
@@ -0,0 +1,68 @@
+//          Copyright Oliver Kowalke 2009.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_FIBERS_DETAIL_COUNTDOWN_H
+#define BOOST_FIBERS_DETAIL_COUNTDOWN_H
+
+#include <cstddef>
+#include <deque>
+
+#include <boost/atomic.hpp>
+#include <boost/config.hpp>
+#include <boost/utility.hpp>
+
+#include <boost/fiber/detail/config.hpp>
+#include <boost/fiber/detail/notify.hpp>
+#include <boost/fiber/detail/spinlock.hpp>
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+# if defined(BOOST_MSVC)
+# pragma warning(push)
+# pragma warning(disable:4251 4275)
+# endif
+
+namespace boost {
+namespace fibers {
+namespace detail {
+
+// counter and waiting fibers of latch and wait_group - the
+// fibers waiting are released if the counter reaches zero
+class BOOST_FIBERS_DECL countdown : private noncopyable
+{
+private:
+    // sub() touches waiting_mtx_ only if the
+    // counter reaches zero, try_wait() only if it is zero
+    atomic< std::size_t >           count_;
+    spinlock                        waiting_mtx_;
+    std::deque< notify::ptr_t >     waiting_;
+
+public:
+    explicit countdown( std::size_t count);
+
+    ~countdown();
+
+    void add( std::size_t n);
+
+    void sub( std::size_t n);
+
+    void wait();
+
+    bool try_wait();
+};
+
+}}}
+
+# if defined(BOOST_MSVC)
+# pragma warning(pop)
+# endif
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
+
+#endif // BOOST_FIBERS_DETAIL_COUNTDOWN_H
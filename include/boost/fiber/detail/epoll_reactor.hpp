@@ -0,0 +1,108 @@
+//          Copyright Oliver Kowalke 2009.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_FIBERS_DETAIL_EPOLL_REACTOR_H
+#define BOOST_FIBERS_DETAIL_EPOLL_REACTOR_H
+
+#include <cstddef>
+#include <deque>
+#include <vector>
+
+#include <boost/config.hpp>
+#include <boost/utility.hpp>
+
+#include <boost/fiber/detail/config.hpp>
+#include <boost/fiber/detail/fiber_base.hpp>
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+# if defined(BOOST_MSVC)
+# pragma warning(push)
+# pragma warning(disable:4251 4275)
+# endif
+
+namespace boost {
+namespace fibers {
+namespace detail {
+
+// direction a fiber waits for on a file descriptor
+enum io_op
+{
+    io_read = 0,
+    io_write = 1
+};
+
+#if defined(BOOST_FIBERS_HAS_EPOLL)
+
+// readiness of file descriptors for the fibers of one scheduler - a
+// descriptor is registered edge-triggered for both directions at its first
+// wait and stays registered until deregister(), so waiting costs no
+// epoll_ctl() call; a fiber waits only after the operation returned EAGAIN
+//
+// not thread-safe, used by the thread running the scheduler
+class BOOST_FIBERS_DECL epoll_reactor : private noncopyable
+{
+private:
+    typedef std::vector< fiber_base::ptr_t >    waiters_t;
+
+    struct descriptor
+    {
+        bool        registered;
+        waiters_t   waiters[2];
+
+        descriptor() :
+            registered( false)
+        {}
+    };
+
+    int                         epfd_;
+    std::vector< descriptor >   descriptors_;
+    std::size_t                 waiting_;
+
+    void wake_( waiters_t &, std::deque< fiber_base::ptr_t > &);
+
+public:
+    // throws fiber_resource_error if no epoll instance can be created
+    epoll_reactor();
+
+    ~epoll_reactor();
+
+    // f is resumed after fd became ready for op - f must be suspended
+    // (state waiting) by the caller
+    void add_waiter( int fd, io_op op, fiber_base::ptr_t const& f);
+
+    // must be called before fd is closed, the descriptor might be
+    // reused by the kernel - appends the fibers still waiting for
+    // fd to ready, returns the number of fibers made ready
+    std::size_t deregister( int fd, std::deque< fiber_base::ptr_t > & ready);
+
+    // waits at most timeout_ms milliseconds (-1 infinite, 0 non-blocking)
+    // and appends the fibers of ready descriptors to ready, returns
+    // the number of fibers made ready
+    std::size_t poll( int timeout_ms, std::deque< fiber_base::ptr_t > & ready);
+
+    std::size_t waiting() const BOOST_NOEXCEPT
+    { return waiting_; }
+
+    // the epoll descriptor is readable if events are available
+    int native_handle() const BOOST_NOEXCEPT
+    { return epfd_; }
+};
+
+#endif
+
+}}}
+
+# if defined(BOOST_MSVC)
+# pragma warning(pop)
+# endif
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
+
+#endif // BOOST_FIBERS_DETAIL_EPOLL_REACTOR_H
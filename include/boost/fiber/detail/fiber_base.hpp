@@ -23,6 +23,7 @@
 
 #include <boost/fiber/detail/config.hpp>
 #include <boost/fiber/detail/flags.hpp>
+#include <boost/fiber/detail/fss.hpp>
 #include <boost/fiber/detail/notify.hpp>
 #include <boost/fiber/detail/spinlock.hpp>
 #include <boost/fiber/detail/states.hpp>
@@ -44,6 +45,20 @@ private:
     template< typename X, typename Y, typename Z >
     friend class fiber_object;
 
+    struct fss_data
+    {
+        std::size_t                         generation;
+        void                            *   vp;
+        fss_cleanup_function::ptr_t         cleanup_function;
+
+        fss_data() BOOST_NOEXCEPT :
+            generation( 0), vp( 0), cleanup_function()
+        {}
+
+        void do_cleanup()
+        { ( * cleanup_function)( vp); }
+    };
+
     atomic< std::size_t >   use_count_;
     atomic< state_t >       state_;
     atomic< int >           flags_;
@@ -51,8 +66,10 @@ private:
     context::fcontext_t     caller_;
     context::fcontext_t *   callee_;
     exception_ptr           except_;
+    chrono::system_clock::time_point    tp_;
     spinlock                joining_mtx_;
     std::vector< ptr_t >    joining_;
+    std::vector< fss_data > fss_data_;
 
     void add_ref() BOOST_NOEXCEPT
     { ++use_count_; }
@@ -69,6 +86,8 @@ protected:
 
     void release();
 
+    void release_fss_data();
+
 public:
     class id
     {
@@ -135,6 +154,29 @@ public:
     void priority( int prio) BOOST_NOEXCEPT
     { priority_ = prio; }
 
+    chrono::system_clock::time_point const& time_point() const BOOST_NOEXCEPT
+    { return tp_; }
+
+    void time_point( chrono::system_clock::time_point const& tp) BOOST_NOEXCEPT
+    { tp_ = tp; }
+
+    void time_point_reset() BOOST_NOEXCEPT
+    { tp_ = (chrono::system_clock::time_point::max)(); }
+
+    // fss-slots are accessed only by the fiber itself
+    void * get_fss_data( fss_key const& key) const BOOST_NOEXCEPT
+    {
+        if ( key.index < fss_data_.size() && key.generation == fss_data_[key.index].generation)
+            return fss_data_[key.index].vp;
+        return 0;
+    }
+
+    void set_fss_data(
+        fss_key const& key,
+        fss_cleanup_function::ptr_t const& cleanup_fn,
+        void * data,
+        bool cleanup_existing);
+
     void resume();
 
     void suspend();
@@ -99,7 +99,7 @@ public:
                 stack_alloc.allocate( attr.size), attr.size,
                 trampoline< fiber_object >),
             fpu_preserved == attr.preserve_fpu),
-        fn_( forward< Fn >( fn) ),
+        fn_( boost::forward< Fn >( fn) ),
         stack_( fiber_base::callee_->fc_stack),
         stack_alloc_( stack_alloc),
         alloc_( alloc)
@@ -138,6 +138,7 @@ public:
     {
         if ( ! is_terminated() )
             unwind_stack();
+        stack_alloc_.deallocate( stack_.sp, stack_.size);
     }
 
     void exec()
@@ -157,6 +158,7 @@ public:
         catch (...)
         { except_ = current_exception(); }
 
+        release_fss_data();
         set_terminated();
         release();
         context::jump_fcontext( callee_, & caller_, 0, preserve_fpu() );
@@ -234,6 +236,7 @@ public:
     {
         if ( ! is_terminated() )
             unwind_stack();
+        stack_alloc_.deallocate( stack_.sp, stack_.size);
     }
 
     void exec()
@@ -253,6 +256,7 @@ public:
         catch (...)
         { except_ = current_exception(); }
 
+        release_fss_data();
         set_terminated();
         release();
         context::jump_fcontext( callee_, & caller_, 0, preserve_fpu() );
@@ -330,6 +334,7 @@ public:
     {
         if ( ! is_terminated() )
             unwind_stack();
+        stack_alloc_.deallocate( stack_.sp, stack_.size);
     }
 
     void exec()
@@ -350,6 +355,7 @@ public:
         catch (...)
         { except_ = current_exception(); }
 
+        release_fss_data();
         set_terminated();
         release();
         context::jump_fcontext( callee_, & caller_, 0, preserve_fpu() );
@@ -0,0 +1,76 @@
+//          Copyright Oliver Kowalke 2009.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_FIBERS_DETAIL_FIBER_POOL_H
+#define BOOST_FIBERS_DETAIL_FIBER_POOL_H
+
+#include <cstddef>
+#include <deque>
+
+#include <boost/config.hpp>
+#include <boost/function.hpp>
+#include <boost/utility.hpp>
+
+#include <boost/fiber/detail/config.hpp>
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+# if defined(BOOST_MSVC)
+# pragma warning(push)
+# pragma warning(disable:4251 4275)
+# endif
+
+namespace boost {
+namespace fibers {
+namespace detail {
+
+// runs posted functions in fibers of the calling thread - a worker
+// fiber runs queued functions until the queue is empty, a new worker
+// is created only if no worker is free (each worker might block
+// in a function)
+class BOOST_FIBERS_DECL fiber_pool : private noncopyable
+{
+private:
+    typedef std::deque< function< void() > >   queue_t;
+
+    queue_t         queue_;
+    std::size_t     workers_;
+    // workers not running a function
+    std::size_t     free_;
+
+    void spawn_();
+
+    void worker_();
+
+public:
+    fiber_pool();
+
+    // the pool of the calling thread
+    static fiber_pool & instance();
+
+    // fn runs after the calling fiber has been suspended
+    void post( function< void() > const& fn);
+
+    bool idle() const BOOST_NOEXCEPT
+    { return 0 == workers_; }
+};
+
+// queues fn at the worker threads of the parallel algorithms (see
+// parallel.cpp), fn runs in a pooled fiber of the worker taking it
+BOOST_FIBERS_DECL void post_any_worker( function< void() > const& fn);
+
+}}}
+
+# if defined(BOOST_MSVC)
+# pragma warning(pop)
+# endif
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
+
+#endif // BOOST_FIBERS_DETAIL_FIBER_POOL_H
@@ -0,0 +1,72 @@
+//          Copyright Oliver Kowalke 2009.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_FIBERS_DETAIL_FSS_H
+#define BOOST_FIBERS_DETAIL_FSS_H
+
+#include <cstddef>
+
+#include <boost/atomic.hpp>
+#include <boost/config.hpp>
+#include <boost/intrusive_ptr.hpp>
+#include <boost/utility.hpp>
+
+#include <boost/fiber/detail/config.hpp>
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+namespace boost {
+namespace fibers {
+namespace detail {
+
+class fss_cleanup_function : private noncopyable
+{
+private:
+    atomic< std::size_t >   use_count_;
+
+public:
+    typedef intrusive_ptr< fss_cleanup_function >   ptr_t;
+
+    fss_cleanup_function() BOOST_NOEXCEPT :
+        use_count_( 0)
+    {}
+
+    virtual ~fss_cleanup_function() {}
+
+    virtual void operator()( void * data) = 0;
+
+    friend inline void intrusive_ptr_add_ref( fss_cleanup_function * p) BOOST_NOEXCEPT
+    { ++p->use_count_; }
+
+    friend inline void intrusive_ptr_release( fss_cleanup_function * p)
+    { if ( 0 == --p->use_count_) delete p; }
+};
+
+// a key addresses a slot in the fss-array of each fiber
+// slots are recycled - the generation distinguishes the
+// current owner of a slot from previous ones
+struct fss_key
+{
+    std::size_t     index;
+    std::size_t     generation;
+
+    fss_key() BOOST_NOEXCEPT :
+        index( 0), generation( 0)
+    {}
+};
+
+BOOST_FIBERS_DECL fss_key allocate_fss_key();
+
+BOOST_FIBERS_DECL void free_fss_key( fss_key const&);
+
+}}}
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
+
+#endif // BOOST_FIBERS_DETAIL_FSS_H
@@ -0,0 +1,158 @@
+//          Copyright Oliver Kowalke 2009.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_FIBERS_DETAIL_IO_URING_H
+#define BOOST_FIBERS_DETAIL_IO_URING_H
+
+#include <cstddef>
+#include <deque>
+#include <vector>
+
+#include <boost/config.hpp>
+#include <boost/utility.hpp>
+
+#include <boost/fiber/detail/config.hpp>
+#include <boost/fiber/detail/fiber_base.hpp>
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+# if defined(BOOST_MSVC)
+# pragma warning(push)
+# pragma warning(disable:4251 4275)
+# endif
+
+namespace boost {
+namespace fibers {
+namespace detail {
+
+// an I/O operation completed by the scheduler - lives on the stack
+// of the fiber, which is suspended until the operation has completed
+struct io_request
+{
+    enum opcode
+    {
+        read = 0,
+        write,
+        fsync,
+        accept,
+        connect,
+        opcode_size
+    };
+
+    opcode              op;
+    int                 fd;
+    // data (read, write), socket address (accept, connect)
+    void            *   buf;
+    // byte count (read, write), address length (connect)
+    std::size_t         len;
+    // socklen_t * of accept
+    void            *   addrlen;
+    // bytes transferred, the accepted socket or -errno
+    long                result;
+    fiber_base::ptr_t   fiber;
+    // requests in flight for fd, cancelled by io::close()
+    io_request      *   prev;
+    io_request      *   next;
+    bool                cancelled;
+
+    io_request( opcode op_, int fd_) :
+        op( op_), fd( fd_), buf( 0), len( 0), addrlen( 0), result( 0), fiber(),
+        prev( 0), next( 0), cancelled( false)
+    {}
+};
+
+#if defined(BOOST_FIBERS_HAS_IO_URING)
+
+// io_uring instance of one scheduler, driven by raw system calls - the
+// requests prepared by the fibers are submitted together by submit(),
+// reap() reads the completion ring without a system call
+//
+// not thread-safe, used by the thread running the scheduler
+class BOOST_FIBERS_DECL io_uring_backend : private noncopyable
+{
+private:
+    int                 fd_;
+    void            *   sq_ring_;
+    std::size_t         sq_ring_size_;
+    void            *   cq_ring_;
+    std::size_t         cq_ring_size_;
+    void            *   sqes_;
+    std::size_t         sqes_size_;
+    unsigned        *   sq_head_;
+    unsigned        *   sq_tail_;
+    unsigned            sq_mask_;
+    unsigned        *   sq_array_;
+    unsigned        *   sq_flags_;
+    unsigned        *   cq_head_;
+    unsigned        *   cq_tail_;
+    unsigned            cq_mask_;
+    void            *   cqes_;
+    // prepared, not yet submitted
+    unsigned            pending_;
+    // submitted, not yet reaped
+    std::size_t         inflight_;
+    bool                supported_[io_request::opcode_size];
+    bool                cancel_supported_;
+    // requests in flight, indexed by descriptor
+    std::vector< io_request * >   fds_;
+
+    io_uring_backend();
+
+    bool setup_( unsigned entries);
+
+    void * next_sqe_();
+
+    void link_( io_request & req);
+
+    void unlink_( io_request & req);
+
+public:
+    // returns 0 if io_uring is not available (old kernel, disabled by
+    // the system or BOOST_FIBERS_IO_URING=0 in the environment)
+    static io_uring_backend * create();
+
+    ~io_uring_backend();
+
+    bool supports( io_request::opcode op) const BOOST_NOEXCEPT
+    { return supported_[op]; }
+
+    // queues req, its fiber is made ready by reap() - returns false
+    // if the submission queue is full and could not be submitted
+    bool prepare( io_request & req);
+
+    // submits the prepared requests with one system call
+    void submit();
+
+    // cancels the requests in flight for fd, their fibers are resumed
+    // by reap() - a cancelled request fails with EBADF
+    void cancel( int fd);
+
+    // appends the fibers of completed requests to ready,
+    // returns the number of completions
+    std::size_t reap( std::deque< fiber_base::ptr_t > & ready);
+
+    // the ring descriptor is readable if completions are available
+    int native_handle() const BOOST_NOEXCEPT
+    { return fd_; }
+
+    std::size_t inflight() const BOOST_NOEXCEPT
+    { return inflight_ + pending_; }
+};
+
+#endif
+
+}}}
+
+# if defined(BOOST_MSVC)
+# pragma warning(pop)
+# endif
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
+
+#endif // BOOST_FIBERS_DETAIL_IO_URING_H
@@ -102,6 +102,9 @@ public:
 
     static algorithm & instance() BOOST_NOEXCEPT;
 
+    // false if no scheduling algorithm was installed in this thread
+    static bool has_instance() BOOST_NOEXCEPT;
+
     static algorithm * replace( algorithm *) BOOST_NOEXCEPT;
 };
 
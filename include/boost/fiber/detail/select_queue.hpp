@@ -0,0 +1,102 @@
+//          Copyright Oliver Kowalke 2009.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_FIBERS_DETAIL_SELECT_QUEUE_H
+#define BOOST_FIBERS_DETAIL_SELECT_QUEUE_H
+
+#include <cstddef>
+#include <vector>
+
+#include <boost/atomic.hpp>
+#include <boost/config.hpp>
+#include <boost/intrusive_ptr.hpp>
+#include <boost/utility.hpp>
+
+#include <boost/fiber/detail/config.hpp>
+#include <boost/fiber/detail/notify.hpp>
+#include <boost/fiber/detail/spinlock.hpp>
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+# if defined(BOOST_MSVC)
+# pragma warning(push)
+# pragma warning(disable:4251 4275)
+# endif
+
+namespace boost {
+namespace fibers {
+namespace detail {
+
+// a fiber blocked in selector::wait() - the same waiter is
+// registered at the select_queue of each channel, the first
+// channel firing the waiter resumes the fiber
+class BOOST_FIBERS_DECL select_waiter : private noncopyable
+{
+private:
+    atomic< std::size_t >   use_count_;
+
+public:
+    typedef intrusive_ptr< select_waiter >  ptr_t;
+
+    spinlock                mtx;
+    notify::ptr_t           n;
+    bool                    fired;
+
+    select_waiter() :
+        use_count_( 0), mtx(), n(), fired( false)
+    {}
+
+    // returns the notifier to be set ready if this call
+    // fired the waiter
+    notify::ptr_t fire();
+
+    friend inline void intrusive_ptr_add_ref( select_waiter * p) BOOST_NOEXCEPT
+    { p->use_count_.fetch_add( 1, memory_order_relaxed); }
+
+    friend inline void intrusive_ptr_release( select_waiter * p)
+    {
+        if ( 1 == p->use_count_.fetch_sub( 1, memory_order_release) )
+        {
+            atomic_thread_fence( memory_order_acquire);
+            delete p;
+        }
+    }
+};
+
+// waiters registered at one side (readable/writeable) of a channel
+// the channel calls notify_all() after its state has changed, the
+// call is a fence and a load if no waiter is registered
+class BOOST_FIBERS_DECL select_queue : private noncopyable
+{
+private:
+    atomic< std::size_t >               count_;
+    spinlock                            mtx_;
+    std::vector< select_waiter::ptr_t > waiting_;
+
+public:
+    select_queue();
+
+    ~select_queue();
+
+    void subscribe( select_waiter::ptr_t const&);
+
+    void unsubscribe( select_waiter::ptr_t const&);
+
+    void notify_all();
+};
+
+}}}
+
+# if defined(BOOST_MSVC)
+# pragma warning(pop)
+# endif
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
+
+#endif // BOOST_FIBERS_DETAIL_SELECT_QUEUE_H
@@ -0,0 +1,151 @@
+//          Copyright Oliver Kowalke 2009.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_FIBERS_EXECUTOR_H
+#define BOOST_FIBERS_EXECUTOR_H
+
+#include <cstddef>
+#include <deque>
+
+#include <boost/config.hpp>
+#include <boost/function.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/utility.hpp>
+
+#include <boost/fiber/detail/config.hpp>
+#include <boost/fiber/fiber.hpp>
+#include <boost/fiber/operations.hpp>
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+# if defined(BOOST_MSVC)
+# pragma warning(push)
+# pragma warning(disable:4251 4275)
+# endif
+
+namespace boost {
+namespace fibers {
+
+// an executor runs a nullary function object passed to submit()
+
+// runs the function in the calling context
+struct inline_executor
+{
+    template< typename Fn >
+    void submit( Fn fn)
+    { fn(); }
+};
+
+namespace detail {
+
+template< typename Fn >
+struct posted_fn
+{
+    Fn  fn;
+
+    posted_fn( Fn fn_) :
+        fn( fn_)
+    {}
+
+    void operator()()
+    {
+        // return to the submitting context first
+        this_fiber::yield();
+        fn();
+    }
+};
+
+}
+
+// runs the function in a new fiber of the scheduler of the calling
+// thread, the submitting context is resumed before the function runs
+struct fiber_executor
+{
+    template< typename Fn >
+    void submit( Fn fn)
+    { fiber( detail::posted_fn< Fn >( fn) ).detach(); }
+};
+
+// owns a worker thread running a round_robin scheduler - the
+// functions are run in pooled fibers of the worker thread
+class BOOST_FIBERS_DECL thread_executor : private noncopyable
+{
+private:
+    typedef std::deque< function< void() > >   queue_t;
+
+    boost::mutex                mtx_;
+    boost::condition_variable   cond_;
+    queue_t                     queue_;
+    bool                        stop_;
+    boost::thread               thrd_;
+
+    void worker_();
+
+    void submit_( function< void() > const&);
+
+public:
+    thread_executor();
+
+    // runs the pending functions and joins the worker thread
+    ~thread_executor();
+
+    template< typename Fn >
+    void submit( Fn fn)
+    { submit_( function< void() >( fn) ); }
+};
+
+namespace detail {
+
+// executors passed to unique_future::then() - stateless executors
+// are copied, all others referenced
+template< typename Executor >
+class executor_ref
+{
+private:
+    Executor    *   ex_;
+
+public:
+    executor_ref( Executor & ex) :
+        ex_( & ex)
+    {}
+
+    template< typename Fn >
+    void submit( Fn fn)
+    { ex_->submit( fn); }
+};
+
+template<>
+class executor_ref< inline_executor > : public inline_executor
+{
+public:
+    executor_ref( inline_executor const&)
+    {}
+};
+
+template<>
+class executor_ref< fiber_executor > : public fiber_executor
+{
+public:
+    executor_ref( fiber_executor const&)
+    {}
+};
+
+}
+
+}}
+
+# if defined(BOOST_MSVC)
+# pragma warning(pop)
+# endif
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
+
+#endif // BOOST_FIBERS_EXECUTOR_H
@@ -85,7 +85,7 @@ public:
         object_t::allocator_t a( alloc);
         impl_ = ptr_t(
             // placement new
-            ::new( a.allocate( 1) ) object_t( forward< fiber_fn >( fn), attr, stack_alloc, a) );
+            ::new( a.allocate( 1) ) object_t( boost::forward< fiber_fn >( fn), attr, stack_alloc, a) );
         spawn_( impl_);
     }
 
@@ -101,7 +101,7 @@ public:
         object_t::allocator_t a( alloc);
         impl_ = ptr_t(
             // placement new
-            ::new( a.allocate( 1) ) object_t( forward< fiber_fn >( fn), attr, stack_alloc, a) );
+            ::new( a.allocate( 1) ) object_t( boost::forward< fiber_fn >( fn), attr, stack_alloc, a) );
         spawn_( impl_);
     }
 
@@ -117,7 +117,7 @@ public:
         object_t::allocator_t a( alloc);
         impl_ = ptr_t(
             // placement new
-            ::new( a.allocate( 1) ) object_t( forward< fiber_fn >( fn), attr, stack_alloc, a) );
+            ::new( a.allocate( 1) ) object_t( boost::forward< fiber_fn >( fn), attr, stack_alloc, a) );
         spawn_( impl_);
     }
 #endif
@@ -137,7 +137,7 @@ public:
         typename object_t::allocator_t a( alloc);
         impl_ = ptr_t(
             // placement new
-            ::new( a.allocate( 1) ) object_t( forward< Fn >( fn), attr, stack_alloc, a) );
+            ::new( a.allocate( 1) ) object_t( boost::forward< Fn >( fn), attr, stack_alloc, a) );
         spawn_( impl_);
     }
 
@@ -157,7 +157,7 @@ public:
         typename object_t::allocator_t a( alloc);
         impl_ = ptr_t(
             // placement new
-            ::new( a.allocate( 1) ) object_t( forward< Fn >( fn), attr, stack_alloc, a) );
+            ::new( a.allocate( 1) ) object_t( boost::forward< Fn >( fn), attr, stack_alloc, a) );
         spawn_( impl_);
     }
     template< typename Fn, typename StackAllocator, typename Allocator >
@@ -176,7 +176,7 @@ public:
         typename object_t::allocator_t a( alloc);
         impl_ = ptr_t(
             // placement new
-            ::new( a.allocate( 1) ) object_t( forward< Fn >( fn), attr, stack_alloc, a) );
+            ::new( a.allocate( 1) ) object_t( boost::forward< Fn >( fn), attr, stack_alloc, a) );
         spawn_( impl_);
     }
 #else
@@ -0,0 +1,114 @@
+//          Copyright Oliver Kowalke 2009.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_FIBERS_FIBER_SPECIFIC_PTR_H
+#define BOOST_FIBERS_FIBER_SPECIFIC_PTR_H
+
+#include <boost/assert.hpp>
+#include <boost/config.hpp>
+#include <boost/utility.hpp>
+
+#include <boost/fiber/detail/config.hpp>
+#include <boost/fiber/detail/fss.hpp>
+#include <boost/fiber/detail/scheduler.hpp>
+#include <boost/fiber/operations.hpp>
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+namespace boost {
+namespace fibers {
+
+template< typename T >
+class fiber_specific_ptr : private noncopyable
+{
+private:
+    struct default_cleanup_function : public detail::fss_cleanup_function
+    {
+        void operator()( void * data)
+        { delete static_cast< T * >( data); }
+    };
+
+    struct custom_cleanup_function : public detail::fss_cleanup_function
+    {
+        void ( * fn)( T *);
+
+        explicit custom_cleanup_function( void ( * fn_)( T *) ) :
+            fn( fn_)
+        {}
+
+        void operator()( void * data)
+        { if ( fn) fn( static_cast< T * >( data) ); }
+    };
+
+    detail::fss_key                         key_;
+    detail::fss_cleanup_function::ptr_t     cleanup_fn_;
+
+public:
+    typedef T   element_type;
+
+    fiber_specific_ptr() :
+        key_( detail::allocate_fss_key() ),
+        cleanup_fn_( new default_cleanup_function() )
+    {}
+
+    explicit fiber_specific_ptr( void( * fn)( T *) ) :
+        key_( detail::allocate_fss_key() ),
+        cleanup_fn_( new custom_cleanup_function( fn) )
+    {}
+
+    ~fiber_specific_ptr()
+    {
+        // values of other fibers are cleaned up if those
+        // fibers terminate or the slot gets reused
+        if ( detail::scheduler::has_instance() && this_fiber::is_fiberized() )
+            reset();
+        detail::free_fss_key( key_);
+    }
+
+    // zero if not called by a fiber
+    T * get() const
+    {
+        if ( ! detail::scheduler::has_instance() ) return 0;
+        detail::fiber_base::ptr_t const& f( detail::scheduler::instance().active() );
+        if ( ! f) return 0;
+        return static_cast< T * >( f->get_fss_data( key_) );
+    }
+
+    T * operator->() const
+    { return get(); }
+
+    T & operator*() const
+    { return * get(); }
+
+    // must be called by a fiber
+    T * release()
+    {
+        BOOST_ASSERT( this_fiber::is_fiberized() );
+        T * tmp = get();
+        detail::scheduler::instance().active()->set_fss_data(
+            key_, cleanup_fn_, 0, false);
+        return tmp;
+    }
+
+    // must be called by a fiber
+    void reset( T * t = 0)
+    {
+        BOOST_ASSERT( this_fiber::is_fiberized() );
+        T * c = get();
+        if ( c != t)
+            detail::scheduler::instance().active()->set_fss_data(
+                key_, cleanup_fn_, t, true);
+    }
+};
+
+}}
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
+
+#endif // BOOST_FIBERS_FIBER_SPECIFIC_PTR_H
@@ -8,8 +8,12 @@
 #define BOOST_FIBERS_FUTURE_HPP
 
 #include <algorithm>
-#include <list>
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <new>
 #include <stdexcept>
+#include <utility>
 #include <vector>
 
 #include <boost/atomic.hpp>
@@ -18,24 +22,37 @@
 #include <boost/config.hpp>
 #include <boost/exception_ptr.hpp>
 #include <boost/function.hpp>
+#include <boost/intrusive_ptr.hpp>
 #include <boost/move/move.hpp>
 #include <boost/mpl/if.hpp>
 #include <boost/next_prior.hpp>
 #include <boost/preprocessor/cat.hpp>
 #include <boost/preprocessor/punctuation/comma_if.hpp>
+#include <boost/preprocessor/repetition/enum.hpp>
+#include <boost/preprocessor/repetition/enum_params.hpp>
 #include <boost/preprocessor/repetition/repeat_from_to.hpp>
 #include <boost/ref.hpp>
-#include <boost/scoped_array.hpp>
-#include <boost/scoped_ptr.hpp>
 #include <boost/shared_ptr.hpp>
 #include <boost/throw_exception.hpp>
+#include <boost/thread/locks.hpp>
+#include <boost/type_traits/aligned_storage.hpp>
+#include <boost/type_traits/alignment_of.hpp>
 #include <boost/type_traits/is_convertible.hpp>
+#include <boost/type_traits/integral_constant.hpp>
 #include <boost/type_traits/is_fundamental.hpp>
+#include <boost/type_traits/is_same.hpp>
+#include <boost/type_traits/is_void.hpp>
 #include <boost/utility/enable_if.hpp>
 #include <boost/utility/result_of.hpp>
 
-#include <boost/fiber/condition.hpp>
-#include <boost/fiber/mutex.hpp>
+#include <boost/fiber/detail/fiber_pool.hpp>
+#include <boost/fiber/detail/notify.hpp>
+#include <boost/fiber/detail/scheduler.hpp>
+#include <boost/fiber/detail/select_queue.hpp>
+#include <boost/fiber/detail/spinlock.hpp>
+#include <boost/fiber/executor.hpp>
+#include <boost/fiber/fiber.hpp>
+#include <boost/fiber/interruption.hpp>
 
 namespace boost {
 namespace fibers {
@@ -91,6 +108,13 @@ namespace fibers {
         {}
     };
 
+    // selects the allocator-aware constructors of promise and
+    // packaged_task and the overloads of async() and then()
+    struct allocator_arg_t
+    {};
+
+    const allocator_arg_t allocator_arg = allocator_arg_t();
+
     namespace future_state
     {
         enum state { uninitialized, waiting, ready, moved };
@@ -98,122 +122,320 @@ namespace fibers {
 
     namespace detail
     {
-        struct future_continuation_base
+        // notified by each future it was added to (continuations,
+        // when_all/when_any), index identifies the future
+        struct future_completion_base
         {
-            future_continuation_base() {}
+        protected:
+            virtual void add_ref() BOOST_NOEXCEPT=0;
+            virtual void release_ref()=0;
+
+        public:
+            future_completion_base() {}
 
-            virtual ~future_continuation_base() {}
+            virtual ~future_completion_base() {}
 
-            virtual void do_continuation(boost::unique_lock<boost::fibers::mutex>& ) {};
+            virtual void on_ready(std::size_t index)=0;
+
+            friend inline void intrusive_ptr_add_ref(future_completion_base* p) BOOST_NOEXCEPT
+            {
+                p->add_ref();
+            }
+
+            friend inline void intrusive_ptr_release(future_completion_base* p)
+            {
+                p->release_ref();
+            }
 
         private:
-            future_continuation_base(future_continuation_base const&);
-            future_continuation_base& operator=(future_continuation_base const&);
+            future_completion_base(future_completion_base const&);
+            future_completion_base& operator=(future_completion_base const&);
         };
 
-        template <typename F, typename R, typename C>
-        struct future_continuation;
+        // completion owning its reference count
+        struct future_completion:
+            future_completion_base
+        {
+            atomic<std::size_t> use_count;
+
+            future_completion():
+                use_count(0)
+            {}
+
+        protected:
+            void add_ref() BOOST_NOEXCEPT
+            {
+                use_count.fetch_add(1,memory_order_relaxed);
+            }
 
+            void release_ref()
+            {
+                if(1==use_count.fetch_sub(1,memory_order_release))
+                {
+                    atomic_thread_fence(memory_order_acquire);
+                    delete this;
+                }
+            }
+        };
+
+        // shared state of promise/packaged_task and the futures - allocated
+        // once and reference counted intrusively. The bits in `state' make
+        // storing the result and get() of a ready future lock-free, the
+        // spinlock is only acquired if fibers wait or completions are
+        // registered (state_waiters).
         struct future_object_base
         {
+            enum
+            {
+                // a result is being stored
+                state_busy=1,
+                // the result is stored
+                state_ready=2,
+                // waiters or completions are registered
+                state_waiters=4
+            };
+
+            typedef std::vector<detail::notify::ptr_t> waiter_list;
+            typedef std::vector<detail::select_waiter::ptr_t> external_waiter_list;
+            typedef std::vector<std::pair<boost::intrusive_ptr<future_completion_base>,std::size_t> > completion_list;
+
+            atomic<std::size_t> use_count;
+            atomic<int> state;
             boost::exception_ptr exception;
-            atomic< bool > done;
-            boost::fibers::mutex mutex;
-            boost::fibers::condition waiters;
-            typedef std::list<boost::fibers::condition*> waiter_list;
-            waiter_list external_waiters;
+            detail::spinlock splk;
+            // the common case - one fiber waits on the future
+            detail::notify::ptr_t waiter;
+            waiter_list more_waiters;
+            external_waiter_list external_waiters;
+            completion_list completions;
             boost::function<void()> callback;
-            shared_ptr<future_continuation_base>    continuation_ptr;
 
             future_object_base():
-                done(false)
+                use_count(0),state(0),exception(),splk(),waiter(),
+                more_waiters(),external_waiters(),completions(),callback()
             {}
             virtual ~future_object_base()
             {}
 
-            waiter_list::iterator register_external_waiter(boost::fibers::condition& cv)
+            // overridden by states created by an allocator
+            virtual void deallocate_object()
             {
-                boost::unique_lock<boost::fibers::mutex> lock(mutex);
-                do_callback(lock);
-                return external_waiters.insert(external_waiters.end(),&cv);
+                delete this;
             }
-            
-            void remove_external_waiter(waiter_list::iterator it)
+
+            friend inline void intrusive_ptr_add_ref(future_object_base* p) BOOST_NOEXCEPT
             {
-                boost::unique_lock<boost::fibers::mutex> lock(mutex);
-                external_waiters.erase(it);
+                p->use_count.fetch_add(1,memory_order_relaxed);
             }
 
-            void do_continuation(boost::unique_lock<boost::fibers::mutex>& lock)
+            friend inline void intrusive_ptr_release(future_object_base* p)
             {
-                if (continuation_ptr) {
-                    continuation_ptr->do_continuation(lock);
+                if(1==p->use_count.fetch_sub(1,memory_order_release))
+                {
+                    atomic_thread_fence(memory_order_acquire);
+                    p->deallocate_object();
                 }
             }
 
-            void set_continuation_ptr(future_continuation_base* continuation,
-                    boost::unique_lock<boost::fibers::mutex>& lock)
+            bool is_ready() const
+            {
+                return 0!=(state.load(memory_order_acquire)&state_ready);
+            }
+
+            // splk must be locked - returns false if the state is already ready
+            bool subscribe_internal()
+            {
+                return 0==(state.fetch_or(state_waiters,memory_order_acq_rel)&state_ready);
+            }
+
+            bool register_external_waiter(detail::select_waiter::ptr_t const& w)
             {
-                continuation_ptr.reset(continuation);
-                if (done) {
-                    do_continuation(lock);
+                do_callback();
+                boost::unique_lock<detail::spinlock> lock(splk);
+                if(!subscribe_internal())
+                {
+                    return false;
+                }
+                external_waiters.push_back(w);
+                return true;
+            }
+            
+            void remove_external_waiter(detail::select_waiter::ptr_t const& w)
+            {
+                boost::unique_lock<detail::spinlock> lock(splk);
+                external_waiter_list::iterator it(
+                    std::find(external_waiters.begin(),external_waiters.end(),w));
+                if(external_waiters.end()!=it)
+                {
+                    external_waiters.erase(it);
                 }
             }
 
-            void mark_finished_internal(boost::unique_lock<boost::fibers::mutex>& lock)
+            // c->on_ready(index) is called once the state is ready -
+            // immediately if it is already ready
+            void add_completion(boost::intrusive_ptr<future_completion_base> const& c,std::size_t index)
             {
-                done=true;
-                waiters.notify_all();
-                for(waiter_list::const_iterator it=external_waiters.begin(),
-                        end=external_waiters.end();it!=end;++it)
+                // runs a deferred function
+                do_callback();
+                boost::unique_lock<detail::spinlock> lock(splk);
+                if(subscribe_internal())
                 {
-                    (*it)->notify_all();
+                    completions.push_back(std::make_pair(c,index));
+                    return;
                 }
-                do_continuation(lock);
+                lock.unlock();
+                c->on_ready(index);
             }
 
-            void make_ready()
+            // claims the right to store the result - fails if a
+            // result is (being) stored
+            bool begin_finish()
             {
-                boost::unique_lock<boost::fibers::mutex> lock(mutex);
-                mark_finished_internal(lock);
+                return 0==(state.fetch_or(state_busy,memory_order_acquire)&(state_busy|state_ready));
+            }
+
+            // storing the result has thrown
+            void abort_finish()
+            {
+                state.fetch_and(~state_busy,memory_order_release);
             }
 
-            struct relocker
+            void mark_finished_internal()
             {
-                boost::unique_lock<boost::fibers::mutex>& lock;
-                
-                relocker(boost::unique_lock<boost::fibers::mutex>& lock_):
-                    lock(lock_)
+                if(state.fetch_or(state_ready,memory_order_acq_rel)&state_waiters)
                 {
-                    lock.unlock();
+                    notify_waiters();
                 }
-                ~relocker()
+            }
+
+            void notify_waiters()
+            {
+                detail::notify::ptr_t n;
+                waiter_list ns;
+                completion_list cs;
                 {
-                    lock.lock();
+                    boost::unique_lock<detail::spinlock> lock(splk);
+                    n.swap(waiter);
+                    ns.swap(more_waiters);
+                    cs.swap(completions);
+                    // external waiters are removed by the waiting fiber
+                    for(external_waiter_list::const_iterator it=external_waiters.begin(),
+                            end=external_waiters.end();it!=end;++it)
+                    {
+                        detail::notify::ptr_t tmp((*it)->fire());
+                        if(tmp)
+                        {
+                            ns.push_back(tmp);
+                        }
+                    }
                 }
-            private:
-                relocker& operator=(relocker const&);
-            };
+                if(n)
+                {
+                    n->set_ready();
+                }
+                for(waiter_list::const_iterator it=ns.begin(),end=ns.end();it!=end;++it)
+                {
+                    (*it)->set_ready();
+                }
+                for(completion_list::const_iterator it=cs.begin(),end=cs.end();it!=end;++it)
+                {
+                    it->first->on_ready(it->second);
+                }
+            }
+
+            void remove_waiter(detail::notify::ptr_t const& n)
+            {
+                if(waiter==n)
+                {
+                    waiter.reset();
+                    return;
+                }
+                waiter_list::iterator it(std::find(more_waiters.begin(),more_waiters.end(),n));
+                if(more_waiters.end()!=it)
+                {
+                    more_waiters.erase(it);
+                }
+            }
 
-            void do_callback(boost::unique_lock<boost::fibers::mutex>& lock)
+            void do_callback()
             {
-                if(callback && !done)
+                if(callback && !is_ready())
                 {
                     boost::function<void()> local_callback=callback;
-                    relocker relock(lock);
                     local_callback();
                 }
             }
-            
 
-            void wait(bool rethrow=true)
+            void wait_internal()
             {
-                boost::unique_lock<boost::fibers::mutex> lock(mutex);
-                do_callback(lock);
-                while(!done)
+                if(is_ready())
+                {
+                    return;
+                }
+
+                detail::notify::ptr_t n(detail::scheduler::instance().active());
+                bool is_fiber=n?true:false;
+                if(!is_fiber)
+                {
+                    // notifier for main-fiber
+                    n=detail::scheduler::instance().notifier();
+                }
+
+                boost::unique_lock<detail::spinlock> lock(splk);
+                if(!subscribe_internal())
                 {
-                    waiters.wait(lock);
+                    return;
                 }
+                if(!waiter)
+                {
+                    waiter=n;
+                }
+                else
+                {
+                    more_waiters.push_back(n);
+                }
+
+                try
+                {
+                    // the waiter is removed by notify_waiters()
+                    while(!is_ready())
+                    {
+                        if(is_fiber)
+                        {
+                            // suspend this fiber
+                            detail::scheduler::instance().wait(lock);
+                            // check if fiber was interrupted
+                            this_fiber::interruption_point();
+                        }
+                        else
+                        {
+                            lock.unlock();
+                            // notifier of main-fiber might have been set
+                            // by a previous wait
+                            while(!n->is_ready())
+                            {
+                                // run scheduler
+                                detail::scheduler::instance().run();
+                            }
+                        }
+                        lock.lock();
+                    }
+                }
+                catch(...)
+                {
+                    if(!lock.owns_lock())
+                    {
+                        lock.lock();
+                    }
+                    remove_waiter(n);
+                    throw;
+                }
+            }
+
+            void wait(bool rethrow=true)
+            {
+                do_callback();
+                wait_internal();
                 if(rethrow && exception)
                 {
                     boost::rethrow_exception(exception);
@@ -235,27 +457,29 @@ namespace fibers {
                 return true;
             }
 #endif
-            void mark_exceptional_finish_internal(boost::exception_ptr const& e,
-                                          boost::unique_lock<boost::fibers::mutex>& lock)
+            // returns false if a result was already stored
+            bool mark_exceptional_finish_internal(boost::exception_ptr const& e)
             {
+                if(!begin_finish())
+                {
+                    return false;
+                }
                 exception=e;
-                mark_finished_internal(lock);
+                mark_finished_internal();
+                return true;
             }
             void mark_exceptional_finish()
             {
-                boost::unique_lock<boost::fibers::mutex> lock(mutex);
-                mark_exceptional_finish_internal(boost::current_exception(),lock);
+                mark_exceptional_finish_internal(boost::current_exception());
             }
 
             bool has_value()
             {
-                boost::unique_lock<boost::fibers::mutex> lock(mutex);
-                return done && !exception;
+                return is_ready() && !exception;
             }
             bool has_exception()
             {
-                boost::unique_lock<boost::fibers::mutex> lock(mutex);
-                return done && exception;
+                return is_ready() && exception;
             }
 
             template<typename F,typename U>
@@ -272,7 +496,10 @@ namespace fibers {
         template<typename T>
         struct future_traits
         {
-            typedef boost::scoped_ptr<T> storage_type;
+            // the result is stored inside the shared state
+            typedef typename boost::aligned_storage<
+                sizeof(T),boost::alignment_of<T>::value
+            >::type storage_type;
 #ifndef BOOST_NO_RVALUE_REFERENCES
             typedef T const& source_reference_type;
             struct dummy;
@@ -286,17 +513,22 @@ namespace fibers {
 
             static void init(storage_type& storage,source_reference_type t)
             {
-                storage.reset(new T(t));
+                new (storage.address()) T(t);
             }
             
             static void init(storage_type& storage,rvalue_source_type t)
             {
-                storage.reset(new T(static_cast<rvalue_source_type>(t)));
+                new (storage.address()) T(static_cast<rvalue_source_type>(t));
+            }
+
+            static T& get(storage_type& storage)
+            {
+                return *static_cast<T*>(storage.address());
             }
 
             static void cleanup(storage_type& storage)
             {
-                storage.reset();
+                get(storage).~T();
             }
         };
         
@@ -314,6 +546,11 @@ namespace fibers {
                 storage=&t;
             }
 
+            static T& get(storage_type& storage)
+            {
+                return *storage;
+            }
+
             static void cleanup(storage_type& storage)
             {
                 storage=0;
@@ -350,41 +587,73 @@ namespace fibers {
             storage_type result;
 
             future_object():
-                result(0)
+                result()
             {}
 
-            void mark_finished_with_result_internal(source_reference_type result_, boost::unique_lock<boost::fibers::mutex>& lock)
+            ~future_object()
+            {
+                if(has_value())
+                {
+                    future_traits<T>::cleanup(result);
+                }
+            }
+
+            // returns false if a result was already stored
+            bool mark_finished_with_result_internal(source_reference_type result_)
             {
-                future_traits<T>::init(result,result_);
-                mark_finished_internal(lock);
+                if(!begin_finish())
+                {
+                    return false;
+                }
+                try
+                {
+                    future_traits<T>::init(result,result_);
+                }
+                catch(...)
+                {
+                    abort_finish();
+                    throw;
+                }
+                mark_finished_internal();
+                return true;
             }
-            void mark_finished_with_result_internal(rvalue_source_type result_, boost::unique_lock<boost::fibers::mutex>& lock)
+            bool mark_finished_with_result_internal(rvalue_source_type result_)
             {
-                future_traits<T>::init(result,static_cast<rvalue_source_type>(result_));
-                mark_finished_internal( lock);
+                if(!begin_finish())
+                {
+                    return false;
+                }
+                try
+                {
+                    future_traits<T>::init(result,static_cast<rvalue_source_type>(result_));
+                }
+                catch(...)
+                {
+                    abort_finish();
+                    throw;
+                }
+                mark_finished_internal();
+                return true;
             }
 
             void mark_finished_with_result(source_reference_type result_)
             {
-                boost::unique_lock<boost::fibers::mutex> lock(mutex);
-                mark_finished_with_result_internal(result_, lock);
+                mark_finished_with_result_internal(result_);
             }
             void mark_finished_with_result(rvalue_source_type result_)
             {
-                boost::unique_lock<boost::fibers::mutex> lock(mutex);
-                mark_finished_with_result_internal(result_, lock);
+                mark_finished_with_result_internal(static_cast<rvalue_source_type>(result_));
             }
 
             move_dest_type get()
             {
                 wait();
-                return static_cast<move_dest_type>(*result);
+                return static_cast<move_dest_type>(future_traits<T>::get(result));
             }
 
             future_state::state get_state()
             {
-                boost::unique_lock<boost::fibers::mutex> guard(mutex);
-                if(!done)
+                if(!is_ready())
                 {
                     return future_state::waiting;
                 }
@@ -406,15 +675,20 @@ namespace fibers {
             future_object()
             {}
 
-            void mark_finished_with_result_internal(boost::unique_lock<boost::fibers::mutex>& lock)
+            // returns false if a result was already stored
+            bool mark_finished_with_result_internal()
             {
-                mark_finished_internal(lock);
+                if(!begin_finish())
+                {
+                    return false;
+                }
+                mark_finished_internal();
+                return true;
             }
 
             void mark_finished_with_result()
             {
-                boost::unique_lock<boost::fibers::mutex> lock(mutex);
-                mark_finished_with_result_internal(lock);
+                mark_finished_with_result_internal();
             }
 
             void get()
@@ -424,8 +698,7 @@ namespace fibers {
             
             future_state::state get_state()
             {
-                boost::unique_lock<boost::fibers::mutex> guard(mutex);
-                if(!done)
+                if(!is_ready())
                 {
                     return future_state::waiting;
                 }
@@ -442,58 +715,50 @@ namespace fibers {
 
         class future_waiter
         {
-            struct registered_waiter;
-            typedef std::vector<registered_waiter>::size_type count_type;
+            typedef std::vector<boost::intrusive_ptr<detail::future_object_base> >::size_type count_type;
             
             struct registered_waiter
             {
-                boost::shared_ptr<detail::future_object_base> future;
-                detail::future_object_base::waiter_list::iterator wait_iterator;
+                boost::intrusive_ptr<detail::future_object_base> future;
                 count_type index;
 
-                registered_waiter(boost::shared_ptr<detail::future_object_base> const& future_,
-                                  detail::future_object_base::waiter_list::iterator wait_iterator_,
+                registered_waiter(boost::intrusive_ptr<detail::future_object_base> const& future_,
                                   count_type index_):
-                    future(future_),wait_iterator(wait_iterator_),index(index_)
+                    future(future_),index(index_)
                 {}
 
             };
             
-            struct all_futures_lock
+            // registered at each future, the first future becoming
+            // ready fires the waiter
+            detail::select_waiter::ptr_t waiter;
+            std::vector<registered_waiter> futures;
+            count_type future_count;
+
+            // a future becomes ready before it fires the waiter - the main
+            // fiber returning without having been notified disarms the
+            // waiter and consumes a notification already handed out,
+            // otherwise it would end the next wait of the main fiber
+            void consume(detail::notify::ptr_t const& n,bool woken)
             {
-                count_type count;
-                boost::scoped_array<boost::unique_lock<boost::fibers::mutex> > locks;
-                
-                all_futures_lock(std::vector<registered_waiter>& futures):
-                    count(futures.size()),locks(new boost::unique_lock<boost::fibers::mutex>[count])
+                bool fired=false;
                 {
-                    for(count_type i=0;i<count;++i)
-                    {
-                        locks[i]=boost::unique_lock<boost::fibers::mutex>(futures[i].future->mutex);
-                    }
-                }
-                
-                void lock()
-                {
-                    boost::lock(locks.get(),locks.get()+count);
+                    boost::unique_lock<detail::spinlock> lk(waiter->mtx);
+                    fired=waiter->fired;
+                    waiter->fired=true;
                 }
-                
-                void unlock()
+                if(fired&&!woken)
                 {
-                    for(count_type i=0;i<count;++i)
+                    while(!n->is_ready())
                     {
-                        locks[i].unlock();
+                        detail::scheduler::instance().run();
                     }
                 }
-            };
-            
-            boost::fibers::condition cv;
-            std::vector<registered_waiter> futures;
-            count_type future_count;
+            }
             
         public:
             future_waiter():
-                future_count(0)
+                waiter(new detail::select_waiter()),future_count(0)
             {}
             
             template<typename F>
@@ -501,24 +766,67 @@ namespace fibers {
             {
                 if(f.future)
                 {
-                    futures.push_back(registered_waiter(f.future,f.future->register_external_waiter(cv),future_count));
+                    f.future->register_external_waiter(waiter);
+                    futures.push_back(registered_waiter(f.future,future_count));
                 }
                 ++future_count;
             }
 
             count_type wait()
             {
-                all_futures_lock lk(futures);
+                detail::notify::ptr_t n(detail::scheduler::instance().active());
+                bool is_fiber=n?true:false;
+                if(!is_fiber)
+                {
+                    // notifier for main-fiber
+                    n=detail::scheduler::instance().notifier();
+                }
+                // false if a future fired the waiter before n was
+                // stored, n is not notified then
+                bool armed=false;
+                {
+                    // a future might have fired the waiter already
+                    boost::unique_lock<detail::spinlock> lk(waiter->mtx);
+                    armed=!waiter->fired;
+                    waiter->n=n;
+                }
+
+                bool woken=false;
                 for(;;)
                 {
                     for(count_type i=0;i<futures.size();++i)
                     {
-                        if(futures[i].future->done)
+                        if(futures[i].future->is_ready())
                         {
+                            if(!is_fiber&&armed)
+                            {
+                                consume(n,woken);
+                            }
                             return futures[i].index;
                         }
                     }
-                    cv.wait(lk);
+
+                    boost::unique_lock<detail::spinlock> lk(waiter->mtx);
+                    if(!waiter->fired)
+                    {
+                        if(is_fiber)
+                        {
+                            // suspend this fiber
+                            detail::scheduler::instance().wait(lk);
+                            // check if fiber was interrupted
+                            this_fiber::interruption_point();
+                        }
+                        else
+                        {
+                            lk.unlock();
+                            while(!n->is_ready())
+                            {
+                                // run scheduler
+                                detail::scheduler::instance().run();
+                            }
+                            woken=true;
+                        }
+                    }
                 }
             }
             
@@ -526,7 +834,7 @@ namespace fibers {
             {
                 for(count_type i=0;i<futures.size();++i)
                 {
-                    futures[i].future->remove_external_waiter(futures[i].wait_iterator);
+                    futures[i].future->remove_external_waiter(waiter);
                 }
             }
             
@@ -534,63 +842,111 @@ namespace fibers {
         
     }
 
-    template <typename R>
-    class unique_future;
-
-    template <typename R>
-    class shared_future;
-
-    template <typename R>
-    class promise;
-
-    template <typename R>
-    class packaged_task;
+    namespace detail
+    {
+        // a shared state allocated by Allocator, destroyed and deallocated
+        // through a copy of the allocator if the last reference is released
+        template< typename Base, typename Allocator >
+        class allocated_object : public Base
+        {
+        public:
+            typedef typename Allocator::template rebind<
+                allocated_object
+            >::other                                allocator_type;
 
-    namespace detail {
+        private:
+            allocator_type  alloc_;
 
-        template <typename F, typename R, typename C>
-            struct future_continuation : future_continuation_base
-        {
-            F& parent;
-            C continuation;
-            promise<R> next;
+        public:
+            explicit allocated_object( allocator_type const& a) :
+                Base(), alloc_( a)
+            {}
 
-            future_continuation(F& f, BOOST_THREAD_FWD_REF(C) c) :
-                parent(f),
-                continuation(boost::forward<C>(c)),
-                next()
+            template< typename A0 >
+            allocated_object( allocator_type const& a, A0 const& a0) :
+                Base( a0), alloc_( a)
             {}
 
-            ~future_continuation()
+            template< typename A0, typename A1, typename A2 >
+            allocated_object( allocator_type const& a, A0 const& a0, A1 const& a1, A2 const& a2) :
+                Base( a0, a1, a2), alloc_( a)
             {}
 
-            void do_continuation(boost::unique_lock<boost::fibers::mutex>& lk)
+            void deallocate_object()
+            {
+                allocator_type a( alloc_);
+                a.destroy( this);
+                a.deallocate( this, 1);
+            }
+
+            static allocated_object * create( Allocator const& alloc)
             {
+                allocator_type a( alloc);
+                allocated_object * p = a.allocate( 1);
                 try
+                { return ::new( p) allocated_object( a); }
+                catch (...)
                 {
-                    lk.unlock();
-                    {
-                        R val = continuation(parent);
-                        next.set_value(boost::move(val));
-                    }
+                    a.deallocate( p, 1);
+                    throw;
                 }
+            }
+
+            template< typename A0 >
+            static allocated_object * create( Allocator const& alloc, A0 const& a0)
+            {
+                allocator_type a( alloc);
+                allocated_object * p = a.allocate( 1);
+                try
+                { return ::new( p) allocated_object( a, a0); }
                 catch (...)
                 {
-                    next.set_exception(boost::current_exception());
+                    a.deallocate( p, 1);
+                    throw;
                 }
             }
-        private:
 
-            future_continuation(future_continuation const&);
-            future_continuation& operator=(future_continuation const&);
+            template< typename A0, typename A1, typename A2 >
+            static allocated_object * create( Allocator const& alloc, A0 const& a0, A1 const& a1, A2 const& a2)
+            {
+                allocator_type a( alloc);
+                allocated_object * p = a.allocate( 1);
+                try
+                { return ::new( p) allocated_object( a, a0, a1, a2); }
+                catch (...)
+                {
+                    a.deallocate( p, 1);
+                    throw;
+                }
+            }
         };
+    }
+
+    template <typename R>
+    class unique_future;
+
+    template <typename R>
+    class shared_future;
+
+    template <typename R>
+    class promise;
+
+    template <typename R>
+    class packaged_task;
+
+    namespace detail {
+
+        struct future_access;
+
+        template <typename R, typename F, typename Executor>
+        struct future_continuation;
 
     }
 
     template <typename R>
     class unique_future
     {
-        typedef boost::shared_ptr<detail::future_object<R> > future_ptr;
+        typedef boost::intrusive_ptr<detail::future_object<R> > future_ptr;
         
         future_ptr future;
 
@@ -598,8 +954,11 @@ namespace fibers {
         friend class promise<R>;
         friend class packaged_task<R>;
         friend class detail::future_waiter;
+        friend struct detail::future_access;
         template <typename A, typename B, typename C>
         friend struct detail::future_continuation;
+        template <typename A>
+        friend class unique_future;
 
         typedef typename detail::future_traits<R>::move_dest_type move_dest_type;
 
@@ -710,55 +1069,57 @@ namespace fibers {
             return future->timed_wait_until(abs_time);
         }
 #endif
-        template<typename RF>
-        unique_future<RF>
-        then(RF(*func)(unique_future< R >&))
+        // attaches func as continuation, func is called with the ready
+        // future (moved from *this) in the context completing it
+        template<typename F>
+        unique_future<typename boost::result_of<F(unique_future<R>&)>::type>
+        then(F func)
         {
-            typedef RF future_type;
+            inline_executor ex;
+            return then(ex,func);
+        }
 
-            if (future)
-            {
-                boost::unique_lock<boost::fibers::mutex> lock(future->mutex);
-                detail::future_continuation<unique_future<R>, future_type, RF(*)(unique_future&) > *ptr =
-                    new detail::future_continuation<unique_future<R>, future_type, RF(*)(unique_future&)>(*this, func);
-                if (ptr==0) return unique_future<future_type>();
-                future->set_continuation_ptr(ptr, lock);
-                return ptr->next.get_future();
-            }
-            else
-            {
-                // fixme what to do when the future has no associated state?
-                return unique_future<future_type>();
-            }
+        // attaches func as continuation run by ex - a stateless executor
+        // (inline_executor, fiber_executor) is copied, others must outlive
+        // the continuation
+        template<typename Executor,typename F>
+        unique_future<typename boost::result_of<F(unique_future<R>&)>::type>
+        then(Executor& ex,F func)
+        {
+            return then(allocator_arg,std::allocator<unique_future>(),ex,func);
         }
 
-        template<typename F>
+        // the continuation (the shared state of the returned future)
+        // is allocated by a
+        template<typename Allocator,typename Executor,typename F>
         unique_future<typename boost::result_of<F(unique_future<R>&)>::type>
-        then(BOOST_RV_REF(F) func)
+        then(allocator_arg_t,Allocator const& a,Executor& ex,F func)
         {
             typedef typename boost::result_of<F(unique_future<R>&)>::type future_type;
+            typedef detail::allocated_object<
+                detail::future_continuation<R,F,Executor>,Allocator
+            > continuation_type;
 
-            if (future)
-            {
-                boost::unique_lock<boost::fibers::mutex> lock(future->mtx);
-                detail::future_continuation<unique_future<R>, future_type, F > *ptr =
-                    new detail::future_continuation<unique_future<R>, future_type, F>(*this, boost::forward<F>(func));
-                if (ptr==0) return unique_future<future_type>();
-                future->set_continuation_ptr(ptr, lock);
-                return ptr->next.get_future();
-            }
-            else
+            if(!future)
             {
-                // fixme what to do when the future has no associated state?
-                return unique_future<future_type>();
+                boost::throw_exception(future_uninitialized());
             }
+            // the continuation is the shared state of the returned future
+            continuation_type* c=continuation_type::create(
+                a,future,func,detail::executor_ref<Executor>(ex));
+            boost::intrusive_ptr<detail::future_object<future_type> > state(c);
+            unique_future<future_type> result(state);
+            future_ptr parent;
+            parent.swap(future);
+            parent->add_completion(boost::intrusive_ptr<detail::future_completion_base>(c),0);
+            return boost::move(result);
         }
     };
 
     template <typename R>
     class shared_future
     {
-        typedef boost::shared_ptr<detail::future_object<R> > future_ptr;
+        typedef boost::intrusive_ptr<detail::future_object<R> > future_ptr;
         
         future_ptr future;
 
@@ -766,6 +1127,7 @@ namespace fibers {
 //         shared_future& operator=(const unique_future<R>& other);
 
         friend class detail::future_waiter;
+        friend struct detail::future_access;
         friend class promise<R>;
         friend class packaged_task<R>;
         
@@ -836,8 +1198,8 @@ namespace fibers {
         }
         shared_future& operator=(BOOST_RV_REF(shared_future) other)
         {
-            future.swap(other->future);
-            other->future.reset();
+            future.swap(other.future);
+            other.future.reset();
             return *this;
         }
 #endif
@@ -913,39 +1275,38 @@ namespace fibers {
     template <typename R>
     class promise
     {
-        typedef boost::shared_ptr<detail::future_object<R> > future_ptr;
+        typedef boost::intrusive_ptr<detail::future_object<R> > future_ptr;
         
         future_ptr future;
         bool future_obtained;
         
         void lazy_init()
         {
-            if(!atomic_load(&future))
+            if(!future)
             {
-                future_ptr blank;
-                atomic_compare_exchange(&future,&blank,future_ptr(new detail::future_object<R>));
+                future.reset(new detail::future_object<R>);
             }
         }
 
         BOOST_MOVABLE_BUT_NOT_COPYABLE( promise);
         
     public:
-//         template <class Allocator> explicit promise(Allocator a);
-
         promise():
             future(),future_obtained(false)
         {}
+
+        // the shared state is allocated by a
+        template <class Allocator>
+        promise(allocator_arg_t,Allocator const& a):
+            future(detail::allocated_object<detail::future_object<R>,Allocator>::create(a)),
+            future_obtained(false)
+        {}
         
         ~promise()
         {
-            if(future)
+            if(future && !future->is_ready())
             {
-                boost::unique_lock<boost::fibers::mutex> lock(future->mutex);
-
-                if(!future->done)
-                {
-                    future->mark_exceptional_finish_internal(boost::copy_exception(broken_promise()),lock);
-                }
+                future->mark_exceptional_finish_internal(boost::copy_exception(broken_promise()));
             }
         }
 
@@ -1003,35 +1364,29 @@ namespace fibers {
         void set_value(typename detail::future_traits<R>::source_reference_type r)
         {
             lazy_init();
-            boost::unique_lock<boost::fibers::mutex> lock(future->mutex);
-            if(future->done)
+            if(!future->mark_finished_with_result_internal(r))
             {
                 boost::throw_exception(promise_already_satisfied());
             }
-            future->mark_finished_with_result_internal(r, lock);
         }
 
 //         void set_value(R && r);
         void set_value(typename detail::future_traits<R>::rvalue_source_type r)
         {
             lazy_init();
-            boost::unique_lock<boost::fibers::mutex> lock(future->mutex);
-            if(future->done)
+            if(!future->mark_finished_with_result_internal(static_cast<typename detail::future_traits<R>::rvalue_source_type>(r)))
             {
                 boost::throw_exception(promise_already_satisfied());
             }
-            future->mark_finished_with_result_internal(static_cast<typename detail::future_traits<R>::rvalue_source_type>(r), lock);
         }
 
         void set_exception(boost::exception_ptr p)
         {
             lazy_init();
-            boost::unique_lock<boost::fibers::mutex> lock(future->mutex);
-            if(future->done)
+            if(!future->mark_exceptional_finish_internal(p))
             {
                 boost::throw_exception(promise_already_satisfied());
             }
-            future->mark_exceptional_finish_internal(p, lock);
         }
 
         template<typename F>
@@ -1046,38 +1401,37 @@ namespace fibers {
     template <>
     class promise<void>
     {
-        typedef boost::shared_ptr<detail::future_object<void> > future_ptr;
+        typedef boost::intrusive_ptr<detail::future_object<void> > future_ptr;
         
         future_ptr future;
         bool future_obtained;
 
         void lazy_init()
         {
-            if(!atomic_load(&future))
+            if(!future)
             {
-                future_ptr blank;
-                atomic_compare_exchange(&future,&blank,future_ptr(new detail::future_object<void>));
+                future.reset(new detail::future_object<void>);
             }
         }
 
     BOOST_MOVABLE_BUT_NOT_COPYABLE( promise);
     public:
-//         template <class Allocator> explicit promise(Allocator a);
-
         promise():
             future(),future_obtained(false)
         {}
+
+        // the shared state is allocated by a
+        template <class Allocator>
+        promise(allocator_arg_t,Allocator const& a):
+            future(detail::allocated_object<detail::future_object<void>,Allocator>::create(a)),
+            future_obtained(false)
+        {}
         
         ~promise()
         {
-            if(future)
+            if(future && !future->is_ready())
             {
-                boost::unique_lock<boost::fibers::mutex> lock(future->mutex);
-
-                if(!future->done)
-                {
-                    future->mark_exceptional_finish_internal(boost::copy_exception(broken_promise()),lock);
-                }
+                future->mark_exceptional_finish_internal(boost::copy_exception(broken_promise()));
             }
         }
 
@@ -1136,23 +1490,19 @@ namespace fibers {
         void set_value()
         {
             lazy_init();
-            boost::unique_lock<boost::fibers::mutex> lock(future->mutex);
-            if(future->done)
+            if(!future->mark_finished_with_result_internal())
             {
                 boost::throw_exception(promise_already_satisfied());
             }
-            future->mark_finished_with_result_internal( lock);
         }
 
         void set_exception(boost::exception_ptr p)
         {
             lazy_init();
-            boost::unique_lock<boost::fibers::mutex> lock(future->mutex);
-            if(future->done)
+            if(!future->mark_exceptional_finish_internal(p))
             {
                 boost::throw_exception(promise_already_satisfied());
             }
-            future->mark_exceptional_finish_internal(p,lock);
         }
 
         template<typename F>
@@ -1170,7 +1520,7 @@ namespace fibers {
         struct task_base:
             detail::future_object<R>
         {
-            bool started;
+            atomic<bool> started;
 
             task_base():
                 started(false)
@@ -1178,24 +1528,27 @@ namespace fibers {
 
             void run()
             {
+                if(started.exchange(true,memory_order_acq_rel))
                 {
-                    boost::unique_lock<boost::fibers::mutex> lk(this->mutex);
-                    if(started)
-                    {
-                        boost::throw_exception(task_already_started());
-                    }
-                    started=true;
+                    boost::throw_exception(task_already_started());
                 }
                 do_run();
             }
 
+            // runs the task if it was not started yet
+            void run_once()
+            {
+                if(!started.exchange(true,memory_order_acq_rel))
+                {
+                    do_run();
+                }
+            }
+
             void owner_destroyed()
             {
-                boost::unique_lock<boost::fibers::mutex> lk(this->mutex);
-                if(!started)
+                if(!started.exchange(true,memory_order_acq_rel))
                 {
-                    started=true;
-                    this->mark_exceptional_finish_internal(boost::copy_exception(boost::fibers::broken_promise()),lk);
+                    this->mark_exceptional_finish_internal(boost::copy_exception(boost::fibers::broken_promise()));
                 }
             }
             
@@ -1261,7 +1614,7 @@ namespace fibers {
     template<typename R>
     class packaged_task
     {
-        boost::shared_ptr<detail::task_base<R> > task;
+        boost::intrusive_ptr<detail::task_base<R> > task;
         bool future_obtained;
 
         BOOST_MOVABLE_BUT_NOT_COPYABLE( packaged_task);
@@ -1279,10 +1632,17 @@ namespace fibers {
             task(new detail::task_object<R,R(*)()>(f)),future_obtained(false)
         {}
 
-//         template <class F, class Allocator>
-//         explicit packaged_task(F const& f, Allocator a);
-//         template <class F, class Allocator>
-//         explicit packaged_task(F&& f, Allocator a);
+        // the shared state (storing f) is allocated by a
+        template <class F, class Allocator>
+        packaged_task(allocator_arg_t,Allocator const& a,F const& f):
+            task(detail::allocated_object<detail::task_object<R,F>,Allocator>::create(a,f)),
+            future_obtained(false)
+        {}
+        template <class Allocator>
+        packaged_task(allocator_arg_t,Allocator const& a,R(*f)()):
+            task(detail::allocated_object<detail::task_object<R,R(*)()>,Allocator>::create(a,f)),
+            future_obtained(false)
+        {}
 
 
         ~packaged_task()
@@ -1365,32 +1725,6 @@ namespace fibers {
         
     };
 
-    template <class R>
-    unique_future<R> async(R(*f)())
-    {
-        typedef packaged_task<R> packaged_task_type;
-
-        packaged_task_type pt( f);
-        unique_future<R> ret = pt.get_future();
-        fiber( boost::move(pt) ).detach();
-
-        return boost::move( ret);
-    }
-
-    template <class F>
-    unique_future<typename boost::result_of<typename decay<F>::type()>::type>
-    async(BOOST_RV_REF(F) f)
-    {
-        typedef typename boost::result_of<typename decay<F>::type()>::type R;
-        typedef packaged_task<R> packaged_task_type;
-
-        packaged_task_type pt( boost::forward<F>(f) );
-        unique_future<R> ret = pt.get_future();
-        fiber( boost::move(pt) ).detach();
-
-        return boost::move( ret);
-    }
-
     template< typename T >
     struct is_future_type
     {
@@ -1433,6 +1767,372 @@ namespace fibers {
         return boost::next( begin, waiter.wait() );
     }
 
+    template< typename Sequence >
+    struct when_any_result
+    {
+        // index of the future which became ready first
+        std::size_t index;
+        Sequence    futures;
+
+        when_any_result():
+            index( 0), futures()
+        {}
+    };
+
+    namespace detail
+    {
+        struct future_access
+        {
+            template< typename F >
+            static boost::intrusive_ptr< future_object_base > get( F const& f)
+            { return f.future; }
+
+            template< typename R >
+            static unique_future< R > make( boost::intrusive_ptr< future_object< R > > const& state)
+            { return unique_future< R >( state); }
+        };
+
+        template< typename F >
+        struct future_result;
+
+        template< typename R >
+        struct future_result< unique_future< R > >
+        { typedef R type; };
+
+        template< typename R >
+        struct future_result< shared_future< R > >
+        { typedef R type; };
+
+        template< typename R >
+        shared_future< R > share_future( unique_future< R > & f)
+        { return shared_future< R >( boost::move( f) ); }
+
+        template< typename R >
+        shared_future< R > share_future( shared_future< R > & f)
+        { return f; }
+
+        // shared state of the future returned by then() - registered as
+        // completion at the state of the parent, func is submitted to the
+        // executor if the parent is ready
+        template< typename R, typename F, typename Executor >
+        struct future_continuation :
+            future_object< typename boost::result_of< F( unique_future< R > &) >::type >,
+            future_completion_base
+        {
+            typedef typename boost::result_of< F( unique_future< R > &) >::type result_type;
+            typedef future_object< result_type >                                base_type;
+
+            struct run_fn
+            {
+                boost::intrusive_ptr< base_type >   self;
+
+                run_fn( future_continuation * self_) :
+                    self( self_)
+                {}
+
+                void operator()() const
+                { static_cast< future_continuation * >( self.get() )->run(); }
+            };
+
+            boost::intrusive_ptr< future_object< R > >  parent;
+            F                                           func;
+            executor_ref< Executor >                    ex;
+
+            future_continuation( boost::intrusive_ptr< future_object< R > > const& parent_,
+                                 F const& func_, executor_ref< Executor > const& ex_) :
+                base_type(), future_completion_base(),
+                parent( parent_), func( func_), ex( ex_)
+            {}
+
+            void on_ready( std::size_t)
+            { ex.submit( run_fn( this) ); }
+
+            void run()
+            {
+                unique_future< R > f( parent);
+                parent.reset();
+                try
+                { run_( f, boost::is_void< result_type >() ); }
+                catch (...)
+                { this->mark_exceptional_finish(); }
+            }
+
+            void run_( unique_future< R > & f, boost::false_type)
+            { this->mark_finished_with_result( func( f) ); }
+
+            void run_( unique_future< R > & f, boost::true_type)
+            {
+                func( f);
+                this->mark_finished_with_result();
+            }
+
+        protected:
+            // the continuation shares the reference count of its state
+            void add_ref() BOOST_NOEXCEPT
+            { intrusive_ptr_add_ref( static_cast< future_object_base * >( this) ); }
+
+            void release_ref()
+            { intrusive_ptr_release( static_cast< future_object_base * >( this) ); }
+        };
+
+        // registered at each future, the last future becoming
+        // ready completes the result
+        template< typename R >
+        struct when_all_completion : future_completion
+        {
+            typedef std::vector< shared_future< R > >   sequence_type;
+
+            sequence_type               futures;
+            atomic< std::size_t >       count;
+            promise< sequence_type >    p;
+
+            when_all_completion() :
+                futures(), count( 0), p()
+            {}
+
+            void on_ready( std::size_t)
+            {
+                if ( 1 == count.fetch_sub( 1, memory_order_acq_rel) )
+                    p.set_value( boost::move( futures) );
+            }
+        };
+
+        // registered at each future, the first future becoming
+        // ready completes the result
+        template< typename R >
+        struct when_any_completion : future_completion
+        {
+            typedef std::vector< shared_future< R > >   sequence_type;
+
+            sequence_type                               futures;
+            atomic< bool >                              done;
+            promise< when_any_result< sequence_type > > p;
+
+            when_any_completion() :
+                futures(), done( false), p()
+            {}
+
+            void on_ready( std::size_t index)
+            {
+                if ( done.exchange( true, memory_order_acq_rel) ) return;
+                when_any_result< sequence_type > result;
+                result.index = index;
+                result.futures.swap( futures);
+                p.set_value( boost::move( result) );
+            }
+        };
+
+        // moves (copies) the futures of [first, last) into c->futures and
+        // registers c at each future
+        template< typename Completion, typename Iterator >
+        void add_completion( boost::intrusive_ptr< Completion > const& c, Iterator first, Iterator last)
+        {
+            std::vector< boost::intrusive_ptr< future_object_base > > states;
+            for ( ; first != last; ++first)
+            {
+                boost::intrusive_ptr< future_object_base > state( future_access::get( * first) );
+                if ( ! state)
+                    boost::throw_exception( future_uninitialized() );
+                states.push_back( state);
+                c->futures.push_back( share_future( * first) );
+            }
+            // c->futures might be moved out by the first on_ready()
+            for ( std::size_t i = 0; i < states.size(); ++i)
+                states[i]->add_completion( c, i);
+        }
+    }
+
+    // returns a future becoming ready after all futures of [first, last)
+    // are ready, the futures are moved (shared_future: copied) into the
+    // result - the calling fiber is not blocked
+    // (a container of unique_futures requires rvalue references, with the
+    // move emulation of C++03 ranges of shared_futures are passed)
+    template< typename Iterator >
+    unique_future<
+        std::vector<
+            shared_future<
+                typename detail::future_result<
+                    typename std::iterator_traits< Iterator >::value_type
+                >::type
+            >
+        >
+    >
+    when_all( Iterator first, Iterator last)
+    {
+        typedef typename detail::future_result<
+            typename std::iterator_traits< Iterator >::value_type
+        >::type R;
+        typedef detail::when_all_completion< R > completion_type;
+
+        boost::intrusive_ptr< completion_type > c( new completion_type() );
+        unique_future< typename completion_type::sequence_type > result( c->p.get_future() );
+        std::size_t count = std::distance( first, last);
+        if ( 0 == count)
+        {
+            c->p.set_value( typename completion_type::sequence_type() );
+            return boost::move( result);
+        }
+        c->count = count;
+        detail::add_completion( c, first, last);
+        return boost::move( result);
+    }
+
+    // returns a future becoming ready if the first future of [first, last)
+    // is ready, the futures are moved (shared_future: copied) into the
+    // result - the calling fiber is not blocked
+    template< typename Iterator >
+    unique_future<
+        when_any_result<
+            std::vector<
+                shared_future<
+                    typename detail::future_result<
+                        typename std::iterator_traits< Iterator >::value_type
+                    >::type
+                >
+            >
+        >
+    >
+    when_any( Iterator first, Iterator last)
+    {
+        typedef typename detail::future_result<
+            typename std::iterator_traits< Iterator >::value_type
+        >::type R;
+        typedef detail::when_any_completion< R > completion_type;
+
+        boost::intrusive_ptr< completion_type > c( new completion_type() );
+        unique_future< when_any_result< typename completion_type::sequence_type > > result(
+            c->p.get_future() );
+        if ( first == last)
+        {
+            when_any_result< typename completion_type::sequence_type > empty;
+            empty.index = static_cast< std::size_t >( -1);
+            c->p.set_value( boost::move( empty) );
+            return boost::move( result);
+        }
+        detail::add_completion( c, first, last);
+        return boost::move( result);
+    }
+
+    namespace launch
+    {
+        // selects where async() runs the function
+        enum policy
+        {
+            // queued at the fiber pool of the calling thread - a pooled
+            // fiber runs the function after the calling fiber was suspended
+            post = 1,
+            // run in the calling fiber before async() returns
+            dispatch = 2,
+            // run by the first wait() or get() (or then(), when_all(), ...)
+            // on the returned future, in the waiting fiber
+            deferred = 4,
+            // run by a pooled fiber of one of the worker threads
+            any_worker = 8
+        };
+
+        inline policy operator|( policy l, policy r)
+        { return static_cast< policy >( static_cast< int >( l) | static_cast< int >( r) ); }
+    }
+
+    namespace detail
+    {
+        template< typename R >
+        struct async_run
+        {
+            boost::intrusive_ptr< task_base< R > >  task;
+
+            async_run( boost::intrusive_ptr< task_base< R > > const& task_) :
+                task( task_)
+            {}
+
+            void operator()() const
+            { task->run_once(); }
+        };
+
+        // evaluated lazily - result_of<> of allocator_arg_t is an error
+        // in C++03, not a substitution failure
+        template< typename Signature >
+        struct async_future
+        { typedef unique_future< typename boost::result_of< Signature >::type > type; };
+    }
+
+    // the result of f is delivered through the shared state of the task,
+    // no fiber is created per call - if several policies are given the
+    // first of post, any_worker, dispatch and deferred is applied
+    // the shared state (storing f) is allocated by a
+    template< typename Allocator, typename F >
+    unique_future< typename boost::result_of< F() >::type >
+    async( launch::policy policy, allocator_arg_t, Allocator const& a, F f)
+    {
+        typedef typename boost::result_of< F() >::type R;
+
+        boost::intrusive_ptr< detail::task_base< R > > task(
+            detail::allocated_object< detail::task_object< R, F >, Allocator >::create( a, f) );
+        unique_future< R > result( detail::future_access::make< R >( task) );
+        if ( 0 != ( policy & launch::post) )
+            detail::fiber_pool::instance().post( detail::async_run< R >( task) );
+        else if ( 0 != ( policy & launch::any_worker) )
+            detail::post_any_worker( detail::async_run< R >( task) );
+        else if ( 0 != ( policy & launch::dispatch) )
+            task->run_once();
+        else
+            task->callback = boost::bind( & detail::task_base< R >::run_once, task.get() );
+        return boost::move( result);
+    }
+
+    template< typename F >
+    unique_future< typename boost::result_of< F() >::type >
+    async( launch::policy policy, F f)
+    {
+        return async( policy, allocator_arg, std::allocator< F >(), f);
+    }
+
+#define BOOST_FIBERS_ASYNC_ARG(z,n,unused) \
+    BOOST_PP_CAT(A,n) BOOST_PP_CAT(a,n)
+
+#define BOOST_FIBERS_ASYNC(z,n,unused) \
+template< typename F, BOOST_PP_ENUM_PARAMS(n, typename A) > \
+typename boost::lazy_disable_if< \
+    is_same< F, allocator_arg_t >, \
+    detail::async_future< F( BOOST_PP_ENUM_PARAMS(n, A) ) > \
+>::type \
+async( launch::policy policy, F f, BOOST_PP_ENUM(n,BOOST_FIBERS_ASYNC_ARG,~) ) \
+{ \
+    typedef typename boost::result_of< F( BOOST_PP_ENUM_PARAMS(n, A) ) >::type R; \
+    return async( policy, boost::bind< R >( f, BOOST_PP_ENUM_PARAMS(n, a) ) ); \
+} \
+\
+template< typename Allocator, typename F, BOOST_PP_ENUM_PARAMS(n, typename A) > \
+unique_future< typename boost::result_of< F( BOOST_PP_ENUM_PARAMS(n, A) ) >::type > \
+async( launch::policy policy, allocator_arg_t, Allocator const& alloc, F f, \
+       BOOST_PP_ENUM(n,BOOST_FIBERS_ASYNC_ARG,~) ) \
+{ \
+    typedef typename boost::result_of< F( BOOST_PP_ENUM_PARAMS(n, A) ) >::type R; \
+    return async( policy, allocator_arg, alloc, boost::bind< R >( f, BOOST_PP_ENUM_PARAMS(n, a) ) ); \
+}
+
+#ifndef BOOST_FIBERS_ASYNC_MAX_ARITY
+#define BOOST_FIBERS_ASYNC_MAX_ARITY 6
+#endif
+
+BOOST_PP_REPEAT_FROM_TO( 1, BOOST_FIBERS_ASYNC_MAX_ARITY, BOOST_FIBERS_ASYNC, ~)
+
+#undef BOOST_FIBERS_ASYNC
+#undef BOOST_FIBERS_ASYNC_ARG
+
+    template <class R>
+    unique_future<R> async(R(*f)())
+    {
+        return async( launch::post, f);
+    }
+
+    template <class F>
+    unique_future<typename boost::result_of<typename decay<F>::type()>::type>
+    async(BOOST_RV_REF(F) f)
+    {
+        return async( launch::post, typename decay<F>::type( boost::forward<F>(f) ) );
+    }
+
 #define BOOST_FIBERS_WAITFOR_FUTURE_FN_ARG(z,n,unused) \
     BOOST_PP_CAT(F,n) & BOOST_PP_CAT(f,n)
 
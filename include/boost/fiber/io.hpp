@@ -0,0 +1,84 @@
+//          Copyright Oliver Kowalke 2009.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_FIBERS_IO_H
+#define BOOST_FIBERS_IO_H
+
+#include <cstddef>
+
+#include <boost/config.hpp>
+
+#include <boost/fiber/detail/config.hpp>
+
+#if defined(BOOST_FIBERS_HAS_EPOLL)
+
+#include <sys/socket.h>
+#include <sys/types.h>
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+namespace boost {
+namespace fibers {
+namespace io {
+
+// I/O functions suspending the calling fiber instead of the thread - the
+// other fibers of the thread continue to run
+//
+// if the kernel supports io_uring, the operations of a fiber are queued
+// at the io_uring of the scheduler (sockets are tried first), which submits the operations queued
+// during one pass through its ready-queue together; otherwise the
+// operation is tried and, if it returns EAGAIN, the descriptor is
+// registered at the epoll reactor of the scheduler and the fiber is
+// suspended until the descriptor is ready (descriptors must be
+// non-blocking)
+//
+// return values and errno are those of the system calls
+
+// suspends the calling fiber until fd is readable (writable)
+BOOST_FIBERS_DECL void wait_readable( int fd);
+
+BOOST_FIBERS_DECL void wait_writable( int fd);
+
+// a non-blocking socket (SOCK_NONBLOCK | SOCK_CLOEXEC)
+BOOST_FIBERS_DECL int socket( int domain, int type, int protocol);
+
+// sets O_NONBLOCK on a descriptor not created by this library
+BOOST_FIBERS_DECL int set_nonblocking( int fd);
+
+BOOST_FIBERS_DECL ssize_t read( int fd, void * buf, std::size_t count);
+
+BOOST_FIBERS_DECL ssize_t write( int fd, void const* buf, std::size_t count);
+
+// the accepted socket is non-blocking
+BOOST_FIBERS_DECL int accept( int fd, sockaddr * addr, socklen_t * addrlen);
+
+BOOST_FIBERS_DECL int connect( int fd, sockaddr const* addr, socklen_t addrlen);
+
+// the readiness based path runs fsync() in a helper thread of
+// offload_pool::instance()
+BOOST_FIBERS_DECL int fsync( int fd);
+
+// a descriptor used by the functions above must be closed by this
+// function, it deregisters the descriptor from the reactor of the
+// calling thread and resumes the fibers waiting for it (their next
+// operation fails with EBADF), requests queued at the io_uring of
+// the calling thread are cancelled and fail with EBADF
+//
+// the reactor of another thread is not updated - a descriptor must be
+// waited for and closed by fibers of one thread, otherwise a reused
+// descriptor number is never registered at the other reactor again
+BOOST_FIBERS_DECL int close( int fd);
+
+}}}
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
+
+#endif
+
+#endif // BOOST_FIBERS_IO_H
@@ -0,0 +1,377 @@
+//          Copyright Oliver Kowalke 2009.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_FIBERS_MPMC_CHANNEL_H
+#define BOOST_FIBERS_MPMC_CHANNEL_H
+
+#include <algorithm>
+#include <cstddef>
+#include <deque>
+
+#include <boost/assert.hpp>
+#include <boost/atomic.hpp>
+#include <boost/config.hpp>
+#include <boost/exception/all.hpp>
+#include <boost/foreach.hpp>
+#include <boost/optional.hpp>
+#include <boost/scoped_array.hpp>
+#include <boost/system/error_code.hpp>
+#include <boost/thread/locks.hpp>
+#include <boost/utility.hpp>
+
+#include <boost/fiber/detail/config.hpp>
+#include <boost/fiber/detail/notify.hpp>
+#include <boost/fiber/detail/scheduler.hpp>
+#include <boost/fiber/detail/spinlock.hpp>
+#include <boost/fiber/exceptions.hpp>
+#include <boost/fiber/interruption.hpp>
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+namespace boost {
+namespace fibers {
+
+// channel for many producers and consumers (fibers or threads)
+// items are passed through a bounded array of sequence-numbered
+// cells (Dmitry Vyukov's MPMC queue), a fiber is suspended only
+// if it has observed an empty/full channel
+template< typename T >
+class mpmc_channel : private noncopyable
+{
+public:
+    typedef optional< T >   value_type;
+
+private:
+    enum state
+    {
+        ACTIVE = 0,
+        DEACTIVE
+    };
+
+    // a cell is writeable for position pos if seq == pos and
+    // readable if seq == pos + 1
+    struct cell
+    {
+        atomic< std::size_t >       seq;
+        value_type                  va;
+
+        cell() :
+            seq( 0), va()
+        {}
+    };
+
+    // suspended producers or consumers, woken up in FIFO order
+    // count mirrors waiting.size() so that the other side can
+    // skip the lock if nobody is waiting, pending counts the
+    // fibers notified but not yet resumed
+    struct wait_queue
+    {
+        atomic< std::size_t >       count;
+        atomic< std::size_t >       pending;
+        detail::spinlock            mtx;
+        std::deque<
+            detail::notify::ptr_t
+        >                           waiting;
+
+        wait_queue() :
+            count( 0), pending( 0), mtx(), waiting()
+        {}
+    };
+
+    typedef bool ( mpmc_channel::*predicate_t)() const;
+
+    atomic< state >                 state_;
+    std::size_t                     mask_;
+    scoped_array< cell >            cells_;
+    char                            pad1_[BOOST_FIBERS_CACHELINE_SIZE];
+    atomic< std::size_t >           enqueue_pos_;
+    char                            pad2_[BOOST_FIBERS_CACHELINE_SIZE];
+    atomic< std::size_t >           dequeue_pos_;
+    char                            pad3_[BOOST_FIBERS_CACHELINE_SIZE];
+    wait_queue                      producers_;
+    char                            pad4_[BOOST_FIBERS_CACHELINE_SIZE];
+    wait_queue                      consumers_;
+
+    static std::size_t round_up_( std::size_t capacity)
+    {
+        std::size_t size = 2;
+        while ( size < capacity) size <<= 1;
+        return size;
+    }
+
+    bool active_() const
+    { return ACTIVE == state_; }
+
+    bool empty_() const
+    {
+        std::size_t pos = dequeue_pos_.load( memory_order_relaxed);
+        std::size_t seq = cells_[pos & mask_].seq.load( memory_order_acquire);
+        return static_cast< std::ptrdiff_t >( seq - ( pos + 1) ) < 0;
+    }
+
+    bool full_() const
+    {
+        std::size_t pos = enqueue_pos_.load( memory_order_relaxed);
+        std::size_t seq = cells_[pos & mask_].seq.load( memory_order_acquire);
+        return static_cast< std::ptrdiff_t >( seq - pos) < 0;
+    }
+
+    bool readable_() const
+    { return ! active_() || ! empty_(); }
+
+    bool writeable_() const
+    { return ! active_() || ! full_(); }
+
+    void notify_one_( wait_queue & q)
+    {
+        atomic_thread_fence( memory_order_seq_cst);
+        if ( 0 == q.count.load( memory_order_relaxed) ) return;
+
+        detail::notify::ptr_t n;
+        unique_lock< detail::spinlock > lk( q.mtx);
+        if ( q.waiting.empty() ) return;
+        n.swap( q.waiting.front() );
+        q.waiting.pop_front();
+        q.count.store( q.waiting.size(), memory_order_relaxed);
+        q.pending.fetch_add( 1, memory_order_relaxed);
+        lk.unlock();
+
+        n->set_ready();
+    }
+
+    void notify_all_( wait_queue & q)
+    {
+        atomic_thread_fence( memory_order_seq_cst);
+        if ( 0 == q.count.load( memory_order_relaxed) ) return;
+
+        std::deque< detail::notify::ptr_t > waiting;
+        unique_lock< detail::spinlock > lk( q.mtx);
+        waiting.swap( q.waiting);
+        q.count.store( 0, memory_order_relaxed);
+        q.pending.fetch_add( waiting.size(), memory_order_relaxed);
+        lk.unlock();
+
+        BOOST_FOREACH( detail::notify::ptr_t const& n, waiting)
+        { n->set_ready(); }
+    }
+
+    // returns true if n was still registered in q
+    static bool remove_( wait_queue & q, detail::notify::ptr_t const& n)
+    {
+        typename std::deque< detail::notify::ptr_t >::iterator i(
+            std::find( q.waiting.begin(), q.waiting.end(), n) );
+        if ( q.waiting.end() == i) return false;
+        q.waiting.erase( i);
+        q.count.store( q.waiting.size(), memory_order_relaxed);
+        return true;
+    }
+
+    // returns true if the fiber was notified, a fiber which
+    // was notified but lost the item (slot) to another fiber
+    // is queued at the front again
+    bool park_( wait_queue & q, predicate_t ready, bool front)
+    {
+        detail::notify::ptr_t n( detail::scheduler::instance().active() );
+        bool is_fiber = n ? true : false;
+        if ( ! is_fiber)
+            // notifier for main-fiber
+            n = detail::scheduler::instance().notifier();
+
+        unique_lock< detail::spinlock > lk( q.mtx);
+        if ( front) q.waiting.push_front( n);
+        else q.waiting.push_back( n);
+        q.count.store( q.waiting.size(), memory_order_relaxed);
+        atomic_thread_fence( memory_order_seq_cst);
+        // other side might have missed this waiter
+        if ( ( this->*ready)() )
+        {
+            remove_( q, n);
+            return false;
+        }
+
+        try
+        {
+            if ( is_fiber)
+            {
+                for (;;)
+                {
+                    // suspend this fiber
+                    detail::scheduler::instance().wait( lk);
+
+                    // check if fiber was interrupted
+                    this_fiber::interruption_point();
+
+                    if ( ! this_fiber::interruption_requested() ) return true;
+
+                    // woken up by an interruption request while
+                    // interruptions are blocked
+                    lk.lock();
+                    if ( q.waiting.end() == std::find( q.waiting.begin(), q.waiting.end(), n) )
+                        return true;
+                }
+            }
+            else
+            {
+                lk.unlock();
+                while ( ! n->is_ready() )
+                    // run scheduler
+                    detail::scheduler::instance().run();
+
+                // notifier of main-fiber might have been set
+                // by a previous wait
+                lk.lock();
+                return ! remove_( q, n);
+            }
+        }
+        catch (...)
+        {
+            if ( ! lk.owns_lock() ) lk.lock();
+            if ( ! remove_( q, n) )
+            {
+                // this fiber was notified - pass it on
+                lk.unlock();
+                q.pending.fetch_sub( 1, memory_order_relaxed);
+                notify_one_( q);
+            }
+            throw;
+        }
+    }
+
+public:
+    explicit mpmc_channel( std::size_t capacity = 1024) :
+        state_( ACTIVE),
+        mask_( round_up_( capacity) - 1),
+        cells_(),
+        pad1_(),
+        enqueue_pos_( 0),
+        pad2_(),
+        dequeue_pos_( 0),
+        pad3_(),
+        producers_(),
+        pad4_(),
+        consumers_()
+    {
+        if ( 0 == capacity)
+            boost::throw_exception(
+                invalid_argument(
+                    system::errc::invalid_argument,
+                    "boost fiber: zero capacity for mpmc_channel") );
+        cells_.reset( new cell[mask_ + 1]);
+        for ( std::size_t i = 0; i <= mask_; ++i)
+            cells_[i].seq.store( i, memory_order_relaxed);
+    }
+
+    std::size_t capacity() const
+    { return mask_ + 1; }
+
+    bool active() const
+    { return active_(); }
+
+    void deactivate()
+    {
+        state_ = DEACTIVE;
+        notify_all_( consumers_);
+        notify_all_( producers_);
+    }
+
+    bool empty() const
+    { return empty_(); }
+
+    bool try_put( T const& t)
+    {
+        if ( ! active_() )
+            boost::throw_exception( fiber_resource_error() );
+
+        cell * c = 0;
+        std::size_t pos = enqueue_pos_.load( memory_order_relaxed);
+        for (;;)
+        {
+            c = & cells_[pos & mask_];
+            std::size_t seq = c->seq.load( memory_order_acquire);
+            std::ptrdiff_t dif = static_cast< std::ptrdiff_t >( seq - pos);
+            if ( 0 == dif)
+            {
+                if ( enqueue_pos_.compare_exchange_weak(
+                        pos, pos + 1, memory_order_relaxed) )
+                    break;
+            }
+            else if ( 0 > dif) return false;
+            else pos = enqueue_pos_.load( memory_order_relaxed);
+        }
+        c->va = t;
+        c->seq.store( pos + 1, memory_order_release);
+        notify_one_( consumers_);
+        return true;
+    }
+
+    void put( T const& t)
+    {
+        bool notified = false;
+        while ( ! try_put( t) )
+        {
+            if ( notified) producers_.pending.fetch_sub( 1, memory_order_relaxed);
+            notified = park_( producers_, & mpmc_channel::writeable_, notified);
+        }
+        if ( notified) producers_.pending.fetch_sub( 1, memory_order_relaxed);
+    }
+
+    bool try_take( value_type & va)
+    {
+        cell * c = 0;
+        std::size_t pos = dequeue_pos_.load( memory_order_relaxed);
+        for (;;)
+        {
+            c = & cells_[pos & mask_];
+            std::size_t seq = c->seq.load( memory_order_acquire);
+            std::ptrdiff_t dif = static_cast< std::ptrdiff_t >( seq - ( pos + 1) );
+            if ( 0 == dif)
+            {
+                if ( dequeue_pos_.compare_exchange_weak(
+                        pos, pos + 1, memory_order_relaxed) )
+                    break;
+            }
+            else if ( 0 > dif) return false;
+            else pos = dequeue_pos_.load( memory_order_relaxed);
+        }
+        swap( va, c->va);
+        c->va = none;
+        c->seq.store( pos + mask_ + 1, memory_order_release);
+        notify_one_( producers_);
+        return va;
+    }
+
+    bool take( value_type & va)
+    {
+        // let consumers notified but not yet resumed run first - a
+        // fiber of the same scheduler would always be overtaken
+        if ( 0 != consumers_.pending.load( memory_order_relaxed) &&
+             detail::scheduler::instance().active() )
+            detail::scheduler::instance().yield();
+
+        bool notified = false;
+        while ( ! try_take( va) )
+        {
+            if ( notified) consumers_.pending.fetch_sub( 1, memory_order_relaxed);
+            // remaining items are delivered after deactivation
+            if ( ! active_() && empty_() ) return false;
+            try
+            { notified = park_( consumers_, & mpmc_channel::readable_, notified); }
+            catch ( fiber_interrupted const&)
+            { return false; }
+        }
+        if ( notified) consumers_.pending.fetch_sub( 1, memory_order_relaxed);
+        return true;
+    }
+};
+
+}}
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
+
+#endif // BOOST_FIBERS_MPMC_CHANNEL_H
@@ -0,0 +1,156 @@
+//          Copyright Oliver Kowalke 2009.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_FIBERS_OFFLOAD_H
+#define BOOST_FIBERS_OFFLOAD_H
+
+#include <cstddef>
+#include <deque>
+#include <memory>
+
+#include <boost/chrono/system_clocks.hpp>
+#include <boost/config.hpp>
+#include <boost/cstdint.hpp>
+#include <boost/function.hpp>
+#include <boost/intrusive_ptr.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/utility.hpp>
+#include <boost/utility/result_of.hpp>
+
+#include <boost/fiber/detail/config.hpp>
+#include <boost/fiber/future.hpp>
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+# if defined(BOOST_MSVC)
+# pragma warning(push)
+# pragma warning(disable:4251 4275)
+# endif
+
+namespace boost {
+namespace fibers {
+
+// plain threads running blocking functions (file I/O, name resolution,
+// compression, ...) on behalf of fibers - a helper thread is created if
+// a function is submitted while no helper is idle and fewer than
+// max_threads() helpers exist, otherwise the function is queued
+class BOOST_FIBERS_DECL offload_pool : private noncopyable
+{
+public:
+    struct snapshot
+    {
+        std::size_t             threads;
+        std::size_t             idle;
+        std::size_t             max_threads;
+        // functions waiting for a helper
+        std::size_t             depth;
+        std::size_t             max_depth;
+        boost::uint64_t         submitted;
+        boost::uint64_t         completed;
+        // longest time a function waited for a helper
+        chrono::nanoseconds     max_wait;
+
+        snapshot() :
+            threads( 0), idle( 0), max_threads( 0),
+            depth( 0), max_depth( 0), submitted( 0), completed( 0),
+            max_wait( 0)
+        {}
+    };
+
+private:
+    typedef chrono::steady_clock    clock_type;
+
+    struct item
+    {
+        function< void() >      fn;
+        clock_type::time_point  submitted;
+
+        item( function< void() > const& fn_, clock_type::time_point const& submitted_) :
+            fn( fn_), submitted( submitted_)
+        {}
+    };
+
+    typedef std::deque< item >      queue_t;
+
+    mutable boost::mutex        mtx_;
+    boost::condition_variable   cond_;
+    queue_t                     queue_;
+    std::size_t                 max_threads_;
+    // the helpers are detached, the destructor waits until
+    // threads_ has dropped to zero
+    std::size_t                 threads_;
+    std::size_t                 idle_;
+    std::size_t                 max_depth_;
+    boost::uint64_t             submitted_;
+    boost::uint64_t             completed_;
+    clock_type::duration        max_wait_;
+    bool                        stop_;
+
+    void helper_();
+
+public:
+    // throws invalid_argument if max_threads is zero
+    explicit offload_pool( std::size_t max_threads);
+
+    // runs the queued functions and waits for the helper threads to exit
+    ~offload_pool();
+
+    // the pool used by this_fiber::offload(fn) - twice the number of
+    // hardware threads, at least four helpers (the helpers block);
+    // never destroyed, the helpers live until the process exits
+    static offload_pool & instance();
+
+    void submit( function< void() > const& fn);
+
+    // a smaller limit lets idle helpers exit
+    void max_threads( std::size_t max_threads);
+
+    std::size_t max_threads() const;
+
+    snapshot statistics() const;
+};
+
+}
+
+namespace this_fiber {
+
+// runs fn in a helper thread of pool, the calling fiber is suspended
+// (the other fibers of its scheduler continue to run) and resumed with
+// the result of fn or the exception thrown by fn
+template< typename Fn >
+typename boost::result_of< Fn() >::type
+offload( fibers::offload_pool & pool, Fn fn)
+{
+    typedef typename boost::result_of< Fn() >::type R;
+
+    boost::intrusive_ptr< fibers::detail::task_base< R > > task(
+        fibers::detail::allocated_object<
+            fibers::detail::task_object< R, Fn >, std::allocator< Fn >
+        >::create( std::allocator< Fn >(), fn) );
+    fibers::unique_future< R > result( fibers::detail::future_access::make< R >( task) );
+    pool.submit( fibers::detail::async_run< R >( task) );
+    return result.get();
+}
+
+template< typename Fn >
+typename boost::result_of< Fn() >::type
+offload( Fn fn)
+{ return offload( fibers::offload_pool::instance(), fn); }
+
+}}
+
+# if defined(BOOST_MSVC)
+# pragma warning(pop)
+# endif
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
+
+#endif // BOOST_FIBERS_OFFLOAD_H
@@ -0,0 +1,270 @@
+//          Copyright Oliver Kowalke 2009.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_FIBERS_PARALLEL_H
+#define BOOST_FIBERS_PARALLEL_H
+
+#include <cstddef>
+
+#include <boost/config.hpp>
+#include <boost/exception_ptr.hpp>
+#include <boost/preprocessor/cat.hpp>
+#include <boost/preprocessor/repetition/enum_params.hpp>
+#include <boost/preprocessor/repetition/enum_binary_params.hpp>
+#include <boost/preprocessor/repetition/repeat.hpp>
+#include <boost/preprocessor/repetition/repeat_from_to.hpp>
+#include <boost/utility.hpp>
+
+#include <boost/fiber/detail/completion.hpp>
+#include <boost/fiber/detail/config.hpp>
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+# if defined(BOOST_MSVC)
+# pragma warning(push)
+# pragma warning(disable:4251 4275)
+# endif
+
+namespace boost {
+namespace fibers {
+namespace detail {
+
+// a unit of work of the parallel algorithms - tasks live on the stack of
+// the fiber splitting the work, which joins them before returning (no
+// allocation per task)
+class BOOST_FIBERS_DECL parallel_task : private noncopyable
+{
+private:
+    completion          done_;
+    exception_ptr       except_;
+
+public:
+    parallel_task();
+
+    virtual ~parallel_task() {}
+
+    virtual void execute() = 0;
+
+    // called by the worker which took the task from a queue
+    virtual void run();
+
+    // blocks until run() has completed, rethrows the exception
+    // thrown by execute()
+    void wait();
+};
+
+// the calling fiber runs in a thread of the worker pool
+BOOST_FIBERS_DECL bool in_worker();
+
+// queues t at the worker running the calling fiber, at one
+// of the workers if called outside of the pool
+BOOST_FIBERS_DECL void spawn_task( parallel_task * t);
+
+// executes t in the calling fiber if it was not stolen,
+// waits for the thief otherwise
+BOOST_FIBERS_DECL void join_task( parallel_task * t);
+
+// executes ts[0] in the calling fiber, ts[1..n) in parallel
+BOOST_FIBERS_DECL void invoke_tasks( parallel_task ** ts, std::size_t n);
+
+template< typename Index, typename Fn >
+void for_range( Index first, Index last, Index grain, Fn & fn);
+
+template< typename Index, typename Fn >
+class for_task : public parallel_task
+{
+private:
+    Index   first_;
+    Index   last_;
+    Index   grain_;
+    Fn  &   fn_;
+
+public:
+    for_task( Index first, Index last, Index grain, Fn & fn) :
+        parallel_task(), first_( first), last_( last), grain_( grain), fn_( fn)
+    {}
+
+    void execute()
+    { for_range( first_, last_, grain_, fn_); }
+};
+
+// splits [first, last) until at most grain indices remain - the upper
+// half is offered to thieves, the lower half is processed in place
+template< typename Index, typename Fn >
+void for_range( Index first, Index last, Index grain, Fn & fn)
+{
+    if ( grain < last - first)
+    {
+        Index middle = first + ( last - first) / 2;
+        for_task< Index, Fn > upper( middle, last, grain, fn);
+        spawn_task( & upper);
+        try
+        { for_range( first, middle, grain, fn); }
+        catch (...)
+        {
+            // upper must not outlive this frame
+            try
+            { join_task( & upper); }
+            catch (...)
+            {}
+            throw;
+        }
+        join_task( & upper);
+        return;
+    }
+    for ( ; first != last; ++first)
+        fn( first);
+}
+
+template< typename Index, typename T, typename Fn, typename Reduce >
+T reduce_range( Index first, Index last, Index grain, T const& identity, Fn & fn, Reduce & reduce);
+
+template< typename Index, typename T, typename Fn, typename Reduce >
+class reduce_task : public parallel_task
+{
+private:
+    Index           first_;
+    Index           last_;
+    Index           grain_;
+    T const     &   identity_;
+    Fn          &   fn_;
+    Reduce      &   reduce_;
+
+public:
+    T               result;
+
+    reduce_task( Index first, Index last, Index grain,
+                 T const& identity, Fn & fn, Reduce & reduce) :
+        parallel_task(), first_( first), last_( last), grain_( grain),
+        identity_( identity), fn_( fn), reduce_( reduce), result( identity)
+    {}
+
+    void execute()
+    { result = reduce_range( first_, last_, grain_, identity_, fn_, reduce_); }
+};
+
+template< typename Index, typename T, typename Fn, typename Reduce >
+T reduce_range( Index first, Index last, Index grain, T const& identity, Fn & fn, Reduce & reduce)
+{
+    if ( grain < last - first)
+    {
+        Index middle = first + ( last - first) / 2;
+        reduce_task< Index, T, Fn, Reduce > upper( middle, last, grain, identity, fn, reduce);
+        spawn_task( & upper);
+        T lower( identity);
+        try
+        { lower = reduce_range( first, middle, grain, identity, fn, reduce); }
+        catch (...)
+        {
+            try
+            { join_task( & upper); }
+            catch (...)
+            {}
+            throw;
+        }
+        join_task( & upper);
+        return reduce( lower, upper.result);
+    }
+    T result( identity);
+    for ( ; first != last; ++first)
+        result = reduce( result, fn( first) );
+    return result;
+}
+
+// runs t in the pool if called outside of it
+template< typename Task >
+void run_root( Task & t)
+{
+    if ( in_worker() )
+        t.execute();
+    else
+    {
+        spawn_task( & t);
+        join_task( & t);
+    }
+}
+
+template< typename Fn >
+class invoke_task : public parallel_task
+{
+private:
+    Fn  &   fn_;
+
+public:
+    invoke_task( Fn & fn) :
+        parallel_task(), fn_( fn)
+    {}
+
+    void execute()
+    { fn_(); }
+};
+
+}
+
+// calls fn( i) for each i in [first, last) - the range is split
+// recursively into fibers of the worker pool (one thread per core),
+// idle workers steal the largest pending ranges; ranges of at most
+// grain indices are processed sequentially
+template< typename Index, typename Fn >
+void parallel_for( Index first, Index last, Index grain, Fn fn)
+{
+    if ( ! ( first < last) ) return;
+    if ( grain < 1) grain = 1;
+    detail::for_task< Index, Fn > root( first, last, grain, fn);
+    detail::run_root( root);
+}
+
+// returns reduce( ... reduce( identity, fn( first) ) ..., fn( last - 1) ) -
+// the order of the reductions is unspecified, reduce must be associative
+template< typename Index, typename T, typename Fn, typename Reduce >
+T parallel_reduce( Index first, Index last, Index grain, T const& identity, Fn fn, Reduce reduce)
+{
+    if ( ! ( first < last) ) return identity;
+    if ( grain < 1) grain = 1;
+    detail::reduce_task< Index, T, Fn, Reduce > root( first, last, grain, identity, fn, reduce);
+    detail::run_root( root);
+    return root.result;
+}
+
+// calls f0(), f1(), ... in parallel and returns after all returned -
+// the first exception is rethrown
+#define BOOST_FIBERS_PARALLEL_INVOKE_TASK(z,n,unused) \
+    detail::invoke_task< BOOST_PP_CAT(F,n) > BOOST_PP_CAT(t,n)( BOOST_PP_CAT(f,n) );
+
+#define BOOST_FIBERS_PARALLEL_INVOKE_PTR(z,n,unused) \
+    & BOOST_PP_CAT(t,n),
+
+#define BOOST_FIBERS_PARALLEL_INVOKE(z,n,unused) \
+template< BOOST_PP_ENUM_PARAMS(n, typename F) > \
+void parallel_invoke( BOOST_PP_ENUM_BINARY_PARAMS(n, F, f) ) \
+{ \
+    BOOST_PP_REPEAT(n,BOOST_FIBERS_PARALLEL_INVOKE_TASK,~) \
+    detail::parallel_task * ts[] = { BOOST_PP_REPEAT(n,BOOST_FIBERS_PARALLEL_INVOKE_PTR,~) 0 }; \
+    detail::invoke_tasks( ts, n); \
+}
+
+#ifndef BOOST_FIBERS_PARALLEL_INVOKE_MAX_ARITY
+#define BOOST_FIBERS_PARALLEL_INVOKE_MAX_ARITY 10
+#endif
+
+BOOST_PP_REPEAT_FROM_TO( 2, BOOST_FIBERS_PARALLEL_INVOKE_MAX_ARITY, BOOST_FIBERS_PARALLEL_INVOKE, ~)
+
+#undef BOOST_FIBERS_PARALLEL_INVOKE
+#undef BOOST_FIBERS_PARALLEL_INVOKE_PTR
+#undef BOOST_FIBERS_PARALLEL_INVOKE_TASK
+
+}}
+
+# if defined(BOOST_MSVC)
+# pragma warning(pop)
+# endif
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
+
+#endif // BOOST_FIBERS_PARALLEL_H
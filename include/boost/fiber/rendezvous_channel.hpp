@@ -0,0 +1,324 @@
+//          Copyright Oliver Kowalke 2009.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_FIBERS_RENDEZVOUS_CHANNEL_H
+#define BOOST_FIBERS_RENDEZVOUS_CHANNEL_H
+
+#include <algorithm>
+#include <deque>
+
+#include <boost/assert.hpp>
+#include <boost/atomic.hpp>
+#include <boost/config.hpp>
+#include <boost/exception/all.hpp>
+#include <boost/foreach.hpp>
+#include <boost/move/move.hpp>
+#include <boost/optional.hpp>
+#include <boost/thread/locks.hpp>
+#include <boost/utility.hpp>
+
+#include <boost/fiber/detail/config.hpp>
+#include <boost/fiber/detail/notify.hpp>
+#include <boost/fiber/detail/scheduler.hpp>
+#include <boost/fiber/detail/spinlock.hpp>
+#include <boost/fiber/exceptions.hpp>
+#include <boost/fiber/interruption.hpp>
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+namespace boost {
+namespace fibers {
+
+// unbuffered channel - put() blocks until a consumer has taken the
+// item, the item is copied (moved) directly from the producer's
+// frame into the consumer's value_type by whichever side arrives
+// second, no node or slot is allocated; the copy (move) runs outside
+// of the channel's lock
+template< typename T >
+class rendezvous_channel : private noncopyable
+{
+public:
+    typedef optional< T >   value_type;
+
+private:
+    enum state
+    {
+        ACTIVE = 0,
+        DEACTIVE
+    };
+
+    // copies or moves the item of the producer, only the variant
+    // used by put() is instantiated (move-only items)
+    typedef void ( * transfer_t)( T *, value_type &);
+
+    // lives in the frame of the waiting fiber, a producer
+    // references its item (src), a consumer the target (dst)
+    struct waiter
+    {
+        detail::notify::ptr_t   n;
+        T                   *   src;
+        transfer_t              transfer;
+        value_type          *   dst;
+        // removed from its queue by the other side, which transfers
+        // the item - the waiting fiber stays until done is set
+        bool                    claimed;
+        bool                    done;
+
+        waiter( T * src_, transfer_t transfer_) :
+            n(), src( src_), transfer( transfer_), dst( 0),
+            claimed( false), done( false)
+        {}
+
+        explicit waiter( value_type * dst_) :
+            n(), src( 0), transfer( 0), dst( dst_),
+            claimed( false), done( false)
+        {}
+    };
+
+    typedef std::deque< waiter * >  queue_t;
+
+    atomic< state >         state_;
+    detail::spinlock        mtx_;
+    queue_t                 producers_;
+    queue_t                 consumers_;
+
+    bool active_() const
+    { return ACTIVE == state_; }
+
+    static void copy_( T * src, value_type & dst)
+    { dst = * src; }
+
+#ifndef BOOST_NO_RVALUE_REFERENCES
+    static void move_( T * src, value_type & dst)
+    { dst = boost::move( * src); }
+#endif
+
+    static void remove_( queue_t & q, waiter * w)
+    {
+        typename queue_t::iterator i( std::find( q.begin(), q.end(), w) );
+        if ( q.end() != i) q.erase( i);
+    }
+
+    // lk must be locked, w is completed by the other side - returns
+    // false if the channel was deactivated before w was done
+    bool wait_( unique_lock< detail::spinlock > & lk, queue_t & q, waiter & w)
+    {
+        w.n = detail::scheduler::instance().active();
+        bool is_fiber = w.n ? true : false;
+        if ( ! is_fiber)
+            // notifier for main-fiber
+            w.n = detail::scheduler::instance().notifier();
+        detail::notify::ptr_t n( w.n);
+
+        q.push_back( & w);
+        try
+        {
+            for (;;)
+            {
+                if ( w.done) return true;
+                if ( ! w.claimed && ! active_() )
+                {
+                    remove_( q, & w);
+                    return false;
+                }
+
+                if ( is_fiber)
+                {
+                    // suspend this fiber
+                    detail::scheduler::instance().wait( lk);
+                    lk.lock();
+                    // an item handed over wins against an interruption
+                    if ( w.done) return true;
+                    // the other side transfers the item
+                    if ( w.claimed) continue;
+
+                    // check if fiber was interrupted
+                    this_fiber::interruption_point();
+                }
+                else
+                {
+                    lk.unlock();
+                    while ( ! n->is_ready() )
+                        // run scheduler
+                        detail::scheduler::instance().run();
+                    // notifier of main-fiber might have been set
+                    // by a previous wait
+                    lk.lock();
+                }
+            }
+        }
+        catch (...)
+        {
+            if ( ! lk.owns_lock() ) lk.lock();
+            remove_( q, & w);
+            throw;
+        }
+    }
+
+    // lk must be locked on mtx_, q must not be empty - the waiter at the
+    // front of q is claimed and the item is transferred with lk released;
+    // if the transfer throws the waiter is put back
+    void transfer_( unique_lock< detail::spinlock > & lk, queue_t & q,
+                    T * src, transfer_t transfer, value_type * dst)
+    {
+        waiter * w = q.front();
+        q.pop_front();
+        w->claimed = true;
+        lk.unlock();
+
+        try
+        { transfer( src ? src : w->src, dst ? * dst : * w->dst); }
+        catch (...)
+        {
+            lk.lock();
+            w->claimed = false;
+            q.push_front( w);
+            // deactivate() has not seen the claimed waiter
+            detail::notify::ptr_t n;
+            if ( ! active_() ) n = w->n;
+            lk.unlock();
+            if ( n) n->set_ready();
+            throw;
+        }
+
+        lk.lock();
+        w->done = true;
+        // w must not be accessed after lk was released
+        detail::notify::ptr_t n;
+        n.swap( w->n);
+        lk.unlock();
+
+        n->set_ready();
+    }
+
+    // lk must be locked on mtx_, consumers_ must not be empty
+    void hand_over_( unique_lock< detail::spinlock > & lk, T * t, transfer_t transfer)
+    { transfer_( lk, consumers_, t, transfer, 0); }
+
+    // lk must be locked on mtx_, producers_ must not be empty
+    void take_over_( unique_lock< detail::spinlock > & lk, value_type & va)
+    { transfer_( lk, producers_, 0, producers_.front()->transfer, & va); }
+
+    void put_( T * t, transfer_t transfer)
+    {
+        unique_lock< detail::spinlock > lk( mtx_);
+        if ( ! active_() )
+            boost::throw_exception( fiber_resource_error() );
+        if ( ! consumers_.empty() )
+        {
+            hand_over_( lk, t, transfer);
+            return;
+        }
+
+        waiter w( t, transfer);
+        if ( ! wait_( lk, producers_, w) )
+            // deactivated before a consumer has taken the item
+            boost::throw_exception( fiber_resource_error() );
+    }
+
+public:
+    rendezvous_channel() :
+        state_( ACTIVE),
+        mtx_(),
+        producers_(),
+        consumers_()
+    {}
+
+    ~rendezvous_channel()
+    {
+        BOOST_ASSERT( producers_.empty() );
+        BOOST_ASSERT( consumers_.empty() );
+    }
+
+    bool active() const
+    { return active_(); }
+
+    // waiting producers throw fiber_resource_error, waiting
+    // consumers return false
+    void deactivate()
+    {
+        std::deque< detail::notify::ptr_t > waiting;
+
+        unique_lock< detail::spinlock > lk( mtx_);
+        state_ = DEACTIVE;
+        BOOST_FOREACH( waiter * w, producers_)
+        { waiting.push_back( w->n); }
+        BOOST_FOREACH( waiter * w, consumers_)
+        { waiting.push_back( w->n); }
+        lk.unlock();
+
+        BOOST_FOREACH( detail::notify::ptr_t const& n, waiting)
+        { n->set_ready(); }
+    }
+
+    // blocks until a consumer has taken t
+    void put( T const& t)
+    { put_( const_cast< T * >( & t), & copy_); }
+
+#ifndef BOOST_NO_RVALUE_REFERENCES
+    // t is moved into the consumer's value
+    void put( BOOST_RV_REF( T) t)
+    { put_( & t, & move_); }
+#endif
+
+    // succeeds only if a consumer is waiting
+    bool try_put( T const& t)
+    {
+        unique_lock< detail::spinlock > lk( mtx_);
+        if ( ! active_() )
+            boost::throw_exception( fiber_resource_error() );
+        if ( consumers_.empty() )
+            return false;
+        hand_over_( lk, const_cast< T * >( & t), & copy_);
+        return true;
+    }
+
+    // returns false if the channel was deactivated
+    // or the fiber interrupted
+    bool take( value_type & va)
+    {
+        unique_lock< detail::spinlock > lk( mtx_);
+        if ( ! producers_.empty() )
+        {
+            take_over_( lk, va);
+            return true;
+        }
+        if ( ! active_() )
+            return false;
+
+        waiter w( & va);
+        try
+        { return wait_( lk, consumers_, w); }
+        catch ( fiber_interrupted const&)
+        { return false; }
+    }
+
+    value_type take()
+    {
+        value_type va;
+        take( va);
+        return va;
+    }
+
+    // succeeds only if a producer is waiting
+    bool try_take( value_type & va)
+    {
+        unique_lock< detail::spinlock > lk( mtx_);
+        if ( producers_.empty() )
+            return false;
+        take_over_( lk, va);
+        return true;
+    }
+};
+
+}}
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
+
+#endif // BOOST_FIBERS_RENDEZVOUS_CHANNEL_H
@@ -9,14 +9,18 @@
 #include <cstddef>
 #include <deque>
 #include <set>
+#include <utility>
 #include <vector>
 
 #include <boost/assert.hpp>
+#include <boost/chrono/system_clocks.hpp>
 #include <boost/config.hpp>
 #include <boost/move/move.hpp>
 #include <boost/thread/locks.hpp>
 
 #include <boost/fiber/detail/config.hpp>
+#include <boost/fiber/detail/epoll_reactor.hpp>
+#include <boost/fiber/detail/io_uring.hpp>
 #include <boost/fiber/detail/notify.hpp>
 #include <boost/fiber/detail/spinlock.hpp>
 #include <boost/fiber/fiber.hpp>
@@ -39,12 +43,39 @@ class BOOST_FIBERS_DECL round_robin : public algorithm
 private:
     typedef std::deque< detail::fiber_base::ptr_t >     wqueue_t;
     typedef std::deque< detail::fiber_base::ptr_t >     rqueue_t;
+    typedef std::pair<
+        chrono::system_clock::time_point,
+        detail::fiber_base::ptr_t
+    >                                                   timer_t;
+    // min-heap of fibers waiting with a deadline
+    typedef std::vector< timer_t >                      tqueue_t;
 
     detail::fiber_base::ptr_t   active_fiber_;
     detail::notify::ptr_t       notifier_;
     wqueue_t                    wqueue_;
+    tqueue_t                    tqueue_;
+    // entries of fibers notified before their deadline
+    std::size_t                 stale_timers_;
     detail::spinlock            rqueue_mtx_;
     rqueue_t                    rqueue_;
+#if defined(BOOST_FIBERS_HAS_EPOLL)
+    // created by the first wait_io()
+    detail::epoll_reactor   *   reactor_;
+#endif
+#if defined(BOOST_FIBERS_HAS_IO_URING)
+    // created by the first wait_completion(), 0 if
+    // io_uring is not available
+    detail::io_uring_backend    *   uring_;
+    bool                            uring_checked_;
+#endif
+
+    void expire_timers_();
+
+    void compact_timers_();
+
+    void poll_wqueue_();
+
+    bool poll_io_( bool);
 
 public:
     round_robin() BOOST_NOEXCEPT;
@@ -57,17 +88,26 @@ public:
 
     void join( detail::fiber_base::ptr_t const&);
 
-    detail::fiber_base::ptr_t active() BOOST_NOEXCEPT
+    detail::fiber_base::ptr_t const& active() BOOST_NOEXCEPT
     { return active_fiber_; }
 
     bool run();
 
     void wait( unique_lock< detail::spinlock > &);
 
+    bool wait_until( unique_lock< detail::spinlock > &,
+                     chrono::system_clock::time_point const&);
+
     void yield();
 
     detail::notify::ptr_t notifier();
 
+    void wait_io( int, detail::io_op);
+
+    void deregister_io( int);
+
+    bool wait_completion( detail::io_request &);
+
     void migrate_to( fiber const&);
 
     fiber steel_from();
@@ -0,0 +1,177 @@
+//          Copyright Oliver Kowalke 2009.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_FIBERS_SELECTOR_H
+#define BOOST_FIBERS_SELECTOR_H
+
+#include <cstddef>
+#include <vector>
+
+#include <boost/chrono/system_clocks.hpp>
+#include <boost/config.hpp>
+#include <boost/utility.hpp>
+
+#include <boost/fiber/detail/config.hpp>
+#include <boost/fiber/detail/select_queue.hpp>
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+# if defined(BOOST_MSVC)
+# pragma warning(push)
+# pragma warning(disable:4251 4275)
+# endif
+
+namespace boost {
+namespace fibers {
+
+// blocks a fiber until one of several channel operations (cases)
+// can proceed - one waiter is registered at all channels while the
+// fiber is suspended and removed from them before wait() returns
+// the referenced channels and values must outlive the selector
+class BOOST_FIBERS_DECL selector : private noncopyable
+{
+public:
+    // wait() did not complete a case because the deadline has expired
+    static const int timeout = -1;
+    // no case can ever proceed - the channels are deactivated
+    static const int closed = -2;
+
+private:
+    class case_base : private noncopyable
+    {
+    public:
+        virtual ~case_base() {}
+
+        // completes the operation if it does not block
+        virtual bool try_complete() = 0;
+
+        // the operation will never proceed
+        virtual bool closed() const = 0;
+
+        virtual void subscribe( detail::select_waiter::ptr_t const&) = 0;
+
+        virtual void unsubscribe( detail::select_waiter::ptr_t const&) = 0;
+    };
+
+    template< typename Channel >
+    class take_case : public case_base
+    {
+    private:
+        Channel                         &   ch_;
+        typename Channel::value_type    &   va_;
+
+    public:
+        take_case( Channel & ch, typename Channel::value_type & va) :
+            ch_( ch), va_( va)
+        {}
+
+        bool try_complete()
+        { return ch_.try_take( va_); }
+
+        // remaining items are delivered after deactivation
+        bool closed() const
+        { return ! ch_.active() && ch_.empty(); }
+
+        void subscribe( detail::select_waiter::ptr_t const& w)
+        { ch_.select_readable_.subscribe( w); }
+
+        void unsubscribe( detail::select_waiter::ptr_t const& w)
+        { ch_.select_readable_.unsubscribe( w); }
+    };
+
+    template< typename Channel, typename T >
+    class put_case : public case_base
+    {
+    private:
+        Channel     &   ch_;
+        T const     &   t_;
+
+    public:
+        put_case( Channel & ch, T const& t) :
+            ch_( ch), t_( t)
+        {}
+
+        bool try_complete()
+        { return ch_.try_put( t_); }
+
+        bool closed() const
+        { return ! ch_.active(); }
+
+        void subscribe( detail::select_waiter::ptr_t const& w)
+        { ch_.select_writeable_.subscribe( w); }
+
+        void unsubscribe( detail::select_waiter::ptr_t const& w)
+        { ch_.select_writeable_.unsubscribe( w); }
+    };
+
+    std::vector< case_base * >      cases_;
+    std::size_t                     next_;
+    detail::select_waiter::ptr_t    waiter_;
+
+    int add_( case_base *);
+
+    int try_select_();
+
+    void subscribe_();
+
+    void unsubscribe_();
+
+    int wait_( chrono::system_clock::time_point const*);
+
+public:
+    selector();
+
+    ~selector();
+
+    // adds a case taking an item from ch into va, returns the
+    // index of the case
+    template< typename Channel >
+    int add_take( Channel & ch, typename Channel::value_type & va)
+    {
+        cases_.reserve( cases_.size() + 1);
+        return add_( new take_case< Channel >( ch, va) );
+    }
+
+    // adds a case putting t into ch (t is referenced, not copied),
+    // returns the index of the case
+    template< typename Channel, typename T >
+    int add_put( Channel & ch, T const& t)
+    {
+        cases_.reserve( cases_.size() + 1);
+        return add_( new put_case< Channel, T >( ch, t) );
+    }
+
+    std::size_t size() const
+    { return cases_.size(); }
+
+    // completes one case which does not block and returns its index,
+    // timeout if all cases would block or closed
+    int try_wait();
+
+    // blocks until one case was completed and returns its index or
+    // closed if no case can proceed anymore - cases are tried
+    // round-robin so that a busy channel does not starve the others
+    int wait();
+
+    int wait_until( chrono::system_clock::time_point const& abs_time);
+
+    template< typename TimeDuration >
+    int wait_for( TimeDuration const& dt)
+    { return wait_until( chrono::system_clock::now() + dt); }
+};
+
+}}
+
+# if defined(BOOST_MSVC)
+# pragma warning(pop)
+# endif
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
+
+#endif // BOOST_FIBERS_SELECTOR_H
@@ -0,0 +1,276 @@
+//          Copyright Oliver Kowalke 2009.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_FIBERS_SPSC_CHANNEL_H
+#define BOOST_FIBERS_SPSC_CHANNEL_H
+
+#include <cstddef>
+
+#include <boost/assert.hpp>
+#include <boost/atomic.hpp>
+#include <boost/config.hpp>
+#include <boost/exception/all.hpp>
+#include <boost/optional.hpp>
+#include <boost/scoped_array.hpp>
+#include <boost/system/error_code.hpp>
+#include <boost/thread/locks.hpp>
+#include <boost/utility.hpp>
+
+#include <boost/fiber/detail/config.hpp>
+#include <boost/fiber/detail/notify.hpp>
+#include <boost/fiber/detail/scheduler.hpp>
+#include <boost/fiber/detail/spinlock.hpp>
+#include <boost/fiber/exceptions.hpp>
+#include <boost/fiber/interruption.hpp>
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+namespace boost {
+namespace fibers {
+
+// channel for exactly one producer and one consumer (fiber or thread)
+// the ring-buffer is accessed without locks, a side parks only
+// after it has observed an empty/full channel
+template< typename T >
+class spsc_channel : private noncopyable
+{
+public:
+    typedef optional< T >   value_type;
+
+private:
+    enum state
+    {
+        ACTIVE = 0,
+        DEACTIVE
+    };
+
+    // parking slot of one side - parked is set before the side
+    // re-checks the channel, the other side notifies only if
+    // parked is set
+    struct waiter
+    {
+        atomic< bool >              parked;
+        detail::spinlock            mtx;
+        detail::notify::ptr_t       n;
+
+        waiter() :
+            parked( false), mtx(), n()
+        {}
+    };
+
+    typedef bool ( spsc_channel::*predicate_t)() const;
+
+    atomic< state >                 state_;
+    std::size_t                     mask_;
+    scoped_array< value_type >      slots_;
+    char                            pad1_[BOOST_FIBERS_CACHELINE_SIZE];
+    // consumer
+    atomic< std::size_t >           head_;
+    std::size_t                     tail_cache_;
+    waiter                          consumer_;
+    char                            pad2_[BOOST_FIBERS_CACHELINE_SIZE];
+    // producer
+    atomic< std::size_t >           tail_;
+    std::size_t                     head_cache_;
+    waiter                          producer_;
+
+    static std::size_t round_up_( std::size_t capacity)
+    {
+        std::size_t size = 1;
+        while ( size < capacity) size <<= 1;
+        return size;
+    }
+
+    bool active_() const
+    { return ACTIVE == state_; }
+
+    bool empty_() const
+    { return head_.load( memory_order_relaxed) == tail_.load( memory_order_acquire); }
+
+    bool full_() const
+    { return tail_.load( memory_order_relaxed) - head_.load( memory_order_acquire) > mask_; }
+
+    bool readable_() const
+    { return ! active_() || ! empty_(); }
+
+    bool writeable_() const
+    { return ! active_() || ! full_(); }
+
+    void notify_( waiter & w)
+    {
+        atomic_thread_fence( memory_order_seq_cst);
+        if ( ! w.parked.load( memory_order_relaxed) ) return;
+
+        detail::notify::ptr_t n;
+        unique_lock< detail::spinlock > lk( w.mtx);
+        if ( ! w.parked.load( memory_order_relaxed) ) return;
+        w.parked.store( false, memory_order_relaxed);
+        n.swap( w.n);
+        lk.unlock();
+
+        n->set_ready();
+    }
+
+    void park_( waiter & w, predicate_t ready)
+    {
+        detail::notify::ptr_t n( detail::scheduler::instance().active() );
+        bool is_fiber = n ? true : false;
+        if ( ! is_fiber)
+            // notifier for main-fiber
+            n = detail::scheduler::instance().notifier();
+
+        unique_lock< detail::spinlock > lk( w.mtx);
+        w.n = n;
+        w.parked.store( true, memory_order_relaxed);
+        atomic_thread_fence( memory_order_seq_cst);
+        // other side might have missed the parked flag
+        if ( ( this->*ready)() )
+        {
+            w.parked.store( false, memory_order_relaxed);
+            w.n.reset();
+            return;
+        }
+
+        try
+        {
+            if ( is_fiber)
+            {
+                for (;;)
+                {
+                    // suspend this fiber
+                    detail::scheduler::instance().wait( lk);
+
+                    // check if fiber was interrupted
+                    this_fiber::interruption_point();
+
+                    // woken up by an interruption request while
+                    // interruptions are blocked - still parked
+                    lk.lock();
+                    if ( ! w.parked.load( memory_order_relaxed) ) break;
+                }
+            }
+            else
+            {
+                lk.unlock();
+                while ( ! n->is_ready() )
+                    // run scheduler
+                    detail::scheduler::instance().run();
+
+                // notifier of main-fiber might have been set
+                // by a previous wait
+                lk.lock();
+                w.parked.store( false, memory_order_relaxed);
+                w.n.reset();
+            }
+        }
+        catch (...)
+        {
+            if ( ! lk.owns_lock() ) lk.lock();
+            w.parked.store( false, memory_order_relaxed);
+            w.n.reset();
+            throw;
+        }
+    }
+
+public:
+    explicit spsc_channel( std::size_t capacity = 1024) :
+        state_( ACTIVE),
+        mask_( round_up_( capacity) - 1),
+        slots_(),
+        pad1_(),
+        head_( 0),
+        tail_cache_( 0),
+        consumer_(),
+        pad2_(),
+        tail_( 0),
+        head_cache_( 0),
+        producer_()
+    {
+        if ( 0 == capacity)
+            boost::throw_exception(
+                invalid_argument(
+                    system::errc::invalid_argument,
+                    "boost fiber: zero capacity for spsc_channel") );
+        slots_.reset( new value_type[mask_ + 1]);
+    }
+
+    std::size_t capacity() const
+    { return mask_ + 1; }
+
+    bool active() const
+    { return active_(); }
+
+    void deactivate()
+    {
+        state_ = DEACTIVE;
+        notify_( consumer_);
+        notify_( producer_);
+    }
+
+    bool empty() const
+    { return head_.load( memory_order_acquire) == tail_.load( memory_order_acquire); }
+
+    bool try_put( T const& t)
+    {
+        if ( ! active_() )
+            boost::throw_exception( fiber_resource_error() );
+
+        std::size_t tail = tail_.load( memory_order_relaxed);
+        if ( tail - head_cache_ > mask_)
+        {
+            head_cache_ = head_.load( memory_order_acquire);
+            if ( tail - head_cache_ > mask_) return false;
+        }
+        slots_[tail & mask_] = t;
+        tail_.store( tail + 1, memory_order_release);
+        notify_( consumer_);
+        return true;
+    }
+
+    void put( T const& t)
+    {
+        while ( ! try_put( t) )
+            park_( producer_, & spsc_channel::writeable_);
+    }
+
+    bool try_take( value_type & va)
+    {
+        std::size_t head = head_.load( memory_order_relaxed);
+        if ( head == tail_cache_)
+        {
+            tail_cache_ = tail_.load( memory_order_acquire);
+            if ( head == tail_cache_) return false;
+        }
+        swap( va, slots_[head & mask_]);
+        slots_[head & mask_] = none;
+        head_.store( head + 1, memory_order_release);
+        notify_( producer_);
+        return va;
+    }
+
+    bool take( value_type & va)
+    {
+        while ( ! try_take( va) )
+        {
+            // remaining items are delivered after deactivation
+            if ( ! active_() && empty_() ) return false;
+            try
+            { park_( consumer_, & spsc_channel::readable_); }
+            catch ( fiber_interrupted const&)
+            { return false; }
+        }
+        return true;
+    }
+};
+
+}}
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
+
+#endif // BOOST_FIBERS_SPSC_CHANNEL_H
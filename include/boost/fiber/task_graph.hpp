@@ -0,0 +1,133 @@
+//          Copyright Oliver Kowalke 2009.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_FIBERS_TASK_GRAPH_H
+#define BOOST_FIBERS_TASK_GRAPH_H
+
+#include <cstddef>
+#include <vector>
+
+#include <boost/atomic.hpp>
+#include <boost/config.hpp>
+#include <boost/exception_ptr.hpp>
+#include <boost/function.hpp>
+#include <boost/scoped_array.hpp>
+#include <boost/utility.hpp>
+
+#include <boost/fiber/detail/completion.hpp>
+#include <boost/fiber/detail/config.hpp>
+#include <boost/fiber/detail/spinlock.hpp>
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+# if defined(BOOST_MSVC)
+# pragma warning(push)
+# pragma warning(disable:4251 4275)
+# endif
+
+namespace boost {
+namespace fibers {
+
+// a directed acyclic graph of functions - a node becomes runnable after
+// all of its predecessors have returned, only runnable nodes are given
+// a (pooled) fiber, so a waiting node costs neither a fiber nor a stack
+//
+// the graph is built by one fiber, run() may be called repeatedly but
+// the graph must not be modified while it is running
+class BOOST_FIBERS_DECL task_graph : private noncopyable
+{
+public:
+    typedef std::size_t     node_id;
+
+private:
+    struct node
+    {
+        function< void() >      fn;
+        std::vector< node_id >  successors;
+        std::size_t             predecessors;
+
+        node( function< void() > const& fn_) :
+            fn( fn_), successors(), predecessors( 0)
+        {}
+    };
+
+    // posts a runnable node
+    typedef function< void( function< void() > const&) >    submit_fn;
+
+    struct run_node;
+    friend struct run_node;
+
+    std::vector< node >                     nodes_;
+    // nodes_ has been checked for cycles
+    bool                                    acyclic_;
+    // state of the current run
+    scoped_array< atomic< std::size_t > >   pending_;
+    scoped_array< atomic< bool > >          cancelled_;
+    atomic< std::size_t >                   remaining_;
+    submit_fn                               submit_;
+    detail::completion                      done_;
+    // guards except_
+    detail::spinlock                        mtx_;
+    exception_ptr                           except_;
+
+    void check_acyclic_();
+
+    void execute_( node_id);
+
+    void complete_();
+
+    void run_( submit_fn const&);
+
+    template< typename Executor >
+    struct executor_submit
+    {
+        Executor    *   ex;
+
+        executor_submit( Executor & ex_) :
+            ex( & ex_)
+        {}
+
+        void operator()( function< void() > const& fn) const
+        { ex->submit( fn); }
+    };
+
+public:
+    task_graph();
+
+    // adds a node without predecessors
+    node_id add( function< void() > const& fn);
+
+    // node runs after predecessor has returned - run() throws
+    // invalid_argument if the dependencies form a cycle
+    void add_dependency( node_id node, node_id predecessor);
+
+    std::size_t size() const BOOST_NOEXCEPT
+    { return nodes_.size(); }
+
+    // runs the graph in pooled fibers of the calling thread (a scheduling
+    // algorithm must be installed) and returns after all nodes have
+    // finished - if a node throws, its successors are skipped and the
+    // first exception is rethrown
+    void run();
+
+    // as run(), the runnable nodes are submitted to ex
+    template< typename Executor >
+    void run( Executor & ex)
+    { run_( executor_submit< Executor >( ex) ); }
+};
+
+}}
+
+# if defined(BOOST_MSVC)
+# pragma warning(pop)
+# endif
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
+
+#endif // BOOST_FIBERS_TASK_GRAPH_H
@@ -15,9 +15,12 @@
 #include <boost/chrono/system_clocks.hpp>
 #include <boost/config.hpp>
 #include <boost/intrusive_ptr.hpp>
+#include <boost/move/move.hpp>
 #include <boost/optional.hpp>
 #include <boost/utility.hpp>
 
+#include <boost/fiber/channel_statistics.hpp>
+#include <boost/fiber/detail/select_queue.hpp>
 #include <boost/fiber/exceptions.hpp>
 #include <boost/fiber/condition.hpp>
 #include <boost/fiber/mutex.hpp>
@@ -56,13 +59,19 @@ void intrusive_ptr_release( unbounded_channel_node< T > * p)
 
 }
 
-template< typename T >
+class selector;
+
+// Statistics is a policy counting items and blocked time, see
+// channel_statistics - the default null_channel_statistics is empty
+template< typename T, typename Statistics = null_channel_statistics >
 class unbounded_channel : private noncopyable
 {
 public:
 	typedef optional< T >	value_type;
 
 private:
+	friend class selector;
+
 	typedef detail::unbounded_channel_node< value_type >	node_type;
 
 	enum state
@@ -77,6 +86,8 @@ private:
 	typename node_type::ptr		tail_;
 	mutable mutex				tail_mtx_;
 	condition					not_empty_cond_;
+	detail::select_queue		select_readable_;
+	Statistics					stats_;
 
 	bool active_() const
 	{ return ACTIVE == state_; }
@@ -98,9 +109,70 @@ private:
 	{
 		typename node_type::ptr old_head = head_;
 		head_ = old_head->next;
+		stats_.on_take( 1);
 		return old_head;
 	}
 
+	// moves up to max items to out, the tail is read only once
+	template< typename OutputIterator >
+	std::size_t pop_head_n_( OutputIterator & out, std::size_t max)
+	{
+		typename node_type::ptr tail = get_tail_();
+		std::size_t n = 0;
+		for ( ; n < max && head_ != tail; ++n)
+		{
+			* out = boost::move( * head_->va);
+			++out;
+			pop_head_();
+		}
+		return n;
+	}
+
+	// lk must be locked on head_mtx_, returns false if the
+	// fiber was interrupted
+	bool wait_not_empty_( mutex::scoped_lock & lk,
+						  chrono::system_clock::time_point const* abs_time)
+	{
+		chrono::high_resolution_clock::time_point start;
+		if ( Statistics::enabled)
+			start = chrono::high_resolution_clock::now();
+		try
+		{
+			while ( active_() && empty_() )
+			{
+				if ( ! abs_time)
+					not_empty_cond_.wait( lk);
+				else if ( ! not_empty_cond_.timed_wait( lk, * abs_time) )
+					break;
+			}
+		}
+		catch ( fiber_interrupted const&)
+		{ return false; }
+		if ( Statistics::enabled)
+			stats_.on_consumer_wait( chrono::high_resolution_clock::now() - start);
+		return true;
+	}
+
+	// returns false if the channel was deactivated, the fiber
+	// interrupted or abs_time has expired
+	bool take_( value_type & va, chrono::system_clock::time_point const* abs_time)
+	{
+		mutex::scoped_lock lk( head_mtx_);
+		bool empty = empty_();
+		if ( ! active_() && empty)
+			return false;
+		if ( empty && ! wait_not_empty_( lk, abs_time) )
+			return false;
+		if ( empty_() )
+			return false;
+		swap( va, head_->va);
+		pop_head_();
+		// put_n() notifies only one consumer - pass it on
+		if ( empty && ! empty_() )
+			not_empty_cond_.notify_one();
+		return va;
+	}
+
 public:
 	unbounded_channel() :
 		state_( ACTIVE),
@@ -108,9 +180,14 @@ public:
 		head_mtx_(),
 		tail_( head_),
 		tail_mtx_(),
-		not_empty_cond_()
+		not_empty_cond_(),
+		select_readable_(),
+		stats_()
 	{}
 
+	Statistics const& statistics() const
+	{ return stats_; }
+
 	bool active() const
 	{ return active_(); }
 
@@ -119,6 +196,7 @@ public:
 		mutex::scoped_lock lk( head_mtx_);
 		deactivate_();
 		not_empty_cond_.notify_all();
+		select_readable_.notify_all();
 	}
 
 	bool empty() const
@@ -139,63 +217,140 @@ public:
 			tail_->va = t;
 			tail_->next = new_node;
 			tail_ = new_node;
+			stats_.on_put( 1);
 		}
 		not_empty_cond_.notify_one();
+		select_readable_.notify_all();
 	}
 
-	bool take( value_type & va)
+#ifndef BOOST_NO_RVALUE_REFERENCES
+	void put( BOOST_RV_REF( T) t)
 	{
-		mutex::scoped_lock lk( head_mtx_);
-		bool empty = empty_();
-		if ( ! active_() && empty)
-			return false;
-		if ( empty)
+		typename node_type::ptr new_node( new node_type() );
 		{
-		try
+			mutex::scoped_lock lk( tail_mtx_);
+
+			if ( ! active_() )
+				throw std::runtime_error("queue is not active");
+
+			tail_->va = boost::move( t);
+			tail_->next = new_node;
+			tail_ = new_node;
+			stats_.on_put( 1);
+		}
+		not_empty_cond_.notify_one();
+		select_readable_.notify_all();
+	}
+
+#ifndef BOOST_NO_VARIADIC_TEMPLATES
+	// constructs the item in the tail node
+	template< typename ... Args >
+	void emplace( Args && ... args)
+	{
+		typename node_type::ptr new_node( new node_type() );
 		{
-				while ( active_() && empty_() )
-					not_empty_cond_.wait( lk);
+			mutex::scoped_lock lk( tail_mtx_);
+
+			if ( ! active_() )
+				throw std::runtime_error("queue is not active");
+
+			tail_->va.emplace( boost::forward< Args >( args) ... );
+			tail_->next = new_node;
+			tail_ = new_node;
+			stats_.on_put( 1);
 		}
-		catch ( fiber_interrupted const&)
-		{ return false; }
+		not_empty_cond_.notify_one();
+		select_readable_.notify_all();
+	}
+#endif
+#endif
+
+	// the nodes are allocated before the tail is locked, the whole
+	// range is appended under one lock acquisition followed by a
+	// single notification
+	template< typename InputIterator >
+	void put_n( InputIterator first, InputIterator last)
+	{
+		if ( first == last) return;
+
+		value_type va( * first);
+		typename node_type::ptr chain( new node_type() );
+		typename node_type::ptr last_node( chain);
+		std::size_t n = 1;
+		for ( ++first; first != last; ++first, ++n)
+		{
+			last_node->va = * first;
+			last_node->next = new node_type();
+			last_node = last_node->next;
 		}
-		if ( ! active_() && empty_() )
-			return false;
-		swap( va, head_->va);
-		pop_head_();
+		{
+			mutex::scoped_lock lk( tail_mtx_);
+
+			if ( ! active_() )
+				throw std::runtime_error("queue is not active");
+
+			swap( tail_->va, va);
+			tail_->next = chain;
+			tail_ = last_node;
+			stats_.on_put( n);
+		}
+		not_empty_cond_.notify_one();
+		select_readable_.notify_all();
+	}
+
+	bool take( value_type & va)
+	{ return take_( va, 0); }
+
+	// returns an empty value if the channel was deactivated
+	// or the fiber interrupted
+	value_type take()
+	{
+		value_type va;
+		take( va);
 		return va;
 	}
-#if 0
-    template< typename TimeDuration >
-	bool take( value_type & va, TimeDuration const& dt)
-	{ return take( va, chrono::system_clock::now() + dt); }
 
-	bool take( value_type & va, chrono::system_clock::time_point const& abs_time)
+	// waits until at least one item is available and moves up to
+	// max items to out under one lock acquisition, returns the
+	// number of items taken (zero if the channel was deactivated
+	// or the fiber interrupted)
+	template< typename OutputIterator >
+	std::size_t take_n( OutputIterator out, std::size_t max)
 	{
+		if ( 0 == max) return 0;
 		mutex::scoped_lock lk( head_mtx_);
 		bool empty = empty_();
 		if ( ! active_() && empty)
-			return false;
-		if ( empty)
-		{
-		try
-		{
-				while ( active_() && empty_() )
-                {
-					if ( ! not_empty_cond_.timed_wait( lk, abs_time) )
-                        return false;
-                }
-		}
-		catch ( fiber_interrupted const&)
-		{ return false; }
-		}
+			return 0;
+		if ( empty && ! wait_not_empty_( lk, 0) )
+			return 0;
 		if ( ! active_() && empty_() )
-			return false;
-		swap( va, head_->va);
-		pop_head_();
-		return va;
+			return 0;
+		std::size_t n = pop_head_n_( out, max);
+		// put_n() notifies only one consumer - pass it on
+		if ( empty && ! empty_() )
+			not_empty_cond_.notify_one();
+		return n;
 	}
-#endif
+
+	// moves all items currently in the channel to out without
+	// waiting, returns the number of items taken
+	template< typename OutputIterator >
+	std::size_t drain( OutputIterator out)
+	{
+		mutex::scoped_lock lk( head_mtx_);
+		return pop_head_n_( out, static_cast< std::size_t >( -1) );
+	}
+
+	// returns false if abs_time has expired before an item became
+	// available (or the channel was deactivated, the fiber interrupted)
+	bool take_until( value_type & va, chrono::system_clock::time_point const& abs_time)
+	{ return take_( va, & abs_time); }
+
+	template< typename TimeDuration >
+	bool take_for( value_type & va, TimeDuration const& dt)
+	{ return take_until( va, chrono::system_clock::now() + dt); }
+
 	bool try_take( value_type & va)
 	{
 		mutex::scoped_lock lk( head_mtx_);
@@ -0,0 +1,61 @@
+//          Copyright Oliver Kowalke 2009.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_FIBERS_WAIT_GROUP_H
+#define BOOST_FIBERS_WAIT_GROUP_H
+
+#include <cstddef>
+
+#include <boost/config.hpp>
+#include <boost/utility.hpp>
+
+#include <boost/fiber/detail/config.hpp>
+#include <boost/fiber/detail/countdown.hpp>
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+# if defined(BOOST_MSVC)
+# pragma warning(push)
+# pragma warning(disable:4355 4251 4275)
+# endif
+
+namespace boost {
+namespace fibers {
+
+// reusable like sync.WaitGroup of Go: add() for the next round must not
+// be called before the fibers waiting for the previous round have
+// returned from wait() - done() reaching zero releases the fibers waiting
+// at that moment, a fiber calling wait() after an early add() might be
+// woken by that release while the counter of the next round is not zero
+class BOOST_FIBERS_DECL wait_group : private noncopyable
+{
+private:
+    detail::countdown               count_;
+
+public:
+    explicit wait_group( std::size_t count = 0);
+
+    void add( std::size_t n = 1);
+
+    void done();
+
+    void wait();
+
+    bool try_wait();
+};
+
+}}
+
+# if defined(BOOST_MSVC)
+# pragma warning(pop)
+# endif
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
+
+#endif // BOOST_FIBERS_WAIT_GROUP_H
@@ -0,0 +1,102 @@
+//          Copyright Oliver Kowalke 2009.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+// async() calls per second of a trivial function for each launch
+// policy, compared with a new fiber running a packaged_task per call -
+// batches of calls are issued before the futures are waited on
+
+#include <cstddef>
+#include <cstdlib>
+#include <iostream>
+
+#include <boost/chrono.hpp>
+#include <boost/scoped_array.hpp>
+
+#include <boost/fiber/all.hpp>
+
+struct trivial
+{
+    typedef int result_type;
+
+    int operator()() const
+    { return 1; }
+};
+
+// std::vector<> of the move-only unique_future needs rvalue references
+typedef boost::scoped_array< boost::fibers::unique_future< int > >  futures_t;
+
+double measure_fiber( int n, int batch)
+{
+    futures_t futures( new boost::fibers::unique_future< int >[batch]);
+
+    boost::chrono::high_resolution_clock::time_point start(
+        boost::chrono::high_resolution_clock::now() );
+    for ( int i = 0; i < n; i += batch)
+    {
+        for ( int j = 0; j < batch; ++j)
+        {
+            boost::fibers::packaged_task< int > pt( ( trivial() ) );
+            futures[j] = pt.get_future();
+            boost::fibers::fiber( boost::move( pt) ).detach();
+        }
+        for ( int j = 0; j < batch; ++j)
+            futures[j].get();
+    }
+    boost::chrono::duration< double > elapsed(
+        boost::chrono::high_resolution_clock::now() - start);
+    return n / elapsed.count();
+}
+
+double measure_async( boost::fibers::launch::policy policy, int n, int batch)
+{
+    futures_t futures( new boost::fibers::unique_future< int >[batch]);
+
+    boost::chrono::high_resolution_clock::time_point start(
+        boost::chrono::high_resolution_clock::now() );
+    for ( int i = 0; i < n; i += batch)
+    {
+        for ( int j = 0; j < batch; ++j)
+            futures[j] = boost::fibers::async( policy, trivial() );
+        for ( int j = 0; j < batch; ++j)
+            futures[j].get();
+    }
+    boost::chrono::duration< double > elapsed(
+        boost::chrono::high_resolution_clock::now() - start);
+    return n / elapsed.count();
+}
+
+int main()
+{
+    try
+    {
+        boost::fibers::round_robin ds;
+        boost::fibers::scheduling_algorithm( & ds);
+
+        int n = 100000, batch = 100;
+        std::cout << "new fiber per call:   "
+                  << static_cast< long >( measure_fiber( n, batch) ) << " per second" << std::endl;
+        std::cout << "launch::post:         "
+                  << static_cast< long >( measure_async( boost::fibers::launch::post, n, batch) )
+                  << " per second" << std::endl;
+        std::cout << "launch::dispatch:     "
+                  << static_cast< long >( measure_async( boost::fibers::launch::dispatch, n, batch) )
+                  << " per second" << std::endl;
+        std::cout << "launch::deferred:     "
+                  << static_cast< long >( measure_async( boost::fibers::launch::deferred, n, batch) )
+                  << " per second" << std::endl;
+        std::cout << "launch::any_worker:   "
+                  << static_cast< long >( measure_async( boost::fibers::launch::any_worker, n, batch) )
+                  << " per second" << std::endl;
+
+        std::cout << "done." << std::endl;
+
+        return EXIT_SUCCESS;
+    }
+    catch ( std::exception const& e)
+    { std::cerr << "exception: " << e.what() << std::endl; }
+    catch (...)
+    { std::cerr << "unhandled exception" << std::endl; }
+    return EXIT_FAILURE;
+}
@@ -0,0 +1,89 @@
+//          Copyright Oliver Kowalke 2009.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+// measures the latency of one barrier round for
+// 1k - 100k fibers distributed over 1 - N threads
+// (each stack occupies two memory mappings - 100k fibers
+// require vm.max_map_count to be raised on Linux)
+
+#include <cstddef>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+#include <boost/bind.hpp>
+#include <boost/chrono.hpp>
+#include <boost/ref.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/thread.hpp>
+
+#include <boost/fiber/all.hpp>
+
+void worker_fn( boost::fibers::barrier & b, int rounds)
+{
+    for ( int i = 0; i < rounds; ++i)
+        b.wait();
+}
+
+void thread_fn( boost::fibers::barrier * b, int fibers, int rounds)
+{
+    boost::fibers::round_robin ds;
+    boost::fibers::scheduling_algorithm( & ds);
+
+    boost::fibers::attributes attr(
+        boost::fibers::stack_allocator::minimum_stacksize() );
+    std::vector< boost::shared_ptr< boost::fibers::fiber > > v;
+    v.reserve( fibers);
+    for ( int i = 0; i < fibers; ++i)
+        v.push_back(
+            boost::shared_ptr< boost::fibers::fiber >(
+                new boost::fibers::fiber(
+                    boost::bind( worker_fn, boost::ref( * b), rounds), attr) ) );
+    for ( int i = 0; i < fibers; ++i)
+        v[i]->join();
+}
+
+void run( int fibers, int threads, int rounds)
+{
+    boost::fibers::barrier b( fibers);
+    int per_thread = fibers / threads;
+
+    boost::chrono::high_resolution_clock::time_point start(
+        boost::chrono::high_resolution_clock::now() );
+    boost::thread_group tg;
+    for ( int i = 0; i < threads; ++i)
+        tg.create_thread( boost::bind( thread_fn, & b, per_thread, rounds) );
+    tg.join_all();
+    boost::chrono::high_resolution_clock::duration elapsed(
+        boost::chrono::high_resolution_clock::now() - start);
+
+    std::cout << "fibers: " << fibers << ", threads: " << threads << ": "
+        << boost::chrono::duration_cast< boost::chrono::microseconds >( elapsed).count() / rounds
+        << " us per round" << std::endl;
+}
+
+int main( int argc, char * argv[])
+{
+    try
+    {
+        int rounds = 10;
+        int max_threads = static_cast< int >( boost::thread::hardware_concurrency() );
+        if ( 1 < argc) max_threads = std::atoi( argv[1]);
+        if ( max_threads < 1) max_threads = 1;
+
+        for ( int fibers = 1000; fibers <= 100000; fibers *= 10)
+            for ( int threads = 1; threads <= max_threads; threads *= 2)
+                run( fibers - fibers % threads, threads, rounds);
+
+        std::cout << "done." << std::endl;
+
+        return EXIT_SUCCESS;
+    }
+    catch ( std::exception const& e)
+    { std::cerr << "exception: " << e.what() << std::endl; }
+    catch (...)
+    { std::cerr << "unhandled exception" << std::endl; }
+    return EXIT_FAILURE;
+}
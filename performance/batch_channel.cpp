@@ -0,0 +1,112 @@
+//          Copyright Oliver Kowalke 2009.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+// messages/sec of put_n()/take_n() at batch sizes 1, 16 and 256
+// compared with put()/take() of single items
+
+#include <cstddef>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+#include <boost/bind.hpp>
+#include <boost/chrono.hpp>
+#include <boost/cstdint.hpp>
+#include <boost/ref.hpp>
+
+#include <boost/fiber/all.hpp>
+
+template< typename Channel >
+void producer_fn( Channel & ch, int n)
+{
+    for ( int i = 0; i < n; ++i)
+        ch.put( boost::uint64_t( i) );
+    ch.deactivate();
+}
+
+template< typename Channel >
+void consumer_fn( Channel & ch)
+{
+    typename Channel::value_type va;
+    while ( ch.take( va) );
+}
+
+template< typename Channel >
+void batch_producer_fn( Channel & ch, int n, std::size_t batch)
+{
+    std::vector< boost::uint64_t > vec( batch, 0);
+    for ( int i = 0; i < n; i += batch)
+        ch.put_n( vec.begin(), vec.end() );
+    ch.deactivate();
+}
+
+template< typename Channel >
+void batch_consumer_fn( Channel & ch, std::size_t batch)
+{
+    std::vector< boost::uint64_t > vec( batch, 0);
+    while ( 0 < ch.take_n( vec.begin(), batch) );
+}
+
+template< typename Channel >
+double measure( Channel & ch, int n, std::size_t batch)
+{
+    boost::chrono::high_resolution_clock::time_point start(
+        boost::chrono::high_resolution_clock::now() );
+    if ( 0 == batch)
+    {
+        boost::fibers::fiber c( boost::bind( consumer_fn< Channel >, boost::ref( ch) ) );
+        boost::fibers::fiber p( boost::bind( producer_fn< Channel >, boost::ref( ch), n) );
+        p.join();
+        c.join();
+    }
+    else
+    {
+        boost::fibers::fiber c( boost::bind( batch_consumer_fn< Channel >, boost::ref( ch), batch) );
+        boost::fibers::fiber p( boost::bind( batch_producer_fn< Channel >, boost::ref( ch), n, batch) );
+        p.join();
+        c.join();
+    }
+    boost::chrono::duration< double > elapsed(
+        boost::chrono::high_resolution_clock::now() - start);
+    return n / elapsed.count();
+}
+
+void run( int n)
+{
+    std::size_t batches[] = { 0, 1, 16, 256 };
+    for ( std::size_t i = 0; i < sizeof( batches) / sizeof( batches[0]); ++i)
+    {
+        boost::fibers::bounded_channel< boost::uint64_t > bounded( 1024);
+        boost::fibers::unbounded_channel< boost::uint64_t > unbounded;
+        if ( 0 == batches[i])
+            std::cout << "put()/take():" << std::endl;
+        else
+            std::cout << "put_n()/take_n(), batch " << batches[i] << ":" << std::endl;
+        std::cout << "  bounded_channel:   " << measure( bounded, n, batches[i]) << " msg/s" << std::endl;
+        std::cout << "  unbounded_channel: " << measure( unbounded, n, batches[i]) << " msg/s" << std::endl;
+    }
+}
+
+int main()
+{
+    try
+    {
+        boost::fibers::round_robin ds;
+        boost::fibers::scheduling_algorithm( & ds);
+
+        // deactivate() of unbounded_channel locks a fibers::mutex
+        boost::fibers::fiber f( boost::bind( run, 1024 * 1024) );
+        f.join();
+
+        std::cout << "done." << std::endl;
+
+        return EXIT_SUCCESS;
+    }
+    catch ( std::exception const& e)
+    { std::cerr << "exception: " << e.what() << std::endl; }
+    catch (...)
+    { std::cerr << "unhandled exception" << std::endl; }
+    return EXIT_FAILURE;
+}
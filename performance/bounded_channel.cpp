@@ -0,0 +1,311 @@
+//          Copyright Oliver Kowalke 2009.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+// messages/sec of fibers::bounded_channel compared with the previous
+// implementation which allocated a linked node for each message
+
+#include <cstddef>
+#include <cstdlib>
+#include <iostream>
+
+#include <boost/atomic.hpp>
+#include <boost/bind.hpp>
+#include <boost/chrono.hpp>
+#include <boost/cstdint.hpp>
+#include <boost/intrusive_ptr.hpp>
+#include <boost/optional.hpp>
+#include <boost/ref.hpp>
+
+#include <boost/fiber/all.hpp>
+
+namespace boost {
+namespace fibers {
+namespace linked {
+
+template< typename T >
+struct linked_channel_node
+{
+    typedef intrusive_ptr< linked_channel_node >   ptr;
+
+    std::size_t use_count;
+    T           va;
+    ptr         next;
+
+    linked_channel_node() :
+        use_count( 0),
+        va(),
+        next()
+    {}
+};
+
+template< typename T >
+void intrusive_ptr_add_ref( linked_channel_node< T > * p)
+{ ++p->use_count; }
+
+template< typename T >
+void intrusive_ptr_release( linked_channel_node< T > * p)
+{ if ( 0 == --p->use_count) delete p; }
+
+template< typename T >
+class linked_bounded_channel : private noncopyable
+{
+public:
+    typedef optional< T >   value_type;
+
+private:
+    typedef linked_channel_node< value_type >      node_type;
+
+    enum state
+    {
+        ACTIVE = 0,
+        DEACTIVE
+    };
+
+    atomic< state >             state_;
+    atomic< std::size_t >       count_;
+    typename node_type::ptr     head_;
+    mutable mutex               head_mtx_;
+    typename node_type::ptr     tail_;
+    mutable mutex               tail_mtx_;
+    condition                   not_empty_cond_;
+    condition                   not_full_cond_;
+    unsigned int                hwm_;
+    unsigned int                lwm_;
+
+    bool active_() const
+    { return ACTIVE == state_; }
+
+    void deactivate_()
+    { state_ = DEACTIVE; }
+
+    std::size_t size_() const
+    { return count_; }
+
+    bool empty_() const
+    { return head_ == get_tail_(); }
+
+    bool full_() const
+    { return size_() >= hwm_; }
+
+    typename node_type::ptr get_tail_() const
+    {
+        mutex::scoped_lock lk( tail_mtx_);
+        typename node_type::ptr tmp = tail_;
+        return tmp;
+    }
+
+    typename node_type::ptr pop_head_()
+    {
+        typename node_type::ptr old_head = head_;
+        head_ = old_head->next;
+        --count_;
+        return old_head;
+    }
+
+public:
+    linked_bounded_channel(
+            std::size_t hwm,
+            std::size_t lwm) :
+        state_( ACTIVE),
+        count_( 0),
+        head_( new node_type() ),
+        head_mtx_(),
+        tail_( head_),
+        tail_mtx_(),
+        not_empty_cond_(),
+        not_full_cond_(),
+        hwm_( hwm),
+        lwm_( lwm)
+    {
+        if ( hwm_ < lwm_)
+            boost::throw_exception(
+                invalid_argument(
+                    system::errc::invalid_argument,
+                    "boost fiber: high-watermark is less than low-watermark for bounded_channel") );
+    }
+
+    linked_bounded_channel( std::size_t wm) :
+        state_( ACTIVE),
+        count_( 0),
+        head_( new node_type() ),
+        head_mtx_(),
+        tail_( head_),
+        tail_mtx_(),
+        not_empty_cond_(),
+        not_full_cond_(),
+        hwm_( wm),
+        lwm_( wm)
+    {}
+
+    std::size_t upper_bound() const
+    { return hwm_; }
+
+    std::size_t lower_bound() const
+    { return lwm_; }
+
+    bool active() const
+    { return active_(); }
+
+    void deactivate()
+    {
+        mutex::scoped_lock head_lk( head_mtx_);
+        mutex::scoped_lock tail_lk( tail_mtx_);
+        deactivate_();
+        not_empty_cond_.notify_all();
+        not_full_cond_.notify_all();
+    }
+
+    bool empty() const
+    { return empty_(); }
+
+    void put( T const& t)
+    {
+        typename node_type::ptr new_node( new node_type() );
+        {
+            mutex::scoped_lock lk( tail_mtx_);
+
+            if ( full_() )
+            {
+                while ( active_() && full_() )
+                    not_full_cond_.wait( lk);
+            }
+
+            if ( ! active_() )
+                boost::throw_exception( fiber_resource_error() );
+
+            tail_->va = t;
+            tail_->next = new_node;
+            tail_ = new_node;
+            ++count_;
+        }
+        not_empty_cond_.notify_one();
+    }
+    bool take( value_type & va)
+    {
+        mutex::scoped_lock lk( head_mtx_);
+        bool empty = empty_();
+        if ( ! active_() && empty)
+            return false;
+        if ( empty)
+        {
+            try
+            {
+                while ( active_() && empty_() )
+                    not_empty_cond_.wait( lk);
+            }
+            catch ( fiber_interrupted const&)
+            { return false; }
+        }
+        if ( ! active_() && empty_() )
+            return false;
+        swap( va, head_->va);
+        pop_head_();
+        if ( size_() <= lwm_)
+        {
+            if ( lwm_ == hwm_)
+                not_full_cond_.notify_one();
+            else
+                // more than one producer could be waiting
+                // for submiting an action object
+                not_full_cond_.notify_all();
+        }
+        return va;
+    }
+    bool try_take( value_type & va)
+    {
+        mutex::scoped_lock lk( head_mtx_);
+        if ( empty_() )
+            return false;
+        swap( va, head_->va);
+        pop_head_();
+        bool valid = va;
+        if ( valid && size_() <= lwm_)
+        {
+            if ( lwm_ == hwm_)
+                not_full_cond_.notify_one();
+            else
+                // more than one producer could be waiting
+                // in order to submit an task
+                not_full_cond_.notify_all();
+        }
+        return valid;
+    }
+};
+
+}}}
+
+struct payload_8
+{ boost::uint64_t data; };
+
+struct payload_256
+{ char data[256]; };
+
+template< typename Channel, typename Payload >
+void producer_fn( Channel & ch, int n)
+{
+    Payload p = Payload();
+    for ( int i = 0; i < n; ++i)
+        ch.put( p);
+    ch.deactivate();
+}
+
+template< typename Channel >
+void consumer_fn( Channel & ch)
+{
+    typename Channel::value_type va;
+    while ( ch.take( va) );
+}
+
+template< typename Channel, typename Payload >
+double measure( std::size_t capacity, int n)
+{
+    boost::fibers::round_robin ds;
+    boost::fibers::scheduling_algorithm( & ds);
+
+    Channel ch( capacity);
+    boost::chrono::high_resolution_clock::time_point start(
+        boost::chrono::high_resolution_clock::now() );
+    boost::fibers::fiber c( boost::bind( consumer_fn< Channel >, boost::ref( ch) ) );
+    boost::fibers::fiber p( boost::bind( producer_fn< Channel, Payload >, boost::ref( ch), n) );
+    p.join();
+    c.join();
+    boost::chrono::duration< double > elapsed(
+        boost::chrono::high_resolution_clock::now() - start);
+    return n / elapsed.count();
+}
+
+template< typename Payload >
+void run( char const* name, std::size_t capacity, int n)
+{
+    std::cout << name << ", capacity " << capacity << ":" << std::endl;
+    std::cout << "  ring-buffer:  "
+        << measure< boost::fibers::bounded_channel< Payload >, Payload >( capacity, n)
+        << " msg/s" << std::endl;
+    std::cout << "  linked nodes: "
+        << measure< boost::fibers::linked::linked_bounded_channel< Payload >, Payload >( capacity, n)
+        << " msg/s" << std::endl;
+}
+
+int main()
+{
+    try
+    {
+        int n = 1000000;
+
+        run< payload_8 >( "8 byte payload", 1024, n);
+        run< payload_256 >( "256 byte payload", 1024, n);
+        run< payload_8 >( "8 byte payload", 16, n);
+        run< payload_256 >( "256 byte payload", 16, n);
+
+        std::cout << "done." << std::endl;
+
+        return EXIT_SUCCESS;
+    }
+    catch ( std::exception const& e)
+    { std::cerr << "exception: " << e.what() << std::endl; }
+    catch (...)
+    { std::cerr << "unhandled exception" << std::endl; }
+    return EXIT_FAILURE;
+}
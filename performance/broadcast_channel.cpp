@@ -0,0 +1,147 @@
+//          Copyright Oliver Kowalke 2009.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+// fan-out cost per subscriber of fibers::broadcast_channel compared
+// with one unbounded_channel per subscriber, publisher and subscribers
+// running as fibers in one thread
+
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+#include <boost/bind.hpp>
+#include <boost/chrono.hpp>
+#include <boost/ref.hpp>
+#include <boost/shared_ptr.hpp>
+
+#include <boost/fiber/all.hpp>
+
+// market data update
+struct quote
+{
+    char    data[256];
+
+    quote()
+    { std::memset( data, 0, sizeof( data) ); }
+};
+
+typedef boost::fibers::broadcast_channel< quote >   broadcast_t;
+typedef boost::fibers::unbounded_channel< quote >   unbounded_t;
+
+void broadcast_publisher_fn( broadcast_t & ch, int n)
+{
+    quote q;
+    for ( int i = 0; i < n; ++i)
+        ch.put( q);
+    ch.deactivate();
+}
+
+void broadcast_subscriber_fn( broadcast_t::subscriber & sub)
+{
+    broadcast_t::value_type va;
+    while ( sub.take( va) );
+}
+
+void unbounded_publisher_fn( std::vector< boost::shared_ptr< unbounded_t > > & chs, int n)
+{
+    quote q;
+    for ( int i = 0; i < n; ++i)
+        for ( std::size_t j = 0; j < chs.size(); ++j)
+            chs[j]->put( q);
+    for ( std::size_t j = 0; j < chs.size(); ++j)
+        chs[j]->deactivate();
+}
+
+void unbounded_subscriber_fn( unbounded_t & ch)
+{
+    unbounded_t::value_type va;
+    while ( ch.take( va) );
+}
+
+typedef boost::shared_ptr< boost::fibers::fiber >   fiber_ptr;
+
+double measure_broadcast( int subscribers, int n)
+{
+    broadcast_t ch( 1024, boost::fibers::block_publisher);
+    std::vector< boost::shared_ptr< broadcast_t::subscriber > > subs;
+    std::vector< fiber_ptr > fibers;
+
+    boost::chrono::high_resolution_clock::time_point start(
+        boost::chrono::high_resolution_clock::now() );
+    for ( int i = 0; i < subscribers; ++i)
+    {
+        subs.push_back( boost::shared_ptr< broadcast_t::subscriber >(
+            new broadcast_t::subscriber( ch) ) );
+        fibers.push_back( fiber_ptr( new boost::fibers::fiber(
+            boost::bind( broadcast_subscriber_fn, boost::ref( * subs.back() ) ) ) ) );
+    }
+    boost::fibers::fiber p( boost::bind( broadcast_publisher_fn, boost::ref( ch), n) );
+    p.join();
+    for ( std::size_t i = 0; i < fibers.size(); ++i)
+        fibers[i]->join();
+    boost::chrono::duration< double, boost::nano > elapsed(
+        boost::chrono::high_resolution_clock::now() - start);
+    return elapsed.count() / ( double( n) * subscribers);
+}
+
+double measure_unbounded( int subscribers, int n)
+{
+    std::vector< boost::shared_ptr< unbounded_t > > chs;
+    std::vector< fiber_ptr > fibers;
+
+    boost::chrono::high_resolution_clock::time_point start(
+        boost::chrono::high_resolution_clock::now() );
+    for ( int i = 0; i < subscribers; ++i)
+    {
+        chs.push_back( boost::shared_ptr< unbounded_t >( new unbounded_t() ) );
+        fibers.push_back( fiber_ptr( new boost::fibers::fiber(
+            boost::bind( unbounded_subscriber_fn, boost::ref( * chs.back() ) ) ) ) );
+    }
+    boost::fibers::fiber p( boost::bind( unbounded_publisher_fn, boost::ref( chs), n) );
+    p.join();
+    for ( std::size_t i = 0; i < fibers.size(); ++i)
+        fibers[i]->join();
+    boost::chrono::duration< double, boost::nano > elapsed(
+        boost::chrono::high_resolution_clock::now() - start);
+    return elapsed.count() / ( double( n) * subscribers);
+}
+
+void run()
+{
+    int const subscribers[] = { 1, 10, 100, 500 };
+    for ( std::size_t i = 0; i < sizeof( subscribers) / sizeof( subscribers[0]); ++i)
+    {
+        int n = 200000 / subscribers[i];
+        std::cout << subscribers[i] << " subscribers:" << std::endl;
+        std::cout << "  broadcast_channel: " << measure_broadcast( subscribers[i], n)
+                  << " ns/message/subscriber" << std::endl;
+        std::cout << "  unbounded_channel: " << measure_unbounded( subscribers[i], n)
+                  << " ns/message/subscriber" << std::endl;
+    }
+}
+
+int main()
+{
+    try
+    {
+        boost::fibers::round_robin ds;
+        boost::fibers::scheduling_algorithm( & ds);
+
+        // deactivate() of unbounded_channel must be called in a fiber
+        boost::fibers::fiber f( run);
+        f.join();
+
+        std::cout << "done." << std::endl;
+
+        return EXIT_SUCCESS;
+    }
+    catch ( std::exception const& e)
+    { std::cerr << "exception: " << e.what() << std::endl; }
+    catch (...)
+    { std::cerr << "unhandled exception" << std::endl; }
+    return EXIT_FAILURE;
+}
@@ -0,0 +1,86 @@
+//          Copyright Oliver Kowalke 2009.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+// cost of the statistics policy of fibers::bounded_channel - a producer
+// and a consumer fiber passing items through a channel with and without
+// channel_statistics
+
+#include <cstddef>
+#include <cstdlib>
+#include <iostream>
+
+#include <boost/bind.hpp>
+#include <boost/chrono.hpp>
+#include <boost/cstdint.hpp>
+#include <boost/ref.hpp>
+
+#include <boost/fiber/all.hpp>
+
+template< typename Channel >
+void producer_fn( Channel & ch, int n)
+{
+    for ( int i = 0; i < n; ++i)
+        ch.put( boost::uint64_t( i) );
+    ch.deactivate();
+}
+
+template< typename Channel >
+void consumer_fn( Channel & ch)
+{
+    typename Channel::value_type va;
+    while ( ch.take( va) );
+}
+
+template< typename Channel >
+double measure( Channel & ch, int n)
+{
+    boost::chrono::high_resolution_clock::time_point start(
+        boost::chrono::high_resolution_clock::now() );
+    boost::fibers::fiber c( boost::bind( consumer_fn< Channel >, boost::ref( ch) ) );
+    boost::fibers::fiber p( boost::bind( producer_fn< Channel >, boost::ref( ch), n) );
+    p.join();
+    c.join();
+    boost::chrono::duration< double, boost::nano > elapsed(
+        boost::chrono::high_resolution_clock::now() - start);
+    return elapsed.count() / n;
+}
+
+int main()
+{
+    try
+    {
+        boost::fibers::round_robin ds;
+        boost::fibers::scheduling_algorithm( & ds);
+
+        typedef boost::fibers::bounded_channel< boost::uint64_t > plain_t;
+        typedef boost::fibers::bounded_channel<
+            boost::uint64_t, boost::fibers::channel_statistics
+        > stats_t;
+
+        int n = 1000000;
+        plain_t ch1( 64);
+        std::cout << "null_channel_statistics: " << measure( ch1, n)
+                  << " ns/item" << std::endl;
+        stats_t ch2( 64);
+        std::cout << "channel_statistics:      " << measure( ch2, n)
+                  << " ns/item" << std::endl;
+
+        boost::fibers::channel_statistics::snapshot s( ch2.statistics().get_snapshot() );
+        std::cout << "  puts " << s.puts << ", max depth " << s.max_depth
+                  << ", producer waits " << s.producers.count
+                  << " (" << s.producers.total.count() / 1000 << " us)"
+                  << ", consumer waits " << s.consumers.count
+                  << " (" << s.consumers.total.count() / 1000 << " us)" << std::endl;
+
+        std::cout << "done." << std::endl;
+
+        return EXIT_SUCCESS;
+    }
+    catch ( std::exception const& e)
+    { std::cerr << "exception: " << e.what() << std::endl; }
+    catch (...)
+    { std::cerr << "unhandled exception" << std::endl; }
+    return EXIT_FAILURE;
+}
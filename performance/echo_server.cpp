@@ -0,0 +1,188 @@
+//          Copyright Oliver Kowalke 2009.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+// loopback echo server with one fiber per connection, clients are fibers
+// of the same thread - each client sends a request of 64 bytes and waits
+// for the echo; reports requests per second and the latency percentiles
+//
+// both ends of a connection need a descriptor, the number of connections
+// is reduced if RLIMIT_NOFILE does not allow two descriptors per connection
+//
+// usage: echo_server [connections [requests per connection]]
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+
+#include <boost/bind.hpp>
+#include <boost/chrono.hpp>
+#include <boost/ref.hpp>
+
+#include <boost/fiber/all.hpp>
+
+namespace io = boost::fibers::io;
+
+typedef boost::chrono::high_resolution_clock    clock_type;
+
+const std::size_t request_size = 64;
+
+int connected = 0;
+int finished = 0;
+
+void echo_fn( int fd)
+{
+    char buf[request_size];
+    ssize_t n = 0;
+    while ( 0 < ( n = io::read( fd, buf, sizeof( buf) ) ) )
+        if ( n != io::write( fd, buf, n) ) break;
+    io::close( fd);
+}
+
+void server_fn( int listener, int connections, boost::fibers::attributes const& attr)
+{
+    for ( int i = 0; i < connections; ++i)
+    {
+        int fd = io::accept( listener, 0, 0);
+        if ( -1 == fd) break;
+        boost::fibers::fiber( boost::bind( echo_fn, fd), attr).detach();
+    }
+}
+
+void client_fn( sockaddr_in addr, int requests, boost::fibers::manual_reset_event & go,
+                std::vector< double > & latencies)
+{
+    int fd = io::socket( AF_INET, SOCK_STREAM, 0);
+    int one = 1;
+    ::setsockopt( fd, IPPROTO_TCP, TCP_NODELAY, & one, sizeof( one) );
+    if ( 0 != io::connect( fd, reinterpret_cast< sockaddr * >( & addr), sizeof( addr) ) )
+    {
+        std::cerr << "connect failed: " << std::strerror( errno) << std::endl;
+        std::exit( EXIT_FAILURE);
+    }
+    ++connected;
+    go.wait();
+
+    char buf[request_size];
+    std::memset( buf, 'x', sizeof( buf) );
+    for ( int i = 0; i < requests; ++i)
+    {
+        clock_type::time_point start( clock_type::now() );
+        io::write( fd, buf, sizeof( buf) );
+        std::size_t got = 0;
+        while ( got < sizeof( buf) )
+        {
+            ssize_t n = io::read( fd, buf + got, sizeof( buf) - got);
+            if ( 0 >= n) break;
+            got += n;
+        }
+        boost::chrono::duration< double, boost::micro > us( clock_type::now() - start);
+        latencies.push_back( us.count() );
+    }
+    io::close( fd);
+    ++finished;
+}
+
+int max_connections( int wanted)
+{
+    rlimit limit;
+    if ( 0 != ::getrlimit( RLIMIT_NOFILE, & limit) ) return wanted;
+    limit.rlim_cur = limit.rlim_max;
+    ::setrlimit( RLIMIT_NOFILE, & limit);
+    // listener, epoll and standard descriptors
+    int available = static_cast< int >( ( limit.rlim_cur - 64) / 2);
+    return std::min( wanted, available);
+}
+
+int main( int argc, char * argv[])
+{
+    try
+    {
+        int connections = 1 < argc ? std::atoi( argv[1]) : 10000;
+        int requests = 2 < argc ? std::atoi( argv[2]) : 10;
+        int allowed = max_connections( connections);
+        if ( allowed < connections)
+        {
+            std::cout << "RLIMIT_NOFILE allows " << allowed << " connections" << std::endl;
+            connections = allowed;
+        }
+
+        boost::fibers::round_robin ds;
+        boost::fibers::scheduling_algorithm( & ds);
+
+        sockaddr_in addr;
+        std::memset( & addr, 0, sizeof( addr) );
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl( INADDR_LOOPBACK);
+        socklen_t len = sizeof( addr);
+        int listener = io::socket( AF_INET, SOCK_STREAM, 0);
+        if ( -1 == listener ||
+             -1 == ::bind( listener, reinterpret_cast< sockaddr * >( & addr), len) ||
+             -1 == ::listen( listener, SOMAXCONN) ||
+             -1 == ::getsockname( listener, reinterpret_cast< sockaddr * >( & addr), & len) )
+        {
+            std::cerr << "listen failed: " << std::strerror( errno) << std::endl;
+            return EXIT_FAILURE;
+        }
+
+        boost::fibers::attributes attr(
+            boost::fibers::stack_allocator::minimum_stacksize() );
+        boost::fibers::fiber( boost::bind( server_fn, listener, connections, attr), attr).detach();
+
+        boost::fibers::manual_reset_event go;
+        std::vector< std::vector< double > > latencies( connections);
+        clock_type::time_point start( clock_type::now() );
+        for ( int i = 0; i < connections; ++i)
+        {
+            latencies[i].reserve( requests);
+            boost::fibers::fiber(
+                boost::bind( client_fn, addr, requests, boost::ref( go),
+                             boost::ref( latencies[i]) ), attr).detach();
+        }
+        while ( connected < connections) ds.run();
+        boost::chrono::duration< double, boost::milli > connect_ms( clock_type::now() - start);
+
+        start = clock_type::now();
+        go.set();
+        while ( finished < connections) ds.run();
+        boost::chrono::duration< double > elapsed( clock_type::now() - start);
+
+        std::vector< double > all;
+        all.reserve( connections * requests);
+        for ( int i = 0; i < connections; ++i)
+            all.insert( all.end(), latencies[i].begin(), latencies[i].end() );
+        std::sort( all.begin(), all.end() );
+
+        std::cout << connections << " connections established in "
+                  << connect_ms.count() << " ms" << std::endl;
+        std::cout << all.size() << " requests: "
+                  << static_cast< long >( all.size() / elapsed.count() ) << " per second" << std::endl;
+        if ( ! all.empty() )
+            std::cout << "latency p50: " << all[all.size() / 2] << " us, p99: "
+                      << all[all.size() * 99 / 100] << " us, max: "
+                      << all.back() << " us" << std::endl;
+
+        // the echo fibers see EOF
+        while ( ds.run() );
+        io::close( listener);
+
+        std::cout << "done." << std::endl;
+
+        return EXIT_SUCCESS;
+    }
+    catch ( std::exception const& e)
+    { std::cerr << "exception: " << e.what() << std::endl; }
+    catch (...)
+    { std::cerr << "unhandled exception" << std::endl; }
+    return EXIT_FAILURE;
+}
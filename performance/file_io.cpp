@@ -0,0 +1,114 @@
+//          Copyright Oliver Kowalke 2009.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+// fibers writing, syncing and reading back files of their own while a
+// ticker fiber yields in a loop - reports the throughput and the longest
+// time the ticker was not resumed, once with the io_uring of the scheduler
+// and once with the fallback (BOOST_FIBERS_IO_URING=0: blocking write()
+// and read(), fsync() in a worker thread)
+//
+// usage: file_io [fibers [blocks of 4 KiB per fiber]]
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+#include <unistd.h>
+
+#include <boost/bind.hpp>
+#include <boost/chrono.hpp>
+#include <boost/ref.hpp>
+
+#include <boost/fiber/all.hpp>
+
+namespace io = boost::fibers::io;
+
+typedef boost::chrono::high_resolution_clock    clock_type;
+
+const std::size_t block_size = 4096;
+
+int finished = 0;
+
+void file_fn( int blocks)
+{
+    char path[] = "/tmp/fiber_file_io_XXXXXX";
+    int fd = ::mkstemp( path);
+    if ( -1 == fd)
+    {
+        std::cerr << "mkstemp failed: " << std::strerror( errno) << std::endl;
+        std::exit( EXIT_FAILURE);
+    }
+    ::unlink( path);
+
+    std::vector< char > buf( block_size, 'x');
+    for ( int i = 0; i < blocks; ++i)
+        io::write( fd, & buf[0], buf.size() );
+    io::fsync( fd);
+    ::lseek( fd, 0, SEEK_SET);
+    while ( 0 < io::read( fd, & buf[0], buf.size() ) );
+    io::close( fd);
+    ++finished;
+}
+
+void ticker_fn( int files, double & max_us)
+{
+    clock_type::time_point last( clock_type::now() );
+    while ( finished < files)
+    {
+        boost::this_fiber::yield();
+        clock_type::time_point now( clock_type::now() );
+        boost::chrono::duration< double, boost::micro > us( now - last);
+        max_us = std::max( max_us, us.count() );
+        last = now;
+    }
+}
+
+void measure( char const* name, int files, int blocks)
+{
+    boost::fibers::round_robin ds;
+    boost::fibers::scheduling_algorithm( & ds);
+
+    finished = 0;
+    double max_us = 0;
+    clock_type::time_point start( clock_type::now() );
+    boost::fibers::fiber ticker( boost::bind( ticker_fn, files, boost::ref( max_us) ) );
+    for ( int i = 0; i < files; ++i)
+        boost::fibers::fiber( boost::bind( file_fn, blocks) ).detach();
+    ticker.join();
+    boost::chrono::duration< double > elapsed( clock_type::now() - start);
+    while ( ds.run() );
+
+    double mb = 2. * files * blocks * block_size / ( 1024 * 1024);
+    std::cout << name << ": " << static_cast< long >( mb / elapsed.count() )
+              << " MB/s written and read, ticker stalled at most "
+              << max_us << " us" << std::endl;
+
+    boost::fibers::scheduling_algorithm( 0);
+}
+
+int main( int argc, char * argv[])
+{
+    try
+    {
+        int files = 1 < argc ? std::atoi( argv[1]) : 64;
+        int blocks = 2 < argc ? std::atoi( argv[2]) : 256;
+
+        measure("io_uring", files, blocks);
+        ::setenv("BOOST_FIBERS_IO_URING", "0", 1);
+        measure("fallback", files, blocks);
+
+        std::cout << "done." << std::endl;
+
+        return EXIT_SUCCESS;
+    }
+    catch ( std::exception const& e)
+    { std::cerr << "exception: " << e.what() << std::endl; }
+    catch (...)
+    { std::cerr << "unhandled exception" << std::endl; }
+    return EXIT_FAILURE;
+}
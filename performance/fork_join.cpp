@@ -0,0 +1,90 @@
+//          Copyright Oliver Kowalke 2009.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+// compares waiting for n child fibers with fibers::wait_group
+// against joining the child fibers one by one
+
+#include <cstddef>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+#include <boost/bind.hpp>
+#include <boost/chrono.hpp>
+#include <boost/ref.hpp>
+#include <boost/shared_ptr.hpp>
+
+#include <boost/fiber/all.hpp>
+
+void child_fn()
+{ boost::this_fiber::yield(); }
+
+void child_done_fn( boost::fibers::wait_group & wg)
+{
+    boost::this_fiber::yield();
+    wg.done();
+}
+
+void join_fn( int n)
+{
+    boost::fibers::attributes attr(
+        boost::fibers::stack_allocator::minimum_stacksize() );
+    std::vector< boost::shared_ptr< boost::fibers::fiber > > v;
+    v.reserve( n);
+    for ( int i = 0; i < n; ++i)
+        v.push_back(
+            boost::shared_ptr< boost::fibers::fiber >(
+                new boost::fibers::fiber( child_fn, attr) ) );
+    for ( int i = 0; i < n; ++i)
+        v[i]->join();
+}
+
+void wait_group_fn( int n)
+{
+    boost::fibers::attributes attr(
+        boost::fibers::stack_allocator::minimum_stacksize() );
+    boost::fibers::wait_group wg( n);
+    for ( int i = 0; i < n; ++i)
+        boost::fibers::fiber(
+            boost::bind( child_done_fn, boost::ref( wg) ), attr).detach();
+    wg.wait();
+}
+
+boost::chrono::microseconds measure( void( * fn)( int), int n)
+{
+    boost::fibers::round_robin ds;
+    boost::fibers::scheduling_algorithm( & ds);
+
+    boost::chrono::high_resolution_clock::time_point start(
+        boost::chrono::high_resolution_clock::now() );
+    boost::fibers::fiber f( boost::bind( fn, n) );
+    f.join();
+    return boost::chrono::duration_cast< boost::chrono::microseconds >(
+        boost::chrono::high_resolution_clock::now() - start);
+}
+
+int main()
+{
+    try
+    {
+        for ( int n = 100; n <= 10000; n *= 10)
+        {
+            std::cout << "children: " << n << std::endl;
+            std::cout << "  join one by one: " << measure( join_fn, n).count()
+                << " us" << std::endl;
+            std::cout << "  wait_group:      " << measure( wait_group_fn, n).count()
+                << " us" << std::endl;
+        }
+
+        std::cout << "done." << std::endl;
+
+        return EXIT_SUCCESS;
+    }
+    catch ( std::exception const& e)
+    { std::cerr << "exception: " << e.what() << std::endl; }
+    catch (...)
+    { std::cerr << "unhandled exception" << std::endl; }
+    return EXIT_FAILURE;
+}
@@ -0,0 +1,90 @@
+//          Copyright Oliver Kowalke 2009.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+// compares get()/reset() of fibers::fiber_specific_ptr
+// with boost::thread_specific_ptr
+
+#include <cstdlib>
+#include <iostream>
+
+#include <boost/chrono.hpp>
+#include <boost/thread/tss.hpp>
+
+#include <boost/fiber/all.hpp>
+
+static const int iterations = 10000000;
+
+int values[2] = { 0, 1 };
+
+// values are not owned by the specific pointers
+void no_cleanup( int *)
+{}
+
+template< typename Ptr >
+void set_fn( Ptr & p)
+{
+    for ( int i = 0; i < iterations; ++i)
+        p.reset( & values[i & 1]);
+}
+
+template< typename Ptr >
+int get_fn( Ptr & p)
+{
+    int sum = 0;
+    for ( int i = 0; i < iterations; ++i)
+        sum += * p.get();
+    return sum;
+}
+
+template< typename Ptr >
+void measure( char const* name, Ptr & p)
+{
+    boost::chrono::high_resolution_clock::time_point start(
+        boost::chrono::high_resolution_clock::now() );
+    set_fn( p);
+    boost::chrono::nanoseconds set_ns(
+        boost::chrono::high_resolution_clock::now() - start);
+
+    start = boost::chrono::high_resolution_clock::now();
+    int sum = get_fn( p);
+    boost::chrono::nanoseconds get_ns(
+        boost::chrono::high_resolution_clock::now() - start);
+
+    std::cout << name << ": reset() " << set_ns.count() / double( iterations)
+        << " ns, get() " << get_ns.count() / double( iterations)
+        << " ns (" << sum << ")" << std::endl;
+}
+
+void fiber_fn()
+{
+    boost::fibers::fiber_specific_ptr< int > fss( no_cleanup);
+    measure( "fiber_specific_ptr ", fss);
+    fss.reset();
+
+    boost::thread_specific_ptr< int > tss( no_cleanup);
+    measure( "thread_specific_ptr", tss);
+    tss.reset();
+}
+
+int main()
+{
+    try
+    {
+        boost::fibers::round_robin ds;
+        boost::fibers::scheduling_algorithm( & ds);
+
+        boost::fibers::fiber f( fiber_fn);
+        f.join();
+
+        std::cout << "done." << std::endl;
+
+        return EXIT_SUCCESS;
+    }
+    catch ( std::exception const& e)
+    { std::cerr << "exception: " << e.what() << std::endl; }
+    catch (...)
+    { std::cerr << "unhandled exception" << std::endl; }
+    return EXIT_FAILURE;
+}
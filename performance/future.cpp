@@ -0,0 +1,167 @@
+//          Copyright Oliver Kowalke 2009.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+// promise/future round trips - a value set before get() (no waiting)
+// and a request/response exchange of two fibers blocking in get(),
+// gathering the results of many futures with when_all() and chains of
+// continuations attached with then()
+
+#include <cstddef>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+#include <boost/bind.hpp>
+#include <boost/chrono.hpp>
+#include <boost/ref.hpp>
+#include <boost/scoped_array.hpp>
+
+#include <boost/fiber/all.hpp>
+
+typedef boost::scoped_array< boost::fibers::promise< int > >   promises_t;
+
+void client_fn( promises_t & requests, promises_t & responses, int n)
+{
+    for ( int i = 0; i < n; ++i)
+    {
+        boost::fibers::unique_future< int > f( responses[i].get_future() );
+        requests[i].set_value( i);
+        f.get();
+    }
+}
+
+void server_fn( promises_t & requests, promises_t & responses, int n)
+{
+    for ( int i = 0; i < n; ++i)
+    {
+        boost::fibers::unique_future< int > f( requests[i].get_future() );
+        responses[i].set_value( f.get() + 1);
+    }
+}
+
+double measure_ready( int n)
+{
+    boost::chrono::high_resolution_clock::time_point start(
+        boost::chrono::high_resolution_clock::now() );
+    for ( int i = 0; i < n; ++i)
+    {
+        boost::fibers::promise< int > p;
+        boost::fibers::unique_future< int > f( p.get_future() );
+        p.set_value( i);
+        f.get();
+    }
+    boost::chrono::duration< double, boost::nano > elapsed(
+        boost::chrono::high_resolution_clock::now() - start);
+    return elapsed.count() / n;
+}
+
+double measure_round_trip( int n)
+{
+    promises_t requests( new boost::fibers::promise< int >[n]);
+    promises_t responses( new boost::fibers::promise< int >[n]);
+
+    boost::chrono::high_resolution_clock::time_point start(
+        boost::chrono::high_resolution_clock::now() );
+    boost::fibers::fiber s(
+        boost::bind( server_fn, boost::ref( requests), boost::ref( responses), n) );
+    boost::fibers::fiber c(
+        boost::bind( client_fn, boost::ref( requests), boost::ref( responses), n) );
+    c.join();
+    s.join();
+    boost::chrono::duration< double, boost::nano > elapsed(
+        boost::chrono::high_resolution_clock::now() - start);
+    return elapsed.count() / n;
+}
+
+#ifndef BOOST_NO_RVALUE_REFERENCES
+typedef boost::fibers::unique_future< int >     range_future_t;
+#else
+// a std::vector of the move-only unique_future needs rvalue references
+typedef boost::fibers::shared_future< int >     range_future_t;
+#endif
+
+double measure_when_all( int n, int fan_out)
+{
+    promises_t promises( new boost::fibers::promise< int >[fan_out]);
+    std::vector< range_future_t > futures( fan_out);
+
+    boost::chrono::high_resolution_clock::time_point start(
+        boost::chrono::high_resolution_clock::now() );
+    for ( int i = 0; i < n; ++i)
+    {
+        for ( int j = 0; j < fan_out; ++j)
+        {
+            boost::fibers::promise< int > p;
+            promises[j].swap( p);
+            futures[j] = range_future_t( promises[j].get_future() );
+        }
+        boost::fibers::unique_future< std::vector< boost::fibers::shared_future< int > > > f(
+            boost::fibers::when_all( futures.begin(), futures.end() ) );
+        for ( int j = 0; j < fan_out; ++j)
+            promises[j].set_value( j);
+        f.get();
+    }
+    boost::chrono::duration< double, boost::nano > elapsed(
+        boost::chrono::high_resolution_clock::now() - start);
+    return elapsed.count() / ( double( n) * fan_out);
+}
+
+int add_one( boost::fibers::unique_future< int > & f)
+{ return f.get() + 1; }
+
+template< typename Executor >
+double measure_then( Executor & ex, int n, int length)
+{
+    boost::chrono::high_resolution_clock::time_point start(
+        boost::chrono::high_resolution_clock::now() );
+    for ( int i = 0; i < n; ++i)
+    {
+        boost::fibers::promise< int > p;
+        boost::fibers::unique_future< int > f( p.get_future() );
+        for ( int j = 0; j < length; ++j)
+            f = f.then( ex, add_one);
+        p.set_value( 0);
+        f.get();
+    }
+    boost::chrono::duration< double, boost::nano > elapsed(
+        boost::chrono::high_resolution_clock::now() - start);
+    return elapsed.count() / ( double( n) * length);
+}
+
+int main()
+{
+    try
+    {
+        boost::fibers::round_robin ds;
+        boost::fibers::scheduling_algorithm( & ds);
+
+        int n = 200000;
+        double ready = measure_ready( n);
+        std::cout << "set_value() + get():   " << ready << " ns ("
+                  << static_cast< long >( 1e9 / ready) << " per second)" << std::endl;
+        double round_trip = measure_round_trip( n);
+        std::cout << "fiber round trip:      " << round_trip << " ns ("
+                  << static_cast< long >( 1e9 / round_trip) << " per second)" << std::endl;
+
+        std::cout << "when_all() of 1000:    " << measure_when_all( 200, 1000)
+                  << " ns per future" << std::endl;
+
+        boost::fibers::inline_executor inline_ex;
+        std::cout << "then() inline:         " << measure_then( inline_ex, 20000, 10)
+                  << " ns per continuation" << std::endl;
+        boost::fibers::fiber_executor fiber_ex;
+        std::cout << "then() new fiber:      " << measure_then( fiber_ex, 20000, 10)
+                  << " ns per continuation" << std::endl;
+
+        std::cout << "done." << std::endl;
+
+        return EXIT_SUCCESS;
+    }
+    catch ( std::exception const& e)
+    { std::cerr << "exception: " << e.what() << std::endl; }
+    catch (...)
+    { std::cerr << "unhandled exception" << std::endl; }
+    return EXIT_FAILURE;
+}
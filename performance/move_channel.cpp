@@ -0,0 +1,147 @@
+//          Copyright Oliver Kowalke 2009.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+// messages/sec of channels transporting std::string/std::vector
+// payloads - the producer creates a new payload for each message and
+// passes it by copy, by move or constructs it in the channel (C++03
+// builds measure only the copy)
+
+#include <cstddef>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <boost/bind.hpp>
+#include <boost/chrono.hpp>
+#include <boost/ref.hpp>
+
+#include <boost/fiber/all.hpp>
+
+enum mode
+{
+    by_copy = 0,
+#ifndef BOOST_NO_RVALUE_REFERENCES
+    by_move,
+# ifndef BOOST_NO_VARIADIC_TEMPLATES
+    by_emplace,
+# endif
+#endif
+    modes_end
+};
+
+template< typename Payload >
+struct payload_traits;
+
+template<>
+struct payload_traits< std::string >
+{ typedef char value_type; };
+
+template<>
+struct payload_traits< std::vector< char > >
+{ typedef char value_type; };
+
+template< typename Channel, typename Payload >
+void producer_fn( Channel & ch, int n, std::size_t size, mode m)
+{
+    for ( int i = 0; i < n; ++i)
+    {
+        switch ( m)
+        {
+        case by_copy:
+            {
+                Payload p( size, 'x');
+                ch.put( static_cast< Payload const& >( p) );
+            }
+            break;
+#ifndef BOOST_NO_RVALUE_REFERENCES
+        case by_move:
+            {
+                Payload p( size, 'x');
+                ch.put( std::move( p) );
+            }
+            break;
+# ifndef BOOST_NO_VARIADIC_TEMPLATES
+        case by_emplace:
+            ch.emplace( size, 'x');
+            break;
+# endif
+#endif
+        default:
+            break;
+        }
+    }
+    ch.deactivate();
+}
+
+template< typename Channel >
+void consumer_fn( Channel & ch)
+{
+    typename Channel::value_type va;
+    while ( ch.take( va) );
+}
+
+template< typename Channel, typename Payload >
+double measure( Channel & ch, int n, std::size_t size, mode m)
+{
+    boost::chrono::high_resolution_clock::time_point start(
+        boost::chrono::high_resolution_clock::now() );
+    boost::fibers::fiber c( boost::bind( consumer_fn< Channel >, boost::ref( ch) ) );
+    boost::fibers::fiber p( boost::bind( producer_fn< Channel, Payload >, boost::ref( ch), n, size, m) );
+    p.join();
+    c.join();
+    boost::chrono::duration< double > elapsed(
+        boost::chrono::high_resolution_clock::now() - start);
+    return n / elapsed.count();
+}
+
+template< typename Payload >
+void run( char const* name, int n, std::size_t size)
+{
+    char const* modes[] = { "copy:   ", "move:   ", "emplace:" };
+    std::cout << name << ", " << size << " byte:" << std::endl;
+    for ( int m = by_copy; m < modes_end; ++m)
+    {
+        boost::fibers::bounded_channel< Payload > bounded( 1024);
+        boost::fibers::unbounded_channel< Payload > unbounded;
+        std::cout << "  " << modes[m]
+            << " bounded_channel " << measure< boost::fibers::bounded_channel< Payload >, Payload >(
+                    bounded, n, size, static_cast< mode >( m) )
+            << " msg/s, unbounded_channel " << measure< boost::fibers::unbounded_channel< Payload >, Payload >(
+                    unbounded, n, size, static_cast< mode >( m) )
+            << " msg/s" << std::endl;
+    }
+}
+
+void run_all( int n)
+{
+    run< std::string >( "std::string", n, 256);
+    run< std::string >( "std::string", n, 4096);
+    run< std::vector< char > >( "std::vector< char >", n, 256);
+    run< std::vector< char > >( "std::vector< char >", n, 4096);
+}
+
+int main()
+{
+    try
+    {
+        boost::fibers::round_robin ds;
+        boost::fibers::scheduling_algorithm( & ds);
+
+        // deactivate() of unbounded_channel locks a fibers::mutex
+        boost::fibers::fiber f( boost::bind( run_all, 200000) );
+        f.join();
+
+        std::cout << "done." << std::endl;
+
+        return EXIT_SUCCESS;
+    }
+    catch ( std::exception const& e)
+    { std::cerr << "exception: " << e.what() << std::endl; }
+    catch (...)
+    { std::cerr << "unhandled exception" << std::endl; }
+    return EXIT_FAILURE;
+}
@@ -0,0 +1,109 @@
+//          Copyright Oliver Kowalke 2009.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+// messages/sec of fibers::mpmc_channel compared with the lock-based
+// channels for 1 - 32 producer and consumer threads, each running one fiber
+
+#include <cstddef>
+#include <cstdlib>
+#include <iostream>
+
+#include <boost/bind.hpp>
+#include <boost/chrono.hpp>
+#include <boost/cstdint.hpp>
+#include <boost/ref.hpp>
+#include <boost/thread.hpp>
+
+#include <boost/fiber/all.hpp>
+
+template< typename Channel >
+void producer_fn( Channel & ch, int n)
+{
+    for ( int i = 0; i < n; ++i)
+        ch.put( boost::uint64_t( i) );
+}
+
+template< typename Channel >
+void consumer_fn( Channel & ch)
+{
+    typename Channel::value_type va;
+    while ( ch.take( va) );
+}
+
+template< typename Channel >
+void thread_producer_fn( Channel * ch, int n)
+{
+    boost::fibers::round_robin ds;
+    boost::fibers::scheduling_algorithm( & ds);
+
+    boost::fibers::fiber p( boost::bind( producer_fn< Channel >, boost::ref( * ch), n) );
+    p.join();
+}
+
+template< typename Channel >
+void thread_consumer_fn( Channel * ch)
+{
+    boost::fibers::round_robin ds;
+    boost::fibers::scheduling_algorithm( & ds);
+
+    boost::fibers::fiber c( boost::bind( consumer_fn< Channel >, boost::ref( * ch) ) );
+    c.join();
+}
+
+template< typename Channel >
+double measure( Channel & ch, int threads, int n)
+{
+    boost::chrono::high_resolution_clock::time_point start(
+        boost::chrono::high_resolution_clock::now() );
+    boost::thread_group consumers;
+    for ( int i = 0; i < threads; ++i)
+        consumers.create_thread( boost::bind( thread_consumer_fn< Channel >, & ch) );
+    boost::thread_group producers;
+    for ( int i = 0; i < threads; ++i)
+        producers.create_thread( boost::bind( thread_producer_fn< Channel >, & ch, n / threads) );
+    producers.join_all();
+    ch.deactivate();
+    consumers.join_all();
+    boost::chrono::duration< double > elapsed(
+        boost::chrono::high_resolution_clock::now() - start);
+    return ( n / threads) * threads / elapsed.count();
+}
+
+void run( int n)
+{
+    for ( int threads = 1; threads <= 32; threads *= 2)
+    {
+        boost::fibers::mpmc_channel< boost::uint64_t > mpmc( 1024);
+        boost::fibers::bounded_channel< boost::uint64_t > bounded( 1024);
+        boost::fibers::unbounded_channel< boost::uint64_t > unbounded;
+        std::cout << threads << " producers / " << threads << " consumers:" << std::endl;
+        std::cout << "  mpmc_channel:      " << measure( mpmc, threads, n) << " msg/s" << std::endl;
+        std::cout << "  bounded_channel:   " << measure( bounded, threads, n) << " msg/s" << std::endl;
+        std::cout << "  unbounded_channel: " << measure( unbounded, threads, n) << " msg/s" << std::endl;
+    }
+}
+
+int main()
+{
+    try
+    {
+        // deactivate() is called from a fiber - unbounded_channel
+        // locks a fibers::mutex
+        boost::fibers::round_robin ds;
+        boost::fibers::scheduling_algorithm( & ds);
+
+        boost::fibers::fiber f( boost::bind( run, 100000) );
+        f.join();
+
+        std::cout << "done." << std::endl;
+
+        return EXIT_SUCCESS;
+    }
+    catch ( std::exception const& e)
+    { std::cerr << "exception: " << e.what() << std::endl; }
+    catch (...)
+    { std::cerr << "unhandled exception" << std::endl; }
+    return EXIT_FAILURE;
+}
@@ -0,0 +1,109 @@
+//          Copyright Oliver Kowalke 2009.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+// fibers calling a blocking function (a sleep of one millisecond) while
+// a ticker fiber yields in a loop - the function is called inline and by
+// this_fiber::offload(); reports the elapsed time, the longest time the
+// ticker was not resumed and the statistics of the offload pool
+//
+// usage: offload [fibers [calls per fiber [helper threads]]]
+
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+
+#include <boost/bind.hpp>
+#include <boost/chrono.hpp>
+#include <boost/ref.hpp>
+#include <boost/thread.hpp>
+
+#include <boost/fiber/all.hpp>
+
+typedef boost::chrono::high_resolution_clock    clock_type;
+
+int finished = 0;
+
+void blocking_fn()
+{ boost::this_thread::sleep_for( boost::chrono::milliseconds( 1) ); }
+
+void inline_fn( int calls)
+{
+    for ( int i = 0; i < calls; ++i)
+        blocking_fn();
+    ++finished;
+}
+
+void offload_fn( boost::fibers::offload_pool & pool, int calls)
+{
+    for ( int i = 0; i < calls; ++i)
+        boost::this_fiber::offload( pool, blocking_fn);
+    ++finished;
+}
+
+void ticker_fn( int fibers, double & max_us)
+{
+    clock_type::time_point last( clock_type::now() );
+    while ( finished < fibers)
+    {
+        boost::this_fiber::yield();
+        clock_type::time_point now( clock_type::now() );
+        boost::chrono::duration< double, boost::micro > us( now - last);
+        max_us = std::max( max_us, us.count() );
+        last = now;
+    }
+}
+
+template< typename Fn >
+void measure( char const* name, int fibers, Fn fn)
+{
+    boost::fibers::round_robin ds;
+    boost::fibers::scheduling_algorithm( & ds);
+
+    finished = 0;
+    double max_us = 0;
+    clock_type::time_point start( clock_type::now() );
+    boost::fibers::fiber ticker( boost::bind( ticker_fn, fibers, boost::ref( max_us) ) );
+    for ( int i = 0; i < fibers; ++i)
+        boost::fibers::fiber( fn).detach();
+    ticker.join();
+    boost::chrono::duration< double, boost::milli > elapsed( clock_type::now() - start);
+    while ( ds.run() );
+
+    std::cout << name << ": " << elapsed.count() << " ms, ticker stalled at most "
+              << max_us << " us" << std::endl;
+
+    boost::fibers::scheduling_algorithm( 0);
+}
+
+int main( int argc, char * argv[])
+{
+    try
+    {
+        int fibers = 1 < argc ? std::atoi( argv[1]) : 32;
+        int calls = 2 < argc ? std::atoi( argv[2]) : 20;
+        int threads = 3 < argc ? std::atoi( argv[3]) : 8;
+
+        measure("inline", fibers, boost::bind( inline_fn, calls) );
+
+        boost::fibers::offload_pool pool( threads);
+        measure("offload", fibers, boost::bind( offload_fn, boost::ref( pool), calls) );
+
+        boost::fibers::offload_pool::snapshot s = pool.statistics();
+        std::cout << "offload pool: " << s.threads << " threads, "
+                  << s.completed << " calls, max queue depth " << s.max_depth
+                  << ", max queue wait "
+                  << boost::chrono::duration_cast< boost::chrono::microseconds >( s.max_wait).count()
+                  << " us" << std::endl;
+
+        std::cout << "done." << std::endl;
+
+        return EXIT_SUCCESS;
+    }
+    catch ( std::exception const& e)
+    { std::cerr << "exception: " << e.what() << std::endl; }
+    catch (...)
+    { std::cerr << "unhandled exception" << std::endl; }
+    return EXIT_FAILURE;
+}
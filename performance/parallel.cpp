@@ -0,0 +1,100 @@
+//          Copyright Oliver Kowalke 2009.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+// a CPU-bound kernel applied to each element of an array - a serial
+// loop, fibers::parallel_for()/parallel_reduce() and (if compiled
+// with OpenMP) an OpenMP parallel loop
+
+#include <cmath>
+#include <cstddef>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+#include <boost/chrono.hpp>
+#include <boost/thread/thread.hpp>
+
+#include <boost/fiber/all.hpp>
+
+double kernel( int i)
+{
+    double x = i;
+    for ( int j = 0; j < 64; ++j)
+        x = std::sqrt( x + j) + std::sin( x);
+    return x;
+}
+
+struct apply
+{
+    std::vector< double >   *   out;
+
+    apply( std::vector< double > & out_) :
+        out( & out_)
+    {}
+
+    void operator()( int i) const
+    { ( * out)[i] = kernel( i); }
+};
+
+struct plus
+{
+    double operator()( double l, double r) const
+    { return l + r; }
+};
+
+typedef boost::chrono::high_resolution_clock    clock_type;
+
+double ms_since( clock_type::time_point start)
+{
+    return boost::chrono::duration< double, boost::milli >(
+        clock_type::now() - start).count();
+}
+
+int main()
+{
+    try
+    {
+        int n = 500000;
+        std::vector< double > out( n);
+
+        std::cout << "threads: " << boost::thread::hardware_concurrency() << std::endl;
+
+        clock_type::time_point start( clock_type::now() );
+        for ( int i = 0; i < n; ++i)
+            out[i] = kernel( i);
+        std::cout << "serial loop:        " << ms_since( start) << " ms" << std::endl;
+
+        // the first call creates the worker threads
+        boost::fibers::parallel_for( 0, 1000, 100, apply( out) );
+
+        for ( int grain = 100; grain <= 10000; grain *= 10)
+        {
+            start = clock_type::now();
+            boost::fibers::parallel_for( 0, n, grain, apply( out) );
+            std::cout << "parallel_for( " << grain << "):  " << ms_since( start) << " ms" << std::endl;
+        }
+
+        start = clock_type::now();
+        double sum = boost::fibers::parallel_reduce( 0, n, 1000, 0.0, kernel, plus() );
+        std::cout << "parallel_reduce:    " << ms_since( start) << " ms (" << sum << ")" << std::endl;
+
+#ifdef _OPENMP
+        start = clock_type::now();
+#pragma omp parallel for schedule(dynamic, 1000)
+        for ( int i = 0; i < n; ++i)
+            out[i] = kernel( i);
+        std::cout << "OpenMP:             " << ms_since( start) << " ms" << std::endl;
+#endif
+
+        std::cout << "done." << std::endl;
+
+        return EXIT_SUCCESS;
+    }
+    catch ( std::exception const& e)
+    { std::cerr << "exception: " << e.what() << std::endl; }
+    catch (...)
+    { std::cerr << "unhandled exception" << std::endl; }
+    return EXIT_FAILURE;
+}
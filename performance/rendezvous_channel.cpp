@@ -0,0 +1,88 @@
+//          Copyright Oliver Kowalke 2009.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+// request/response round trips of two fibers connected by a pair of
+// fibers::rendezvous_channel compared with a pair of unbounded_channel
+
+#include <cstddef>
+#include <cstdlib>
+#include <iostream>
+
+#include <boost/bind.hpp>
+#include <boost/chrono.hpp>
+#include <boost/cstdint.hpp>
+#include <boost/ref.hpp>
+
+#include <boost/fiber/all.hpp>
+
+template< typename Channel >
+void client_fn( Channel & requests, Channel & responses, int n)
+{
+    typename Channel::value_type va;
+    for ( int i = 0; i < n; ++i)
+    {
+        requests.put( boost::uint64_t( i) );
+        responses.take( va);
+    }
+    requests.deactivate();
+}
+
+template< typename Channel >
+void server_fn( Channel & requests, Channel & responses)
+{
+    typename Channel::value_type va;
+    while ( requests.take( va) )
+        responses.put( * va + 1);
+}
+
+template< typename Channel >
+double measure( int n)
+{
+    Channel requests, responses;
+
+    boost::chrono::high_resolution_clock::time_point start(
+        boost::chrono::high_resolution_clock::now() );
+    boost::fibers::fiber s(
+        boost::bind( server_fn< Channel >, boost::ref( requests), boost::ref( responses) ) );
+    boost::fibers::fiber c(
+        boost::bind( client_fn< Channel >, boost::ref( requests), boost::ref( responses), n) );
+    c.join();
+    s.join();
+    boost::chrono::duration< double, boost::nano > elapsed(
+        boost::chrono::high_resolution_clock::now() - start);
+    return elapsed.count() / n;
+}
+
+void run( int n)
+{
+    std::cout << "rendezvous_channel: "
+              << measure< boost::fibers::rendezvous_channel< boost::uint64_t > >( n)
+              << " ns/round trip" << std::endl;
+    std::cout << "unbounded_channel:  "
+              << measure< boost::fibers::unbounded_channel< boost::uint64_t > >( n)
+              << " ns/round trip" << std::endl;
+}
+
+int main()
+{
+    try
+    {
+        boost::fibers::round_robin ds;
+        boost::fibers::scheduling_algorithm( & ds);
+
+        // deactivate() of unbounded_channel must be called in a fiber
+        boost::fibers::fiber f( boost::bind( run, 200000) );
+        f.join();
+
+        std::cout << "done." << std::endl;
+
+        return EXIT_SUCCESS;
+    }
+    catch ( std::exception const& e)
+    { std::cerr << "exception: " << e.what() << std::endl; }
+    catch (...)
+    { std::cerr << "unhandled exception" << std::endl; }
+    return EXIT_FAILURE;
+}
@@ -0,0 +1,118 @@
+//          Copyright Oliver Kowalke 2009.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+// compares fibers::counting_semaphore with a semaphore emulated
+// by fibers::mutex + fibers::condition + counter
+
+#include <cstddef>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+#include <boost/bind.hpp>
+#include <boost/chrono.hpp>
+#include <boost/ref.hpp>
+#include <boost/shared_ptr.hpp>
+
+#include <boost/fiber/all.hpp>
+
+class emulated_semaphore
+{
+private:
+    boost::fibers::mutex        mtx_;
+    boost::fibers::condition    cond_;
+    std::size_t                 permits_;
+
+public:
+    explicit emulated_semaphore( std::size_t initial) :
+        mtx_(), cond_(), permits_( initial)
+    {}
+
+    void acquire()
+    {
+        boost::unique_lock< boost::fibers::mutex > lk( mtx_);
+        while ( 0 == permits_)
+            cond_.wait( lk);
+        --permits_;
+    }
+
+    void release()
+    {
+        boost::unique_lock< boost::fibers::mutex > lk( mtx_);
+        ++permits_;
+        lk.unlock();
+        cond_.notify_one();
+    }
+};
+
+template< typename Semaphore >
+void worker_fn( Semaphore & sem, int iterations)
+{
+    for ( int i = 0; i < iterations; ++i)
+    {
+        sem.acquire();
+        boost::this_fiber::yield();
+        sem.release();
+    }
+}
+
+template< typename Semaphore >
+boost::chrono::nanoseconds measure( std::size_t permits, int fibers, int iterations)
+{
+    boost::fibers::round_robin ds;
+    boost::fibers::scheduling_algorithm( & ds);
+
+    Semaphore sem( permits);
+    std::vector< boost::shared_ptr< boost::fibers::fiber > > v;
+
+    boost::chrono::high_resolution_clock::time_point start(
+        boost::chrono::high_resolution_clock::now() );
+    for ( int i = 0; i < fibers; ++i)
+        v.push_back(
+            boost::shared_ptr< boost::fibers::fiber >(
+                new boost::fibers::fiber(
+                    boost::bind( worker_fn< Semaphore >, boost::ref( sem), iterations) ) ) );
+    for ( int i = 0; i < fibers; ++i)
+        v[i]->join();
+    boost::chrono::high_resolution_clock::duration elapsed(
+        boost::chrono::high_resolution_clock::now() - start);
+
+    return boost::chrono::duration_cast< boost::chrono::nanoseconds >( elapsed)
+        / ( static_cast< long >( fibers) * iterations);
+}
+
+void run( std::size_t permits, int fibers, int iterations)
+{
+    std::cout << "permits: " << permits << ", fibers: " << fibers << std::endl;
+    std::cout << "  counting_semaphore:     "
+        << measure< boost::fibers::counting_semaphore >( permits, fibers, iterations).count()
+        << " ns per acquire/release" << std::endl;
+    std::cout << "  mutex/condition/counter: "
+        << measure< emulated_semaphore >( permits, fibers, iterations).count()
+        << " ns per acquire/release" << std::endl;
+}
+
+int main()
+{
+    try
+    {
+        int iterations = 10000;
+
+        // uncontended - enough permits for all fibers
+        run( 100, 100, iterations);
+        // contended - fibers block on the semaphore
+        run( 10, 100, iterations);
+        run( 1, 100, iterations);
+
+        std::cout << "done." << std::endl;
+
+        return EXIT_SUCCESS;
+    }
+    catch ( std::exception const& e)
+    { std::cerr << "exception: " << e.what() << std::endl; }
+    catch (...)
+    { std::cerr << "unhandled exception" << std::endl; }
+    return EXIT_FAILURE;
+}
@@ -0,0 +1,115 @@
+//          Copyright Oliver Kowalke 2009.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+// messages/sec of fibers::spsc_channel compared with the lock-based
+// channels, producer and consumer running in one or in two threads
+
+#include <cstddef>
+#include <cstdlib>
+#include <iostream>
+
+#include <boost/bind.hpp>
+#include <boost/chrono.hpp>
+#include <boost/cstdint.hpp>
+#include <boost/ref.hpp>
+#include <boost/thread.hpp>
+
+#include <boost/fiber/all.hpp>
+
+template< typename Channel >
+void producer_fn( Channel & ch, int n)
+{
+    for ( int i = 0; i < n; ++i)
+        ch.put( boost::uint64_t( i) );
+    ch.deactivate();
+}
+
+template< typename Channel >
+void consumer_fn( Channel & ch)
+{
+    typename Channel::value_type va;
+    while ( ch.take( va) );
+}
+
+template< typename Channel >
+void thread_producer_fn( Channel * ch, int n)
+{
+    boost::fibers::round_robin ds;
+    boost::fibers::scheduling_algorithm( & ds);
+
+    boost::fibers::fiber p( boost::bind( producer_fn< Channel >, boost::ref( * ch), n) );
+    p.join();
+}
+
+template< typename Channel >
+void thread_consumer_fn( Channel * ch)
+{
+    boost::fibers::round_robin ds;
+    boost::fibers::scheduling_algorithm( & ds);
+
+    boost::fibers::fiber c( boost::bind( consumer_fn< Channel >, boost::ref( * ch) ) );
+    c.join();
+}
+
+template< typename Channel >
+double measure_fibers( Channel & ch, int n)
+{
+    boost::fibers::round_robin ds;
+    boost::fibers::scheduling_algorithm( & ds);
+
+    boost::chrono::high_resolution_clock::time_point start(
+        boost::chrono::high_resolution_clock::now() );
+    boost::fibers::fiber c( boost::bind( consumer_fn< Channel >, boost::ref( ch) ) );
+    boost::fibers::fiber p( boost::bind( producer_fn< Channel >, boost::ref( ch), n) );
+    p.join();
+    c.join();
+    boost::chrono::duration< double > elapsed(
+        boost::chrono::high_resolution_clock::now() - start);
+    return n / elapsed.count();
+}
+
+template< typename Channel >
+double measure_threads( Channel & ch, int n)
+{
+    boost::chrono::high_resolution_clock::time_point start(
+        boost::chrono::high_resolution_clock::now() );
+    boost::thread c( boost::bind( thread_consumer_fn< Channel >, & ch) );
+    boost::thread p( boost::bind( thread_producer_fn< Channel >, & ch, n) );
+    p.join();
+    c.join();
+    boost::chrono::duration< double > elapsed(
+        boost::chrono::high_resolution_clock::now() - start);
+    return n / elapsed.count();
+}
+
+template< typename Channel >
+void run( char const* name, int n)
+{
+    Channel ch1( 1024);
+    Channel ch2( 1024);
+    std::cout << name << ":" << std::endl;
+    std::cout << "  one thread:  " << measure_fibers( ch1, n) << " msg/s" << std::endl;
+    std::cout << "  two threads: " << measure_threads( ch2, n) << " msg/s" << std::endl;
+}
+
+int main()
+{
+    try
+    {
+        int n = 1000000;
+
+        run< boost::fibers::spsc_channel< boost::uint64_t > >( "spsc_channel", n);
+        run< boost::fibers::bounded_channel< boost::uint64_t > >( "bounded_channel", n);
+
+        std::cout << "done." << std::endl;
+
+        return EXIT_SUCCESS;
+    }
+    catch ( std::exception const& e)
+    { std::cerr << "exception: " << e.what() << std::endl; }
+    catch (...)
+    { std::cerr << "unhandled exception" << std::endl; }
+    return EXIT_FAILURE;
+}
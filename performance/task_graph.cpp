@@ -0,0 +1,190 @@
+//          Copyright Oliver Kowalke 2009.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+// runs a layered DAG (100 nodes per layer, each node depends on three
+// nodes of the previous layer) with fibers::task_graph and with one fiber
+// per node waiting in shared_future::get() for its predecessors - reports
+// nodes per second and the peak memory of the process
+//
+// each parked fiber maps a stack plus a guard page, the fiber per node
+// variant is therefore limited by vm.max_map_count (about 32k fibers with
+// the default of 65530) and runs a smaller graph by default
+//
+// usage: task_graph [graph nodes [fiber per node nodes]]
+
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+#include <boost/bind.hpp>
+#include <boost/chrono.hpp>
+#include <boost/shared_ptr.hpp>
+
+#include <boost/fiber/all.hpp>
+
+#if defined(__linux__)
+#include <unistd.h>
+#endif
+
+typedef boost::chrono::high_resolution_clock    clock_type;
+
+const int width = 100;
+const int fan_in = 3;
+
+// virtual and resident size of the process in kB, sampled by the nodes
+struct memory
+{
+    long    vm;
+    long    rss;
+
+    memory() :
+        vm( 0), rss( 0)
+    {}
+};
+
+memory peak;
+
+void sample()
+{
+#if defined(__linux__)
+    std::FILE * f = std::fopen("/proc/self/statm", "r");
+    if ( ! f) return;
+    long vm = 0, rss = 0;
+    if ( 2 == std::fscanf( f, "%ld %ld", & vm, & rss) )
+    {
+        long kb = ::sysconf( _SC_PAGESIZE) / 1024;
+        if ( peak.vm < vm * kb) peak.vm = vm * kb;
+        if ( peak.rss < rss * kb) peak.rss = rss * kb;
+    }
+    std::fclose( f);
+#endif
+}
+
+void reset_peak()
+{
+    peak = memory();
+    sample();
+}
+
+int visited = 0;
+
+void node_fn()
+{
+    // sampling every node would dominate the run time
+    if ( 0 == ++visited % 1000) sample();
+}
+
+std::size_t predecessor( int n, int k)
+{ return n - width - n % width + ( n % width + k) % width; }
+
+double measure_graph( int n, double & build_ms)
+{
+    clock_type::time_point start( clock_type::now() );
+    boost::fibers::task_graph g;
+    for ( int i = 0; i < n; ++i)
+    {
+        boost::fibers::task_graph::node_id id = g.add( node_fn);
+        if ( width <= i)
+            for ( int k = 0; k < fan_in; ++k)
+                g.add_dependency( id, predecessor( i, k) );
+    }
+    boost::chrono::duration< double, boost::milli > built( clock_type::now() - start);
+    build_ms = built.count();
+
+    start = clock_type::now();
+    g.run();
+    boost::chrono::duration< double > elapsed( clock_type::now() - start);
+    return n / elapsed.count();
+}
+
+typedef boost::fibers::shared_future< void >    future_t;
+
+void future_node_fn( std::vector< future_t > * futures, future_t * start, int i,
+                     boost::shared_ptr< boost::fibers::promise< void > > p)
+{
+    if ( width <= i)
+        for ( int k = 0; k < fan_in; ++k)
+            ( * futures)[predecessor( i, k)].get();
+    else
+        start->get();
+    node_fn();
+    p->set_value();
+}
+
+double measure_futures( int n)
+{
+    std::vector< future_t > futures( n);
+    boost::fibers::promise< void > gate;
+    future_t start_future( gate.get_future() );
+
+    // all nodes are parked before the roots are released
+    clock_type::time_point start( clock_type::now() );
+    for ( int i = 0; i < n; ++i)
+    {
+        boost::shared_ptr< boost::fibers::promise< void > > p(
+            new boost::fibers::promise< void >() );
+        futures[i] = future_t( p->get_future() );
+        boost::fibers::fiber(
+            boost::bind( future_node_fn, & futures, & start_future, i, p) ).detach();
+    }
+    sample();
+    gate.set_value();
+    for ( int i = n - width; i < n; ++i)
+        futures[i].get();
+    boost::chrono::duration< double > elapsed( clock_type::now() - start);
+    return n / elapsed.count();
+}
+
+int main( int argc, char * argv[])
+{
+    try
+    {
+        boost::fibers::round_robin ds;
+        boost::fibers::scheduling_algorithm( & ds);
+
+        int graph_nodes = 1 < argc ? std::atoi( argv[1]) : 100000;
+        int future_nodes = 2 < argc ? std::atoi( argv[2]) : 20000;
+        graph_nodes -= graph_nodes % width;
+        future_nodes -= future_nodes % width;
+
+        reset_peak();
+        memory base( peak);
+        double build_ms = 0;
+        double rate = measure_graph( graph_nodes, build_ms);
+        std::cout << "task_graph, " << graph_nodes << " nodes: "
+                  << static_cast< long >( rate) << " nodes per second, built in "
+                  << build_ms << " ms" << std::endl
+                  << "  peak memory: +" << peak.vm - base.vm << " kB virtual, +"
+                  << peak.rss - base.rss << " kB resident ("
+                  << ( peak.vm - base.vm) * 1024.0 / graph_nodes << " bytes/node virtual)"
+                  << std::endl;
+
+        // return the pooled fibers
+        while ( ds.run() );
+
+        reset_peak();
+        base = peak;
+        rate = measure_futures( future_nodes);
+        std::cout << "fiber per node, " << future_nodes << " nodes: "
+                  << static_cast< long >( rate) << " nodes per second" << std::endl
+                  << "  peak memory: +" << peak.vm - base.vm << " kB virtual, +"
+                  << peak.rss - base.rss << " kB resident ("
+                  << ( peak.vm - base.vm) * 1024.0 / future_nodes << " bytes/node virtual)"
+                  << std::endl;
+
+        while ( ds.run() );
+
+        std::cout << "done." << std::endl;
+
+        return EXIT_SUCCESS;
+    }
+    catch ( std::exception const& e)
+    { std::cerr << "exception: " << e.what() << std::endl; }
+    catch (...)
+    { std::cerr << "unhandled exception" << std::endl; }
+    return EXIT_FAILURE;
+}
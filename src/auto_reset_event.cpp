@@ -0,0 +1,185 @@
+//          Copyright Oliver Kowalke 2009.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#define BOOST_FIBERS_SOURCE
+
+#include <boost/fiber/auto_reset_event.hpp>
+
+#include <algorithm>
+
+#include <boost/assert.hpp>
+#include <boost/thread/locks.hpp>
+
+#include <boost/fiber/detail/scheduler.hpp>
+#include <boost/fiber/interruption.hpp>
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+namespace boost {
+namespace fibers {
+
+auto_reset_event::auto_reset_event( bool isset) :
+    state_( isset ? SET : 0),
+    waiting_mtx_(),
+    waiting_()
+{}
+
+auto_reset_event::~auto_reset_event()
+{ BOOST_ASSERT( waiting_.empty() ); }
+
+void
+auto_reset_event::set()
+{
+    // fast path: no fiber is waiting, the signal is stored in state_
+    std::size_t expected = state_.load( memory_order_relaxed);
+    while ( expected < WAITER)
+    {
+        if ( state_.compare_exchange_weak(
+                expected, expected | SET,
+                memory_order_release, memory_order_relaxed) )
+            return;
+    }
+
+    // slow path: hand the signal over to the first waiting fiber
+    detail::notify::ptr_t n;
+
+    unique_lock< detail::spinlock > lk( waiting_mtx_);
+    expected = state_.load( memory_order_relaxed);
+    for (;;)
+    {
+        if ( expected < WAITER)
+        {
+            // all waiters have left in the meantime (interrupted)
+            if ( state_.compare_exchange_weak(
+                    expected, expected | SET,
+                    memory_order_release, memory_order_relaxed) )
+                break;
+        }
+        else if ( state_.compare_exchange_weak(
+                    expected, expected - WAITER,
+                    memory_order_release, memory_order_relaxed) )
+        {
+            BOOST_ASSERT( ! waiting_.empty() );
+            n.swap( waiting_.front() );
+            waiting_.pop_front();
+            break;
+        }
+    }
+    lk.unlock();
+
+    if ( n)
+        n->set_ready();
+}
+
+void
+auto_reset_event::wait()
+{
+    // fast path: consume a pending signal
+    if ( try_wait() ) return;
+
+    detail::notify::ptr_t n( detail::scheduler::instance().active() );
+    bool is_fiber = n ? true : false;
+    if ( ! is_fiber)
+        // notifier for main-fiber
+        n = detail::scheduler::instance().notifier();
+
+    // store this fiber in order to be notified later
+    unique_lock< detail::spinlock > lk( waiting_mtx_);
+    waiting_.push_back( n);
+
+    // a signal set in the meantime must be consumed instead
+    // of registering as waiter
+    std::size_t expected = state_.load( memory_order_relaxed);
+    for (;;)
+    {
+        if ( 0 != ( expected & SET) )
+        {
+            if ( state_.compare_exchange_weak(
+                    expected, expected - SET,
+                    memory_order_acquire, memory_order_relaxed) )
+            {
+                waiting_.pop_back();
+                return;
+            }
+        }
+        else if ( state_.compare_exchange_weak(
+                    expected, expected + WAITER,
+                    memory_order_relaxed, memory_order_relaxed) )
+            break;
+    }
+
+    try
+    {
+        if ( is_fiber)
+        {
+            for (;;)
+            {
+                // suspend this fiber
+                detail::scheduler::instance().wait( lk);
+
+                // check if fiber was interrupted
+                this_fiber::interruption_point();
+
+                if ( ! this_fiber::interruption_requested() ) break;
+
+                // woken up by an interruption request while interruptions
+                // are blocked - only a fiber removed from waiting_ got
+                // the signal handed over
+                lk.lock();
+                if ( waiting_.end() == std::find( waiting_.begin(), waiting_.end(), n) )
+                    break;
+            }
+        }
+        else
+        {
+            lk.unlock();
+            while ( ! n->is_ready() )
+                // run scheduler
+                detail::scheduler::instance().run();
+        }
+    }
+    catch (...)
+    {
+        // remove fiber from waiting_
+        if ( ! lk.owns_lock() ) lk.lock();
+        std::deque< detail::notify::ptr_t >::iterator i(
+            std::find( waiting_.begin(), waiting_.end(), n) );
+        if ( waiting_.end() != i)
+        {
+            waiting_.erase( i);
+            state_.fetch_sub( WAITER, memory_order_relaxed);
+        }
+        else
+        {
+            // set() has already handed the signal over to
+            // this fiber - pass it on
+            lk.unlock();
+            set();
+        }
+        throw;
+    }
+}
+
+bool
+auto_reset_event::try_wait()
+{
+    std::size_t expected = state_.load( memory_order_relaxed);
+    while ( 0 != ( expected & SET) )
+    {
+        if ( state_.compare_exchange_weak(
+                expected, expected - SET,
+                memory_order_acquire, memory_order_relaxed) )
+            return true;
+    }
+    return false;
+}
+
+}}
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
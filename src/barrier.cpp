@@ -8,10 +8,15 @@
 
 #include "boost/fiber/barrier.hpp"
 
+#include <algorithm>
+
+#include <boost/assert.hpp>
 #include <boost/exception/all.hpp>
+#include <boost/foreach.hpp>
+#include <boost/thread/locks.hpp>
 
+#include <boost/fiber/detail/scheduler.hpp>
 #include <boost/fiber/exceptions.hpp>
-#include <boost/fiber/operations.hpp>
 
 #ifdef BOOST_HAS_ABI_HEADERS
 #  include BOOST_ABI_PREFIX
@@ -23,9 +28,9 @@ namespace fibers {
 barrier::barrier( std::size_t initial) :
 	initial_( initial),
 	current_( initial_),
-	cycle_( true),
-	mtx_(),
-	cond_()
+    pad_(),
+	phase_( 0),
+    groups_()
 {
     if ( 0 == initial)
         boost::throw_exception(
@@ -34,25 +39,93 @@ barrier::barrier( std::size_t initial) :
                 "boost fiber: zero initial barrier count") );
 }
 
+barrier::~barrier()
+{
+    for ( std::size_t i = 0; i < GROUPS; ++i)
+    {
+        BOOST_ASSERT( groups_[i].waiting[0].empty() );
+        BOOST_ASSERT( groups_[i].waiting[1].empty() );
+    }
+}
+
+barrier::group &
+barrier::group_of_this_thread_()
+{
+    // each thread runs its own scheduler
+    std::size_t key = reinterpret_cast< std::size_t >(
+        & detail::scheduler::instance() );
+    return groups_[( key >> 6) % GROUPS];
+}
+
+void
+barrier::release_( std::size_t phase)
+{
+    // wake up the fibers of each group in one batch
+    std::vector< detail::notify::ptr_t > waiting;
+    for ( std::size_t i = 0; i < GROUPS; ++i)
+    {
+        unique_lock< detail::spinlock > lk( groups_[i].mtx);
+        waiting.swap( groups_[i].waiting[phase & 1]);
+        lk.unlock();
+
+        BOOST_FOREACH( detail::notify::ptr_t const& n, waiting)
+        { n->set_ready(); }
+        waiting.clear();
+    }
+}
+
 bool
 barrier::wait()
 {
-	mutex::scoped_lock lk( mtx_);
-	bool cycle( cycle_);
-	if ( 0 == --current_)
+    // phase_ can not advance before this fiber has arrived
+	std::size_t phase = phase_.load( memory_order_acquire);
+	if ( 1 == current_.fetch_sub( 1, memory_order_acq_rel) )
 	{
-		cycle_ = ! cycle_;
-		current_ = initial_;
-		cond_.notify_all();
+        // last fiber: reset the counter for the next phase
+        // before other fibers can arrive again
+		current_.store( initial_, memory_order_relaxed);
+        phase_.store( phase + 1, memory_order_release);
+        release_( phase);
 		return true;
 	}
-	else
-	{
-		while ( cycle == cycle_)
-            //FIXME: what happend if fiber is interrupted?
-            // ++current_ ?
-			cond_.wait( lk);
-	}
+
+    detail::notify::ptr_t n( detail::scheduler::instance().active() );
+    bool is_fiber = n ? true : false;
+    if ( ! is_fiber)
+        // notifier for main-fiber
+        n = detail::scheduler::instance().notifier();
+
+    group & g = group_of_this_thread_();
+    unique_lock< detail::spinlock > lk( g.mtx);
+    // phase was completed before this fiber got registered -
+    // the group has already been released
+    if ( phase != phase_.load( memory_order_acquire) ) return false;
+    std::vector< detail::notify::ptr_t > & waiting( g.waiting[phase & 1]);
+    waiting.push_back( n);
+
+    // barrier::wait() is not an interruption point
+    if ( is_fiber)
+    {
+        for (;;)
+        {
+            // suspend this fiber
+            detail::scheduler::instance().wait( lk);
+
+            // woken up by an interruption request if this fiber
+            // is still registered
+            lk.lock();
+            if ( waiting.end() == std::find( waiting.begin(), waiting.end(), n) )
+                break;
+        }
+    }
+    else
+    {
+        lk.unlock();
+        while ( ! n->is_ready() )
+            // run scheduler
+            detail::scheduler::instance().run();
+    }
+    atomic_thread_fence( memory_order_acquire);
 	return false;
 }
 
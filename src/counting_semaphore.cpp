@@ -0,0 +1,201 @@
+//          Copyright Oliver Kowalke 2009.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#define BOOST_FIBERS_SOURCE
+
+#include <boost/fiber/counting_semaphore.hpp>
+
+#include <algorithm>
+
+#include <boost/assert.hpp>
+#include <boost/thread/locks.hpp>
+
+#include <boost/fiber/detail/scheduler.hpp>
+#include <boost/fiber/interruption.hpp>
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+namespace boost {
+namespace fibers {
+
+counting_semaphore::counting_semaphore( std::size_t initial) :
+    permits_( initial),
+    waiters_( 0),
+    waiting_mtx_(),
+    waiting_()
+{}
+
+counting_semaphore::~counting_semaphore()
+{ BOOST_ASSERT( waiting_.empty() ); }
+
+void
+counting_semaphore::notify_( std::size_t n)
+{
+    // wake up at most n waiting fibers - each of them competes
+    // for a permit again
+    unique_lock< detail::spinlock > lk( waiting_mtx_);
+    for ( ; 0 < n && ! waiting_.empty(); --n)
+    {
+        waiting_.front()->set_ready();
+        waiting_.pop_front();
+        waiters_.fetch_sub( 1, memory_order_relaxed);
+    }
+}
+
+bool
+counting_semaphore::wait_( chrono::system_clock::time_point const& abs_time)
+{
+    bool timed = (chrono::system_clock::time_point::max)() != abs_time;
+    detail::notify::ptr_t n( detail::scheduler::instance().active() );
+    bool is_fiber = n ? true : false;
+    if ( ! is_fiber)
+        // notifier for main-fiber
+        n = detail::scheduler::instance().notifier();
+
+    unique_lock< detail::spinlock > lk( waiting_mtx_, defer_lock);
+    for (;;)
+    {
+        // store this fiber in order to be notified later
+        lk.lock();
+        waiting_.push_back( n);
+        waiters_.fetch_add( 1, memory_order_seq_cst);
+
+        // release() might have missed this fiber as waiter
+        if ( try_acquire() )
+        {
+            waiting_.pop_back();
+            waiters_.fetch_sub( 1, memory_order_relaxed);
+            return true;
+        }
+
+        bool expired = false;
+        try
+        {
+            if ( is_fiber)
+            {
+                // suspend this fiber
+                if ( timed)
+                    expired = ! detail::scheduler::instance().wait_until( lk, abs_time);
+                else
+                    detail::scheduler::instance().wait( lk);
+
+                // check if fiber was interrupted
+                this_fiber::interruption_point();
+            }
+            else
+            {
+                lk.unlock();
+                while ( ! n->is_ready() )
+                {
+                    if ( timed && chrono::system_clock::now() >= abs_time)
+                    {
+                        expired = true;
+                        break;
+                    }
+                    // run scheduler
+                    detail::scheduler::instance().run();
+                }
+            }
+        }
+        catch (...)
+        {
+            // remove fiber from waiting_
+            if ( ! lk.owns_lock() ) lk.lock();
+            std::deque< detail::notify::ptr_t >::iterator i(
+                std::find( waiting_.begin(), waiting_.end(), n) );
+            if ( waiting_.end() != i)
+            {
+                waiting_.erase( i);
+                waiters_.fetch_sub( 1, memory_order_relaxed);
+            }
+            else
+            {
+                // release() has already woken up this fiber -
+                // pass the notification on
+                lk.unlock();
+                if ( 0 < permits_.load() ) notify_( 1);
+            }
+            throw;
+        }
+
+        lk.lock();
+        std::deque< detail::notify::ptr_t >::iterator i(
+            std::find( waiting_.begin(), waiting_.end(), n) );
+        if ( waiting_.end() != i)
+        {
+            // deadline reached or woken up by an interruption
+            // request while interruptions are blocked
+            waiting_.erase( i);
+            waiters_.fetch_sub( 1, memory_order_relaxed);
+            lk.unlock();
+        }
+        else
+        {
+            lk.unlock();
+            // consume notification of main-fiber
+            if ( ! is_fiber) n->is_ready();
+
+            // woken up by release()
+            if ( try_acquire() ) return true;
+        }
+
+        if ( expired) return try_acquire();
+    }
+}
+
+void
+counting_semaphore::acquire()
+{
+    // fast path: take an available permit
+    if ( try_acquire() ) return;
+
+    wait_( (chrono::system_clock::time_point::max)() );
+}
+
+bool
+counting_semaphore::try_acquire()
+{
+    std::size_t expected = permits_.load();
+    while ( 0 < expected)
+    {
+        if ( permits_.compare_exchange_weak(
+                expected, expected - 1,
+                memory_order_acquire, memory_order_relaxed) )
+            return true;
+    }
+    return false;
+}
+
+bool
+counting_semaphore::try_acquire_until( chrono::system_clock::time_point const& abs_time)
+{
+    // fast path: take an available permit
+    if ( try_acquire() ) return true;
+
+    if ( chrono::system_clock::now() >= abs_time) return false;
+
+    return wait_( abs_time);
+}
+
+void
+counting_semaphore::release( std::size_t n)
+{
+    if ( 0 == n) return;
+
+    permits_.fetch_add( n, memory_order_seq_cst);
+
+    // fast path: no fiber is waiting for a permit
+    if ( 0 == waiters_.load( memory_order_seq_cst) ) return;
+
+    notify_( n);
+}
+
+}}
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
@@ -0,0 +1,99 @@
+//          Copyright Oliver Kowalke 2009.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#define BOOST_FIBERS_SOURCE
+
+#include <boost/fiber/detail/completion.hpp>
+
+#include <boost/thread/locks.hpp>
+#include <boost/thread/thread.hpp>
+
+#include <boost/fiber/detail/scheduler.hpp>
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+namespace boost {
+namespace fibers {
+namespace detail {
+
+completion::completion( bool done) :
+    mtx_(),
+    done_( done),
+    waiter_()
+{}
+
+void
+completion::reset()
+{
+    unique_lock< spinlock > lk( mtx_);
+    BOOST_ASSERT( ! waiter_);
+    done_ = false;
+}
+
+void
+completion::set()
+{
+    notify::ptr_t n;
+    {
+        unique_lock< spinlock > lk( mtx_);
+        done_ = true;
+        n.swap( waiter_);
+    }
+    if ( n) n->set_ready();
+}
+
+void
+completion::wait()
+{
+    unique_lock< spinlock > lk( mtx_);
+    if ( done_) return;
+
+    if ( ! scheduler::has_instance() )
+    {
+        // thread without scheduler
+        while ( ! done_)
+        {
+            lk.unlock();
+            this_thread::yield();
+            lk.lock();
+        }
+        return;
+    }
+
+    notify::ptr_t n( scheduler::instance().active() );
+    if ( n)
+    {
+        waiter_ = n;
+        while ( ! done_)
+        {
+            // suspend this fiber
+            scheduler::instance().wait( lk);
+            lk.lock();
+        }
+        return;
+    }
+
+    // notifier for main-fiber
+    n = scheduler::instance().notifier();
+    waiter_ = n;
+    while ( ! done_)
+    {
+        lk.unlock();
+        // set() swaps out waiter_ before n is made ready, a
+        // notification left by another primitive only repeats
+        // the check of done_
+        while ( ! n->is_ready() )
+            scheduler::instance().run();
+        lk.lock();
+    }
+}
+
+}}}
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
@@ -0,0 +1,148 @@
+//          Copyright Oliver Kowalke 2009.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#define BOOST_FIBERS_SOURCE
+
+#include <boost/fiber/detail/countdown.hpp>
+
+#include <algorithm>
+
+#include <boost/assert.hpp>
+#include <boost/foreach.hpp>
+#include <boost/thread/locks.hpp>
+
+#include <boost/fiber/detail/scheduler.hpp>
+#include <boost/fiber/interruption.hpp>
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+namespace boost {
+namespace fibers {
+namespace detail {
+
+countdown::countdown( std::size_t count) :
+    count_( count),
+    waiting_mtx_(),
+    waiting_()
+{}
+
+countdown::~countdown()
+{ BOOST_ASSERT( waiting_.empty() ); }
+
+void
+countdown::add( std::size_t n)
+{ count_.fetch_add( n, memory_order_relaxed); }
+
+void
+countdown::sub( std::size_t n)
+{
+    std::size_t count = count_.load( memory_order_relaxed);
+    for (;;)
+    {
+        BOOST_ASSERT( n <= count);
+        if ( n == count) break;
+        if ( count_.compare_exchange_weak( count, count - n, memory_order_acq_rel, memory_order_relaxed) )
+            return;
+    }
+
+    // the counter reaches zero under waiting_mtx_ - a fiber
+    // seeing zero in try_wait() acquires waiting_mtx_ before it
+    // returns and might destroy this object, the released
+    // fibers are notified without touching this object
+    std::deque< notify::ptr_t > waiting;
+    unique_lock< spinlock > lk( waiting_mtx_);
+    std::size_t previous = count_.fetch_sub( n, memory_order_acq_rel);
+    BOOST_ASSERT( n <= previous);
+    if ( n == previous)
+        waiting.swap( waiting_);
+    lk.unlock();
+
+    // release all waiting fibers
+    BOOST_FOREACH( notify::ptr_t const& f, waiting)
+    { f->set_ready(); }
+}
+
+void
+countdown::wait()
+{
+    // fast path: counter has already reached zero
+    if ( try_wait() ) return;
+
+    notify::ptr_t n( scheduler::instance().active() );
+    bool is_fiber = n ? true : false;
+    if ( ! is_fiber)
+        // notifier for main-fiber
+        n = scheduler::instance().notifier();
+
+    // store this fiber in order to be notified later
+    unique_lock< spinlock > lk( waiting_mtx_);
+    // counter reached zero in the meantime
+    if ( 0 == count_.load( memory_order_acquire) ) return;
+    waiting_.push_back( n);
+
+    try
+    {
+        if ( is_fiber)
+        {
+            for (;;)
+            {
+                // suspend this fiber
+                scheduler::instance().wait( lk);
+
+                // check if fiber was interrupted
+                this_fiber::interruption_point();
+
+                if ( ! this_fiber::interruption_requested() ) break;
+
+                // woken up by an interruption request while interruptions
+                // are blocked - sub() removes all fibers from waiting_
+                lk.lock();
+                if ( waiting_.end() == std::find( waiting_.begin(), waiting_.end(), n) )
+                    break;
+            }
+        }
+        else
+        {
+            lk.unlock();
+            // a notification left at the notifier of the main
+            // fiber by another primitive does not end the wait
+            do
+            {
+                while ( ! n->is_ready() )
+                    // run scheduler
+                    scheduler::instance().run();
+            }
+            while ( ! try_wait() );
+        }
+    }
+    catch (...)
+    {
+        // remove fiber from waiting_
+        if ( ! lk.owns_lock() ) lk.lock();
+        std::deque< notify::ptr_t >::iterator i(
+            std::find( waiting_.begin(), waiting_.end(), n) );
+        if ( waiting_.end() != i)
+            waiting_.erase( i);
+        throw;
+    }
+    atomic_thread_fence( memory_order_acquire);
+}
+
+bool
+countdown::try_wait()
+{
+    if ( 0 != count_.load( memory_order_acquire) ) return false;
+    // sub() might still hold waiting_mtx_
+    unique_lock< spinlock > lk( waiting_mtx_);
+    return true;
+}
+
+}}}
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
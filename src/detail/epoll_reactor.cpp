@@ -0,0 +1,138 @@
+//          Copyright Oliver Kowalke 2009.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#define BOOST_FIBERS_SOURCE
+
+#include <boost/fiber/detail/epoll_reactor.hpp>
+
+#include <cerrno>
+
+#include <sys/epoll.h>
+#include <unistd.h>
+
+#include <boost/assert.hpp>
+#include <boost/foreach.hpp>
+#include <boost/throw_exception.hpp>
+
+#include <boost/fiber/exceptions.hpp>
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+namespace boost {
+namespace fibers {
+namespace detail {
+
+namespace {
+
+// events returned by one epoll_wait() call
+const int max_events = 256;
+
+}
+
+epoll_reactor::epoll_reactor() :
+    epfd_( ::epoll_create1( EPOLL_CLOEXEC) ),
+    descriptors_(),
+    waiting_( 0)
+{
+    if ( -1 == epfd_)
+        boost::throw_exception(
+            fiber_resource_error(
+                errno,
+                "boost fiber: epoll_create1() failed") );
+}
+
+epoll_reactor::~epoll_reactor()
+{
+    BOOST_ASSERT( 0 == waiting_);
+    ::close( epfd_);
+}
+
+void
+epoll_reactor::add_waiter( int fd, io_op op, fiber_base::ptr_t const& f)
+{
+    BOOST_ASSERT( 0 <= fd);
+    BOOST_ASSERT( f);
+
+    if ( descriptors_.size() <= static_cast< std::size_t >( fd) )
+        descriptors_.resize( fd + 1);
+    descriptor & d = descriptors_[fd];
+    if ( ! d.registered)
+    {
+        ::epoll_event ev;
+        ev.events = EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET;
+        ev.data.fd = fd;
+        if ( -1 == ::epoll_ctl( epfd_, EPOLL_CTL_ADD, fd, & ev) )
+        {
+            // registered through a duplicate of fd
+            if ( EEXIST != errno ||
+                 -1 == ::epoll_ctl( epfd_, EPOLL_CTL_MOD, fd, & ev) )
+                boost::throw_exception(
+                    fiber_resource_error(
+                        errno,
+                        "boost fiber: epoll_ctl() failed") );
+        }
+        d.registered = true;
+    }
+    d.waiters[op].push_back( f);
+    ++waiting_;
+}
+
+std::size_t
+epoll_reactor::deregister( int fd, std::deque< fiber_base::ptr_t > & ready)
+{
+    if ( descriptors_.size() <= static_cast< std::size_t >( fd) ) return 0;
+    descriptor & d = descriptors_[fd];
+    if ( ! d.registered) return 0;
+    ::epoll_ctl( epfd_, EPOLL_CTL_DEL, fd, 0);
+    d.registered = false;
+    // fibers still waiting for fd would never be woken up,
+    // their next operation fails with EBADF
+    std::size_t size = ready.size();
+    wake_( d.waiters[io_read], ready);
+    wake_( d.waiters[io_write], ready);
+    return ready.size() - size;
+}
+
+void
+epoll_reactor::wake_( waiters_t & waiters, std::deque< fiber_base::ptr_t > & ready)
+{
+    BOOST_FOREACH( fiber_base::ptr_t const& f, waiters)
+    {
+        f->set_ready();
+        ready.push_back( f);
+    }
+    waiting_ -= waiters.size();
+    waiters.clear();
+}
+
+std::size_t
+epoll_reactor::poll( int timeout_ms, std::deque< fiber_base::ptr_t > & ready)
+{
+    ::epoll_event events[max_events];
+    int n = ::epoll_wait( epfd_, events, max_events, timeout_ms);
+    // EINTR - a signal was delivered
+    if ( 0 >= n) return 0;
+
+    std::size_t size = ready.size();
+    for ( int i = 0; i < n; ++i)
+    {
+        descriptor & d = descriptors_[events[i].data.fd];
+        // errors and hang-ups wake both directions, the
+        // fibers get the error from the next operation
+        if ( events[i].events & ( EPOLLIN | EPOLLRDHUP | EPOLLHUP | EPOLLERR) )
+            wake_( d.waiters[io_read], ready);
+        if ( events[i].events & ( EPOLLOUT | EPOLLHUP | EPOLLERR) )
+            wake_( d.waiters[io_write], ready);
+    }
+    return ready.size() - size;
+}
+
+}}}
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
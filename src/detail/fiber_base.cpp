@@ -30,8 +30,10 @@ fiber_base::fiber_base( context::fcontext_t * callee, bool preserve_fpu) :
     caller_(),
     callee_( callee),
     except_(),
+    tp_( (chrono::system_clock::time_point::max)() ),
     joining_mtx_(),
-    joining_()
+    joining_(),
+    fss_data_()
 { if ( preserve_fpu) flags_ |= flag_preserve_fpu; }
 
 fiber_base::~fiber_base()
@@ -72,6 +74,54 @@ fiber_base::release()
     joining_.clear();
 }
 
+void
+fiber_base::release_fss_data()
+{
+    // cleanup functions might store new values
+    while ( ! fss_data_.empty() )
+    {
+        std::vector< fss_data > data;
+        data.swap( fss_data_);
+        BOOST_FOREACH( fss_data & d, data)
+        { if ( d.vp) d.do_cleanup(); }
+    }
+}
+
+void
+fiber_base::set_fss_data(
+    fss_key const& key,
+    fss_cleanup_function::ptr_t const& cleanup_fn,
+    void * data,
+    bool cleanup_existing)
+{
+    if ( fss_data_.size() <= key.index)
+        fss_data_.resize( key.index + 1);
+
+    fss_data & d = fss_data_[key.index];
+    void * vp = d.vp;
+    fss_cleanup_function::ptr_t cleanup_previous;
+    if ( key.generation == d.generation)
+    {
+        if ( ! cleanup_existing) vp = 0;
+    }
+    else
+    {
+        // value stored by a previous owner of the slot
+        // (fiber_specific_ptr destroyed) is always cleaned up
+        cleanup_previous.swap( d.cleanup_function);
+        d.cleanup_function = cleanup_fn;
+        d.generation = key.generation;
+    }
+    d.vp = data;
+
+    // cleanup function might access the fss-slots
+    if ( vp)
+    {
+        if ( cleanup_previous) ( * cleanup_previous)( vp);
+        else ( * cleanup_fn)( vp);
+    }
+}
+
 bool
 fiber_base::join( ptr_t const& p)
 {
@@ -0,0 +1,98 @@
+//          Copyright Oliver Kowalke 2009.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#define BOOST_FIBERS_SOURCE
+
+#include <boost/fiber/detail/fiber_pool.hpp>
+
+#include <boost/bind.hpp>
+#include <boost/thread/tss.hpp>
+
+#include <boost/fiber/detail/fiber_object.hpp>
+#include <boost/fiber/fiber.hpp>
+#include <boost/fiber/operations.hpp>
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+namespace boost {
+namespace fibers {
+namespace detail {
+
+namespace {
+
+thread_specific_ptr< fiber_pool > pool_instance;
+
+}
+
+fiber_pool::fiber_pool() :
+    queue_(),
+    workers_( 0),
+    free_( 0)
+{}
+
+fiber_pool &
+fiber_pool::instance()
+{
+    fiber_pool * p = pool_instance.get();
+    if ( ! p)
+    {
+        p = new fiber_pool();
+        pool_instance.reset( p);
+    }
+    return * p;
+}
+
+void
+fiber_pool::spawn_()
+{
+    ++workers_;
+    ++free_;
+    fiber( bind( & fiber_pool::worker_, this) ).detach();
+}
+
+void
+fiber_pool::worker_()
+{
+    // a new fiber is resumed at construction -
+    // return to the posting context first
+    this_fiber::yield();
+
+    while ( ! queue_.empty() )
+    {
+        function< void() > fn;
+        fn.swap( queue_.front() );
+        queue_.pop_front();
+        --free_;
+        // keep a free worker for the queued functions
+        if ( ! queue_.empty() && 0 == free_)
+            spawn_();
+
+        try
+        { fn(); }
+        catch ( forced_unwind const&)
+        { throw; }
+        catch (...)
+        {}
+        ++free_;
+    }
+    --free_;
+    --workers_;
+}
+
+void
+fiber_pool::post( function< void() > const& fn)
+{
+    queue_.push_back( fn);
+    if ( 0 == free_)
+        spawn_();
+}
+
+}}}
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
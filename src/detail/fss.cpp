@@ -0,0 +1,61 @@
+//          Copyright Oliver Kowalke 2009.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#define BOOST_FIBERS_SOURCE
+
+#include <boost/fiber/detail/fss.hpp>
+
+#include <vector>
+
+#include <boost/thread/locks.hpp>
+
+#include <boost/fiber/detail/spinlock.hpp>
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+namespace boost {
+namespace fibers {
+namespace detail {
+
+namespace {
+
+// keys are allocated and freed only on construction and destruction
+// of fiber_specific_ptr - access to the slots does not touch the registry
+spinlock                    keys_mtx;
+std::size_t                 keys_next_index = 0;
+std::size_t                 keys_generation = 0;
+std::vector< std::size_t >  keys_free;
+
+}
+
+fss_key allocate_fss_key()
+{
+    unique_lock< spinlock > lk( keys_mtx);
+    fss_key key;
+    // generation 0 marks an unused slot
+    key.generation = ++keys_generation;
+    if ( keys_free.empty() )
+        key.index = keys_next_index++;
+    else
+    {
+        key.index = keys_free.back();
+        keys_free.pop_back();
+    }
+    return key;
+}
+
+void free_fss_key( fss_key const& key)
+{
+    unique_lock< spinlock > lk( keys_mtx);
+    keys_free.push_back( key.index);
+}
+
+}}}
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
@@ -0,0 +1,319 @@
+//          Copyright Oliver Kowalke 2009.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#define BOOST_FIBERS_SOURCE
+
+#include <boost/fiber/detail/io_uring.hpp>
+
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <boost/assert.hpp>
+#include <boost/cstdint.hpp>
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+namespace boost {
+namespace fibers {
+namespace detail {
+
+namespace {
+
+// submission queue entries, the completion queue is larger -
+// many requests might be in flight (one per waiting fiber)
+const unsigned sq_entries = 256;
+const unsigned cq_entries = 4096;
+
+int io_uring_setup( unsigned entries, io_uring_params * p)
+{ return static_cast< int >( ::syscall( __NR_io_uring_setup, entries, p) ); }
+
+int io_uring_enter( int fd, unsigned to_submit, unsigned min_complete, unsigned flags)
+{ return static_cast< int >( ::syscall( __NR_io_uring_enter, fd, to_submit, min_complete, flags, 0, 0) ); }
+
+int io_uring_register( int fd, unsigned opcode, void * arg, unsigned nr_args)
+{ return static_cast< int >( ::syscall( __NR_io_uring_register, fd, opcode, arg, nr_args) ); }
+
+// the rings are shared with the kernel
+unsigned load_acquire( unsigned const* p)
+{ return __atomic_load_n( p, __ATOMIC_ACQUIRE); }
+
+void store_release( unsigned * p, unsigned v)
+{ __atomic_store_n( p, v, __ATOMIC_RELEASE); }
+
+void * map( int fd, std::size_t size, off_t offset)
+{
+    void * p = ::mmap( 0, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, offset);
+    return MAP_FAILED == p ? 0 : p;
+}
+
+}
+
+io_uring_backend::io_uring_backend() :
+    fd_( -1),
+    sq_ring_( 0), sq_ring_size_( 0),
+    cq_ring_( 0), cq_ring_size_( 0),
+    sqes_( 0), sqes_size_( 0),
+    sq_head_( 0), sq_tail_( 0), sq_mask_( 0), sq_array_( 0), sq_flags_( 0),
+    cq_head_( 0), cq_tail_( 0), cq_mask_( 0), cqes_( 0),
+    pending_( 0),
+    inflight_( 0),
+    cancel_supported_( false),
+    fds_()
+{ std::memset( supported_, 0, sizeof( supported_) ); }
+
+io_uring_backend *
+io_uring_backend::create()
+{
+    char const* env = std::getenv("BOOST_FIBERS_IO_URING");
+    if ( env && 0 == std::strcmp( env, "0") ) return 0;
+
+    io_uring_backend * b = new io_uring_backend();
+    if ( b->setup_( sq_entries) ) return b;
+    delete b;
+    return 0;
+}
+
+bool
+io_uring_backend::setup_( unsigned entries)
+{
+    io_uring_params p;
+    std::memset( & p, 0, sizeof( p) );
+    p.flags = IORING_SETUP_CQSIZE;
+    p.cq_entries = cq_entries;
+    fd_ = io_uring_setup( entries, & p);
+    if ( -1 == fd_) return false;
+
+    // completions must not be dropped if the completion queue overflows,
+    // read/write at the current file position (linux 5.6)
+    if ( ! ( p.features & IORING_FEAT_NODROP) ||
+         ! ( p.features & IORING_FEAT_RW_CUR_POS) )
+        return false;
+
+    sq_ring_size_ = p.sq_off.array + p.sq_entries * sizeof( unsigned);
+    cq_ring_size_ = p.cq_off.cqes + p.cq_entries * sizeof( io_uring_cqe);
+    if ( p.features & IORING_FEAT_SINGLE_MMAP)
+    {
+        if ( sq_ring_size_ < cq_ring_size_) sq_ring_size_ = cq_ring_size_;
+        cq_ring_size_ = 0;
+    }
+    sq_ring_ = map( fd_, sq_ring_size_, IORING_OFF_SQ_RING);
+    if ( ! sq_ring_) return false;
+    if ( 0 == cq_ring_size_)
+        cq_ring_ = sq_ring_;
+    else if ( 0 == ( cq_ring_ = map( fd_, cq_ring_size_, IORING_OFF_CQ_RING) ) )
+        return false;
+    sqes_size_ = p.sq_entries * sizeof( io_uring_sqe);
+    sqes_ = map( fd_, sqes_size_, IORING_OFF_SQES);
+    if ( ! sqes_) return false;
+
+    char * sq = static_cast< char * >( sq_ring_);
+    char * cq = static_cast< char * >( cq_ring_);
+    sq_head_ = reinterpret_cast< unsigned * >( sq + p.sq_off.head);
+    sq_tail_ = reinterpret_cast< unsigned * >( sq + p.sq_off.tail);
+    sq_mask_ = * reinterpret_cast< unsigned * >( sq + p.sq_off.ring_mask);
+    sq_array_ = reinterpret_cast< unsigned * >( sq + p.sq_off.array);
+    sq_flags_ = reinterpret_cast< unsigned * >( sq + p.sq_off.flags);
+    cq_head_ = reinterpret_cast< unsigned * >( cq + p.cq_off.head);
+    cq_tail_ = reinterpret_cast< unsigned * >( cq + p.cq_off.tail);
+    cq_mask_ = * reinterpret_cast< unsigned * >( cq + p.cq_off.ring_mask);
+    cqes_ = cq + p.cq_off.cqes;
+
+    // operations supported by the kernel
+    std::vector< char > buf( sizeof( io_uring_probe) + 256 * sizeof( io_uring_probe_op), 0);
+    io_uring_probe * probe = reinterpret_cast< io_uring_probe * >( & buf[0]);
+    if ( 0 != io_uring_register( fd_, IORING_REGISTER_PROBE, probe, 256) ) return false;
+    static const int opcodes[io_request::opcode_size] = {
+        IORING_OP_READ, IORING_OP_WRITE, IORING_OP_FSYNC, IORING_OP_ACCEPT, IORING_OP_CONNECT };
+    for ( int i = 0; i < io_request::opcode_size; ++i)
+        supported_[i] = opcodes[i] <= probe->last_op &&
+            ( probe->ops[opcodes[i]].flags & IO_URING_OP_SUPPORTED);
+    cancel_supported_ = IORING_OP_ASYNC_CANCEL <= probe->last_op &&
+        ( probe->ops[IORING_OP_ASYNC_CANCEL].flags & IO_URING_OP_SUPPORTED);
+    return true;
+}
+
+io_uring_backend::~io_uring_backend()
+{
+    BOOST_ASSERT( 0 == inflight() );
+    if ( sqes_) ::munmap( sqes_, sqes_size_);
+    if ( cq_ring_ && cq_ring_ != sq_ring_) ::munmap( cq_ring_, cq_ring_size_);
+    if ( sq_ring_) ::munmap( sq_ring_, sq_ring_size_);
+    if ( -1 != fd_) ::close( fd_);
+}
+
+bool
+io_uring_backend::prepare( io_request & req)
+{
+    BOOST_ASSERT( supports( req.op) );
+    BOOST_ASSERT( req.fiber);
+
+    io_uring_sqe * sqe = static_cast< io_uring_sqe * >( next_sqe_() );
+    if ( ! sqe) return false;
+    sqe->fd = req.fd;
+    sqe->user_data = reinterpret_cast< boost::uintptr_t >( & req);
+    switch ( req.op)
+    {
+    case io_request::read:
+        sqe->opcode = IORING_OP_READ;
+        sqe->addr = reinterpret_cast< boost::uintptr_t >( req.buf);
+        sqe->len = static_cast< unsigned >( req.len);
+        // the current file position
+        sqe->off = static_cast< boost::uint64_t >( -1);
+        break;
+    case io_request::write:
+        sqe->opcode = IORING_OP_WRITE;
+        sqe->addr = reinterpret_cast< boost::uintptr_t >( req.buf);
+        sqe->len = static_cast< unsigned >( req.len);
+        sqe->off = static_cast< boost::uint64_t >( -1);
+        break;
+    case io_request::fsync:
+        sqe->opcode = IORING_OP_FSYNC;
+        break;
+    case io_request::accept:
+        sqe->opcode = IORING_OP_ACCEPT;
+        sqe->addr = reinterpret_cast< boost::uintptr_t >( req.buf);
+        sqe->addr2 = reinterpret_cast< boost::uintptr_t >( req.addrlen);
+        sqe->accept_flags = SOCK_NONBLOCK | SOCK_CLOEXEC;
+        break;
+    case io_request::connect:
+        sqe->opcode = IORING_OP_CONNECT;
+        sqe->addr = reinterpret_cast< boost::uintptr_t >( req.buf);
+        sqe->off = req.len;
+        break;
+    default:
+        BOOST_ASSERT_MSG( false, "invalid io_request");
+    }
+    link_( req);
+    return true;
+}
+
+void *
+io_uring_backend::next_sqe_()
+{
+    // the submission queue is full
+    if ( sq_mask_ < * sq_tail_ - load_acquire( sq_head_) )
+    {
+        submit();
+        if ( sq_mask_ < * sq_tail_ - load_acquire( sq_head_) ) return 0;
+    }
+
+    unsigned tail = * sq_tail_;
+    unsigned index = tail & sq_mask_;
+    io_uring_sqe * sqe = static_cast< io_uring_sqe * >( sqes_) + index;
+    std::memset( sqe, 0, sizeof( io_uring_sqe) );
+    // the kernel reads the entry in io_uring_enter() (no SQPOLL),
+    // the caller fills it before submit()
+    sq_array_[index] = index;
+    store_release( sq_tail_, tail + 1);
+    ++pending_;
+    return sqe;
+}
+
+void
+io_uring_backend::link_( io_request & req)
+{
+    BOOST_ASSERT( 0 <= req.fd);
+    std::size_t fd = static_cast< std::size_t >( req.fd);
+    if ( fds_.size() <= fd) fds_.resize( fd + 1, 0);
+    req.prev = 0;
+    req.next = fds_[fd];
+    if ( req.next) req.next->prev = & req;
+    fds_[fd] = & req;
+}
+
+void
+io_uring_backend::unlink_( io_request & req)
+{
+    if ( req.prev) req.prev->next = req.next;
+    else fds_[req.fd] = req.next;
+    if ( req.next) req.next->prev = req.prev;
+    req.prev = req.next = 0;
+}
+
+void
+io_uring_backend::submit()
+{
+    if ( 0 == pending_) return;
+    // EINTR, EAGAIN, EBUSY (completion backlog) - retried by the next call
+    int n = io_uring_enter( fd_, pending_, 0, 0);
+    if ( 0 >= n) return;
+    pending_ -= n;
+    inflight_ += n;
+}
+
+void
+io_uring_backend::cancel( int fd)
+{
+    if ( ! cancel_supported_ || 0 > fd ||
+         fds_.size() <= static_cast< std::size_t >( fd) )
+        return;
+
+    for ( io_request * req = fds_[fd]; req; req = req->next)
+    {
+        if ( req->cancelled) continue;
+        io_uring_sqe * sqe = static_cast< io_uring_sqe * >( next_sqe_() );
+        // the submission queue is full, the remaining
+        // requests are not cancelled
+        if ( ! sqe) break;
+        sqe->opcode = IORING_OP_ASYNC_CANCEL;
+        sqe->fd = -1;
+        sqe->addr = reinterpret_cast< boost::uintptr_t >( req);
+        // the completion of the cancel request is skipped by reap()
+        sqe->user_data = 0;
+        req->cancelled = true;
+    }
+    // the requests must be cancelled before the descriptor is closed
+    submit();
+}
+
+std::size_t
+io_uring_backend::reap( std::deque< fiber_base::ptr_t > & ready)
+{
+    std::size_t n = 0;
+    for (;;)
+    {
+        unsigned head = * cq_head_;
+        unsigned tail = load_acquire( cq_tail_);
+        for ( ; head != tail; ++head, ++n)
+        {
+            io_uring_cqe * cqe = static_cast< io_uring_cqe * >( cqes_) + ( head & cq_mask_);
+            io_request * req = reinterpret_cast< io_request * >( cqe->user_data);
+            if ( ! req) continue;
+            unlink_( * req);
+            // a request interrupted by io::close() fails as if the
+            // descriptor had been closed before
+            req->result = req->cancelled && ( -ECANCELED == cqe->res || -EINTR == cqe->res)
+                ? -EBADF : cqe->res;
+            fiber_base::ptr_t f;
+            f.swap( req->fiber);
+            f->set_ready();
+            ready.push_back( f);
+        }
+        store_release( cq_head_, head);
+
+        // completions kept by the kernel because the queue was full
+        // are flushed by entering with IORING_ENTER_GETEVENTS
+        if ( ! ( load_acquire( sq_flags_) & IORING_SQ_CQ_OVERFLOW) ) break;
+        io_uring_enter( fd_, 0, 0, IORING_ENTER_GETEVENTS);
+    }
+    inflight_ -= n;
+    return n;
+}
+
+}}}
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
@@ -28,14 +28,18 @@ __thread algorithm * scheduler::instance_ = 0;
 #endif
 
 algorithm &
-scheduler::instance()
+scheduler::instance() BOOST_NOEXCEPT
 {
     BOOST_ASSERT( instance_);
 	return * instance_;
 }
 
+bool
+scheduler::has_instance() BOOST_NOEXCEPT
+{ return instance_ ? true : false; }
+
 algorithm *
-scheduler::replace( algorithm * other)
+scheduler::replace( algorithm * other) BOOST_NOEXCEPT
 {
     algorithm * old = instance_;
     instance_ = other;
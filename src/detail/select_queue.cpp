@@ -0,0 +1,99 @@
+//          Copyright Oliver Kowalke 2009.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#define BOOST_FIBERS_SOURCE
+
+#include <boost/fiber/detail/select_queue.hpp>
+
+#include <algorithm>
+
+#include <boost/assert.hpp>
+#include <boost/foreach.hpp>
+#include <boost/thread/locks.hpp>
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+namespace boost {
+namespace fibers {
+namespace detail {
+
+notify::ptr_t
+select_waiter::fire()
+{
+    notify::ptr_t tmp;
+    unique_lock< spinlock > lk( mtx);
+    if ( ! fired)
+    {
+        fired = true;
+        tmp = n;
+    }
+    return tmp;
+}
+
+select_queue::select_queue() :
+    count_( 0),
+    mtx_(),
+    waiting_()
+{}
+
+select_queue::~select_queue()
+{ BOOST_ASSERT( waiting_.empty() ); }
+
+void
+select_queue::subscribe( select_waiter::ptr_t const& w)
+{
+    unique_lock< spinlock > lk( mtx_);
+    waiting_.push_back( w);
+    count_.store( waiting_.size(), memory_order_relaxed);
+    lk.unlock();
+    // the channel is checked by the selector after this
+    // store (see notify_all())
+    atomic_thread_fence( memory_order_seq_cst);
+}
+
+void
+select_queue::unsubscribe( select_waiter::ptr_t const& w)
+{
+    unique_lock< spinlock > lk( mtx_);
+    std::vector< select_waiter::ptr_t >::iterator i(
+        std::find( waiting_.begin(), waiting_.end(), w) );
+    if ( waiting_.end() != i)
+    {
+        // order of the waiters does not matter
+        std::swap( * i, waiting_.back() );
+        waiting_.pop_back();
+    }
+    count_.store( waiting_.size(), memory_order_relaxed);
+}
+
+void
+select_queue::notify_all()
+{
+    // pairs with the fence in subscribe() - either the selector
+    // sees the new channel state or this call sees the selector
+    atomic_thread_fence( memory_order_seq_cst);
+    if ( 0 == count_.load( memory_order_relaxed) ) return;
+
+    // waiters stay registered until the selector has resumed
+    std::vector< notify::ptr_t > ready;
+    unique_lock< spinlock > lk( mtx_);
+    BOOST_FOREACH( select_waiter::ptr_t const& w, waiting_)
+    {
+        notify::ptr_t n( w->fire() );
+        if ( n) ready.push_back( n);
+    }
+    lk.unlock();
+
+    BOOST_FOREACH( notify::ptr_t const& n, ready)
+    { n->set_ready(); }
+}
+
+}}}
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
@@ -0,0 +1,98 @@
+//          Copyright Oliver Kowalke 2009.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#define BOOST_FIBERS_SOURCE
+
+#include "boost/fiber/executor.hpp"
+
+#include <boost/date_time/posix_time/posix_time_types.hpp>
+#include <boost/foreach.hpp>
+#include <boost/thread/locks.hpp>
+
+#include <boost/fiber/algorithm.hpp>
+#include <boost/fiber/detail/fiber_pool.hpp>
+#include <boost/fiber/operations.hpp>
+#include <boost/fiber/round_robin.hpp>
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+namespace boost {
+namespace fibers {
+
+thread_executor::thread_executor() :
+    mtx_(),
+    cond_(),
+    queue_(),
+    stop_( false),
+    thrd_()
+{ thrd_ = boost::thread( boost::bind( & thread_executor::worker_, this) ); }
+
+thread_executor::~thread_executor()
+{
+    {
+        boost::unique_lock< boost::mutex > lk( mtx_);
+        stop_ = true;
+    }
+    cond_.notify_one();
+    thrd_.join();
+}
+
+void
+thread_executor::submit_( function< void() > const& fn)
+{
+    bool notify = false;
+    {
+        boost::unique_lock< boost::mutex > lk( mtx_);
+        // the worker blocks only on an empty queue
+        notify = queue_.empty();
+        queue_.push_back( fn);
+    }
+    if ( notify) cond_.notify_one();
+}
+
+void
+thread_executor::worker_()
+{
+    round_robin ds;
+    algorithm * old = scheduling_algorithm( & ds);
+    detail::fiber_pool & pool = detail::fiber_pool::instance();
+
+    queue_t fns;
+    for (;;)
+    {
+        {
+            boost::unique_lock< boost::mutex > lk( mtx_);
+            // block the thread only if no fiber is alive
+            while ( queue_.empty() && ! stop_ && pool.idle() )
+                cond_.wait( lk);
+            if ( queue_.empty() && stop_ && pool.idle() ) break;
+            fns.swap( queue_);
+        }
+
+        BOOST_FOREACH( function< void() > const& fn, fns)
+        { pool.post( fn); }
+        fns.clear();
+
+        // the fibers wait for other threads - a fiber made ready by
+        // another thread does not signal cond_, back off for at most
+        // one millisecond (a submit() wakes the worker earlier)
+        if ( ! ds.run() && ! pool.idle() )
+        {
+            boost::unique_lock< boost::mutex > lk( mtx_);
+            if ( queue_.empty() && ! stop_)
+                cond_.timed_wait( lk, posix_time::milliseconds( 1) );
+        }
+    }
+
+    scheduling_algorithm( old);
+}
+
+}}
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
@@ -0,0 +1,235 @@
+//          Copyright Oliver Kowalke 2009.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#define BOOST_FIBERS_SOURCE
+
+#include "boost/fiber/io.hpp"
+
+#include <cerrno>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+
+#include <boost/bind.hpp>
+
+#include <boost/fiber/algorithm.hpp>
+#include <boost/fiber/detail/io_uring.hpp>
+#include <boost/fiber/detail/scheduler.hpp>
+#include <boost/fiber/offload.hpp>
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+namespace boost {
+namespace fibers {
+namespace io {
+
+namespace {
+
+bool would_block()
+{ return EAGAIN == errno || EWOULDBLOCK == errno; }
+
+// completes req by the io_uring of the scheduler - false if the
+// readiness based functions must be used
+bool complete_( detail::io_request & req)
+{
+    if ( ! detail::scheduler::has_instance() ||
+         ! detail::scheduler::instance().active() ||
+         ! detail::scheduler::instance().wait_completion( req) )
+        return false;
+    // kernels not waiting for non-blocking descriptors
+    return -EAGAIN != req.result;
+}
+
+long result_( long r)
+{
+    if ( 0 <= r) return r;
+    errno = static_cast< int >( -r);
+    return -1;
+}
+
+int fsync_errno( int fd)
+{ return 0 == ::fsync( fd) ? 0 : errno; }
+
+void wait_( int fd, detail::io_op op)
+{
+    if ( detail::scheduler::has_instance() && detail::scheduler::instance().active() )
+    {
+        detail::scheduler::instance().wait_io( fd, op);
+        return;
+    }
+
+    ::pollfd pfd;
+    pfd.fd = fd;
+    pfd.events = detail::io_read == op ? POLLIN : POLLOUT;
+    pfd.revents = 0;
+    if ( ! detail::scheduler::has_instance() )
+    {
+        // a thread without scheduler
+        ::poll( & pfd, 1, -1);
+        return;
+    }
+    // main fiber - runs the other fibers until fd is ready
+    while ( 0 == ::poll( & pfd, 1, 0) )
+    {
+        if ( ! detail::scheduler::instance().run() &&
+             0 != ::poll( & pfd, 1, 1) )
+            break;
+    }
+}
+
+}
+
+void
+wait_readable( int fd)
+{ wait_( fd, detail::io_read); }
+
+void
+wait_writable( int fd)
+{ wait_( fd, detail::io_write); }
+
+int
+socket( int domain, int type, int protocol)
+{ return ::socket( domain, type | SOCK_NONBLOCK | SOCK_CLOEXEC, protocol); }
+
+int
+set_nonblocking( int fd)
+{
+    int flags = ::fcntl( fd, F_GETFL, 0);
+    if ( -1 == flags) return -1;
+    return ::fcntl( fd, F_SETFL, flags | O_NONBLOCK);
+}
+
+ssize_t
+read( int fd, void * buf, std::size_t count)
+{
+    // data available at a socket is read without a pass through the
+    // ready-queue; ENOTSOCK (regular files, pipes) leaves the read to
+    // the ring, a regular file would block despite O_NONBLOCK
+    ssize_t n = ::recv( fd, buf, count, MSG_DONTWAIT);
+    if ( -1 != n || ( ENOTSOCK != errno && ! would_block() ) ) return n;
+    bool tried = ENOTSOCK != errno;
+
+    detail::io_request req( detail::io_request::read, fd);
+    req.buf = buf;
+    req.len = count;
+    if ( complete_( req) ) return result_( req.result);
+
+    if ( ! tried)
+    {
+        n = ::read( fd, buf, count);
+        if ( -1 != n || ! would_block() ) return n;
+    }
+    for (;;)
+    {
+        wait_( fd, detail::io_read);
+        n = ::read( fd, buf, count);
+        if ( -1 != n || ! would_block() ) return n;
+    }
+}
+
+ssize_t
+write( int fd, void const* buf, std::size_t count)
+{
+    // see read()
+    ssize_t n = ::send( fd, buf, count, MSG_DONTWAIT);
+    if ( -1 != n || ( ENOTSOCK != errno && ! would_block() ) ) return n;
+    bool tried = ENOTSOCK != errno;
+
+    detail::io_request req( detail::io_request::write, fd);
+    req.buf = const_cast< void * >( buf);
+    req.len = count;
+    if ( complete_( req) ) return result_( req.result);
+
+    if ( ! tried)
+    {
+        n = ::write( fd, buf, count);
+        if ( -1 != n || ! would_block() ) return n;
+    }
+    for (;;)
+    {
+        wait_( fd, detail::io_write);
+        n = ::write( fd, buf, count);
+        if ( -1 != n || ! would_block() ) return n;
+    }
+}
+
+int
+accept( int fd, sockaddr * addr, socklen_t * addrlen)
+{
+    // the backlog of a busy listener is drained without waiting for
+    // a completion, a loop accepting connections would take one pass
+    // through the ready-queue for each connection
+    int s = ::accept4( fd, addr, addrlen, SOCK_NONBLOCK | SOCK_CLOEXEC);
+    if ( -1 != s || ! would_block() ) return s;
+
+    detail::io_request req( detail::io_request::accept, fd);
+    req.buf = addr;
+    req.addrlen = addrlen;
+    if ( complete_( req) ) return result_( req.result);
+
+    for (;;)
+    {
+        wait_( fd, detail::io_read);
+        s = ::accept4( fd, addr, addrlen, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if ( -1 != s || ! would_block() ) return s;
+    }
+}
+
+int
+connect( int fd, sockaddr const* addr, socklen_t addrlen)
+{
+    detail::io_request req( detail::io_request::connect, fd);
+    req.buf = const_cast< sockaddr * >( addr);
+    req.len = addrlen;
+    if ( complete_( req) )
+    {
+        if ( -EINPROGRESS != req.result) return result_( req.result);
+    }
+    else
+    {
+        int r = ::connect( fd, addr, addrlen);
+        if ( 0 == r || EINPROGRESS != errno) return r;
+    }
+    // the socket becomes writable if the connection is established or failed
+    wait_( fd, detail::io_write);
+    int err = 0;
+    socklen_t len = sizeof( err);
+    if ( -1 == ::getsockopt( fd, SOL_SOCKET, SO_ERROR, & err, & len) ) return -1;
+    if ( 0 == err) return 0;
+    errno = err;
+    return -1;
+}
+
+int
+fsync( int fd)
+{
+    detail::io_request req( detail::io_request::fsync, fd);
+    if ( complete_( req) ) return result_( req.result);
+    if ( ! detail::scheduler::has_instance() ) return ::fsync( fd);
+
+    // readiness does not apply to files - a helper thread
+    // blocks while the fiber is suspended
+    int err = this_fiber::offload( bind( fsync_errno, fd) );
+    if ( 0 == err) return 0;
+    errno = err;
+    return -1;
+}
+
+int
+close( int fd)
+{
+    if ( detail::scheduler::has_instance() )
+        detail::scheduler::instance().deregister_io( fd);
+    return ::close( fd);
+}
+
+}}}
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
@@ -0,0 +1,44 @@
+//          Copyright Oliver Kowalke 2009.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#define BOOST_FIBERS_SOURCE
+
+#include <boost/fiber/latch.hpp>
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+namespace boost {
+namespace fibers {
+
+latch::latch( std::size_t count) :
+    count_( count)
+{}
+
+void
+latch::count_down( std::size_t n)
+{ count_.sub( n); }
+
+void
+latch::wait()
+{ count_.wait(); }
+
+bool
+latch::try_wait()
+{ return count_.try_wait(); }
+
+void
+latch::arrive_and_wait( std::size_t n)
+{
+    count_down( n);
+    wait();
+}
+
+}}
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
@@ -0,0 +1,149 @@
+//          Copyright Oliver Kowalke 2009.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#define BOOST_FIBERS_SOURCE
+
+#include <boost/fiber/manual_reset_event.hpp>
+
+#include <algorithm>
+
+#include <boost/assert.hpp>
+#include <boost/foreach.hpp>
+#include <boost/thread/locks.hpp>
+
+#include <boost/fiber/detail/scheduler.hpp>
+#include <boost/fiber/interruption.hpp>
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+namespace boost {
+namespace fibers {
+
+manual_reset_event::manual_reset_event( bool isset) :
+    state_( isset ? SET : 0),
+    waiting_mtx_(),
+    waiting_()
+{}
+
+manual_reset_event::~manual_reset_event()
+{ BOOST_ASSERT( waiting_.empty() ); }
+
+void
+manual_reset_event::set()
+{
+    // fast path: no fiber is waiting, the signal is stored in state_
+    std::size_t expected = state_.load( memory_order_relaxed);
+    while ( expected < WAITER)
+    {
+        if ( state_.compare_exchange_weak(
+                expected, expected | SET,
+                memory_order_release, memory_order_relaxed) )
+            return;
+    }
+
+    // slow path: release all waiting fibers
+    std::deque< detail::notify::ptr_t > waiting;
+
+    unique_lock< detail::spinlock > lk( waiting_mtx_);
+    waiting.swap( waiting_);
+    state_.store( SET, memory_order_release);
+    lk.unlock();
+
+    BOOST_FOREACH( detail::notify::ptr_t const& n, waiting)
+    { n->set_ready(); }
+}
+
+void
+manual_reset_event::reset()
+{ state_.fetch_and( ~static_cast< std::size_t >( SET), memory_order_relaxed); }
+
+void
+manual_reset_event::wait()
+{
+    // fast path: event is already signaled
+    if ( try_wait() ) return;
+
+    detail::notify::ptr_t n( detail::scheduler::instance().active() );
+    bool is_fiber = n ? true : false;
+    if ( ! is_fiber)
+        // notifier for main-fiber
+        n = detail::scheduler::instance().notifier();
+
+    // store this fiber in order to be notified later
+    unique_lock< detail::spinlock > lk( waiting_mtx_);
+    waiting_.push_back( n);
+
+    // do not register as waiter if the event was signaled
+    // in the meantime
+    std::size_t expected = state_.load( memory_order_relaxed);
+    for (;;)
+    {
+        if ( 0 != ( expected & SET) )
+        {
+            waiting_.pop_back();
+            atomic_thread_fence( memory_order_acquire);
+            return;
+        }
+        else if ( state_.compare_exchange_weak(
+                    expected, expected + WAITER,
+                    memory_order_relaxed, memory_order_relaxed) )
+            break;
+    }
+
+    try
+    {
+        if ( is_fiber)
+        {
+            for (;;)
+            {
+                // suspend this fiber
+                detail::scheduler::instance().wait( lk);
+
+                // check if fiber was interrupted
+                this_fiber::interruption_point();
+
+                if ( ! this_fiber::interruption_requested() ) break;
+
+                // woken up by an interruption request while interruptions
+                // are blocked - set() removes all fibers from waiting_
+                lk.lock();
+                if ( waiting_.end() == std::find( waiting_.begin(), waiting_.end(), n) )
+                    break;
+            }
+        }
+        else
+        {
+            lk.unlock();
+            while ( ! n->is_ready() )
+                // run scheduler
+                detail::scheduler::instance().run();
+        }
+    }
+    catch (...)
+    {
+        // remove fiber from waiting_
+        if ( ! lk.owns_lock() ) lk.lock();
+        std::deque< detail::notify::ptr_t >::iterator i(
+            std::find( waiting_.begin(), waiting_.end(), n) );
+        if ( waiting_.end() != i)
+        {
+            waiting_.erase( i);
+            state_.fetch_sub( WAITER, memory_order_relaxed);
+        }
+        throw;
+    }
+}
+
+bool
+manual_reset_event::try_wait()
+{ return 0 != ( state_.load( memory_order_acquire) & SET); }
+
+}}
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
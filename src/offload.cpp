@@ -0,0 +1,180 @@
+//          Copyright Oliver Kowalke 2009.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#define BOOST_FIBERS_SOURCE
+
+#include "boost/fiber/offload.hpp"
+
+#include <algorithm>
+
+#include <boost/bind.hpp>
+#include <boost/system/error_code.hpp>
+#include <boost/thread/locks.hpp>
+#include <boost/thread/once.hpp>
+#include <boost/throw_exception.hpp>
+
+#include <boost/fiber/exceptions.hpp>
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+namespace boost {
+namespace fibers {
+
+namespace {
+
+once_flag instance_flag = BOOST_ONCE_INIT;
+offload_pool * pool_instance = 0;
+
+void create_instance()
+{
+    std::size_t n = 2 * thread::hardware_concurrency();
+    // never deleted - the helpers live until the process exits
+    pool_instance = new offload_pool( (std::max)( n, std::size_t( 4) ) );
+}
+
+}
+
+offload_pool::offload_pool( std::size_t max_threads) :
+    mtx_(),
+    cond_(),
+    queue_(),
+    max_threads_( max_threads),
+    threads_( 0),
+    idle_( 0),
+    max_depth_( 0),
+    submitted_( 0),
+    completed_( 0),
+    max_wait_( clock_type::duration::zero() ),
+    stop_( false)
+{
+    if ( 0 == max_threads_)
+        boost::throw_exception(
+            invalid_argument( system::errc::invalid_argument, "boost fiber: offload_pool without threads") );
+}
+
+offload_pool::~offload_pool()
+{
+    boost::unique_lock< boost::mutex > lk( mtx_);
+    stop_ = true;
+    cond_.notify_all();
+    while ( 0 != threads_)
+        cond_.wait( lk);
+}
+
+offload_pool &
+offload_pool::instance()
+{
+    call_once( instance_flag, create_instance);
+    return * pool_instance;
+}
+
+void
+offload_pool::helper_()
+{
+    boost::unique_lock< boost::mutex > lk( mtx_);
+    for (;;)
+    {
+        ++idle_;
+        while ( queue_.empty() && ! stop_ && threads_ <= max_threads_)
+            cond_.wait( lk);
+        --idle_;
+        // the queued functions are run before the helpers exit
+        if ( queue_.empty() || threads_ > max_threads_) break;
+
+        function< void() > fn;
+        fn.swap( queue_.front().fn);
+        clock_type::duration waited = clock_type::now() - queue_.front().submitted;
+        queue_.pop_front();
+        if ( max_wait_ < waited) max_wait_ = waited;
+
+        lk.unlock();
+        // the shared state of offload() stores the exception
+        fn();
+        lk.lock();
+        ++completed_;
+    }
+    --threads_;
+    // the destructor waits for the last helper, this
+    // helper does not touch the pool after releasing mtx_
+    if ( stop_ && 0 == threads_)
+        cond_.notify_all();
+}
+
+void
+offload_pool::submit( function< void() > const& fn)
+{
+    {
+        boost::unique_lock< boost::mutex > lk( mtx_);
+        queue_.push_back( item( fn, clock_type::now() ) );
+        // an idle helper might not have dequeued its function yet
+        if ( queue_.size() > idle_ && threads_ < max_threads_)
+        {
+            try
+            {
+                // detached - a helper exiting after max_threads()
+                // was lowered leaves nothing to join
+                thread( bind( & offload_pool::helper_, this) ).detach();
+                ++threads_;
+            }
+            catch (...)
+            {
+                // the existing helpers run the function
+                if ( 0 == threads_)
+                {
+                    queue_.pop_back();
+                    throw;
+                }
+            }
+        }
+        ++submitted_;
+        max_depth_ = (std::max)( max_depth_, queue_.size() );
+    }
+    cond_.notify_one();
+}
+
+void
+offload_pool::max_threads( std::size_t max_threads)
+{
+    if ( 0 == max_threads)
+        boost::throw_exception(
+            invalid_argument( system::errc::invalid_argument, "boost fiber: offload_pool without threads") );
+    {
+        boost::unique_lock< boost::mutex > lk( mtx_);
+        max_threads_ = max_threads;
+    }
+    // surplus helpers exit when idle
+    cond_.notify_all();
+}
+
+std::size_t
+offload_pool::max_threads() const
+{
+    boost::unique_lock< boost::mutex > lk( mtx_);
+    return max_threads_;
+}
+
+offload_pool::snapshot
+offload_pool::statistics() const
+{
+    boost::unique_lock< boost::mutex > lk( mtx_);
+    snapshot s;
+    s.threads = threads_;
+    s.idle = idle_;
+    s.max_threads = max_threads_;
+    s.depth = queue_.size();
+    s.max_depth = max_depth_;
+    s.submitted = submitted_;
+    s.completed = completed_;
+    s.max_wait = chrono::duration_cast< chrono::nanoseconds >( max_wait_);
+    return s;
+}
+
+}}
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
@@ -0,0 +1,308 @@
+//          Copyright Oliver Kowalke 2009.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#define BOOST_FIBERS_SOURCE
+
+#include "boost/fiber/parallel.hpp"
+
+#include <deque>
+
+#include <boost/atomic.hpp>
+#include <boost/bind.hpp>
+#include <boost/function.hpp>
+#include <boost/date_time/posix_time/posix_time_types.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/thread/locks.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/once.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/thread/tss.hpp>
+
+#include <boost/fiber/algorithm.hpp>
+#include <boost/fiber/detail/fiber_object.hpp>
+#include <boost/fiber/detail/fiber_pool.hpp>
+#include <boost/fiber/detail/scheduler.hpp>
+#include <boost/fiber/detail/spinlock.hpp>
+#include <boost/fiber/operations.hpp>
+#include <boost/fiber/round_robin.hpp>
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+namespace boost {
+namespace fibers {
+namespace detail {
+
+namespace {
+
+// the tasks queued at one worker thread - the owner pushes and pops
+// at the back, thieves take the oldest (largest) tasks from the front
+struct worker_queue
+{
+    spinlock                        mtx;
+    std::deque< parallel_task * >   tasks;
+    std::size_t                     index;
+
+    worker_queue() :
+        mtx(), tasks(), index( 0)
+    {}
+};
+
+void no_cleanup( worker_queue *)
+{}
+
+// the queue of the worker running the calling thread
+thread_specific_ptr< worker_queue > current_queue( no_cleanup);
+
+class worker_pool : private noncopyable
+{
+private:
+    std::size_t             size_;
+    worker_queue        *   queues_;
+    atomic< std::size_t >   next_;
+    atomic< std::size_t >   sleepers_;
+    boost::mutex            mtx_;
+    boost::condition_variable   cond_;
+
+    parallel_task * take_( std::size_t index)
+    {
+        {
+            unique_lock< spinlock > lk( queues_[index].mtx);
+            if ( ! queues_[index].tasks.empty() )
+            {
+                parallel_task * t = queues_[index].tasks.back();
+                queues_[index].tasks.pop_back();
+                return t;
+            }
+        }
+        for ( std::size_t i = 1; i < size_; ++i)
+        {
+            worker_queue & victim = queues_[( index + i) % size_];
+            unique_lock< spinlock > lk( victim.mtx);
+            if ( ! victim.tasks.empty() )
+            {
+                parallel_task * t = victim.tasks.front();
+                victim.tasks.pop_front();
+                return t;
+            }
+        }
+        return 0;
+    }
+
+    void worker_( std::size_t index)
+    {
+        round_robin ds;
+        scheduling_algorithm( & ds);
+        current_queue.reset( & queues_[index]);
+        fiber_pool & fibers = fiber_pool::instance();
+
+        for (;;)
+        {
+            // each task runs in a pooled fiber, a task waiting
+            // for a stolen task suspends only its fiber
+            parallel_task * t = take_( index);
+            if ( t)
+                fibers.post( bind( & parallel_task::run, t) );
+            if ( ds.run() || t) continue;
+
+            unique_lock< boost::mutex > lk( mtx_);
+            // a push() after the increment sees the sleeper and
+            // notifies under mtx_, an earlier push() is found by
+            // scanning the queues again
+            sleepers_.fetch_add( 1);
+            t = take_( index);
+            if ( ! t)
+            {
+                if ( fibers.idle() )
+                    cond_.wait( lk);
+                else
+                    // the fibers wait for tasks stolen by other workers,
+                    // a fiber made ready by another thread does not
+                    // signal cond_
+                    cond_.timed_wait( lk, posix_time::milliseconds( 1) );
+            }
+            sleepers_.fetch_sub( 1);
+            lk.unlock();
+            if ( t)
+                fibers.post( bind( & parallel_task::run, t) );
+        }
+    }
+
+public:
+    worker_pool() :
+        size_( thread::hardware_concurrency() ),
+        queues_( 0),
+        next_( 0),
+        sleepers_( 0),
+        mtx_(),
+        cond_()
+    {
+        if ( 0 == size_) size_ = 1;
+        queues_ = new worker_queue[size_];
+        for ( std::size_t i = 0; i < size_; ++i)
+        {
+            queues_[i].index = i;
+            thread( bind( & worker_pool::worker_, this, i) ).detach();
+        }
+    }
+
+    void push( worker_queue * q, parallel_task * t)
+    {
+        if ( ! q) q = & queues_[next_.fetch_add( 1, memory_order_relaxed) % size_];
+        {
+            unique_lock< spinlock > lk( q->mtx);
+            q->tasks.push_back( t);
+        }
+        if ( 0 != sleepers_.load() )
+        {
+            // a sleeper is either waiting on cond_ or
+            // has not scanned the queues yet
+            unique_lock< boost::mutex > lk( mtx_);
+            cond_.notify_one();
+        }
+    }
+
+    bool remove( worker_queue * q, parallel_task * t)
+    {
+        unique_lock< spinlock > lk( q->mtx);
+        for ( std::deque< parallel_task * >::reverse_iterator i = q->tasks.rbegin();
+              i != q->tasks.rend(); ++i)
+        {
+            if ( * i == t)
+            {
+                q->tasks.erase( -- i.base() );
+                return true;
+            }
+        }
+        return false;
+    }
+};
+
+// a function queued by post_any_worker() - nobody
+// waits for it, deleted after it has run
+class function_task : public parallel_task
+{
+private:
+    function< void() >  fn_;
+
+public:
+    function_task( function< void() > const& fn) :
+        fn_( fn)
+    {}
+
+    void execute()
+    { fn_(); }
+
+    void run()
+    {
+        try
+        { fn_(); }
+        catch ( forced_unwind const&)
+        {
+            delete this;
+            throw;
+        }
+        catch (...)
+        {}
+        delete this;
+    }
+};
+
+once_flag pool_flag = BOOST_ONCE_INIT;
+worker_pool * pool = 0;
+
+void create_pool()
+{
+    // never deleted - the workers live until the process exits
+    pool = new worker_pool();
+}
+
+worker_pool & get_pool()
+{
+    call_once( pool_flag, create_pool);
+    return * pool;
+}
+
+}
+
+parallel_task::parallel_task() :
+    done_(),
+    except_()
+{}
+
+void
+parallel_task::run()
+{
+    try
+    { execute(); }
+    catch (...)
+    { except_ = current_exception(); }
+
+    // the waiter might destroy this task once done_ is set
+    done_.set();
+}
+
+void
+parallel_task::wait()
+{
+    done_.wait();
+    if ( except_) rethrow_exception( except_);
+}
+
+void
+post_any_worker( function< void() > const& fn)
+{ get_pool().push( current_queue.get(), new function_task( fn) ); }
+
+bool
+in_worker()
+{ return 0 != current_queue.get(); }
+
+void
+spawn_task( parallel_task * t)
+{ get_pool().push( current_queue.get(), t); }
+
+void
+join_task( parallel_task * t)
+{
+    worker_queue * q = current_queue.get();
+    // not stolen - run it in this fiber
+    if ( q && get_pool().remove( q, t) )
+        t->execute();
+    else
+        t->wait();
+}
+
+void
+invoke_tasks( parallel_task ** ts, std::size_t n)
+{
+    // outside of the pool all tasks are run by workers
+    std::size_t first = in_worker() ? 1 : 0;
+    for ( std::size_t i = first; i < n; ++i)
+        spawn_task( ts[i]);
+
+    exception_ptr except;
+    if ( 1 == first)
+    {
+        try
+        { ts[0]->execute(); }
+        catch (...)
+        { except = current_exception(); }
+    }
+    for ( std::size_t i = n; i-- > first;)
+    {
+        try
+        { join_task( ts[i]); }
+        catch (...)
+        { if ( ! except) except = current_exception(); }
+    }
+    if ( except) rethrow_exception( except);
+}
+
+}}}
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
@@ -13,11 +13,16 @@
 #include <memory>
 #include <utility>
 
+#if defined(BOOST_FIBERS_HAS_EPOLL)
+#include <poll.h>
+#endif
+
 #include <boost/assert.hpp>
 #include <boost/bind.hpp>
 #include <boost/foreach.hpp>
 #include <boost/scope_exit.hpp>
 #include <boost/thread/locks.hpp>
+#include <boost/throw_exception.hpp>
 
 #include <boost/fiber/detail/scheduler.hpp>
 #include <boost/fiber/exceptions.hpp>
@@ -63,14 +68,30 @@ public:
     { p->release_ref(); }
 };
 
+struct deadline_greater
+{
+    template< typename T >
+    bool operator()( T const& l, T const& r) const
+    { return r.first < l.first; }
+};
+
 }
 
 round_robin::round_robin() :
     active_fiber_(),
     notifier_( new detail::main_notifier() ),
     wqueue_(),
+    tqueue_(),
+    stale_timers_( 0),
     rqueue_mtx_(),
     rqueue_()
+#if defined(BOOST_FIBERS_HAS_EPOLL)
+    , reactor_( 0)
+#endif
+#if defined(BOOST_FIBERS_HAS_IO_URING)
+    , uring_( 0)
+    , uring_checked_( false)
+#endif
 {}
 
 round_robin::~round_robin()
@@ -88,6 +109,12 @@ round_robin::~round_robin()
         p->release();
     }
 #endif
+#if defined(BOOST_FIBERS_HAS_EPOLL)
+    delete reactor_;
+#endif
+#if defined(BOOST_FIBERS_HAS_IO_URING)
+    delete uring_;
+#endif
 }
 
 void
@@ -113,8 +140,54 @@ round_robin::spawn( detail::fiber_base::ptr_t const& f)
     active_fiber_ = tmp;
 }
 
-bool
-round_robin::run()
+void
+round_robin::expire_timers_()
+{
+    chrono::system_clock::time_point now( chrono::system_clock::now() );
+    while ( ! tqueue_.empty() && tqueue_.front().first <= now)
+    {
+        timer_t t( tqueue_.front() );
+        std::pop_heap( tqueue_.begin(), tqueue_.end(), detail::deadline_greater() );
+        tqueue_.pop_back();
+
+        // entry is stale if the fiber was notified before its deadline
+        // and has been resumed (wait_until() reset its time-point)
+        if ( t.second->time_point() != t.first)
+        {
+            if ( 0 < stale_timers_) --stale_timers_;
+            continue;
+        }
+        if ( t.second->is_waiting() )
+        {
+            // tells wait_until() that the deadline woke the fiber
+            t.second->time_point( (chrono::system_clock::time_point::min)() );
+            t.second->set_ready();
+        }
+        else
+            // notified, but not resumed yet
+            t.second->time_point_reset();
+    }
+}
+
+void
+round_robin::compact_timers_()
+{
+    // drop the entries of fibers woken up before their deadline,
+    // they keep finished fibers (and their stacks) alive
+    tqueue_t tqueue;
+    tqueue.reserve( tqueue_.size() - stale_timers_);
+    BOOST_FOREACH( timer_t const& t, tqueue_)
+    {
+        if ( t.second->time_point() == t.first)
+            tqueue.push_back( t);
+    }
+    std::make_heap( tqueue.begin(), tqueue.end(), detail::deadline_greater() );
+    tqueue_.swap( tqueue);
+    stale_timers_ = 0;
+}
+
+void
+round_robin::poll_wqueue_()
 {
     // loop over waiting queue
     wqueue_t wqueue;
@@ -136,14 +209,101 @@ round_robin::run()
     }
     // exchange local with global waiting queue
     wqueue_.swap( wqueue);
+}
+
+bool
+round_robin::poll_io_( bool block)
+{
+#if defined(BOOST_FIBERS_HAS_EPOLL)
+    bool epoll = reactor_ && 0 < reactor_->waiting();
+# if defined(BOOST_FIBERS_HAS_IO_URING)
+    bool uring = uring_ && 0 < uring_->inflight();
+# else
+    bool uring = false;
+# endif
+    if ( ! epoll && ! uring) return false;
+
+    int timeout_ms = 0;
+    if ( block)
+    {
+        // cross-thread notifications do not interrupt epoll_wait(),
+        // the thread wakes up at least once per millisecond
+        timeout_ms = 1;
+        if ( ! tqueue_.empty() &&
+             tqueue_.front().first <= chrono::system_clock::now() )
+            timeout_ms = 0;
+    }
+    rqueue_t ready;
+# if defined(BOOST_FIBERS_HAS_IO_URING)
+    if ( uring)
+    {
+        // the requests prepared during this pass are submitted
+        // together, completions are read without a system call
+        uring_->submit();
+        uring_->reap( ready);
+        if ( ! ready.empty() ) timeout_ms = 0;
+        if ( 0 != timeout_ms)
+        {
+            // both descriptors are readable if events are available
+            ::pollfd fds[2];
+            fds[0].fd = uring_->native_handle();
+            fds[0].events = POLLIN;
+            fds[0].revents = 0;
+            if ( epoll)
+            {
+                fds[1].fd = reactor_->native_handle();
+                fds[1].events = POLLIN;
+                fds[1].revents = 0;
+            }
+            ::poll( fds, epoll ? 2 : 1, timeout_ms);
+            timeout_ms = 0;
+            uring_->reap( ready);
+        }
+    }
+# endif
+    if ( epoll) reactor_->poll( timeout_ms, ready);
+    if ( ready.empty() ) return false;
+
+    unique_lock< detail::spinlock > lk( rqueue_mtx_);
+    rqueue_.insert( rqueue_.end(), ready.begin(), ready.end() );
+    return true;
+#else
+    return false;
+#endif
+}
+
+bool
+round_robin::run()
+{
+    // wake up fibers with expired deadline
+    if ( ! tqueue_.empty() ) expire_timers_();
 
     // pop new fiber from ready-queue which is not complete
     // (example: fiber in ready-queue could be canceled by active-fiber)
+    // the waiting queue is polled only if the ready-queue is empty -
+    // polling on each run() would be quadratic in the number of fibers
+    // woken up at once (barrier, notify_all())
+    // the reactor and the io_uring are polled once per pass through the
+    // ready-queue, they block only if no fiber is ready
+    bool polled = false, blocked = false;
     detail::fiber_base::ptr_t f;
     do
     {
         unique_lock< detail::spinlock > lk( rqueue_mtx_);
-        if ( rqueue_.empty() ) return false;
+        if ( rqueue_.empty() )
+        {
+            lk.unlock();
+            if ( polled)
+            {
+                if ( blocked || ! poll_io_( true) ) return false;
+                blocked = true;
+                continue;
+            }
+            poll_wqueue_();
+            poll_io_( false);
+            polled = true;
+            continue;
+        }
         f.swap( rqueue_.front() );
         rqueue_.pop_front();
         lk.unlock();
@@ -183,6 +343,43 @@ round_robin::wait( unique_lock< detail::spinlock > & lk)
     BOOST_ASSERT( tmp == detail::scheduler::instance().active() );
 }
 
+bool
+round_robin::wait_until( unique_lock< detail::spinlock > & lk,
+                         chrono::system_clock::time_point const& abs_time)
+{
+    BOOST_ASSERT( active_fiber_);
+    BOOST_ASSERT( active_fiber_->is_running() );
+
+    // set active_fiber to state_waiting
+    active_fiber_->set_waiting();
+    // push active fiber to wqueue_
+    wqueue_.push_back( active_fiber_);
+    // register deadline, run() makes the fiber ready
+    // if not notified before
+    active_fiber_->time_point( abs_time);
+    tqueue_.push_back( timer_t( abs_time, active_fiber_) );
+    std::push_heap( tqueue_.begin(), tqueue_.end(), detail::deadline_greater() );
+    // store active fiber in local var
+    detail::fiber_base::ptr_t tmp = active_fiber_;
+    // release lock
+    lk.unlock();
+    // suspend fiber
+    tmp->suspend();
+    // fiber is resumed
+
+    BOOST_ASSERT( tmp->is_running() );
+    BOOST_ASSERT( tmp == detail::scheduler::instance().active() );
+
+    // the entry of a fiber notified before its deadline stays in
+    // the heap until it expires or the heap is compacted
+    bool stale = abs_time == tmp->time_point();
+    bool notified = (chrono::system_clock::time_point::min)() != tmp->time_point();
+    tmp->time_point_reset();
+    if ( stale && ++stale_timers_ > tqueue_.size() / 2)
+        compact_timers_();
+    return notified;
+}
+
 void
 round_robin::yield()
 {
@@ -262,6 +459,88 @@ detail::notify::ptr_t
 round_robin::notifier()
 { return notifier_; }
 
+void
+round_robin::wait_io( int fd, detail::io_op op)
+{
+#if defined(BOOST_FIBERS_HAS_EPOLL)
+    BOOST_ASSERT( active_fiber_);
+    BOOST_ASSERT( active_fiber_->is_running() );
+
+    if ( ! reactor_) reactor_ = new detail::epoll_reactor();
+    // the fiber is not pushed to wqueue_, the
+    // reactor moves it to the ready-queue
+    active_fiber_->set_waiting();
+    reactor_->add_waiter( fd, op, active_fiber_);
+    // store active fiber in local var
+    detail::fiber_base::ptr_t tmp = active_fiber_;
+    // suspend fiber
+    tmp->suspend();
+    // fiber is resumed
+
+    BOOST_ASSERT( tmp->is_running() );
+    BOOST_ASSERT( tmp == detail::scheduler::instance().active() );
+#else
+    boost::throw_exception(
+        fiber_exception(
+            system::errc::operation_not_supported,
+            "boost fiber: no reactor") );
+#endif
+}
+
+void
+round_robin::deregister_io( int fd)
+{
+#if defined(BOOST_FIBERS_HAS_IO_URING)
+    // fibers suspended in a request for fd are resumed by run()
+    if ( uring_) uring_->cancel( fd);
+#endif
+#if defined(BOOST_FIBERS_HAS_EPOLL)
+    if ( ! reactor_) return;
+    rqueue_t ready;
+    if ( 0 == reactor_->deregister( fd, ready) ) return;
+
+    unique_lock< detail::spinlock > lk( rqueue_mtx_);
+    rqueue_.insert( rqueue_.end(), ready.begin(), ready.end() );
+#endif
+}
+
+bool
+round_robin::wait_completion( detail::io_request & req)
+{
+#if defined(BOOST_FIBERS_HAS_IO_URING)
+    BOOST_ASSERT( active_fiber_);
+    BOOST_ASSERT( active_fiber_->is_running() );
+
+    if ( ! uring_checked_)
+    {
+        uring_ = detail::io_uring_backend::create();
+        uring_checked_ = true;
+    }
+    if ( ! uring_ || ! uring_->supports( req.op) ) return false;
+
+    req.fiber = active_fiber_;
+    if ( ! uring_->prepare( req) )
+    {
+        req.fiber.reset();
+        return false;
+    }
+    // submitted by run(), the completion moves
+    // the fiber to the ready-queue
+    active_fiber_->set_waiting();
+    // store active fiber in local var
+    detail::fiber_base::ptr_t tmp = active_fiber_;
+    // suspend fiber
+    tmp->suspend();
+    // fiber is resumed
+
+    BOOST_ASSERT( tmp->is_running() );
+    BOOST_ASSERT( tmp == detail::scheduler::instance().active() );
+    return true;
+#else
+    return false;
+#endif
+}
+
 void
 round_robin::migrate_to( fiber const& f)
 {
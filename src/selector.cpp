@@ -0,0 +1,197 @@
+//          Copyright Oliver Kowalke 2009.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#define BOOST_FIBERS_SOURCE
+
+#include <boost/fiber/selector.hpp>
+
+#include <boost/assert.hpp>
+#include <boost/foreach.hpp>
+#include <boost/thread/locks.hpp>
+
+#include <boost/fiber/detail/scheduler.hpp>
+#include <boost/fiber/interruption.hpp>
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+namespace boost {
+namespace fibers {
+
+namespace {
+
+// a channel might fire the waiter of the main-fiber after its wait loop
+// has returned - the flag of the main-fiber notifier is shared by all
+// primitives and must be consumed; fired is set to ignore a fire()
+// racing with unsubscribe_()
+void consume_( detail::select_waiter & w, detail::notify::ptr_t const& n, bool woken)
+{
+    bool fired = false;
+    {
+        unique_lock< detail::spinlock > lk( w.mtx);
+        fired = w.fired;
+        w.fired = true;
+    }
+    // the channel sets the flag after fire() has returned
+    if ( fired && ! woken)
+        while ( ! n->is_ready() )
+            detail::scheduler::instance().run();
+}
+
+}
+
+const int selector::timeout;
+const int selector::closed;
+
+selector::selector() :
+    cases_(),
+    next_( 0),
+    waiter_( new detail::select_waiter() )
+{}
+
+selector::~selector()
+{
+    BOOST_FOREACH( case_base * c, cases_)
+    { delete c; }
+}
+
+int
+selector::add_( case_base * c)
+{
+    // capacity was reserved by the caller
+    cases_.push_back( c);
+    return static_cast< int >( cases_.size() - 1);
+}
+
+int
+selector::try_select_()
+{
+    bool open = false;
+    std::size_t size = cases_.size();
+    for ( std::size_t i = 0; i < size; ++i)
+    {
+        std::size_t idx = ( next_ + i) % size;
+        if ( cases_[idx]->try_complete() )
+        {
+            next_ = idx + 1;
+            return static_cast< int >( idx);
+        }
+        if ( ! cases_[idx]->closed() ) open = true;
+    }
+    return open ? timeout : closed;
+}
+
+void
+selector::subscribe_()
+{
+    BOOST_FOREACH( case_base * c, cases_)
+    { c->subscribe( waiter_); }
+}
+
+void
+selector::unsubscribe_()
+{
+    BOOST_FOREACH( case_base * c, cases_)
+    { c->unsubscribe( waiter_); }
+}
+
+int
+selector::wait_( chrono::system_clock::time_point const* abs_time)
+{
+    // fast path: a case can proceed without blocking
+    int idx = try_select_();
+    if ( timeout != idx) return idx;
+
+    detail::notify::ptr_t n( detail::scheduler::instance().active() );
+    bool is_fiber = n ? true : false;
+    if ( ! is_fiber)
+        // notifier for main-fiber
+        n = detail::scheduler::instance().notifier();
+
+    // the main-fiber consumed the notification
+    bool woken = false;
+    for (;;)
+    {
+        if ( abs_time && chrono::system_clock::now() >= * abs_time)
+            return timeout;
+
+        {
+            unique_lock< detail::spinlock > lk( waiter_->mtx);
+            waiter_->n = n;
+            waiter_->fired = false;
+        }
+        subscribe_();
+
+        // a channel might have changed before the waiter was registered
+        idx = try_select_();
+        if ( timeout != idx)
+        {
+            unsubscribe_();
+            if ( ! is_fiber) consume_( * waiter_, n, false);
+            return idx;
+        }
+
+        try
+        {
+            unique_lock< detail::spinlock > lk( waiter_->mtx);
+            if ( ! waiter_->fired)
+            {
+                if ( is_fiber)
+                {
+                    // suspend this fiber until a channel fires the
+                    // waiter or abs_time has expired
+                    if ( abs_time)
+                        detail::scheduler::instance().wait_until( lk, * abs_time);
+                    else
+                        detail::scheduler::instance().wait( lk);
+
+                    // check if fiber was interrupted
+                    this_fiber::interruption_point();
+                }
+                else
+                {
+                    lk.unlock();
+                    while ( ! ( woken = n->is_ready() ) &&
+                            ( ! abs_time || chrono::system_clock::now() < * abs_time) )
+                        // run scheduler
+                        detail::scheduler::instance().run();
+                }
+            }
+        }
+        catch (...)
+        {
+            unsubscribe_();
+            throw;
+        }
+        unsubscribe_();
+
+        if ( ! is_fiber) consume_( * waiter_, n, woken);
+        woken = false;
+
+        // another fiber might have taken the item (slot) in the
+        // meantime or the wakeup was spurious - wait again
+        idx = try_select_();
+        if ( timeout != idx) return idx;
+    }
+}
+
+int
+selector::try_wait()
+{ return try_select_(); }
+
+int
+selector::wait()
+{ return wait_( 0); }
+
+int
+selector::wait_until( chrono::system_clock::time_point const& abs_time)
+{ return wait_( & abs_time); }
+
+}}
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
@@ -0,0 +1,192 @@
+//          Copyright Oliver Kowalke 2009.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#define BOOST_FIBERS_SOURCE
+
+#include "boost/fiber/task_graph.hpp"
+
+#include <boost/assert.hpp>
+#include <boost/bind.hpp>
+#include <boost/foreach.hpp>
+#include <boost/thread/locks.hpp>
+#include <boost/throw_exception.hpp>
+
+#include <boost/fiber/detail/fiber_pool.hpp>
+#include <boost/fiber/exceptions.hpp>
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+namespace boost {
+namespace fibers {
+
+// small enough for the buffer of boost::function
+struct task_graph::run_node
+{
+    task_graph  *   g;
+    node_id         id;
+
+    run_node( task_graph * g_, node_id id_) :
+        g( g_), id( id_)
+    {}
+
+    void operator()() const
+    { g->execute_( id); }
+};
+
+task_graph::task_graph() :
+    nodes_(),
+    acyclic_( true),
+    pending_(),
+    cancelled_(),
+    remaining_( 0),
+    submit_(),
+    done_( true),
+    mtx_(),
+    except_()
+{}
+
+task_graph::node_id
+task_graph::add( function< void() > const& fn)
+{
+    nodes_.push_back( node( fn) );
+    acyclic_ = false;
+    return nodes_.size() - 1;
+}
+
+void
+task_graph::add_dependency( node_id n, node_id predecessor)
+{
+    if ( n >= nodes_.size() || predecessor >= nodes_.size() || n == predecessor)
+        boost::throw_exception(
+            invalid_argument(
+                system::errc::invalid_argument,
+                "boost fiber: invalid task_graph dependency") );
+    nodes_[predecessor].successors.push_back( n);
+    ++nodes_[n].predecessors;
+    acyclic_ = false;
+}
+
+void
+task_graph::check_acyclic_()
+{
+    // Kahn's algorithm - every node is reached only if there is no cycle
+    std::vector< std::size_t > pending( nodes_.size() );
+    std::vector< node_id > ready;
+    for ( node_id i = 0; i < nodes_.size(); ++i)
+    {
+        pending[i] = nodes_[i].predecessors;
+        if ( 0 == pending[i]) ready.push_back( i);
+    }
+    std::size_t reached = 0;
+    while ( ! ready.empty() )
+    {
+        node_id i = ready.back();
+        ready.pop_back();
+        ++reached;
+        BOOST_FOREACH( node_id s, nodes_[i].successors)
+        { if ( 0 == --pending[s]) ready.push_back( s); }
+    }
+    if ( reached != nodes_.size() )
+        boost::throw_exception(
+            invalid_argument(
+                system::errc::invalid_argument,
+                "boost fiber: task_graph contains a cycle") );
+    acyclic_ = true;
+}
+
+void
+task_graph::execute_( node_id id)
+{
+    for (;;)
+    {
+        bool cancel = cancelled_[id].load( memory_order_relaxed);
+        if ( ! cancel)
+        {
+            try
+            { nodes_[id].fn(); }
+            catch (...)
+            {
+                unique_lock< detail::spinlock > lk( mtx_);
+                if ( ! except_) except_ = current_exception();
+                cancel = true;
+            }
+        }
+
+        // the last ready successor is run in this fiber,
+        // the others are submitted
+        bool has_next = false;
+        node_id next = 0;
+        BOOST_FOREACH( node_id s, nodes_[id].successors)
+        {
+            // published by the release of the decrement
+            if ( cancel) cancelled_[s].store( true, memory_order_relaxed);
+            if ( 1 == pending_[s].fetch_sub( 1, memory_order_acq_rel) )
+            {
+                if ( has_next) submit_( run_node( this, next) );
+                has_next = true;
+                next = s;
+            }
+        }
+        // the graph might be destroyed after the last completion
+        complete_();
+        if ( ! has_next) return;
+        id = next;
+    }
+}
+
+void
+task_graph::complete_()
+{
+    if ( 1 != remaining_.fetch_sub( 1, memory_order_acq_rel) ) return;
+    done_.set();
+}
+
+void
+task_graph::run()
+{
+    run_( bind( & detail::fiber_pool::post, & detail::fiber_pool::instance(), _1) );
+}
+
+void
+task_graph::run_( submit_fn const& submit)
+{
+    if ( nodes_.empty() ) return;
+    if ( ! acyclic_)
+    {
+        check_acyclic_();
+        pending_.reset( new atomic< std::size_t >[nodes_.size()]);
+        cancelled_.reset( new atomic< bool >[nodes_.size()]);
+    }
+
+    for ( node_id i = 0; i < nodes_.size(); ++i)
+    {
+        pending_[i].store( nodes_[i].predecessors, memory_order_relaxed);
+        cancelled_[i].store( false, memory_order_relaxed);
+    }
+    remaining_.store( nodes_.size(), memory_order_relaxed);
+    submit_ = submit;
+    done_.reset();
+    except_ = exception_ptr();
+
+    // the roots are collected first - a submitted
+    // node might run before the loop has finished
+    std::vector< node_id > roots;
+    for ( node_id i = 0; i < nodes_.size(); ++i)
+        if ( 0 == nodes_[i].predecessors) roots.push_back( i);
+    BOOST_FOREACH( node_id i, roots)
+    { submit_( run_node( this, i) ); }
+
+    done_.wait();
+    submit_.clear();
+    if ( except_) rethrow_exception( except_);
+}
+
+}}
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
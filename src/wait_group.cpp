@@ -0,0 +1,41 @@
+//          Copyright Oliver Kowalke 2009.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#define BOOST_FIBERS_SOURCE
+
+#include <boost/fiber/wait_group.hpp>
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+namespace boost {
+namespace fibers {
+
+wait_group::wait_group( std::size_t count) :
+    count_( count)
+{}
+
+void
+wait_group::add( std::size_t n)
+{ count_.add( n); }
+
+void
+wait_group::done()
+{ count_.sub( 1); }
+
+void
+wait_group::wait()
+{ count_.wait(); }
+
+bool
+wait_group::try_wait()
+{ return count_.try_wait(); }
+
+}}
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
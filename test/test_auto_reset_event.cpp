@@ -0,0 +1,158 @@
+//          Copyright Oliver Kowalke 2009.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include <boost/atomic.hpp>
+#include <boost/bind.hpp>
+#include <boost/ref.hpp>
+#include <boost/test/unit_test.hpp>
+#include <boost/thread.hpp>
+#include <boost/utility.hpp>
+
+#include <boost/fiber/all.hpp>
+
+int value = 0;
+
+void wait_fn( boost::fibers::auto_reset_event & ev)
+{
+    ev.wait();
+    ++value;
+}
+
+void interrupted_wait_fn( boost::fibers::auto_reset_event & ev, bool & interrupted)
+{
+    try
+    { ev.wait(); }
+    catch ( boost::fibers::fiber_interrupted const&)
+    { interrupted = true; }
+}
+
+void test_case_1()
+{
+    boost::fibers::auto_reset_event ev;
+    BOOST_CHECK( ! ev.try_wait() );
+
+    ev.set();
+    BOOST_CHECK( ev.try_wait() );
+    // signal was consumed by try_wait()
+    BOOST_CHECK( ! ev.try_wait() );
+
+    boost::fibers::auto_reset_event ev_set( true);
+    BOOST_CHECK( ev_set.try_wait() );
+    BOOST_CHECK( ! ev_set.try_wait() );
+}
+
+void test_case_2()
+{
+    boost::fibers::round_robin ds;
+    boost::fibers::scheduling_algorithm( & ds);
+
+    value = 0;
+    boost::fibers::auto_reset_event ev;
+
+    // signal set before any fiber waits is not lost
+    ev.set();
+    boost::fibers::fiber s1(
+        boost::bind( wait_fn, boost::ref( ev) ) );
+    BOOST_CHECK_EQUAL( 1, value);
+    BOOST_CHECK( ! ev.try_wait() );
+    s1.join();
+}
+
+void test_case_3()
+{
+    boost::fibers::round_robin ds;
+    boost::fibers::scheduling_algorithm( & ds);
+
+    value = 0;
+    boost::fibers::auto_reset_event ev;
+
+    boost::fibers::fiber s1(
+        boost::bind( wait_fn, boost::ref( ev) ) );
+    boost::fibers::fiber s2(
+        boost::bind( wait_fn, boost::ref( ev) ) );
+    BOOST_CHECK_EQUAL( 0, value);
+
+    // each signal releases exactly one fiber
+    ev.set();
+    while ( ds.run() );
+    BOOST_CHECK_EQUAL( 1, value);
+    BOOST_CHECK( ! ev.try_wait() );
+
+    ev.set();
+    while ( ds.run() );
+    BOOST_CHECK_EQUAL( 2, value);
+    BOOST_CHECK( ! ev.try_wait() );
+
+    s1.join();
+    s2.join();
+}
+
+void test_case_4()
+{
+    boost::fibers::round_robin ds;
+    boost::fibers::scheduling_algorithm( & ds);
+
+    value = 0;
+    bool interrupted = false;
+    boost::fibers::auto_reset_event ev;
+
+    boost::fibers::fiber s1(
+        boost::bind( interrupted_wait_fn, boost::ref( ev), boost::ref( interrupted) ) );
+    boost::fibers::fiber s2(
+        boost::bind( wait_fn, boost::ref( ev) ) );
+
+    s1.interrupt();
+    s1.join();
+    BOOST_CHECK( interrupted);
+
+    // the interrupted fiber must not swallow the signal
+    ev.set();
+    s2.join();
+    BOOST_CHECK_EQUAL( 1, value);
+    BOOST_CHECK( ! ev.try_wait() );
+}
+
+boost::atomic< int > counter( 0);
+
+void worker_fn( boost::fibers::auto_reset_event * ev, int n)
+{
+    boost::fibers::round_robin ds;
+    boost::fibers::scheduling_algorithm( & ds);
+
+    for ( int i = 0; i < n; ++i)
+    {
+        ev->wait();
+        ++counter;
+    }
+}
+
+void test_case_5()
+{
+    counter = 0;
+    boost::fibers::auto_reset_event ev;
+
+    boost::thread t( boost::bind( worker_fn, & ev, 1000) );
+    while ( counter < 1000)
+    {
+        ev.set();
+        boost::this_thread::yield();
+    }
+    t.join();
+    BOOST_CHECK_EQUAL( 1000, counter);
+}
+
+boost::unit_test::test_suite * init_unit_test_suite( int, char* [])
+{
+    boost::unit_test::test_suite * test =
+        BOOST_TEST_SUITE("Boost.Fiber: auto_reset_event test suite");
+
+    test->add( BOOST_TEST_CASE( & test_case_1) );
+    test->add( BOOST_TEST_CASE( & test_case_2) );
+    test->add( BOOST_TEST_CASE( & test_case_3) );
+    test->add( BOOST_TEST_CASE( & test_case_4) );
+    test->add( BOOST_TEST_CASE( & test_case_5) );
+
+    return test;
+}
@@ -6,8 +6,14 @@
 
 #include <sstream>
 #include <string>
+#include <vector>
 
+#include <boost/atomic.hpp>
+#include <boost/bind.hpp>
+#include <boost/ref.hpp>
+#include <boost/shared_ptr.hpp>
 #include <boost/test/unit_test.hpp>
+#include <boost/thread.hpp>
 #include <boost/utility.hpp>
 
 #include <boost/fiber/all.hpp>
@@ -75,12 +81,90 @@ void test_barrier()
     BOOST_CHECK_EQUAL( 5, value2);
 }
 
+boost::atomic< int > arrived( 0);
+boost::atomic< int > serial( 0);
+boost::atomic< bool > in_phase( true);
+
+void rounds_fn( boost::fibers::barrier & b, int rounds, int n)
+{
+    for ( int i = 0; i < rounds; ++i)
+    {
+        ++arrived;
+        if ( b.wait() ) ++serial;
+        // no fiber leaves the barrier before all have arrived
+        if ( arrived.load() < ( i + 1) * n) in_phase = false;
+        b.wait();
+    }
+}
+
+void test_barrier_rounds()
+{
+    boost::fibers::round_robin ds;
+    boost::fibers::scheduling_algorithm( & ds);
+
+    arrived = 0;
+    serial = 0;
+    in_phase = true;
+
+    boost::fibers::barrier b( 10);
+    std::vector< boost::shared_ptr< boost::fibers::fiber > > v;
+    for ( int i = 0; i < 10; ++i)
+        v.push_back(
+            boost::shared_ptr< boost::fibers::fiber >(
+                new boost::fibers::fiber(
+                    boost::bind( rounds_fn, boost::ref( b), 5, 10) ) ) );
+    for ( int i = 0; i < 10; ++i)
+        v[i]->join();
+
+    BOOST_CHECK_EQUAL( 50, arrived.load() );
+    BOOST_CHECK_EQUAL( 5, serial.load() );
+    BOOST_CHECK( in_phase);
+}
+
+void thread_fn( boost::fibers::barrier * b, int fibers, int rounds, int n)
+{
+    boost::fibers::round_robin ds;
+    boost::fibers::scheduling_algorithm( & ds);
+
+    std::vector< boost::shared_ptr< boost::fibers::fiber > > v;
+    for ( int i = 0; i < fibers; ++i)
+        v.push_back(
+            boost::shared_ptr< boost::fibers::fiber >(
+                new boost::fibers::fiber(
+                    boost::bind( rounds_fn, boost::ref( * b), rounds, n) ) ) );
+    for ( int i = 0; i < fibers; ++i)
+        v[i]->join();
+}
+
+void test_barrier_threads()
+{
+    arrived = 0;
+    serial = 0;
+    in_phase = true;
+
+    boost::fibers::barrier b( 40);
+    boost::thread t1( boost::bind( thread_fn, & b, 10, 20, 40) );
+    boost::thread t2( boost::bind( thread_fn, & b, 10, 20, 40) );
+    boost::thread t3( boost::bind( thread_fn, & b, 10, 20, 40) );
+    boost::thread t4( boost::bind( thread_fn, & b, 10, 20, 40) );
+    t1.join();
+    t2.join();
+    t3.join();
+    t4.join();
+
+    BOOST_CHECK_EQUAL( 800, arrived.load() );
+    BOOST_CHECK_EQUAL( 20, serial.load() );
+    BOOST_CHECK( in_phase);
+}
+
 boost::unit_test::test_suite * init_unit_test_suite( int, char* [])
 {
     boost::unit_test::test_suite * test =
         BOOST_TEST_SUITE("Boost.Fiber: barrier test suite");
 
     test->add( BOOST_TEST_CASE( & test_barrier) );
+    test->add( BOOST_TEST_CASE( & test_barrier_rounds) );
+    test->add( BOOST_TEST_CASE( & test_barrier_threads) );
 
     return test;
 }
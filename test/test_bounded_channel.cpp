@@ -0,0 +1,431 @@
+//          Copyright Oliver Kowalke 2009.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include <iterator>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <boost/bind.hpp>
+#include <boost/chrono/system_clocks.hpp>
+#include <boost/cstdint.hpp>
+#include <boost/optional.hpp>
+#include <boost/ref.hpp>
+#include <boost/test/unit_test.hpp>
+#include <boost/thread.hpp>
+#include <boost/utility.hpp>
+
+#include <boost/fiber/all.hpp>
+
+typedef boost::fibers::bounded_channel< int >   channel_t;
+
+void producer_fn( channel_t & ch, int n)
+{
+    for ( int i = 0; i < n; ++i)
+        ch.put( i);
+}
+
+void consumer_fn( channel_t & ch, int & sum, int & count)
+{
+    channel_t::value_type va;
+    while ( ch.take( va) )
+    {
+        sum += * va;
+        ++count;
+    }
+}
+
+void test_case_1()
+{
+    channel_t ch( 3);
+    BOOST_CHECK_EQUAL( std::size_t( 3), ch.upper_bound() );
+    BOOST_CHECK( ch.empty() );
+
+    // wrap around the ring-buffer several times
+    channel_t::value_type va;
+    for ( int i = 0; i < 10; ++i)
+    {
+        ch.put( 2 * i);
+        ch.put( 2 * i + 1);
+        BOOST_CHECK( ! ch.empty() );
+        BOOST_CHECK( ch.try_take( va) );
+        BOOST_CHECK_EQUAL( 2 * i, * va);
+        BOOST_CHECK( ch.take( va) );
+        BOOST_CHECK_EQUAL( 2 * i + 1, * va);
+    }
+    BOOST_CHECK( ch.empty() );
+    BOOST_CHECK( ! ch.try_take( va) );
+
+    ch.put( 42);
+    ch.deactivate();
+    BOOST_CHECK( ! ch.active() );
+    BOOST_CHECK_THROW( ch.put( 1), boost::fibers::fiber_resource_error);
+    // remaining items are still delivered
+    BOOST_CHECK( ch.take( va) );
+    BOOST_CHECK_EQUAL( 42, * va);
+    BOOST_CHECK( ! ch.take( va) );
+}
+
+void test_case_2()
+{
+    BOOST_CHECK_THROW( channel_t( 0), boost::fibers::invalid_argument);
+    BOOST_CHECK_THROW( channel_t( 2, 3), boost::fibers::invalid_argument);
+}
+
+void test_case_3()
+{
+    boost::fibers::round_robin ds;
+    boost::fibers::scheduling_algorithm( & ds);
+
+    // producer blocks on the full channel
+    channel_t ch( 2);
+    int sum = 0, count = 0;
+    boost::fibers::fiber p( boost::bind( producer_fn, boost::ref( ch), 100) );
+    BOOST_CHECK( ! ch.empty() );
+    boost::fibers::fiber c(
+        boost::bind( consumer_fn, boost::ref( ch), boost::ref( sum), boost::ref( count) ) );
+    p.join();
+    ch.deactivate();
+    c.join();
+    BOOST_CHECK_EQUAL( 100, count);
+    BOOST_CHECK_EQUAL( 4950, sum);
+}
+
+void thread_producer_fn( channel_t * ch, int n)
+{
+    boost::fibers::round_robin ds;
+    boost::fibers::scheduling_algorithm( & ds);
+
+    boost::fibers::fiber p( boost::bind( producer_fn, boost::ref( * ch), n) );
+    p.join();
+}
+
+void thread_consumer_fn( channel_t * ch, int * sum, int * count)
+{
+    boost::fibers::round_robin ds;
+    boost::fibers::scheduling_algorithm( & ds);
+
+    boost::fibers::fiber c(
+        boost::bind( consumer_fn, boost::ref( * ch), boost::ref( * sum), boost::ref( * count) ) );
+    c.join();
+}
+
+void test_case_4()
+{
+    channel_t ch( 16, 4);
+    int sum = 0, count = 0;
+    boost::thread c( boost::bind( thread_consumer_fn, & ch, & sum, & count) );
+    boost::thread p( boost::bind( thread_producer_fn, & ch, 10000) );
+    p.join();
+    ch.deactivate();
+    c.join();
+    BOOST_CHECK_EQUAL( 10000, count);
+    BOOST_CHECK_EQUAL( 49995000, sum);
+}
+
+void many_fn( std::size_t hwm, std::size_t lwm)
+{
+    boost::fibers::round_robin ds;
+    boost::fibers::scheduling_algorithm( & ds);
+
+    // several producers and consumers wait at the same time
+    channel_t ch( hwm, lwm);
+    int sum[4] = { 0, 0, 0, 0 }, count[4] = { 0, 0, 0, 0 };
+    boost::fibers::fiber c1(
+        boost::bind( consumer_fn, boost::ref( ch), boost::ref( sum[0]), boost::ref( count[0]) ) );
+    boost::fibers::fiber c2(
+        boost::bind( consumer_fn, boost::ref( ch), boost::ref( sum[1]), boost::ref( count[1]) ) );
+    boost::fibers::fiber c3(
+        boost::bind( consumer_fn, boost::ref( ch), boost::ref( sum[2]), boost::ref( count[2]) ) );
+    boost::fibers::fiber c4(
+        boost::bind( consumer_fn, boost::ref( ch), boost::ref( sum[3]), boost::ref( count[3]) ) );
+    boost::fibers::fiber p1( boost::bind( producer_fn, boost::ref( ch), 1000) );
+    boost::fibers::fiber p2( boost::bind( producer_fn, boost::ref( ch), 1000) );
+    boost::fibers::fiber p3( boost::bind( producer_fn, boost::ref( ch), 1000) );
+    boost::fibers::fiber p4( boost::bind( producer_fn, boost::ref( ch), 1000) );
+    p1.join();
+    p2.join();
+    p3.join();
+    p4.join();
+    ch.deactivate();
+    c1.join();
+    c2.join();
+    c3.join();
+    c4.join();
+    BOOST_CHECK_EQUAL( 4000, count[0] + count[1] + count[2] + count[3]);
+    BOOST_CHECK_EQUAL( 4 * 499500, sum[0] + sum[1] + sum[2] + sum[3]);
+}
+
+void test_case_5()
+{
+    many_fn( 2, 2);
+    many_fn( 8, 2);
+}
+
+void test_case_6()
+{
+    channel_t ch( 4, 2);
+    int items[] = { 0, 1, 2, 3, 4, 5 };
+    std::vector< int > vec;
+
+    ch.put_n( items, items + 3);
+    BOOST_CHECK_EQUAL( std::size_t( 2), ch.take_n( std::back_inserter( vec), 2) );
+    BOOST_CHECK_EQUAL( std::size_t( 1), ch.take_n( std::back_inserter( vec), 8) );
+    BOOST_CHECK( ch.empty() );
+    BOOST_CHECK_EQUAL( std::size_t( 0), ch.drain( std::back_inserter( vec) ) );
+
+    // wrap around the ring-buffer
+    ch.put_n( items + 3, items + 6);
+    BOOST_CHECK_EQUAL( std::size_t( 3), ch.drain( std::back_inserter( vec) ) );
+    BOOST_CHECK( ch.empty() );
+    BOOST_CHECK_EQUAL( std::size_t( 6), vec.size() );
+    for ( int i = 0; i < 6; ++i)
+        BOOST_CHECK_EQUAL( i, vec[i]);
+
+    ch.put_n( items, items + 2);
+    ch.deactivate();
+    BOOST_CHECK_THROW( ch.put_n( items, items + 1), boost::fibers::fiber_resource_error);
+    // remaining items are still delivered
+    BOOST_CHECK_EQUAL( std::size_t( 2), ch.take_n( std::back_inserter( vec), 8) );
+    BOOST_CHECK_EQUAL( std::size_t( 0), ch.take_n( std::back_inserter( vec), 8) );
+}
+
+void batch_producer_fn( channel_t & ch, int n)
+{
+    std::vector< int > vec;
+    for ( int i = 0; i < n; ++i)
+        vec.push_back( i);
+    ch.put_n( vec.begin(), vec.end() );
+}
+
+void batch_consumer_fn( channel_t & ch, int & sum, int & count)
+{
+    std::vector< int > vec;
+    while ( 0 < ch.take_n( std::back_inserter( vec), 7) );
+    for ( std::size_t i = 0; i < vec.size(); ++i)
+        sum += vec[i];
+    count += static_cast< int >( vec.size() );
+}
+
+void test_case_7()
+{
+    boost::fibers::round_robin ds;
+    boost::fibers::scheduling_algorithm( & ds);
+
+    // batches larger than the channel, several consumers
+    channel_t ch( 16, 4);
+    int sum[3] = { 0, 0, 0 }, count[3] = { 0, 0, 0 };
+    boost::fibers::fiber c1(
+        boost::bind( batch_consumer_fn, boost::ref( ch), boost::ref( sum[0]), boost::ref( count[0]) ) );
+    boost::fibers::fiber c2(
+        boost::bind( batch_consumer_fn, boost::ref( ch), boost::ref( sum[1]), boost::ref( count[1]) ) );
+    boost::fibers::fiber c3(
+        boost::bind( consumer_fn, boost::ref( ch), boost::ref( sum[2]), boost::ref( count[2]) ) );
+    boost::fibers::fiber p1( boost::bind( batch_producer_fn, boost::ref( ch), 1000) );
+    boost::fibers::fiber p2( boost::bind( batch_producer_fn, boost::ref( ch), 1000) );
+    p1.join();
+    p2.join();
+    ch.deactivate();
+    c1.join();
+    c2.join();
+    c3.join();
+    BOOST_CHECK_EQUAL( 2000, count[0] + count[1] + count[2]);
+    BOOST_CHECK_EQUAL( 2 * 499500, sum[0] + sum[1] + sum[2]);
+}
+
+#ifndef BOOST_NO_RVALUE_REFERENCES
+void move_fn()
+{
+    // move-only items
+    boost::fibers::bounded_channel< std::unique_ptr< int > > ch( 4);
+    std::unique_ptr< int > p( new int( 1) );
+    ch.put( std::move( p) );
+    BOOST_CHECK( ! p);
+#ifndef BOOST_NO_VARIADIC_TEMPLATES
+    ch.emplace( new int( 2) );
+#else
+    ch.put( std::unique_ptr< int >( new int( 2) ) );
+#endif
+    boost::optional< std::unique_ptr< int > > va( ch.take() );
+    BOOST_CHECK( va);
+    BOOST_CHECK_EQUAL( 1, * * va);
+    BOOST_CHECK( ch.take( va) );
+    BOOST_CHECK_EQUAL( 2, * * va);
+
+    // items are not copied
+    boost::fibers::bounded_channel< std::string > str_ch( 4);
+    std::string str( 64, 'a');
+    char const* data = str.data();
+    str_ch.put( std::move( str) );
+#ifndef BOOST_NO_VARIADIC_TEMPLATES
+    str_ch.emplace( std::size_t( 3), 'b');
+#else
+    str_ch.put( std::string( 3, 'b') );
+#endif
+    boost::optional< std::string > s( str_ch.take() );
+    BOOST_CHECK( s);
+    BOOST_CHECK_EQUAL( data, s->data() );
+    s = str_ch.take();
+    BOOST_CHECK_EQUAL( std::string( "bbb"), * s);
+
+    str_ch.deactivate();
+    BOOST_CHECK( ! str_ch.take() );
+}
+#endif
+
+void test_case_8()
+{
+#ifndef BOOST_NO_RVALUE_REFERENCES
+    boost::fibers::round_robin ds;
+    boost::fibers::scheduling_algorithm( & ds);
+
+    boost::fibers::fiber f( move_fn);
+    f.join();
+#endif
+}
+
+void delayed_put_fn( channel_t & ch, int i, boost::chrono::milliseconds const& ms)
+{
+    boost::chrono::system_clock::time_point abs_time(
+        boost::chrono::system_clock::now() + ms);
+    while ( boost::chrono::system_clock::now() < abs_time)
+        boost::this_fiber::yield();
+    ch.put( i);
+}
+
+void timed_fn()
+{
+    channel_t ch( 1);
+    channel_t::value_type va;
+
+    // empty channel
+    boost::chrono::system_clock::time_point abs_time(
+        boost::chrono::system_clock::now() + boost::chrono::milliseconds( 20) );
+    BOOST_CHECK( ! ch.take_until( va, abs_time) );
+    BOOST_CHECK( boost::chrono::system_clock::now() >= abs_time);
+    BOOST_CHECK( ch.active() );
+
+    // full channel
+    BOOST_CHECK( ch.put_for( 1, boost::chrono::milliseconds( 10) ) );
+    BOOST_CHECK( ! ch.put_for( 2, boost::chrono::milliseconds( 10) ) );
+    BOOST_CHECK( ch.take_for( va, boost::chrono::milliseconds( 10) ) );
+    BOOST_CHECK_EQUAL( 1, * va);
+
+    // periodic flushing while waiting for items
+    boost::fibers::fiber p(
+        boost::bind( delayed_put_fn, boost::ref( ch), 3, boost::chrono::milliseconds( 50) ) );
+    int timeouts = 0;
+    while ( ! ch.take_for( va, boost::chrono::milliseconds( 5) ) )
+        ++timeouts;
+    BOOST_CHECK_EQUAL( 3, * va);
+    BOOST_CHECK( 0 < timeouts);
+    p.join();
+
+    ch.deactivate();
+    BOOST_CHECK( ! ch.take_for( va, boost::chrono::milliseconds( 10) ) );
+    BOOST_CHECK_THROW( ch.put_for( 1, boost::chrono::milliseconds( 10) ), boost::fibers::fiber_resource_error);
+}
+
+void test_case_9()
+{
+    boost::fibers::round_robin ds;
+    boost::fibers::scheduling_algorithm( & ds);
+
+    boost::fibers::fiber f( timed_fn);
+    f.join();
+}
+
+typedef boost::fibers::bounded_channel<
+    int, boost::fibers::channel_statistics
+> stats_channel_t;
+
+void stats_producer_fn( stats_channel_t & ch, int n)
+{
+    for ( int i = 0; i < n; ++i)
+        ch.put( i);
+    ch.deactivate();
+}
+
+void stats_consumer_fn( stats_channel_t & ch, int & count)
+{
+    stats_channel_t::value_type va;
+    while ( ch.take( va) )
+    {
+        ++count;
+        boost::this_fiber::yield();
+    }
+}
+
+boost::uint64_t sum_histogram( boost::fibers::channel_statistics::wait_snapshot const& w)
+{
+    boost::uint64_t sum = 0;
+    for ( std::size_t i = 0; i < boost::fibers::channel_statistics::histogram_size; ++i)
+        sum += w.histogram[i];
+    return sum;
+}
+
+void test_case_10()
+{
+    boost::fibers::round_robin ds;
+    boost::fibers::scheduling_algorithm( & ds);
+
+    stats_channel_t ch( 5);
+    boost::fibers::channel_statistics::snapshot s( ch.statistics().get_snapshot() );
+    BOOST_CHECK_EQUAL( boost::uint64_t( 0), s.puts);
+    BOOST_CHECK_EQUAL( std::size_t( 0), s.depth);
+
+    int count = 0;
+    boost::fibers::fiber c( boost::bind( stats_consumer_fn, boost::ref( ch), boost::ref( count) ) );
+    boost::fibers::fiber p( boost::bind( stats_producer_fn, boost::ref( ch), 50) );
+    p.join();
+    c.join();
+    BOOST_CHECK_EQUAL( 50, count);
+
+    s = ch.statistics().get_snapshot();
+    BOOST_CHECK_EQUAL( boost::uint64_t( 50), s.puts);
+    BOOST_CHECK_EQUAL( boost::uint64_t( 50), s.takes);
+    BOOST_CHECK_EQUAL( std::size_t( 0), s.depth);
+    BOOST_CHECK_EQUAL( std::size_t( 5), s.max_depth);
+    // the slow consumer makes the producer wait on a full channel
+    BOOST_CHECK( 0 < s.producers.count);
+    BOOST_CHECK_EQUAL( s.producers.count, sum_histogram( s.producers) );
+    BOOST_CHECK( s.producers.total >= s.producers.max);
+    // the consumer started on an empty channel
+    BOOST_CHECK( 0 < s.consumers.count);
+    BOOST_CHECK_EQUAL( s.consumers.count, sum_histogram( s.consumers) );
+
+    // batched operations are counted per item
+    stats_channel_t ch2( 10);
+    std::vector< int > vec( 7, 1);
+    ch2.put_n( vec.begin(), vec.end() );
+    std::vector< int > out;
+    BOOST_CHECK_EQUAL( std::size_t( 3), ch2.take_n( std::back_inserter( out), 3) );
+    s = ch2.statistics().get_snapshot();
+    BOOST_CHECK_EQUAL( boost::uint64_t( 7), s.puts);
+    BOOST_CHECK_EQUAL( boost::uint64_t( 3), s.takes);
+    BOOST_CHECK_EQUAL( std::size_t( 4), s.depth);
+    BOOST_CHECK_EQUAL( std::size_t( 7), s.max_depth);
+    BOOST_CHECK_EQUAL( boost::uint64_t( 0), s.producers.count);
+    BOOST_CHECK_EQUAL( boost::uint64_t( 0), s.consumers.count);
+}
+
+boost::unit_test::test_suite * init_unit_test_suite( int, char* [])
+{
+    boost::unit_test::test_suite * test =
+        BOOST_TEST_SUITE("Boost.Fiber: bounded_channel test suite");
+
+    test->add( BOOST_TEST_CASE( & test_case_1) );
+    test->add( BOOST_TEST_CASE( & test_case_2) );
+    test->add( BOOST_TEST_CASE( & test_case_3) );
+    test->add( BOOST_TEST_CASE( & test_case_4) );
+    test->add( BOOST_TEST_CASE( & test_case_5) );
+    test->add( BOOST_TEST_CASE( & test_case_6) );
+    test->add( BOOST_TEST_CASE( & test_case_7) );
+    test->add( BOOST_TEST_CASE( & test_case_8) );
+    test->add( BOOST_TEST_CASE( & test_case_9) );
+    test->add( BOOST_TEST_CASE( & test_case_10) );
+
+    return test;
+}
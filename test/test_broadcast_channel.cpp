@@ -0,0 +1,222 @@
+//          Copyright Oliver Kowalke 2009.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <boost/bind.hpp>
+#include <boost/ref.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/test/unit_test.hpp>
+#include <boost/thread.hpp>
+#include <boost/utility.hpp>
+
+#include <boost/fiber/all.hpp>
+
+typedef boost::fibers::broadcast_channel< int > channel_t;
+
+void publisher_fn( channel_t & ch, int n)
+{
+    for ( int i = 0; i < n; ++i)
+        ch.put( i);
+    ch.deactivate();
+}
+
+void subscriber_fn( channel_t::subscriber & sub, std::vector< int > & vec, bool slow)
+{
+    channel_t::value_type va;
+    while ( sub.take( va) )
+    {
+        vec.push_back( * va);
+        if ( slow) boost::this_fiber::yield();
+    }
+}
+
+void test_case_1()
+{
+    typedef boost::fibers::broadcast_channel< std::string > string_channel_t;
+
+    string_channel_t ch( 4);
+    BOOST_CHECK_EQUAL( std::size_t( 4), ch.capacity() );
+    BOOST_CHECK_EQUAL( boost::fibers::drop_oldest, ch.policy() );
+    BOOST_CHECK( ch.active() );
+
+    string_channel_t::subscriber sub1( ch);
+    ch.put( std::string("abc") );
+    string_channel_t::subscriber sub2( ch);
+    BOOST_CHECK_EQUAL( std::size_t( 2), ch.subscribers() );
+    ch.put( std::string("xyz") );
+
+    // subscribers receive the messages put after their construction
+    string_channel_t::value_type va1, va2;
+    BOOST_CHECK( sub1.try_take( va1) );
+    BOOST_CHECK_EQUAL( std::string("abc"), * va1);
+    BOOST_CHECK( sub1.try_take( va1) );
+    BOOST_CHECK( sub2.try_take( va2) );
+    BOOST_CHECK_EQUAL( std::string("xyz"), * va2);
+    // the payload is shared, not copied
+    BOOST_CHECK_EQUAL( va1.get(), va2.get() );
+    BOOST_CHECK( ! sub1.try_take( va1) );
+    BOOST_CHECK( ! sub2.try_take( va2) );
+
+    // a shared message is put without copying
+    string_channel_t::value_type msg( new std::string("123") );
+    ch.put( msg);
+    BOOST_CHECK( sub1.try_take( va1) );
+    BOOST_CHECK_EQUAL( msg.get(), va1.get() );
+
+    ch.deactivate();
+    BOOST_CHECK( ! ch.active() );
+    BOOST_CHECK( sub2.take( va2) );
+    BOOST_CHECK_EQUAL( msg.get(), va2.get() );
+    BOOST_CHECK( ! sub2.take( va2) );
+    BOOST_CHECK_THROW( ch.put( std::string("abc") ), boost::fibers::fiber_resource_error);
+}
+
+void test_case_2()
+{
+    // drop_oldest: the lagging subscriber skips the overwritten messages
+    channel_t ch1( 4);
+    channel_t::subscriber sub1( ch1);
+    for ( int i = 0; i < 10; ++i)
+        ch1.put( i);
+    channel_t::value_type va;
+    BOOST_CHECK( sub1.try_take( va) );
+    BOOST_CHECK_EQUAL( 6, * va);
+    BOOST_CHECK_EQUAL( std::size_t( 6), sub1.missed() );
+    BOOST_CHECK( sub1.connected() );
+    for ( int i = 7; i < 10; ++i)
+    {
+        BOOST_CHECK( sub1.try_take( va) );
+        BOOST_CHECK_EQUAL( i, * va);
+    }
+    BOOST_CHECK( ! sub1.try_take( va) );
+
+    // disconnect_lagging: the lagging subscriber is disconnected
+    channel_t ch2( 4, boost::fibers::disconnect_lagging);
+    channel_t::subscriber sub2( ch2);
+    channel_t::subscriber sub3( ch2);
+    for ( int i = 0; i < 4; ++i)
+        ch2.put( i);
+    BOOST_CHECK( sub3.try_take( va) );
+    BOOST_CHECK_EQUAL( 0, * va);
+    ch2.put( 4);
+    BOOST_CHECK( ! sub2.try_take( va) );
+    BOOST_CHECK( ! sub2.connected() );
+    BOOST_CHECK( ! sub2.take( va) );
+    BOOST_CHECK( sub3.try_take( va) );
+    BOOST_CHECK_EQUAL( 1, * va);
+    BOOST_CHECK( sub3.connected() );
+}
+
+void test_case_3()
+{
+    boost::fibers::round_robin ds;
+    boost::fibers::scheduling_algorithm( & ds);
+
+    // block_publisher: the publisher waits for the slowest subscriber
+    channel_t ch( 2, boost::fibers::block_publisher);
+    channel_t::subscriber fast( ch), slow( ch);
+    std::vector< int > vec1, vec2;
+
+    boost::fibers::fiber s1( boost::bind( subscriber_fn, boost::ref( fast), boost::ref( vec1), false) );
+    boost::fibers::fiber s2( boost::bind( subscriber_fn, boost::ref( slow), boost::ref( vec2), true) );
+    boost::fibers::fiber p( boost::bind( publisher_fn, boost::ref( ch), 100) );
+    p.join();
+    s1.join();
+    s2.join();
+
+    BOOST_REQUIRE_EQUAL( std::size_t( 100), vec1.size() );
+    BOOST_REQUIRE_EQUAL( std::size_t( 100), vec2.size() );
+    for ( int i = 0; i < 100; ++i)
+    {
+        BOOST_CHECK_EQUAL( i, vec1[i]);
+        BOOST_CHECK_EQUAL( i, vec2[i]);
+    }
+    BOOST_CHECK_EQUAL( std::size_t( 0), slow.missed() );
+}
+
+void test_case_4()
+{
+    boost::fibers::round_robin ds;
+    boost::fibers::scheduling_algorithm( & ds);
+
+    // fan-out to many waiting subscribers
+    int const subscribers = 50;
+    channel_t ch( 16, boost::fibers::block_publisher);
+    std::vector< boost::shared_ptr< channel_t::subscriber > > subs;
+    std::vector< std::vector< int > > vecs( subscribers);
+    std::vector< boost::shared_ptr< boost::fibers::fiber > > fibers;
+    for ( int i = 0; i < subscribers; ++i)
+    {
+        subs.push_back( boost::shared_ptr< channel_t::subscriber >( new channel_t::subscriber( ch) ) );
+        fibers.push_back( boost::shared_ptr< boost::fibers::fiber >(
+            new boost::fibers::fiber(
+                boost::bind( subscriber_fn, boost::ref( * subs[i]), boost::ref( vecs[i]), false) ) ) );
+    }
+    boost::fibers::fiber p( boost::bind( publisher_fn, boost::ref( ch), 200) );
+    p.join();
+    for ( int i = 0; i < subscribers; ++i)
+    {
+        fibers[i]->join();
+        BOOST_CHECK_EQUAL( std::size_t( 200), vecs[i].size() );
+    }
+}
+
+void thread_subscriber_fn( channel_t * ch, std::vector< int > * vec)
+{
+    boost::fibers::round_robin ds;
+    boost::fibers::scheduling_algorithm( & ds);
+
+    channel_t::subscriber sub( * ch);
+    boost::fibers::fiber s( boost::bind( subscriber_fn, boost::ref( sub), boost::ref( * vec), false) );
+    s.join();
+}
+
+void thread_publisher_fn( channel_t * ch, int n)
+{
+    boost::fibers::round_robin ds;
+    boost::fibers::scheduling_algorithm( & ds);
+
+    while ( 2 != ch->subscribers() )
+        boost::this_thread::yield();
+    boost::fibers::fiber p( boost::bind( publisher_fn, boost::ref( * ch), n) );
+    p.join();
+}
+
+void test_case_5()
+{
+    channel_t ch( 8, boost::fibers::block_publisher);
+    std::vector< int > vec1, vec2;
+    boost::thread s1( boost::bind( thread_subscriber_fn, & ch, & vec1) );
+    boost::thread s2( boost::bind( thread_subscriber_fn, & ch, & vec2) );
+    boost::thread p( boost::bind( thread_publisher_fn, & ch, 1000) );
+    p.join();
+    s1.join();
+    s2.join();
+
+    BOOST_REQUIRE_EQUAL( std::size_t( 1000), vec1.size() );
+    BOOST_REQUIRE_EQUAL( std::size_t( 1000), vec2.size() );
+    for ( int i = 0; i < 1000; ++i)
+    {
+        BOOST_CHECK_EQUAL( i, vec1[i]);
+        BOOST_CHECK_EQUAL( i, vec2[i]);
+    }
+}
+
+boost::unit_test::test_suite * init_unit_test_suite( int, char* [])
+{
+    boost::unit_test::test_suite * test =
+        BOOST_TEST_SUITE("Boost.Fiber: broadcast_channel test suite");
+
+    test->add( BOOST_TEST_CASE( & test_case_1) );
+    test->add( BOOST_TEST_CASE( & test_case_2) );
+    test->add( BOOST_TEST_CASE( & test_case_3) );
+    test->add( BOOST_TEST_CASE( & test_case_4) );
+    test->add( BOOST_TEST_CASE( & test_case_5) );
+
+    return test;
+}
@@ -354,6 +354,60 @@ void test_condition_waits()
     do_test_condition_waits();
 }
 
+void timed_wait_fn( boost::fibers::mutex & mtx, boost::fibers::condition & cond, bool & notified)
+{
+    boost::unique_lock< boost::fibers::mutex > lk( mtx);
+    notified = cond.timed_wait( lk, boost::chrono::seconds( 5) );
+    BOOST_CHECK( lk ? true : false);
+}
+
+void do_test_condition_timed_wait()
+{
+    boost::fibers::mutex mtx;
+    boost::fibers::condition cond;
+
+    // deadline expires
+    {
+        boost::unique_lock< boost::fibers::mutex > lk( mtx);
+        boost::chrono::system_clock::time_point abs_time( delay( 0, 50) );
+        BOOST_CHECK( ! cond.timed_wait( lk, abs_time) );
+        BOOST_CHECK( boost::chrono::system_clock::now() >= abs_time);
+        BOOST_CHECK( lk ? true : false);
+        BOOST_CHECK( ! cond.timed_wait( lk, boost::chrono::milliseconds( 10) ) );
+        value = 0;
+        BOOST_CHECK( ! cond.timed_wait(
+            lk, boost::chrono::milliseconds( 10), cond_predicate( value, 1) ) );
+        value = 1;
+        BOOST_CHECK( cond.timed_wait(
+            lk, boost::chrono::milliseconds( 10), cond_predicate( value, 1) ) );
+    }
+
+    // notified before the deadline
+    bool notified = false;
+    boost::fibers::fiber s1(
+            boost::bind(
+                timed_wait_fn,
+                boost::ref( mtx),
+                boost::ref( cond),
+                boost::ref( notified) ) );
+    boost::fibers::fiber s2(
+            boost::bind(
+                notify_one_fn,
+                boost::ref( cond) ) );
+    s1.join();
+    s2.join();
+    BOOST_CHECK( notified);
+}
+
+void test_condition_timed_wait()
+{
+    boost::fibers::round_robin ds;
+    boost::fibers::scheduling_algorithm( & ds);
+
+    boost::fibers::fiber f( do_test_condition_timed_wait);
+    f.join();
+}
+
 boost::unit_test::test_suite * init_unit_test_suite( int, char* [])
 {
     boost::unit_test::test_suite * test =
@@ -363,6 +417,7 @@ boost::unit_test::test_suite * init_unit_test_suite( int, char* [])
     test->add( BOOST_TEST_CASE( & test_two_waiter_notify_one) );
     test->add( BOOST_TEST_CASE( & test_two_waiter_notify_all) );
     test->add( BOOST_TEST_CASE( & test_condition_waits) );
+    test->add( BOOST_TEST_CASE( & test_condition_timed_wait) );
     test->add(  BOOST_TEST_CASE( & test_condition_wait_is_a_interruption_point) );
 
 	return test;
@@ -0,0 +1,224 @@
+//          Copyright Oliver Kowalke 2009.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include <boost/atomic.hpp>
+#include <boost/bind.hpp>
+#include <boost/chrono.hpp>
+#include <boost/ref.hpp>
+#include <boost/test/unit_test.hpp>
+#include <boost/thread.hpp>
+#include <boost/utility.hpp>
+
+#include <boost/fiber/all.hpp>
+
+int value = 0;
+
+void acquire_fn( boost::fibers::counting_semaphore & sem)
+{
+    sem.acquire();
+    ++value;
+}
+
+void timed_acquire_fn( boost::fibers::counting_semaphore & sem, bool & acquired)
+{ acquired = sem.try_acquire_for( boost::chrono::milliseconds( 50) ); }
+
+void long_acquire_fn( boost::fibers::counting_semaphore & sem, int n, int & acquired)
+{
+    for ( int i = 0; i < n; ++i)
+        if ( sem.try_acquire_for( boost::chrono::seconds( 10) ) ) ++acquired;
+}
+
+void release_fn( boost::fibers::counting_semaphore & sem, int n)
+{
+    for ( int i = 0; i < n; ++i)
+    {
+        boost::this_fiber::yield();
+        sem.release();
+    }
+}
+
+void late_release_fn( boost::fibers::counting_semaphore & sem)
+{
+    // blocks the thread beyond the deadline of the waiter
+    boost::this_thread::sleep_for( boost::chrono::milliseconds( 100) );
+    sem.release();
+}
+
+void interrupted_acquire_fn( boost::fibers::counting_semaphore & sem, bool & interrupted)
+{
+    try
+    { sem.acquire(); }
+    catch ( boost::fibers::fiber_interrupted const&)
+    { interrupted = true; }
+}
+
+void test_case_1()
+{
+    boost::fibers::counting_semaphore sem( 2);
+    BOOST_CHECK( sem.try_acquire() );
+    BOOST_CHECK( sem.try_acquire() );
+    BOOST_CHECK( ! sem.try_acquire() );
+
+    sem.release( 3);
+    BOOST_CHECK( sem.try_acquire() );
+    BOOST_CHECK( sem.try_acquire() );
+    BOOST_CHECK( sem.try_acquire() );
+    BOOST_CHECK( ! sem.try_acquire() );
+}
+
+void test_case_2()
+{
+    boost::fibers::round_robin ds;
+    boost::fibers::scheduling_algorithm( & ds);
+
+    value = 0;
+    boost::fibers::counting_semaphore sem;
+
+    boost::fibers::fiber s1(
+        boost::bind( acquire_fn, boost::ref( sem) ) );
+    boost::fibers::fiber s2(
+        boost::bind( acquire_fn, boost::ref( sem) ) );
+    boost::fibers::fiber s3(
+        boost::bind( acquire_fn, boost::ref( sem) ) );
+    BOOST_CHECK_EQUAL( 0, value);
+
+    // release( n) wakes exactly n fibers
+    sem.release( 2);
+    while ( ds.run() );
+    BOOST_CHECK_EQUAL( 2, value);
+    BOOST_CHECK( ! sem.try_acquire() );
+
+    sem.release();
+    while ( ds.run() );
+    BOOST_CHECK_EQUAL( 3, value);
+    BOOST_CHECK( ! sem.try_acquire() );
+
+    s1.join();
+    s2.join();
+    s3.join();
+}
+
+void test_case_3()
+{
+    boost::fibers::round_robin ds;
+    boost::fibers::scheduling_algorithm( & ds);
+
+    boost::fibers::counting_semaphore sem;
+
+    // deadline expires
+    bool acquired = true;
+    boost::fibers::fiber s1(
+        boost::bind( timed_acquire_fn, boost::ref( sem), boost::ref( acquired) ) );
+    s1.join();
+    BOOST_CHECK( ! acquired);
+
+    // permit released before deadline
+    acquired = false;
+    boost::fibers::fiber s2(
+        boost::bind( timed_acquire_fn, boost::ref( sem), boost::ref( acquired) ) );
+    sem.release();
+    s2.join();
+    BOOST_CHECK( acquired);
+    BOOST_CHECK( ! sem.try_acquire() );
+
+    // main-fiber
+    BOOST_CHECK( ! sem.try_acquire_for( boost::chrono::milliseconds( 10) ) );
+    sem.release();
+    BOOST_CHECK( sem.try_acquire_for( boost::chrono::milliseconds( 10) ) );
+}
+
+void test_case_4()
+{
+    boost::fibers::round_robin ds;
+    boost::fibers::scheduling_algorithm( & ds);
+
+    value = 0;
+    bool interrupted = false;
+    boost::fibers::counting_semaphore sem;
+
+    boost::fibers::fiber s1(
+        boost::bind( interrupted_acquire_fn, boost::ref( sem), boost::ref( interrupted) ) );
+    boost::fibers::fiber s2(
+        boost::bind( acquire_fn, boost::ref( sem) ) );
+
+    s1.interrupt();
+    s1.join();
+    BOOST_CHECK( interrupted);
+
+    // the interrupted fiber must not swallow the permit
+    sem.release();
+    s2.join();
+    BOOST_CHECK_EQUAL( 1, value);
+    BOOST_CHECK( ! sem.try_acquire() );
+}
+
+boost::atomic< int > counter( 0);
+
+void worker_fn( boost::fibers::counting_semaphore * sem, int n)
+{
+    boost::fibers::round_robin ds;
+    boost::fibers::scheduling_algorithm( & ds);
+
+    for ( int i = 0; i < n; ++i)
+    {
+        sem->acquire();
+        ++counter;
+    }
+}
+
+void test_case_5()
+{
+    counter = 0;
+    boost::fibers::counting_semaphore sem;
+
+    boost::thread t( boost::bind( worker_fn, & sem, 1000) );
+    for ( int i = 0; i < 1000; ++i)
+        sem.release();
+    t.join();
+    BOOST_CHECK_EQUAL( 1000, counter);
+    BOOST_CHECK( ! sem.try_acquire() );
+}
+
+void test_case_6()
+{
+    boost::fibers::round_robin ds;
+    boost::fibers::scheduling_algorithm( & ds);
+
+    // the timers of acquires notified long before their
+    // deadline do not accumulate in the scheduler
+    boost::fibers::counting_semaphore sem;
+    int acquired = 0;
+    boost::fibers::fiber w( boost::bind( long_acquire_fn, boost::ref( sem), 1000, boost::ref( acquired) ) );
+    boost::fibers::fiber r( boost::bind( release_fn, boost::ref( sem), 1000) );
+    w.join();
+    r.join();
+    BOOST_CHECK_EQUAL( 1000, acquired);
+
+    // notified, but resumed after the deadline
+    bool timed_acquired = false;
+    boost::fibers::fiber w2( boost::bind( timed_acquire_fn, boost::ref( sem), boost::ref( timed_acquired) ) );
+    boost::fibers::fiber r2( boost::bind( late_release_fn, boost::ref( sem) ) );
+    w2.join();
+    r2.join();
+    BOOST_CHECK( timed_acquired);
+    BOOST_CHECK( ! sem.try_acquire() );
+
+    boost::fibers::scheduling_algorithm( 0);
+}
+
+boost::unit_test::test_suite * init_unit_test_suite( int, char* [])
+{
+    boost::unit_test::test_suite * test =
+        BOOST_TEST_SUITE("Boost.Fiber: counting_semaphore test suite");
+
+    test->add( BOOST_TEST_CASE( & test_case_1) );
+    test->add( BOOST_TEST_CASE( & test_case_2) );
+    test->add( BOOST_TEST_CASE( & test_case_3) );
+    test->add( BOOST_TEST_CASE( & test_case_4) );
+    test->add( BOOST_TEST_CASE( & test_case_5) );
+    test->add( BOOST_TEST_CASE( & test_case_6) );
+
+    return test;
+}
@@ -0,0 +1,172 @@
+//          Copyright Oliver Kowalke 2009.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include <boost/bind.hpp>
+#include <boost/ref.hpp>
+#include <boost/test/unit_test.hpp>
+#include <boost/thread.hpp>
+#include <boost/utility.hpp>
+
+#include <boost/fiber/all.hpp>
+
+int cleanups = 0;
+
+struct tracked
+{
+    int value;
+
+    explicit tracked( int v) :
+        value( v)
+    {}
+
+    ~tracked()
+    { ++cleanups; }
+};
+
+void custom_cleanup( int * p)
+{
+    cleanups += 10;
+    delete p;
+}
+
+void fss_fn( boost::fibers::fiber_specific_ptr< tracked > & fss, int v, int & result)
+{
+    BOOST_CHECK( ! fss.get() );
+    fss.reset( new tracked( v) );
+    for ( int i = 0; i < 3; ++i)
+    {
+        boost::this_fiber::yield();
+        // each fiber sees its own value
+        BOOST_CHECK_EQUAL( v, fss->value);
+    }
+    result = ( * fss).value;
+}
+
+void reset_fn( boost::fibers::fiber_specific_ptr< tracked > & fss)
+{
+    fss.reset( new tracked( 1) );
+    // replaced value is cleaned up
+    fss.reset( new tracked( 2) );
+    BOOST_CHECK_EQUAL( 1, cleanups);
+
+    // released value is not cleaned up
+    tracked * t = fss.release();
+    BOOST_CHECK( ! fss.get() );
+    BOOST_CHECK_EQUAL( 2, t->value);
+    delete t;
+    BOOST_CHECK_EQUAL( 2, cleanups);
+}
+
+void custom_fn( boost::fibers::fiber_specific_ptr< int > & fss)
+{ fss.reset( new int( 7) ); }
+
+void reuse_fn()
+{
+    {
+        boost::fibers::fiber_specific_ptr< tracked > fss1;
+        fss1.reset( new tracked( 1) );
+    }
+    BOOST_CHECK_EQUAL( 1, cleanups);
+
+    // slot of fss1 is recycled, the value of fss1 is not visible
+    boost::fibers::fiber_specific_ptr< tracked > fss2;
+    BOOST_CHECK( ! fss2.get() );
+    fss2.reset( new tracked( 2) );
+    BOOST_CHECK_EQUAL( 2, fss2->value);
+}
+
+void test_case_1()
+{
+    boost::fibers::round_robin ds;
+    boost::fibers::scheduling_algorithm( & ds);
+
+    cleanups = 0;
+    int result1 = 0, result2 = 0;
+    boost::fibers::fiber_specific_ptr< tracked > fss;
+
+    boost::fibers::fiber s1(
+        boost::bind( fss_fn, boost::ref( fss), 1, boost::ref( result1) ) );
+    boost::fibers::fiber s2(
+        boost::bind( fss_fn, boost::ref( fss), 2, boost::ref( result2) ) );
+    s1.join();
+    s2.join();
+
+    BOOST_CHECK_EQUAL( 1, result1);
+    BOOST_CHECK_EQUAL( 2, result2);
+    // values are cleaned up at fiber termination
+    BOOST_CHECK_EQUAL( 2, cleanups);
+}
+
+void test_case_2()
+{
+    boost::fibers::round_robin ds;
+    boost::fibers::scheduling_algorithm( & ds);
+
+    cleanups = 0;
+    boost::fibers::fiber_specific_ptr< tracked > fss;
+
+    boost::fibers::fiber s( boost::bind( reset_fn, boost::ref( fss) ) );
+    s.join();
+    BOOST_CHECK_EQUAL( 2, cleanups);
+}
+
+void test_case_3()
+{
+    boost::fibers::round_robin ds;
+    boost::fibers::scheduling_algorithm( & ds);
+
+    cleanups = 0;
+    boost::fibers::fiber_specific_ptr< int > fss( custom_cleanup);
+
+    boost::fibers::fiber s( boost::bind( custom_fn, boost::ref( fss) ) );
+    s.join();
+    BOOST_CHECK_EQUAL( 10, cleanups);
+}
+
+void test_case_4()
+{
+    boost::fibers::round_robin ds;
+    boost::fibers::scheduling_algorithm( & ds);
+
+    cleanups = 0;
+    boost::fibers::fiber s( reuse_fn);
+    s.join();
+    BOOST_CHECK_EQUAL( 2, cleanups);
+}
+
+void thread_get_fn( boost::fibers::fiber_specific_ptr< int > & fss, bool & null)
+{ null = 0 == fss.get(); }
+
+void test_case_5()
+{
+    boost::fibers::fiber_specific_ptr< int > fss;
+
+    // a thread without scheduler
+    bool null = false;
+    boost::thread t( boost::bind( thread_get_fn, boost::ref( fss), boost::ref( null) ) );
+    t.join();
+    BOOST_CHECK( null);
+
+    // the main fiber
+    boost::fibers::round_robin ds;
+    boost::fibers::scheduling_algorithm( & ds);
+    BOOST_CHECK( 0 == fss.get() );
+    while ( ds.run() );
+    boost::fibers::scheduling_algorithm( 0);
+}
+
+boost::unit_test::test_suite * init_unit_test_suite( int, char* [])
+{
+    boost::unit_test::test_suite * test =
+        BOOST_TEST_SUITE("Boost.Fiber: fiber_specific_ptr test suite");
+
+    test->add( BOOST_TEST_CASE( & test_case_1) );
+    test->add( BOOST_TEST_CASE( & test_case_2) );
+    test->add( BOOST_TEST_CASE( & test_case_3) );
+    test->add( BOOST_TEST_CASE( & test_case_4) );
+    test->add( BOOST_TEST_CASE( & test_case_5) );
+
+    return test;
+}
@@ -7,9 +7,11 @@
 #include <utility>
 #include <memory>
 #include <string>
+#include <vector>
 
 #include <boost/chrono/system_clocks.hpp>
 #include <boost/move/move.hpp>
+#include <boost/thread.hpp>
 #include <boost/fiber/all.hpp>
 #include <boost/test/unit_test.hpp>
 
@@ -1153,6 +1155,165 @@ void wait_for_all_five_futures()
 }
 
 
+void wait_on_shared_future(boost::fibers::shared_future<int> sf, int* result)
+{
+    *result=sf.get();
+}
+
+void several_fibers_wait_on_shared_future()
+{
+    boost::fibers::promise<int> pi;
+    boost::fibers::shared_future<int> sf(pi.get_future());
+    int results[3]={0,0,0};
+
+    boost::fibers::fiber f1(boost::bind(wait_on_shared_future,sf,&results[0]));
+    boost::fibers::fiber f2(boost::bind(wait_on_shared_future,sf,&results[1]));
+    boost::fibers::fiber f3(boost::bind(wait_on_shared_future,sf,&results[2]));
+    boost::this_fiber::yield();
+    BOOST_CHECK(!sf.is_ready());
+
+    pi.set_value(42);
+    f1.join();
+    f2.join();
+    f3.join();
+    for(int i=0;i<3;++i)
+    {
+        BOOST_CHECK_EQUAL(42,results[i]);
+    }
+}
+
+void set_promise_from_thread(boost::fibers::promise<int>* p)
+{
+    boost::this_thread::sleep_for(boost::chrono::milliseconds(10));
+    p->set_value(42);
+}
+
+void future_set_from_other_thread()
+{
+    boost::fibers::promise<int> pi;
+    boost::fibers::unique_future<int> fi(pi.get_future());
+    boost::thread t(boost::bind(set_promise_from_thread,&pi));
+    BOOST_CHECK_EQUAL(42,fi.get());
+    t.join();
+}
+
+void set_promise_after_yield(boost::fibers::promise<int>* p)
+{
+    boost::this_fiber::yield();
+    boost::this_fiber::yield();
+    p->set_value(42);
+}
+
+void wait_for_any_blocks_until_set()
+{
+    boost::fibers::promise<int> pi1,pi2;
+    boost::fibers::unique_future<int> f1(pi1.get_future());
+    boost::fibers::unique_future<int> f2(pi2.get_future());
+    boost::fibers::fiber f(boost::bind(set_promise_after_yield,&pi2));
+
+    unsigned const future=boost::fibers::waitfor_any(f1,f2);
+
+    BOOST_CHECK(future==1);
+    BOOST_CHECK(!f1.is_ready());
+    BOOST_CHECK(f2.is_ready());
+    BOOST_CHECK(f2.get()==42);
+    f.join();
+    // the waiter was removed from both futures
+    pi1.set_value(1);
+    BOOST_CHECK(f1.get()==1);
+}
+
+#ifndef BOOST_NO_RVALUE_REFERENCES
+typedef boost::fibers::unique_future<int> range_future;
+#else
+// a std::vector of the move-only unique_future needs rvalue references
+typedef boost::fibers::shared_future<int> range_future;
+#endif
+
+void when_all_becomes_ready_after_all_futures()
+{
+    boost::fibers::promise<int> p[3];
+    std::vector<range_future> futures;
+    for(int i=0;i<3;++i)
+    {
+        futures.push_back(range_future(p[i].get_future()));
+    }
+
+    boost::fibers::unique_future<std::vector<boost::fibers::shared_future<int> > > f(
+        boost::fibers::when_all(futures.begin(),futures.end()));
+#ifndef BOOST_NO_RVALUE_REFERENCES
+    // the futures are moved into the result
+    BOOST_CHECK(futures[0].get_state()==boost::fibers::future_state::uninitialized);
+#endif
+
+    p[2].set_value(2);
+    p[0].set_value(0);
+    BOOST_CHECK(!f.is_ready());
+    p[1].set_exception(boost::copy_exception(my_exception()));
+    BOOST_CHECK(f.is_ready());
+
+    std::vector<boost::fibers::shared_future<int> > results(f.get());
+    BOOST_REQUIRE_EQUAL(std::size_t(3),results.size());
+    BOOST_CHECK_EQUAL(0,results[0].get());
+    BOOST_CHECK(results[1].has_exception());
+    BOOST_CHECK_EQUAL(2,results[2].get());
+
+    std::vector<range_future> empty;
+    f=boost::fibers::when_all(empty.begin(),empty.end());
+    BOOST_CHECK(f.is_ready());
+    BOOST_CHECK(f.get().empty());
+}
+
+void when_any_becomes_ready_with_first_future()
+{
+    boost::fibers::promise<int> p[3];
+    std::vector<boost::fibers::shared_future<int> > futures;
+    for(int i=0;i<3;++i)
+    {
+        futures.push_back(boost::fibers::shared_future<int>(p[i].get_future()));
+    }
+
+    boost::fibers::unique_future<boost::fibers::when_any_result<std::vector<boost::fibers::shared_future<int> > > > f(
+        boost::fibers::when_any(futures.begin(),futures.end()));
+    BOOST_CHECK(!f.is_ready());
+    p[1].set_value(42);
+    BOOST_CHECK(f.is_ready());
+    p[0].set_value(1);
+
+    boost::fibers::when_any_result<std::vector<boost::fibers::shared_future<int> > > result(f.get());
+    BOOST_CHECK_EQUAL(std::size_t(1),result.index);
+    BOOST_REQUIRE_EQUAL(std::size_t(3),result.futures.size());
+    BOOST_CHECK_EQUAL(42,result.futures[1].get());
+    BOOST_CHECK(!result.futures[2].is_ready());
+    // shared_futures are copied
+    BOOST_CHECK_EQUAL(42,futures[1].get());
+
+    // a ready future completes the result immediately
+    f=boost::fibers::when_any(futures.begin(),futures.end());
+    BOOST_CHECK(f.is_ready());
+    BOOST_CHECK_EQUAL(std::size_t(0),f.get().index);
+}
+
+void when_all_of_many_fibers()
+{
+    int const count=1000;
+    std::vector<range_future> futures;
+    for(int i=0;i<count;++i)
+    {
+        boost::fibers::packaged_task<int> pt(boost::bind(echo,i));
+        futures.push_back(range_future(pt.get_future()));
+        boost::fibers::fiber(boost::move(pt)).detach();
+    }
+
+    std::vector<boost::fibers::shared_future<int> > results(
+        boost::fibers::when_all(futures.begin(),futures.end()).get());
+    BOOST_REQUIRE_EQUAL(std::size_t(count),results.size());
+    for(int i=0;i<count;++i)
+    {
+        BOOST_CHECK_EQUAL(i,results[i].get());
+    }
+}
+
 void test_store_value_from_thread()
 {
     boost::fibers::round_robin ds;
@@ -1581,6 +1742,206 @@ void test_future_wait()
     future_wait();
 }
 
+void test_several_fibers_wait_on_shared_future()
+{
+    boost::fibers::round_robin ds;
+    boost::fibers::scheduling_algorithm( & ds);
+
+    boost::fibers::fiber f(several_fibers_wait_on_shared_future);
+    f.join();
+}
+
+void test_future_set_from_other_thread()
+{
+    boost::fibers::round_robin ds;
+    boost::fibers::scheduling_algorithm( & ds);
+
+    future_set_from_other_thread();
+    boost::fibers::fiber f(future_set_from_other_thread);
+    f.join();
+}
+
+void test_wait_for_any_blocks_until_set()
+{
+    boost::fibers::round_robin ds;
+    boost::fibers::scheduling_algorithm( & ds);
+
+    wait_for_any_blocks_until_set();
+    boost::fibers::fiber f(wait_for_any_blocks_until_set);
+    f.join();
+}
+
+void test_when_all_becomes_ready_after_all_futures()
+{
+    boost::fibers::round_robin ds;
+    boost::fibers::scheduling_algorithm( & ds);
+
+    when_all_becomes_ready_after_all_futures();
+}
+
+void test_when_any_becomes_ready_with_first_future()
+{
+    boost::fibers::round_robin ds;
+    boost::fibers::scheduling_algorithm( & ds);
+
+    when_any_becomes_ready_with_first_future();
+}
+
+void test_when_all_of_many_fibers()
+{
+    boost::fibers::round_robin ds;
+    boost::fibers::scheduling_algorithm( & ds);
+
+    boost::fibers::fiber f(when_all_of_many_fibers);
+    f.join();
+}
+
+int async_counter = 0;
+
+int async_add( int a, int b)
+{
+    ++async_counter;
+    return a + b;
+}
+
+boost::thread::id async_thread_id()
+{ return boost::this_thread::get_id(); }
+
+int async_throw()
+{ throw std::runtime_error("async"); }
+
+int async_wait( boost::fibers::shared_future< int > f)
+{ return f.get() + 1; }
+
+void async_set( boost::fibers::promise< int > * p)
+{ p->set_value( 0); }
+
+void test_async_launch_policies()
+{
+    boost::fibers::round_robin ds;
+    boost::fibers::scheduling_algorithm( & ds);
+
+    async_counter = 0;
+    boost::fibers::unique_future< int > f1(
+        boost::fibers::async( boost::fibers::launch::post, async_add, 1, 2) );
+    // runs after the caller was suspended
+    BOOST_CHECK_EQUAL( 0, async_counter);
+    BOOST_CHECK_EQUAL( 3, f1.get() );
+
+    async_counter = 0;
+    boost::fibers::unique_future< int > f2(
+        boost::fibers::async( boost::fibers::launch::dispatch, async_add, 2, 3) );
+    BOOST_CHECK_EQUAL( 1, async_counter);
+    BOOST_CHECK( f2.is_ready() );
+    BOOST_CHECK_EQUAL( 5, f2.get() );
+
+    async_counter = 0;
+    boost::fibers::unique_future< int > f3(
+        boost::fibers::async( boost::fibers::launch::deferred, async_add, 3, 4) );
+    BOOST_CHECK_EQUAL( 0, async_counter);
+    BOOST_CHECK( ! f3.is_ready() );
+    BOOST_CHECK_EQUAL( 7, f3.get() );
+    BOOST_CHECK_EQUAL( 1, async_counter);
+
+    boost::fibers::unique_future< boost::thread::id > f4(
+        boost::fibers::async( boost::fibers::launch::any_worker, async_thread_id) );
+    BOOST_CHECK( boost::this_thread::get_id() != f4.get() );
+
+    boost::fibers::unique_future< int > f5(
+        boost::fibers::async( boost::fibers::launch::post | boost::fibers::launch::dispatch, async_throw) );
+    BOOST_CHECK_THROW( f5.get(), std::runtime_error);
+}
+
+void test_async_posted_tasks_waiting_on_each_other()
+{
+    boost::fibers::round_robin ds;
+    boost::fibers::scheduling_algorithm( & ds);
+
+    // each task blocks on the future of the task posted before it,
+    // the first one on a promise set by the last task
+    boost::fibers::promise< int > p;
+    boost::fibers::shared_future< int > f( p.get_future() );
+    std::vector< boost::fibers::shared_future< int > > fs;
+    for ( int i = 0; i < 100; ++i)
+    {
+        fs.push_back( boost::fibers::shared_future< int >(
+            boost::fibers::async( boost::fibers::launch::post, async_wait, f) ) );
+        f = fs.back();
+    }
+    boost::fibers::async( boost::fibers::launch::post, async_set, & p);
+    BOOST_CHECK_EQUAL( 100, fs.back().get() );
+}
+
+int allocations = 0;
+int deallocations = 0;
+
+template< typename T >
+struct counting_allocator : public std::allocator< T >
+{
+    template< typename U >
+    struct rebind
+    { typedef counting_allocator< U > other; };
+
+    counting_allocator()
+    {}
+
+    template< typename U >
+    counting_allocator( counting_allocator< U > const&)
+    {}
+
+    T * allocate( std::size_t n)
+    {
+        ++allocations;
+        return std::allocator< T >::allocate( n);
+    }
+
+    void deallocate( T * p, std::size_t n)
+    {
+        ++deallocations;
+        std::allocator< T >::deallocate( p, n);
+    }
+};
+
+int double_it( boost::fibers::unique_future< int > & f)
+{ return 2 * f.get(); }
+
+void test_allocator_aware_construction()
+{
+    boost::fibers::round_robin ds;
+    boost::fibers::scheduling_algorithm( & ds);
+
+    counting_allocator< int > a;
+    allocations = 0;
+    deallocations = 0;
+    {
+        boost::fibers::promise< int > p( boost::fibers::allocator_arg, a);
+        boost::fibers::unique_future< int > f( p.get_future() );
+        p.set_value( 1);
+        BOOST_CHECK_EQUAL( 1, f.get() );
+    }
+    {
+        boost::fibers::promise< void > p( boost::fibers::allocator_arg, a);
+        p.set_value();
+    }
+    {
+        boost::fibers::packaged_task< int > pt( boost::fibers::allocator_arg, a, make_int);
+        boost::fibers::unique_future< int > f( pt.get_future() );
+        pt();
+        BOOST_CHECK_EQUAL( 42, f.get() );
+    }
+    {
+        boost::fibers::unique_future< int > f(
+            boost::fibers::async( boost::fibers::launch::post, boost::fibers::allocator_arg, a,
+                                  async_add, 1, 2) );
+        boost::fibers::inline_executor ex;
+        boost::fibers::unique_future< int > f2(
+            f.then( boost::fibers::allocator_arg, a, ex, double_it) );
+        BOOST_CHECK_EQUAL( 6, f2.get() );
+    }
+    BOOST_CHECK_EQUAL( 5, allocations);
+    BOOST_CHECK_EQUAL( allocations, deallocations);
+}
+
 boost::unit_test_framework::test_suite* init_unit_test_suite(int, char*[])
 {
     boost::unit_test_framework::test_suite* test =
@@ -1642,6 +2003,15 @@ boost::unit_test_framework::test_suite* init_unit_test_suite(int, char*[])
     test->add(BOOST_TEST_CASE(test_wait_for_all_four_futures));
     test->add(BOOST_TEST_CASE(test_wait_for_all_five_futures));
     test->add(BOOST_TEST_CASE(test_future_wait));
+    test->add(BOOST_TEST_CASE(test_several_fibers_wait_on_shared_future));
+    test->add(BOOST_TEST_CASE(test_future_set_from_other_thread));
+    test->add(BOOST_TEST_CASE(test_wait_for_any_blocks_until_set));
+    test->add(BOOST_TEST_CASE(test_when_all_becomes_ready_after_all_futures));
+    test->add(BOOST_TEST_CASE(test_when_any_becomes_ready_with_first_future));
+    test->add(BOOST_TEST_CASE(test_when_all_of_many_fibers));
+    test->add(BOOST_TEST_CASE(test_async_launch_policies));
+    test->add(BOOST_TEST_CASE(test_async_posted_tasks_waiting_on_each_other));
+    test->add(BOOST_TEST_CASE(test_allocator_aware_construction));
 
     return test;
 }
@@ -0,0 +1,340 @@
+//          Copyright Oliver Kowalke 2009.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <boost/bind.hpp>
+#include <boost/ref.hpp>
+#include <boost/test/unit_test.hpp>
+#include <boost/utility.hpp>
+
+#include <boost/fiber/all.hpp>
+
+namespace io = boost::fibers::io;
+
+int value = 0;
+
+void reader_fn( int fd, std::string & s)
+{
+    char buf[16];
+    ssize_t n = 0;
+    while ( 0 < ( n = io::read( fd, buf, sizeof( buf) ) ) )
+        s.append( buf, n);
+}
+
+void writer_fn( int fd, std::string const& s)
+{
+    io::write( fd, s.data(), s.size() );
+    io::close( fd);
+}
+
+void increment_fn( int n)
+{
+    for ( int i = 0; i < n; ++i)
+    {
+        ++value;
+        boost::this_fiber::yield();
+    }
+}
+
+void echo_fn( int fd)
+{
+    char buf[64];
+    ssize_t n = 0;
+    while ( 0 < ( n = io::read( fd, buf, sizeof( buf) ) ) )
+        io::write( fd, buf, n);
+    io::close( fd);
+}
+
+void server_fn( int listener, int connections)
+{
+    for ( int i = 0; i < connections; ++i)
+    {
+        int fd = io::accept( listener, 0, 0);
+        BOOST_REQUIRE( -1 != fd);
+        boost::fibers::fiber( boost::bind( echo_fn, fd) ).detach();
+    }
+}
+
+void client_fn( sockaddr_in addr, int & echoed)
+{
+    int fd = io::socket( AF_INET, SOCK_STREAM, 0);
+    BOOST_REQUIRE( -1 != fd);
+    BOOST_REQUIRE_EQUAL( 0,
+        io::connect( fd, reinterpret_cast< sockaddr * >( & addr), sizeof( addr) ) );
+    char buf[4];
+    for ( int i = 0; i < 10; ++i)
+    {
+        BOOST_CHECK_EQUAL( 4, io::write( fd, "ping", 4) );
+        std::size_t got = 0;
+        while ( got < sizeof( buf) )
+        {
+            ssize_t n = io::read( fd, buf + got, sizeof( buf) - got);
+            BOOST_REQUIRE( 0 < n);
+            got += n;
+        }
+        if ( 0 == std::memcmp( buf, "ping", 4) ) ++echoed;
+    }
+    io::close( fd);
+}
+
+void file_fn( int i, bool & ok)
+{
+    char path[] = "/tmp/test_io_XXXXXX";
+    int fd = ::mkstemp( path);
+    BOOST_REQUIRE( -1 != fd);
+    ::unlink( path);
+
+    std::string sent( 4096 + i, 'a' + i % 26);
+    ok = static_cast< ssize_t >( sent.size() ) == io::write( fd, sent.data(), sent.size() ) &&
+         0 == io::fsync( fd) &&
+         0 == ::lseek( fd, 0, SEEK_SET);
+    std::string received( sent.size() + 1, 0);
+    ok = ok && static_cast< ssize_t >( sent.size() ) == io::read( fd, & received[0], received.size() );
+    received.resize( sent.size() );
+    ok = ok && sent == received;
+    // at the end of the file
+    ok = ok && 0 == io::read( fd, & received[0], received.size() );
+    io::close( fd);
+}
+
+void wait_close_fn( int fd, int & err)
+{
+    io::wait_readable( fd);
+    char c;
+    if ( -1 == ::read( fd, & c, 1) ) err = errno;
+}
+
+void read_close_fn( int fd, int & err)
+{
+    char c;
+    if ( -1 == io::read( fd, & c, 1) ) err = errno;
+}
+
+void yield_close_fn( int fd)
+{
+    // a pass through the ready-queue submits the queued request
+    boost::this_fiber::yield();
+    io::close( fd);
+}
+
+void bad_read_fn( int & err)
+{
+    char c;
+    if ( -1 == io::read( -1, & c, 1) ) err = errno;
+}
+
+int listen_loopback( sockaddr_in & addr)
+{
+    int fd = io::socket( AF_INET, SOCK_STREAM, 0);
+    std::memset( & addr, 0, sizeof( addr) );
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl( INADDR_LOOPBACK);
+    addr.sin_port = 0;
+    socklen_t len = sizeof( addr);
+    if ( -1 == fd ||
+         -1 == ::bind( fd, reinterpret_cast< sockaddr * >( & addr), len) ||
+         -1 == ::listen( fd, 128) ||
+         -1 == ::getsockname( fd, reinterpret_cast< sockaddr * >( & addr), & len) )
+        return -1;
+    return fd;
+}
+
+void test_socketpair()
+{
+    boost::fibers::round_robin ds;
+    boost::fibers::scheduling_algorithm( & ds);
+
+    int fds[2];
+    BOOST_REQUIRE_EQUAL( 0, ::socketpair( AF_UNIX, SOCK_STREAM, 0, fds) );
+    BOOST_REQUIRE_EQUAL( 0, io::set_nonblocking( fds[0]) );
+    BOOST_REQUIRE_EQUAL( 0, io::set_nonblocking( fds[1]) );
+
+    // the reader waits, the other fibers continue
+    std::string received;
+    value = 0;
+    boost::fibers::fiber r( boost::bind( reader_fn, fds[0], boost::ref( received) ) );
+    boost::fibers::fiber i( boost::bind( increment_fn, 10) );
+    i.join();
+    BOOST_CHECK_EQUAL( 10, value);
+    BOOST_CHECK( received.empty() );
+
+    std::string sent( 100000, 'x');
+    boost::fibers::fiber w( boost::bind( writer_fn, fds[1], boost::cref( sent) ) );
+    r.join();
+    w.join();
+    BOOST_CHECK( sent == received);
+    io::close( fds[0]);
+
+    boost::fibers::scheduling_algorithm( 0);
+}
+
+void test_main_fiber()
+{
+    boost::fibers::round_robin ds;
+    boost::fibers::scheduling_algorithm( & ds);
+
+    int fds[2];
+    BOOST_REQUIRE_EQUAL( 0, ::socketpair( AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK, 0, fds) );
+
+    // the main fiber runs the writer while it waits
+    std::string sent( "hello");
+    boost::fibers::fiber w( boost::bind( writer_fn, fds[1], boost::cref( sent) ) );
+    std::string received;
+    reader_fn( fds[0], received);
+    BOOST_CHECK( sent == received);
+    w.join();
+    io::close( fds[0]);
+
+    boost::fibers::scheduling_algorithm( 0);
+}
+
+void test_echo()
+{
+    boost::fibers::round_robin ds;
+    boost::fibers::scheduling_algorithm( & ds);
+
+    sockaddr_in addr;
+    int listener = listen_loopback( addr);
+    BOOST_REQUIRE( -1 != listener);
+
+    const int connections = 50;
+    std::vector< int > echoed( connections, 0);
+    boost::fibers::fiber s( boost::bind( server_fn, listener, connections) );
+    std::vector< boost::fibers::fiber * > clients;
+    for ( int i = 0; i < connections; ++i)
+        clients.push_back(
+            new boost::fibers::fiber(
+                boost::bind( client_fn, addr, boost::ref( echoed[i]) ) ) );
+    for ( int i = 0; i < connections; ++i)
+    {
+        clients[i]->join();
+        delete clients[i];
+        BOOST_CHECK_EQUAL( 10, echoed[i]);
+    }
+    s.join();
+    // the echo fibers see EOF
+    while ( ds.run() );
+    io::close( listener);
+
+    boost::fibers::scheduling_algorithm( 0);
+}
+
+void test_connect_refused()
+{
+    boost::fibers::round_robin ds;
+    boost::fibers::scheduling_algorithm( & ds);
+
+    // a port without listener
+    sockaddr_in addr;
+    int listener = listen_loopback( addr);
+    BOOST_REQUIRE( -1 != listener);
+    io::close( listener);
+
+    int fd = io::socket( AF_INET, SOCK_STREAM, 0);
+    BOOST_CHECK_EQUAL( -1,
+        io::connect( fd, reinterpret_cast< sockaddr * >( & addr), sizeof( addr) ) );
+    BOOST_CHECK_EQUAL( ECONNREFUSED, errno);
+    io::close( fd);
+
+    boost::fibers::scheduling_algorithm( 0);
+}
+
+void test_file()
+{
+    boost::fibers::round_robin ds;
+    boost::fibers::scheduling_algorithm( & ds);
+
+    // the operations of the fibers are submitted together
+    const int files = 20;
+    bool ok[files];
+    std::vector< boost::fibers::fiber * > fibers;
+    for ( int i = 0; i < files; ++i)
+        fibers.push_back(
+            new boost::fibers::fiber(
+                boost::bind( file_fn, i, boost::ref( ok[i]) ) ) );
+    for ( int i = 0; i < files; ++i)
+    {
+        fibers[i]->join();
+        delete fibers[i];
+        BOOST_CHECK( ok[i]);
+    }
+
+    // errors are reported by errno
+    int err = 0;
+    boost::fibers::fiber f( boost::bind( bad_read_fn, boost::ref( err) ) );
+    f.join();
+    BOOST_CHECK_EQUAL( EBADF, err);
+
+    boost::fibers::scheduling_algorithm( 0);
+}
+
+void test_close_waiting()
+{
+    boost::fibers::round_robin ds;
+    boost::fibers::scheduling_algorithm( & ds);
+
+    int fds[2];
+    BOOST_REQUIRE_EQUAL( 0, ::socketpair( AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK, 0, fds) );
+
+    // the waiting fiber is resumed by close()
+    int err = 0;
+    boost::fibers::fiber f( boost::bind( wait_close_fn, fds[0], boost::ref( err) ) );
+    boost::fibers::fiber c( boost::bind( io::close, fds[0]) );
+    f.join();
+    c.join();
+    BOOST_CHECK_EQUAL( EBADF, err);
+    ::close( fds[1]);
+
+    // a request queued at the io_uring is cancelled by close() - some
+    // kernels return EAGAIN for non-blocking descriptors instead of
+    // waiting, a blocking socket keeps the request in flight
+    BOOST_REQUIRE_EQUAL( 0, ::socketpair( AF_UNIX, SOCK_STREAM, 0, fds) );
+    err = 0;
+    boost::fibers::fiber r( boost::bind( read_close_fn, fds[0], boost::ref( err) ) );
+    boost::fibers::fiber d( boost::bind( yield_close_fn, fds[0]) );
+    r.join();
+    d.join();
+    BOOST_CHECK_EQUAL( EBADF, err);
+    ::close( fds[1]);
+
+    boost::fibers::scheduling_algorithm( 0);
+}
+
+void test_without_io_uring()
+{
+    // the scheduler falls back to epoll and worker threads
+    ::setenv("BOOST_FIBERS_IO_URING", "0", 1);
+    test_echo();
+    test_file();
+    test_connect_refused();
+    ::unsetenv("BOOST_FIBERS_IO_URING");
+}
+
+boost::unit_test::test_suite * init_unit_test_suite( int, char* [])
+{
+    boost::unit_test::test_suite * test =
+        BOOST_TEST_SUITE("Boost.Fiber: io test suite");
+
+    test->add( BOOST_TEST_CASE( & test_socketpair) );
+    test->add( BOOST_TEST_CASE( & test_main_fiber) );
+    test->add( BOOST_TEST_CASE( & test_echo) );
+    test->add( BOOST_TEST_CASE( & test_connect_refused) );
+    test->add( BOOST_TEST_CASE( & test_file) );
+    test->add( BOOST_TEST_CASE( & test_close_waiting) );
+    test->add( BOOST_TEST_CASE( & test_without_io_uring) );
+
+    return test;
+}
@@ -0,0 +1,192 @@
+//          Copyright Oliver Kowalke 2009.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include <boost/atomic.hpp>
+#include <boost/bind.hpp>
+#include <boost/ref.hpp>
+#include <boost/test/unit_test.hpp>
+#include <boost/thread.hpp>
+#include <boost/utility.hpp>
+
+#include <boost/fiber/all.hpp>
+
+int value = 0;
+
+void wait_fn( boost::fibers::latch & l)
+{
+    l.wait();
+    ++value;
+}
+
+void count_down_fn( boost::fibers::latch & l)
+{
+    boost::this_fiber::yield();
+    l.count_down();
+}
+
+void arrive_fn( boost::fibers::latch & l)
+{
+    l.arrive_and_wait();
+    ++value;
+}
+
+void interrupted_wait_fn( boost::fibers::latch & l, bool & interrupted)
+{
+    try
+    { l.wait(); }
+    catch ( boost::fibers::fiber_interrupted const&)
+    { interrupted = true; }
+}
+
+void test_case_1()
+{
+    boost::fibers::latch l( 2);
+    BOOST_CHECK( ! l.try_wait() );
+    l.count_down();
+    BOOST_CHECK( ! l.try_wait() );
+    l.count_down();
+    BOOST_CHECK( l.try_wait() );
+    // does not block
+    l.wait();
+
+    boost::fibers::latch l0( 0);
+    BOOST_CHECK( l0.try_wait() );
+}
+
+void test_case_2()
+{
+    boost::fibers::round_robin ds;
+    boost::fibers::scheduling_algorithm( & ds);
+
+    value = 0;
+    boost::fibers::latch l( 3);
+
+    boost::fibers::fiber s1(
+        boost::bind( wait_fn, boost::ref( l) ) );
+    boost::fibers::fiber s2(
+        boost::bind( wait_fn, boost::ref( l) ) );
+    BOOST_CHECK_EQUAL( 0, value);
+
+    l.count_down( 2);
+    while ( ds.run() );
+    BOOST_CHECK_EQUAL( 0, value);
+
+    // last count_down() releases all waiting fibers
+    l.count_down();
+    s1.join();
+    s2.join();
+    BOOST_CHECK_EQUAL( 2, value);
+}
+
+void test_case_3()
+{
+    boost::fibers::round_robin ds;
+    boost::fibers::scheduling_algorithm( & ds);
+
+    value = 0;
+    boost::fibers::latch l( 3);
+
+    // children count down, main-fiber waits
+    boost::fibers::fiber s1(
+        boost::bind( count_down_fn, boost::ref( l) ) );
+    boost::fibers::fiber s2(
+        boost::bind( count_down_fn, boost::ref( l) ) );
+    boost::fibers::fiber s3(
+        boost::bind( count_down_fn, boost::ref( l) ) );
+    s1.detach();
+    s2.detach();
+    s3.detach();
+    l.wait();
+    BOOST_CHECK( l.try_wait() );
+
+    boost::fibers::latch l2( 2);
+    boost::fibers::fiber s4(
+        boost::bind( arrive_fn, boost::ref( l2) ) );
+    boost::fibers::fiber s5(
+        boost::bind( arrive_fn, boost::ref( l2) ) );
+    s4.join();
+    s5.join();
+    BOOST_CHECK_EQUAL( 2, value);
+}
+
+void test_case_4()
+{
+    boost::fibers::round_robin ds;
+    boost::fibers::scheduling_algorithm( & ds);
+
+    bool interrupted = false;
+    boost::fibers::latch l( 1);
+
+    boost::fibers::fiber s1(
+        boost::bind( interrupted_wait_fn, boost::ref( l), boost::ref( interrupted) ) );
+    s1.interrupt();
+    s1.join();
+    BOOST_CHECK( interrupted);
+    BOOST_CHECK( ! l.try_wait() );
+    l.count_down();
+}
+
+boost::atomic< int > counter( 0);
+
+void worker_fn( boost::fibers::latch * l)
+{
+    boost::fibers::round_robin ds;
+    boost::fibers::scheduling_algorithm( & ds);
+
+    l->wait();
+    ++counter;
+}
+
+void test_case_5()
+{
+    counter = 0;
+    boost::fibers::latch l( 100);
+
+    boost::thread t1( boost::bind( worker_fn, & l) );
+    boost::thread t2( boost::bind( worker_fn, & l) );
+    for ( int i = 0; i < 100; ++i)
+        l.count_down();
+    t1.join();
+    t2.join();
+    BOOST_CHECK_EQUAL( 2, counter);
+}
+
+void count_down_thread_fn( boost::fibers::latch * l)
+{ l->count_down(); }
+
+void test_case_6()
+{
+    boost::fibers::round_robin ds;
+    boost::fibers::scheduling_algorithm( & ds);
+
+    // the waiter destroys the latch as soon as wait() returns,
+    // count_down() must not touch it after reaching zero
+    for ( int i = 0; i < 1000; ++i)
+    {
+        boost::fibers::latch * l = new boost::fibers::latch( 1);
+        boost::thread t( boost::bind( count_down_thread_fn, l) );
+        l->wait();
+        delete l;
+        t.join();
+    }
+
+    while ( ds.run() );
+    boost::fibers::scheduling_algorithm( 0);
+}
+
+boost::unit_test::test_suite * init_unit_test_suite( int, char* [])
+{
+    boost::unit_test::test_suite * test =
+        BOOST_TEST_SUITE("Boost.Fiber: latch test suite");
+
+    test->add( BOOST_TEST_CASE( & test_case_1) );
+    test->add( BOOST_TEST_CASE( & test_case_2) );
+    test->add( BOOST_TEST_CASE( & test_case_3) );
+    test->add( BOOST_TEST_CASE( & test_case_4) );
+    test->add( BOOST_TEST_CASE( & test_case_5) );
+    test->add( BOOST_TEST_CASE( & test_case_6) );
+
+    return test;
+}
@@ -0,0 +1,122 @@
+//          Copyright Oliver Kowalke 2009.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include <boost/bind.hpp>
+#include <boost/ref.hpp>
+#include <boost/test/unit_test.hpp>
+#include <boost/utility.hpp>
+
+#include <boost/fiber/all.hpp>
+
+int value = 0;
+
+void wait_fn( boost::fibers::manual_reset_event & ev)
+{
+    ev.wait();
+    ++value;
+}
+
+void set_fn( boost::fibers::manual_reset_event & ev)
+{
+    boost::this_fiber::yield();
+    ev.set();
+}
+
+void test_case_1()
+{
+    boost::fibers::manual_reset_event ev;
+    BOOST_CHECK( ! ev.try_wait() );
+
+    ev.set();
+    BOOST_CHECK( ev.try_wait() );
+    // event remains signaled
+    BOOST_CHECK( ev.try_wait() );
+
+    ev.reset();
+    BOOST_CHECK( ! ev.try_wait() );
+
+    boost::fibers::manual_reset_event ev_set( true);
+    BOOST_CHECK( ev_set.try_wait() );
+}
+
+void test_case_2()
+{
+    boost::fibers::round_robin ds;
+    boost::fibers::scheduling_algorithm( & ds);
+
+    value = 0;
+    boost::fibers::manual_reset_event ev;
+
+    boost::fibers::fiber s1(
+        boost::bind( wait_fn, boost::ref( ev) ) );
+    boost::fibers::fiber s2(
+        boost::bind( wait_fn, boost::ref( ev) ) );
+    boost::fibers::fiber s3(
+        boost::bind( wait_fn, boost::ref( ev) ) );
+    BOOST_CHECK_EQUAL( 0, value);
+
+    // set() releases all waiting fibers
+    ev.set();
+    s1.join();
+    s2.join();
+    s3.join();
+    BOOST_CHECK_EQUAL( 3, value);
+    BOOST_CHECK( ev.try_wait() );
+
+    // wait() on a signaled event returns immediately
+    boost::fibers::fiber s4(
+        boost::bind( wait_fn, boost::ref( ev) ) );
+    BOOST_CHECK_EQUAL( 4, value);
+    s4.join();
+}
+
+void test_case_3()
+{
+    boost::fibers::round_robin ds;
+    boost::fibers::scheduling_algorithm( & ds);
+
+    value = 0;
+    boost::fibers::manual_reset_event ev( true);
+    ev.reset();
+
+    boost::fibers::fiber s1(
+        boost::bind( wait_fn, boost::ref( ev) ) );
+    BOOST_CHECK_EQUAL( 0, value);
+
+    boost::fibers::fiber s2(
+        boost::bind( set_fn, boost::ref( ev) ) );
+    s1.join();
+    s2.join();
+    BOOST_CHECK_EQUAL( 1, value);
+}
+
+void test_case_4()
+{
+    boost::fibers::round_robin ds;
+    boost::fibers::scheduling_algorithm( & ds);
+
+    value = 0;
+    boost::fibers::manual_reset_event ev;
+
+    // main-fiber waits until a fiber sets the event
+    boost::fibers::fiber s1(
+        boost::bind( set_fn, boost::ref( ev) ) );
+    ev.wait();
+    BOOST_CHECK( ev.try_wait() );
+    s1.join();
+}
+
+boost::unit_test::test_suite * init_unit_test_suite( int, char* [])
+{
+    boost::unit_test::test_suite * test =
+        BOOST_TEST_SUITE("Boost.Fiber: manual_reset_event test suite");
+
+    test->add( BOOST_TEST_CASE( & test_case_1) );
+    test->add( BOOST_TEST_CASE( & test_case_2) );
+    test->add( BOOST_TEST_CASE( & test_case_3) );
+    test->add( BOOST_TEST_CASE( & test_case_4) );
+
+    return test;
+}
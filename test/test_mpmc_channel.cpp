@@ -0,0 +1,162 @@
+//          Copyright Oliver Kowalke 2009.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include <string>
+
+#include <boost/bind.hpp>
+#include <boost/ref.hpp>
+#include <boost/test/unit_test.hpp>
+#include <boost/thread.hpp>
+#include <boost/utility.hpp>
+
+#include <boost/fiber/all.hpp>
+
+typedef boost::fibers::mpmc_channel< int >  channel_t;
+
+void producer_fn( channel_t & ch, int n)
+{
+    for ( int i = 0; i < n; ++i)
+        ch.put( i);
+}
+
+void consumer_fn( channel_t & ch, int & sum, int & count)
+{
+    channel_t::value_type va;
+    while ( ch.take( va) )
+    {
+        sum += * va;
+        ++count;
+    }
+}
+
+void test_case_1()
+{
+    channel_t ch( 3);
+    BOOST_CHECK_EQUAL( std::size_t( 4), ch.capacity() );
+    BOOST_CHECK( ch.empty() );
+
+    // wrap around the cells several times
+    channel_t::value_type va;
+    for ( int i = 0; i < 10; ++i)
+    {
+        ch.put( 2 * i);
+        ch.put( 2 * i + 1);
+        BOOST_CHECK( ! ch.empty() );
+        BOOST_CHECK( ch.try_take( va) );
+        BOOST_CHECK_EQUAL( 2 * i, * va);
+        BOOST_CHECK( ch.take( va) );
+        BOOST_CHECK_EQUAL( 2 * i + 1, * va);
+    }
+    BOOST_CHECK( ch.empty() );
+    BOOST_CHECK( ! ch.try_take( va) );
+
+    // full channel
+    for ( int i = 0; i < 4; ++i)
+        BOOST_CHECK( ch.try_put( i) );
+    BOOST_CHECK( ! ch.try_put( 4) );
+
+    ch.deactivate();
+    BOOST_CHECK( ! ch.active() );
+    BOOST_CHECK_THROW( ch.put( 1), boost::fibers::fiber_resource_error);
+    // remaining items are still delivered
+    for ( int i = 0; i < 4; ++i)
+    {
+        BOOST_CHECK( ch.take( va) );
+        BOOST_CHECK_EQUAL( i, * va);
+    }
+    BOOST_CHECK( ! ch.take( va) );
+}
+
+void test_case_2()
+{
+    BOOST_CHECK_THROW( channel_t( 0), boost::fibers::invalid_argument);
+}
+
+void test_case_3()
+{
+    boost::fibers::round_robin ds;
+    boost::fibers::scheduling_algorithm( & ds);
+
+    // several producers and consumers wait at the same time
+    channel_t ch( 2);
+    int sum[4] = { 0, 0, 0, 0 }, count[4] = { 0, 0, 0, 0 };
+    boost::fibers::fiber c1(
+        boost::bind( consumer_fn, boost::ref( ch), boost::ref( sum[0]), boost::ref( count[0]) ) );
+    boost::fibers::fiber c2(
+        boost::bind( consumer_fn, boost::ref( ch), boost::ref( sum[1]), boost::ref( count[1]) ) );
+    boost::fibers::fiber c3(
+        boost::bind( consumer_fn, boost::ref( ch), boost::ref( sum[2]), boost::ref( count[2]) ) );
+    boost::fibers::fiber c4(
+        boost::bind( consumer_fn, boost::ref( ch), boost::ref( sum[3]), boost::ref( count[3]) ) );
+    boost::fibers::fiber p1( boost::bind( producer_fn, boost::ref( ch), 1000) );
+    boost::fibers::fiber p2( boost::bind( producer_fn, boost::ref( ch), 1000) );
+    boost::fibers::fiber p3( boost::bind( producer_fn, boost::ref( ch), 1000) );
+    boost::fibers::fiber p4( boost::bind( producer_fn, boost::ref( ch), 1000) );
+    p1.join();
+    p2.join();
+    p3.join();
+    p4.join();
+    ch.deactivate();
+    c1.join();
+    c2.join();
+    c3.join();
+    c4.join();
+    BOOST_CHECK_EQUAL( 4000, count[0] + count[1] + count[2] + count[3]);
+    BOOST_CHECK_EQUAL( 4 * 499500, sum[0] + sum[1] + sum[2] + sum[3]);
+    // consumers are woken up in FIFO order
+    BOOST_CHECK( 0 < count[0]);
+    BOOST_CHECK( 0 < count[1]);
+    BOOST_CHECK( 0 < count[2]);
+    BOOST_CHECK( 0 < count[3]);
+}
+
+void thread_producer_fn( channel_t * ch, int n)
+{
+    boost::fibers::round_robin ds;
+    boost::fibers::scheduling_algorithm( & ds);
+
+    boost::fibers::fiber p( boost::bind( producer_fn, boost::ref( * ch), n) );
+    p.join();
+}
+
+void thread_consumer_fn( channel_t * ch, int * sum, int * count)
+{
+    boost::fibers::round_robin ds;
+    boost::fibers::scheduling_algorithm( & ds);
+
+    boost::fibers::fiber c(
+        boost::bind( consumer_fn, boost::ref( * ch), boost::ref( * sum), boost::ref( * count) ) );
+    c.join();
+}
+
+void test_case_4()
+{
+    channel_t ch( 16);
+    int sum[4] = { 0, 0, 0, 0 }, count[4] = { 0, 0, 0, 0 };
+    boost::thread_group consumers;
+    for ( int i = 0; i < 4; ++i)
+        consumers.create_thread( boost::bind( thread_consumer_fn, & ch, & sum[i], & count[i]) );
+    boost::thread_group producers;
+    for ( int i = 0; i < 4; ++i)
+        producers.create_thread( boost::bind( thread_producer_fn, & ch, 2500) );
+    producers.join_all();
+    ch.deactivate();
+    consumers.join_all();
+    BOOST_CHECK_EQUAL( 10000, count[0] + count[1] + count[2] + count[3]);
+    BOOST_CHECK_EQUAL( 4 * 3123750, sum[0] + sum[1] + sum[2] + sum[3]);
+}
+
+boost::unit_test::test_suite * init_unit_test_suite( int, char* [])
+{
+    boost::unit_test::test_suite * test =
+        BOOST_TEST_SUITE("Boost.Fiber: mpmc_channel test suite");
+
+    test->add( BOOST_TEST_CASE( & test_case_1) );
+    test->add( BOOST_TEST_CASE( & test_case_2) );
+    test->add( BOOST_TEST_CASE( & test_case_3) );
+    test->add( BOOST_TEST_CASE( & test_case_4) );
+
+    return test;
+}
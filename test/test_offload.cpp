@@ -0,0 +1,185 @@
+//          Copyright Oliver Kowalke 2009.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <boost/atomic.hpp>
+#include <boost/bind.hpp>
+#include <boost/chrono.hpp>
+#include <boost/ref.hpp>
+#include <boost/test/unit_test.hpp>
+#include <boost/thread.hpp>
+#include <boost/utility.hpp>
+
+#include <boost/fiber/all.hpp>
+
+int value = 0;
+bool done = false;
+
+int blocking_fn( int i)
+{
+    boost::this_thread::sleep_for( boost::chrono::milliseconds( 50) );
+    return i;
+}
+
+void sleep_fn()
+{ boost::this_thread::sleep_for( boost::chrono::milliseconds( 20) ); }
+
+void throw_fn()
+{ throw std::runtime_error("offload"); }
+
+boost::thread::id thread_fn()
+{ return boost::this_thread::get_id(); }
+
+void offload_fn( int & result)
+{
+    result = boost::this_fiber::offload( boost::bind( blocking_fn, 42) );
+    done = true;
+}
+
+void increment_fn()
+{
+    while ( ! done)
+    {
+        ++value;
+        boost::this_fiber::yield();
+    }
+}
+
+void pool_fn( boost::fibers::offload_pool & pool)
+{ boost::this_fiber::offload( pool, sleep_fn); }
+
+void throwing_fn( std::string & what)
+{
+    try
+    { boost::this_fiber::offload( throw_fn); }
+    catch ( std::runtime_error const& e)
+    { what = e.what(); }
+}
+
+void finish( boost::fibers::round_robin & ds)
+{
+    while ( ds.run() );
+    boost::fibers::scheduling_algorithm( 0);
+}
+
+void test_result()
+{
+    boost::fibers::round_robin ds;
+    boost::fibers::scheduling_algorithm( & ds);
+
+    // the other fibers run while the function blocks a helper
+    value = 0;
+    done = false;
+    int result = 0;
+    boost::fibers::fiber f( boost::bind( offload_fn, boost::ref( result) ) );
+    boost::fibers::fiber i( increment_fn);
+    f.join();
+    i.join();
+    BOOST_CHECK_EQUAL( 42, result);
+    BOOST_CHECK( 1 < value);
+
+    finish( ds);
+}
+
+void test_exception()
+{
+    boost::fibers::round_robin ds;
+    boost::fibers::scheduling_algorithm( & ds);
+
+    std::string what;
+    boost::fibers::fiber f( boost::bind( throwing_fn, boost::ref( what) ) );
+    f.join();
+    BOOST_CHECK_EQUAL( std::string("offload"), what);
+
+    finish( ds);
+}
+
+void test_main_fiber()
+{
+    boost::fibers::round_robin ds;
+    boost::fibers::scheduling_algorithm( & ds);
+
+    // the main fiber runs the other fibers while it waits
+    BOOST_CHECK( boost::this_thread::get_id() != boost::this_fiber::offload( thread_fn) );
+    BOOST_CHECK_EQUAL( 7, boost::this_fiber::offload( boost::bind( blocking_fn, 7) ) );
+
+    finish( ds);
+}
+
+void test_bounded()
+{
+    boost::fibers::round_robin ds;
+    boost::fibers::scheduling_algorithm( & ds);
+
+    boost::fibers::offload_pool pool( 2);
+    std::vector< boost::fibers::fiber * > fibers;
+    for ( int i = 0; i < 8; ++i)
+        fibers.push_back(
+            new boost::fibers::fiber( boost::bind( pool_fn, boost::ref( pool) ) ) );
+    for ( int i = 0; i < 8; ++i)
+    {
+        fibers[i]->join();
+        delete fibers[i];
+    }
+
+    // eight functions, two helpers - the other functions were queued
+    boost::fibers::offload_pool::snapshot s = pool.statistics();
+    BOOST_CHECK_EQUAL( std::size_t( 2), s.threads);
+    BOOST_CHECK_EQUAL( std::size_t( 2), s.max_threads);
+    BOOST_CHECK_EQUAL( std::size_t( 0), s.depth);
+    BOOST_CHECK( 6 <= s.max_depth);
+    BOOST_CHECK_EQUAL( 8u, s.submitted);
+    BOOST_CHECK( boost::chrono::milliseconds( 20) <= s.max_wait);
+
+    finish( ds);
+}
+
+void test_max_threads()
+{
+    boost::fibers::offload_pool pool( 4);
+    BOOST_CHECK_EQUAL( std::size_t( 4), pool.max_threads() );
+    BOOST_CHECK_THROW( pool.max_threads( 0), boost::fibers::invalid_argument);
+    BOOST_CHECK_THROW( boost::fibers::offload_pool( 0), boost::fibers::invalid_argument);
+
+    // the surplus helpers exit
+    for ( int i = 0; i < 4; ++i)
+        pool.submit( sleep_fn);
+    pool.max_threads( 1);
+    while ( 1 < pool.statistics().threads)
+        boost::this_thread::yield();
+    BOOST_CHECK_EQUAL( std::size_t( 1), pool.max_threads() );
+
+    // the helpers are detached - exited helpers are replaced,
+    // the destructor waits for the remaining ones
+    for ( int cycle = 0; cycle < 3; ++cycle)
+    {
+        pool.max_threads( 4);
+        for ( int i = 0; i < 4; ++i)
+            pool.submit( sleep_fn);
+        BOOST_CHECK( 1 < pool.statistics().threads);
+        pool.max_threads( 1);
+        while ( 1 < pool.statistics().threads)
+            boost::this_thread::yield();
+    }
+
+    BOOST_CHECK( 4 <= boost::fibers::offload_pool::instance().max_threads() );
+}
+
+boost::unit_test::test_suite * init_unit_test_suite( int, char* [])
+{
+    boost::unit_test::test_suite * test =
+        BOOST_TEST_SUITE("Boost.Fiber: offload test suite");
+
+    test->add( BOOST_TEST_CASE( & test_result) );
+    test->add( BOOST_TEST_CASE( & test_exception) );
+    test->add( BOOST_TEST_CASE( & test_main_fiber) );
+    test->add( BOOST_TEST_CASE( & test_bounded) );
+    test->add( BOOST_TEST_CASE( & test_max_threads) );
+
+    return test;
+}
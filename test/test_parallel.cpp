@@ -0,0 +1,144 @@
+//          Copyright Oliver Kowalke 2009.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include <stdexcept>
+
+#include <boost/atomic.hpp>
+#include <boost/bind.hpp>
+#include <boost/ref.hpp>
+#include <boost/scoped_array.hpp>
+#include <boost/test/unit_test.hpp>
+#include <boost/thread.hpp>
+#include <boost/utility.hpp>
+
+#include <boost/fiber/all.hpp>
+
+// std::vector<> needs a copyable element in C++03
+boost::atomic< int > * make_visited( int n)
+{
+    boost::atomic< int > * visited = new boost::atomic< int >[n];
+    for ( int i = 0; i < n; ++i)
+        visited[i].store( 0);
+    return visited;
+}
+
+struct visit
+{
+    boost::atomic< int > * visited;
+
+    visit( boost::scoped_array< boost::atomic< int > > & v) :
+        visited( v.get() )
+    {}
+
+    void operator()( int i) const
+    { ++visited[i]; }
+};
+
+struct square
+{
+    typedef long result_type;
+
+    long operator()( int i) const
+    { return long( i) * i; }
+};
+
+struct plus
+{
+    long operator()( long l, long r) const
+    { return l + r; }
+};
+
+struct thrower
+{
+    void operator()( int i) const
+    { if ( 777 == i) throw std::runtime_error("parallel_for"); }
+};
+
+boost::atomic< int > invoked( 0);
+
+void invoke_fn( int n)
+{ invoked.fetch_add( n); }
+
+void nested_fn()
+{
+    boost::scoped_array< boost::atomic< int > > visited( make_visited( 1000) );
+    boost::fibers::parallel_for( 0, 1000, 10, visit( visited) );
+    for ( int i = 0; i < 1000; ++i)
+        if ( 1 != visited[i]) throw std::logic_error("nested parallel_for");
+    invoked.fetch_add( 1);
+}
+
+void for_each_index()
+{
+    boost::scoped_array< boost::atomic< int > > visited( make_visited( 100000) );
+    boost::fibers::parallel_for( 0, 100000, 100, visit( visited) );
+    int once = 0;
+    for ( int i = 0; i < 100000; ++i)
+        if ( 1 == visited[i]) ++once;
+    BOOST_CHECK_EQUAL( 100000, once);
+
+    // empty range
+    boost::fibers::parallel_for( 5, 5, 1, visit( visited) );
+}
+
+void test_parallel_for()
+{
+    // a thread without scheduler
+    for_each_index();
+
+    // a fiber
+    boost::fibers::round_robin ds;
+    boost::fibers::scheduling_algorithm( & ds);
+    boost::fibers::fiber f( for_each_index);
+    f.join();
+    // the following tests run without scheduler
+    boost::fibers::scheduling_algorithm( 0);
+}
+
+void test_parallel_reduce()
+{
+    long expected = 0;
+    for ( int i = 0; i < 100000; ++i)
+        expected += long( i) * i;
+    BOOST_CHECK_EQUAL( expected,
+        boost::fibers::parallel_reduce( 0, 100000, 100, 0L, square(), plus() ) );
+    BOOST_CHECK_EQUAL( 0L,
+        boost::fibers::parallel_reduce( 0, 0, 100, 0L, square(), plus() ) );
+}
+
+void test_parallel_invoke()
+{
+    invoked = 0;
+    boost::fibers::parallel_invoke(
+        boost::bind( invoke_fn, 1),
+        boost::bind( invoke_fn, 2),
+        boost::bind( invoke_fn, 4) );
+    BOOST_CHECK_EQUAL( 7, invoked.load() );
+
+    // parallel algorithms called by tasks of the pool
+    invoked = 0;
+    boost::fibers::parallel_invoke( nested_fn, nested_fn, nested_fn, nested_fn);
+    BOOST_CHECK_EQUAL( 4, invoked.load() );
+}
+
+void test_exception()
+{
+    BOOST_CHECK_THROW(
+        boost::fibers::parallel_for( 0, 10000, 10, thrower() ),
+        std::runtime_error);
+}
+
+boost::unit_test::test_suite * init_unit_test_suite( int, char* [])
+{
+    boost::unit_test::test_suite * test =
+        BOOST_TEST_SUITE("Boost.Fiber: parallel algorithms test suite");
+
+    test->add( BOOST_TEST_CASE( & test_parallel_for) );
+    test->add( BOOST_TEST_CASE( & test_parallel_reduce) );
+    test->add( BOOST_TEST_CASE( & test_parallel_invoke) );
+    test->add( BOOST_TEST_CASE( & test_exception) );
+
+    return test;
+}
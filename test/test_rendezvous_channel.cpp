@@ -0,0 +1,282 @@
+//          Copyright Oliver Kowalke 2009.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <boost/bind.hpp>
+#include <boost/optional.hpp>
+#include <boost/ref.hpp>
+#include <boost/test/unit_test.hpp>
+#include <boost/thread.hpp>
+#include <boost/utility.hpp>
+
+#include <boost/fiber/all.hpp>
+
+typedef boost::fibers::rendezvous_channel< int > channel_t;
+
+void producer_fn( channel_t & ch, int n)
+{
+    for ( int i = 0; i < n; ++i)
+        ch.put( i);
+    ch.deactivate();
+}
+
+void consumer_fn( channel_t & ch, std::vector< int > & vec)
+{
+    channel_t::value_type va;
+    while ( ch.take( va) )
+        vec.push_back( * va);
+}
+
+void put_fn( channel_t & ch, int i, bool & thrown)
+{
+    try
+    { ch.put( i); }
+    catch ( boost::fibers::fiber_resource_error const&)
+    { thrown = true; }
+}
+
+void take_fn( channel_t & ch, bool & taken)
+{
+    channel_t::value_type va;
+    taken = ch.take( va);
+}
+
+void test_case_1()
+{
+    channel_t ch;
+    channel_t::value_type va;
+    BOOST_CHECK( ch.active() );
+
+    // no waiting peer
+    BOOST_CHECK( ! ch.try_put( 1) );
+    BOOST_CHECK( ! ch.try_take( va) );
+    BOOST_CHECK( ! va);
+
+    ch.deactivate();
+    BOOST_CHECK( ! ch.active() );
+    BOOST_CHECK( ! ch.take( va) );
+    BOOST_CHECK_THROW( ch.put( 1), boost::fibers::fiber_resource_error);
+    BOOST_CHECK_THROW( ch.try_put( 1), boost::fibers::fiber_resource_error);
+}
+
+void test_case_2()
+{
+    boost::fibers::round_robin ds;
+    boost::fibers::scheduling_algorithm( & ds);
+
+    // consumer arrives first, then producer first
+    for ( int k = 0; k < 2; ++k)
+    {
+        channel_t ch;
+        std::vector< int > vec;
+        if ( 0 == k)
+        {
+            boost::fibers::fiber c( boost::bind( consumer_fn, boost::ref( ch), boost::ref( vec) ) );
+            boost::fibers::fiber p( boost::bind( producer_fn, boost::ref( ch), 100) );
+            p.join();
+            c.join();
+        }
+        else
+        {
+            boost::fibers::fiber p( boost::bind( producer_fn, boost::ref( ch), 100) );
+            boost::fibers::fiber c( boost::bind( consumer_fn, boost::ref( ch), boost::ref( vec) ) );
+            p.join();
+            c.join();
+        }
+        BOOST_REQUIRE_EQUAL( std::size_t( 100), vec.size() );
+        for ( int i = 0; i < 100; ++i)
+            BOOST_CHECK_EQUAL( i, vec[i]);
+    }
+}
+
+void deactivate_fn()
+{
+    // a waiting producer throws, a waiting consumer returns false
+    channel_t ch1;
+    bool thrown = false;
+    boost::fibers::fiber p( boost::bind( put_fn, boost::ref( ch1), 1, boost::ref( thrown) ) );
+    boost::this_fiber::yield();
+    ch1.deactivate();
+    p.join();
+    BOOST_CHECK( thrown);
+
+    channel_t ch2;
+    bool taken = true;
+    boost::fibers::fiber c( boost::bind( take_fn, boost::ref( ch2), boost::ref( taken) ) );
+    boost::this_fiber::yield();
+    ch2.deactivate();
+    c.join();
+    BOOST_CHECK( ! taken);
+
+    // an interrupted consumer returns false
+    channel_t ch3;
+    taken = true;
+    boost::fibers::fiber i( boost::bind( take_fn, boost::ref( ch3), boost::ref( taken) ) );
+    boost::this_fiber::yield();
+    i.interrupt();
+    i.join();
+    BOOST_CHECK( ! taken);
+}
+
+void test_case_3()
+{
+    boost::fibers::round_robin ds;
+    boost::fibers::scheduling_algorithm( & ds);
+
+    boost::fibers::fiber f( deactivate_fn);
+    f.join();
+}
+
+#ifndef BOOST_NO_RVALUE_REFERENCES
+typedef boost::fibers::rendezvous_channel< std::unique_ptr< std::string > > uptr_channel_t;
+
+void move_producer_fn( uptr_channel_t & ch, std::string const** data)
+{
+    std::unique_ptr< std::string > p( new std::string("abc") );
+    * data = p.get();
+    ch.put( std::move( p) );
+    BOOST_CHECK( ! p);
+}
+
+void move_consumer_fn( uptr_channel_t & ch, std::string const** data)
+{
+    uptr_channel_t::value_type va;
+    BOOST_CHECK( ch.take( va) );
+    BOOST_REQUIRE( va);
+    // the item was moved, not copied
+    BOOST_CHECK_EQUAL( * data, va->get() );
+    BOOST_CHECK_EQUAL( std::string("abc"), ** va);
+}
+#endif
+
+void test_case_4()
+{
+#ifndef BOOST_NO_RVALUE_REFERENCES
+    boost::fibers::round_robin ds;
+    boost::fibers::scheduling_algorithm( & ds);
+
+    uptr_channel_t ch;
+    std::string const* data = 0;
+    boost::fibers::fiber p( boost::bind( move_producer_fn, boost::ref( ch), & data) );
+    boost::fibers::fiber c( boost::bind( move_consumer_fn, boost::ref( ch), & data) );
+    p.join();
+    c.join();
+#endif
+}
+
+void thread_producer_fn( channel_t * ch, int n)
+{
+    boost::fibers::round_robin ds;
+    boost::fibers::scheduling_algorithm( & ds);
+
+    boost::fibers::fiber p( boost::bind( producer_fn, boost::ref( * ch), n) );
+    p.join();
+}
+
+void thread_consumer_fn( channel_t * ch, std::vector< int > * vec)
+{
+    boost::fibers::round_robin ds;
+    boost::fibers::scheduling_algorithm( & ds);
+
+    boost::fibers::fiber c( boost::bind( consumer_fn, boost::ref( * ch), boost::ref( * vec) ) );
+    c.join();
+}
+
+void test_case_5()
+{
+    channel_t ch;
+    std::vector< int > vec;
+    boost::thread c( boost::bind( thread_consumer_fn, & ch, & vec) );
+    boost::thread p( boost::bind( thread_producer_fn, & ch, 1000) );
+    p.join();
+    c.join();
+
+    BOOST_REQUIRE_EQUAL( std::size_t( 1000), vec.size() );
+    for ( int i = 0; i < 1000; ++i)
+        BOOST_CHECK_EQUAL( i, vec[i]);
+}
+
+// copying throws while fail is set
+struct fragile
+{
+    static bool fail;
+
+    int i;
+
+    fragile( int i_ = 0) :
+        i( i_)
+    {}
+
+    fragile( fragile const& other) :
+        i( other.i)
+    { if ( fail) throw std::runtime_error("fragile"); }
+
+    fragile & operator=( fragile const& other)
+    {
+        if ( fail) throw std::runtime_error("fragile");
+        i = other.i;
+        return * this;
+    }
+};
+
+bool fragile::fail = false;
+
+typedef boost::fibers::rendezvous_channel< fragile > fragile_channel_t;
+
+void fragile_consumer_fn( fragile_channel_t & ch, int & result)
+{
+    fragile_channel_t::value_type va;
+    if ( ch.take( va) ) result = va->i;
+}
+
+void fragile_producer_fn( fragile_channel_t & ch, bool & thrown)
+{
+    fragile::fail = true;
+    try
+    { ch.put( fragile( 1) ); }
+    catch ( std::runtime_error const&)
+    { thrown = true; }
+    fragile::fail = false;
+    ch.put( fragile( 2) );
+}
+
+void test_case_6()
+{
+    boost::fibers::round_robin ds;
+    boost::fibers::scheduling_algorithm( & ds);
+
+    // a throwing copy leaves the consumer waiting for the next item
+    fragile_channel_t ch;
+    int result = 0;
+    bool thrown = false;
+    boost::fibers::fiber c( boost::bind( fragile_consumer_fn, boost::ref( ch), boost::ref( result) ) );
+    boost::fibers::fiber p( boost::bind( fragile_producer_fn, boost::ref( ch), boost::ref( thrown) ) );
+    p.join();
+    c.join();
+    BOOST_CHECK( thrown);
+    BOOST_CHECK_EQUAL( 2, result);
+
+    while ( ds.run() );
+    boost::fibers::scheduling_algorithm( 0);
+}
+
+boost::unit_test::test_suite * init_unit_test_suite( int, char* [])
+{
+    boost::unit_test::test_suite * test =
+        BOOST_TEST_SUITE("Boost.Fiber: rendezvous_channel test suite");
+
+    test->add( BOOST_TEST_CASE( & test_case_1) );
+    test->add( BOOST_TEST_CASE( & test_case_2) );
+    test->add( BOOST_TEST_CASE( & test_case_3) );
+    test->add( BOOST_TEST_CASE( & test_case_4) );
+    test->add( BOOST_TEST_CASE( & test_case_5) );
+    test->add( BOOST_TEST_CASE( & test_case_6) );
+
+    return test;
+}
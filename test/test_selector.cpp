@@ -0,0 +1,249 @@
+//          Copyright Oliver Kowalke 2009.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include <vector>
+
+#include <boost/bind.hpp>
+#include <boost/chrono/system_clocks.hpp>
+#include <boost/optional.hpp>
+#include <boost/ref.hpp>
+#include <boost/test/unit_test.hpp>
+#include <boost/thread.hpp>
+#include <boost/utility.hpp>
+
+#include <boost/fiber/all.hpp>
+
+typedef boost::fibers::bounded_channel< int >   bounded_t;
+typedef boost::fibers::unbounded_channel< int > unbounded_t;
+
+template< typename Channel >
+void producer_fn( Channel & ch, int first, int n)
+{
+    for ( int i = first; i < first + n; ++i)
+    {
+        ch.put( i);
+        boost::this_fiber::yield();
+    }
+    ch.deactivate();
+}
+
+void gateway_fn( bounded_t & ch1, unbounded_t & ch2, bounded_t & ch3,
+                 std::vector< int > & counts, int & sum)
+{
+    bounded_t::value_type va1;
+    unbounded_t::value_type va2;
+    bounded_t::value_type va3;
+
+    boost::fibers::selector sel;
+    BOOST_CHECK_EQUAL( 0, sel.add_take( ch1, va1) );
+    BOOST_CHECK_EQUAL( 1, sel.add_take( ch2, va2) );
+    BOOST_CHECK_EQUAL( 2, sel.add_take( ch3, va3) );
+    BOOST_CHECK_EQUAL( std::size_t( 3), sel.size() );
+
+    int idx = 0;
+    while ( boost::fibers::selector::closed != ( idx = sel.wait() ) )
+    {
+        BOOST_REQUIRE( 0 <= idx && 3 > idx);
+        ++counts[idx];
+        switch ( idx)
+        {
+        case 0: sum += * va1; break;
+        case 1: sum += * va2; break;
+        default: sum += * va3; break;
+        }
+    }
+}
+
+void test_try_wait()
+{
+    bounded_t ch1( 2);
+    unbounded_t ch2;
+    bounded_t::value_type va1;
+    unbounded_t::value_type va2;
+
+    boost::fibers::selector empty;
+    BOOST_CHECK_EQUAL( boost::fibers::selector::closed, empty.try_wait() );
+
+    boost::fibers::selector sel;
+    sel.add_take( ch1, va1);
+    sel.add_take( ch2, va2);
+    BOOST_CHECK_EQUAL( boost::fibers::selector::timeout, sel.try_wait() );
+
+    ch2.put( 7);
+    BOOST_CHECK_EQUAL( 1, sel.try_wait() );
+    BOOST_CHECK( va2);
+    BOOST_CHECK_EQUAL( 7, * va2);
+    BOOST_CHECK( ! va1);
+    BOOST_CHECK_EQUAL( boost::fibers::selector::timeout, sel.try_wait() );
+
+    // items remaining after deactivation are delivered
+    ch1.put( 1);
+    ch1.deactivate();
+    ch2.deactivate();
+    BOOST_CHECK_EQUAL( 0, sel.try_wait() );
+    BOOST_CHECK_EQUAL( 1, * va1);
+    BOOST_CHECK_EQUAL( boost::fibers::selector::closed, sel.try_wait() );
+    BOOST_CHECK_EQUAL( boost::fibers::selector::closed, sel.wait() );
+}
+
+void test_fan_in()
+{
+    boost::fibers::round_robin ds;
+    boost::fibers::scheduling_algorithm( & ds);
+
+    bounded_t ch1( 2);
+    unbounded_t ch2;
+    bounded_t ch3( 5, 2);
+    std::vector< int > counts( 3, 0);
+    int sum = 0;
+
+    boost::fibers::fiber g(
+        boost::bind( gateway_fn, boost::ref( ch1), boost::ref( ch2), boost::ref( ch3),
+                     boost::ref( counts), boost::ref( sum) ) );
+    boost::fibers::fiber p1( boost::bind( producer_fn< bounded_t >, boost::ref( ch1), 0, 100) );
+    boost::fibers::fiber p2( boost::bind( producer_fn< unbounded_t >, boost::ref( ch2), 100, 50) );
+    boost::fibers::fiber p3( boost::bind( producer_fn< bounded_t >, boost::ref( ch3), 150, 10) );
+    p1.join();
+    p2.join();
+    p3.join();
+    g.join();
+
+    BOOST_CHECK_EQUAL( 100, counts[0]);
+    BOOST_CHECK_EQUAL( 50, counts[1]);
+    BOOST_CHECK_EQUAL( 10, counts[2]);
+    BOOST_CHECK_EQUAL( 159 * 160 / 2, sum);
+}
+
+void timeout_fn()
+{
+    bounded_t ch1( 1);
+    unbounded_t ch2;
+    bounded_t::value_type va1;
+    unbounded_t::value_type va2;
+
+    boost::fibers::selector sel;
+    sel.add_take( ch1, va1);
+    sel.add_take( ch2, va2);
+
+    boost::chrono::system_clock::time_point abs_time(
+        boost::chrono::system_clock::now() + boost::chrono::milliseconds( 20) );
+    BOOST_CHECK_EQUAL( boost::fibers::selector::timeout, sel.wait_until( abs_time) );
+    BOOST_CHECK( boost::chrono::system_clock::now() >= abs_time);
+
+    ch2.put( 3);
+    BOOST_CHECK_EQUAL( 1, sel.wait_for( boost::chrono::milliseconds( 20) ) );
+    BOOST_CHECK_EQUAL( 3, * va2);
+}
+
+void test_timeout()
+{
+    boost::fibers::round_robin ds;
+    boost::fibers::scheduling_algorithm( & ds);
+
+    boost::fibers::fiber f( timeout_fn);
+    f.join();
+}
+
+void put_select_fn( bounded_t & out, bounded_t & in, std::vector< int > & taken)
+{
+    int value = 0;
+    bounded_t::value_type va;
+
+    boost::fibers::selector sel;
+    sel.add_put( out, value);
+    sel.add_take( in, va);
+
+    // out is full - the selector blocks until the consumer
+    // has taken an item or in became readable
+    while ( 10 > value)
+    {
+        int idx = sel.wait();
+        if ( 0 == idx) ++value;
+        else if ( 1 == idx) taken.push_back( * va);
+        else break;
+    }
+    out.deactivate();
+}
+
+void consume_fn( bounded_t & out, bounded_t & in, int & sum)
+{
+    bounded_t::value_type va;
+    in.put( -1);
+    while ( out.take( va) )
+        sum += * va;
+}
+
+void test_put()
+{
+    boost::fibers::round_robin ds;
+    boost::fibers::scheduling_algorithm( & ds);
+
+    bounded_t out( 1);
+    bounded_t in( 1);
+    std::vector< int > taken;
+    int sum = 0;
+
+    out.put( 100);
+    boost::fibers::fiber s(
+        boost::bind( put_select_fn, boost::ref( out), boost::ref( in), boost::ref( taken) ) );
+    boost::fibers::fiber c(
+        boost::bind( consume_fn, boost::ref( out), boost::ref( in), boost::ref( sum) ) );
+    s.join();
+    c.join();
+
+    BOOST_CHECK_EQUAL( 100 + 45, sum);
+    BOOST_REQUIRE_EQUAL( std::size_t( 1), taken.size() );
+    BOOST_CHECK_EQUAL( -1, taken[0]);
+}
+
+void thread_producer_fn( unbounded_t & ch, int n)
+{
+    for ( int i = 0; i < n; ++i)
+        ch.put( 1);
+    ch.deactivate();
+}
+
+void thread_gateway_fn( unbounded_t & ch1, unbounded_t & ch2, int & count)
+{
+    unbounded_t::value_type va1, va2;
+    boost::fibers::selector sel;
+    sel.add_take( ch1, va1);
+    sel.add_take( ch2, va2);
+    while ( boost::fibers::selector::closed != sel.wait() )
+        ++count;
+}
+
+void test_threads()
+{
+    boost::fibers::round_robin ds;
+    boost::fibers::scheduling_algorithm( & ds);
+
+    unbounded_t ch1, ch2;
+    int count = 0;
+
+    boost::fibers::fiber g(
+        boost::bind( thread_gateway_fn, boost::ref( ch1), boost::ref( ch2), boost::ref( count) ) );
+    boost::thread t1( boost::bind( thread_producer_fn, boost::ref( ch1), 500) );
+    boost::thread t2( boost::bind( thread_producer_fn, boost::ref( ch2), 500) );
+    g.join();
+    t1.join();
+    t2.join();
+
+    BOOST_CHECK_EQUAL( 1000, count);
+}
+
+boost::unit_test::test_suite * init_unit_test_suite( int, char* [])
+{
+    boost::unit_test::test_suite * test =
+        BOOST_TEST_SUITE("Boost.Fiber: selector test suite");
+
+    test->add( BOOST_TEST_CASE( & test_try_wait) );
+    test->add( BOOST_TEST_CASE( & test_fan_in) );
+    test->add( BOOST_TEST_CASE( & test_timeout) );
+    test->add( BOOST_TEST_CASE( & test_put) );
+    test->add( BOOST_TEST_CASE( & test_threads) );
+
+    return test;
+}
@@ -0,0 +1,155 @@
+//          Copyright Oliver Kowalke 2009.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include <string>
+
+#include <boost/bind.hpp>
+#include <boost/ref.hpp>
+#include <boost/test/unit_test.hpp>
+#include <boost/thread.hpp>
+#include <boost/utility.hpp>
+
+#include <boost/fiber/all.hpp>
+
+typedef boost::fibers::spsc_channel< int >  channel_t;
+
+void producer_fn( channel_t & ch, int n)
+{
+    for ( int i = 0; i < n; ++i)
+        ch.put( i);
+}
+
+void consumer_fn( channel_t & ch, int & sum, int & count)
+{
+    channel_t::value_type va;
+    while ( ch.take( va) )
+    {
+        sum += * va;
+        ++count;
+    }
+}
+
+void test_case_1()
+{
+    channel_t ch( 3);
+    BOOST_CHECK_EQUAL( std::size_t( 4), ch.capacity() );
+    BOOST_CHECK( ch.empty() );
+
+    // wrap around the ring-buffer several times
+    channel_t::value_type va;
+    for ( int i = 0; i < 10; ++i)
+    {
+        ch.put( 2 * i);
+        ch.put( 2 * i + 1);
+        BOOST_CHECK( ! ch.empty() );
+        BOOST_CHECK( ch.try_take( va) );
+        BOOST_CHECK_EQUAL( 2 * i, * va);
+        BOOST_CHECK( ch.take( va) );
+        BOOST_CHECK_EQUAL( 2 * i + 1, * va);
+    }
+    BOOST_CHECK( ch.empty() );
+    BOOST_CHECK( ! ch.try_take( va) );
+
+    // full channel
+    for ( int i = 0; i < 4; ++i)
+        BOOST_CHECK( ch.try_put( i) );
+    BOOST_CHECK( ! ch.try_put( 4) );
+
+    ch.deactivate();
+    BOOST_CHECK( ! ch.active() );
+    BOOST_CHECK_THROW( ch.put( 1), boost::fibers::fiber_resource_error);
+    // remaining items are still delivered
+    for ( int i = 0; i < 4; ++i)
+    {
+        BOOST_CHECK( ch.take( va) );
+        BOOST_CHECK_EQUAL( i, * va);
+    }
+    BOOST_CHECK( ! ch.take( va) );
+}
+
+void test_case_2()
+{
+    BOOST_CHECK_THROW( channel_t( 0), boost::fibers::invalid_argument);
+}
+
+void test_case_3()
+{
+    boost::fibers::round_robin ds;
+    boost::fibers::scheduling_algorithm( & ds);
+
+    // producer parks on the full channel, consumer on the empty one
+    channel_t ch( 2);
+    int sum = 0, count = 0;
+    boost::fibers::fiber p( boost::bind( producer_fn, boost::ref( ch), 100) );
+    BOOST_CHECK( ! ch.empty() );
+    boost::fibers::fiber c(
+        boost::bind( consumer_fn, boost::ref( ch), boost::ref( sum), boost::ref( count) ) );
+    p.join();
+    ch.deactivate();
+    c.join();
+    BOOST_CHECK_EQUAL( 100, count);
+    BOOST_CHECK_EQUAL( 4950, sum);
+}
+
+void test_case_4()
+{
+    boost::fibers::round_robin ds;
+    boost::fibers::scheduling_algorithm( & ds);
+
+    // deactivate() wakes a parked consumer
+    channel_t ch;
+    int sum = 0, count = 0;
+    boost::fibers::fiber c(
+        boost::bind( consumer_fn, boost::ref( ch), boost::ref( sum), boost::ref( count) ) );
+    ch.deactivate();
+    c.join();
+    BOOST_CHECK_EQUAL( 0, count);
+}
+
+void thread_producer_fn( channel_t * ch, int n)
+{
+    boost::fibers::round_robin ds;
+    boost::fibers::scheduling_algorithm( & ds);
+
+    boost::fibers::fiber p( boost::bind( producer_fn, boost::ref( * ch), n) );
+    p.join();
+}
+
+void thread_consumer_fn( channel_t * ch, int * sum, int * count)
+{
+    boost::fibers::round_robin ds;
+    boost::fibers::scheduling_algorithm( & ds);
+
+    boost::fibers::fiber c(
+        boost::bind( consumer_fn, boost::ref( * ch), boost::ref( * sum), boost::ref( * count) ) );
+    c.join();
+}
+
+void test_case_5()
+{
+    channel_t ch( 16);
+    int sum = 0, count = 0;
+    boost::thread c( boost::bind( thread_consumer_fn, & ch, & sum, & count) );
+    boost::thread p( boost::bind( thread_producer_fn, & ch, 10000) );
+    p.join();
+    ch.deactivate();
+    c.join();
+    BOOST_CHECK_EQUAL( 10000, count);
+    BOOST_CHECK_EQUAL( 49995000, sum);
+}
+
+boost::unit_test::test_suite * init_unit_test_suite( int, char* [])
+{
+    boost::unit_test::test_suite * test =
+        BOOST_TEST_SUITE("Boost.Fiber: spsc_channel test suite");
+
+    test->add( BOOST_TEST_CASE( & test_case_1) );
+    test->add( BOOST_TEST_CASE( & test_case_2) );
+    test->add( BOOST_TEST_CASE( & test_case_3) );
+    test->add( BOOST_TEST_CASE( & test_case_4) );
+    test->add( BOOST_TEST_CASE( & test_case_5) );
+
+    return test;
+}
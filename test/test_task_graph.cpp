@@ -0,0 +1,198 @@
+//          Copyright Oliver Kowalke 2009.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include <stdexcept>
+#include <vector>
+
+#include <boost/atomic.hpp>
+#include <boost/bind.hpp>
+#include <boost/ref.hpp>
+#include <boost/test/unit_test.hpp>
+#include <boost/thread.hpp>
+#include <boost/utility.hpp>
+
+#include <boost/fiber/all.hpp>
+
+typedef boost::fibers::task_graph::node_id node_id;
+
+std::vector< int > order;
+
+void record( int i)
+{
+    // the nodes of the diamond block in the middle
+    boost::this_fiber::yield();
+    order.push_back( i);
+}
+
+void count( boost::atomic< int > * counter)
+{ counter->fetch_add( 1); }
+
+void throw_fn()
+{ throw std::runtime_error("task_graph"); }
+
+int position( int i)
+{
+    for ( std::size_t p = 0; p < order.size(); ++p)
+        if ( i == order[p]) return static_cast< int >( p);
+    return -1;
+}
+
+void finish( boost::fibers::round_robin & ds)
+{
+    // the pooled fibers return after the last node has completed
+    while ( ds.run() );
+    boost::fibers::scheduling_algorithm( 0);
+}
+
+void build_diamond( boost::fibers::task_graph & g)
+{
+    node_id a = g.add( boost::bind( record, 0) );
+    node_id b = g.add( boost::bind( record, 1) );
+    node_id c = g.add( boost::bind( record, 2) );
+    node_id d = g.add( boost::bind( record, 3) );
+    g.add_dependency( b, a);
+    g.add_dependency( c, a);
+    g.add_dependency( d, b);
+    g.add_dependency( d, c);
+}
+
+void check_diamond()
+{
+    BOOST_CHECK_EQUAL( std::size_t( 4), order.size() );
+    BOOST_CHECK_EQUAL( 0, position( 0) );
+    BOOST_CHECK_EQUAL( 3, position( 3) );
+}
+
+void run_diamond()
+{
+    boost::fibers::task_graph g;
+    build_diamond( g);
+    order.clear();
+    g.run();
+    check_diamond();
+}
+
+void test_diamond()
+{
+    boost::fibers::round_robin ds;
+    boost::fibers::scheduling_algorithm( & ds);
+
+    boost::fibers::task_graph g;
+    BOOST_CHECK_EQUAL( std::size_t( 0), g.size() );
+    g.run();
+
+    build_diamond( g);
+    BOOST_CHECK_EQUAL( std::size_t( 4), g.size() );
+    order.clear();
+    g.run();
+    check_diamond();
+
+    // a graph can be run again
+    order.clear();
+    g.run();
+    check_diamond();
+
+    // run() called by a fiber
+    boost::fibers::fiber f( run_diamond);
+    f.join();
+
+    finish( ds);
+}
+
+void test_large_graph()
+{
+    boost::fibers::round_robin ds;
+    boost::fibers::scheduling_algorithm( & ds);
+
+    // 100 layers of 100 nodes, each node depends on three
+    // nodes of the previous layer
+    boost::atomic< int > counter( 0);
+    boost::fibers::task_graph g;
+    for ( int l = 0; l < 100; ++l)
+    {
+        for ( int i = 0; i < 100; ++i)
+        {
+            node_id n = g.add( boost::bind( count, & counter) );
+            if ( 0 < l)
+                for ( int k = 0; k < 3; ++k)
+                    g.add_dependency( n, ( l - 1) * 100 + ( i + k) % 100);
+        }
+    }
+    g.run();
+    BOOST_CHECK_EQUAL( 10000, counter.load() );
+
+    finish( ds);
+}
+
+void test_executor()
+{
+    boost::fibers::round_robin ds;
+    boost::fibers::scheduling_algorithm( & ds);
+
+    boost::atomic< int > counter( 0);
+    boost::fibers::task_graph g;
+    node_id prev = g.add( boost::bind( count, & counter) );
+    for ( int i = 1; i < 1000; ++i)
+    {
+        node_id n = g.add( boost::bind( count, & counter) );
+        g.add_dependency( n, prev);
+        prev = n;
+    }
+    boost::fibers::thread_executor ex;
+    g.run( ex);
+    BOOST_CHECK_EQUAL( 1000, counter.load() );
+
+    finish( ds);
+}
+
+void test_exception()
+{
+    boost::fibers::round_robin ds;
+    boost::fibers::scheduling_algorithm( & ds);
+
+    boost::atomic< int > counter( 0);
+    boost::fibers::task_graph g;
+    node_id a = g.add( throw_fn);
+    node_id b = g.add( boost::bind( count, & counter) );
+    node_id c = g.add( boost::bind( count, & counter) );
+    node_id d = g.add( boost::bind( count, & counter) );
+    g.add_dependency( b, a);
+    g.add_dependency( c, b);
+    // d does not depend on a
+    (void)d;
+    BOOST_CHECK_THROW( g.run(), std::runtime_error);
+    BOOST_CHECK_EQUAL( 1, counter.load() );
+
+    finish( ds);
+}
+
+void test_invalid_dependency()
+{
+    boost::fibers::task_graph g;
+    boost::atomic< int > counter( 0);
+    node_id a = g.add( boost::bind( count, & counter) );
+    node_id b = g.add( boost::bind( count, & counter) );
+    BOOST_CHECK_THROW( g.add_dependency( a, a), boost::fibers::invalid_argument);
+    BOOST_CHECK_THROW( g.add_dependency( a, 7), boost::fibers::invalid_argument);
+
+    g.add_dependency( b, a);
+    g.add_dependency( a, b);
+    BOOST_CHECK_THROW( g.run(), boost::fibers::invalid_argument);
+    BOOST_CHECK_EQUAL( 0, counter.load() );
+}
+
+boost::unit_test::test_suite * init_unit_test_suite( int, char* [])
+{
+    boost::unit_test::test_suite * test =
+        BOOST_TEST_SUITE("Boost.Fiber: task_graph test suite");
+
+    test->add( BOOST_TEST_CASE( & test_diamond) );
+    test->add( BOOST_TEST_CASE( & test_large_graph) );
+    test->add( BOOST_TEST_CASE( & test_executor) );
+    test->add( BOOST_TEST_CASE( & test_exception) );
+    test->add( BOOST_TEST_CASE( & test_invalid_dependency) );
+
+    return test;
+}
@@ -12,6 +12,12 @@
 
 #include <boost/test/unit_test.hpp>
 
+#include <stdexcept>
+
+#include <boost/bind.hpp>
+#include <boost/ref.hpp>
+#include <boost/thread/thread.hpp>
+
 #include <boost/fiber/all.hpp>
 
 int p1()
@@ -24,6 +30,23 @@ int p2(boost::fibers::unique_future<int>& f)
   return 2 * f.get();
 }
 
+boost::thread::id p3(boost::fibers::unique_future<int>& f)
+{
+  f.get();
+  return boost::this_thread::get_id();
+}
+
+int p4(boost::fibers::unique_future<int>& f)
+{
+  f.get();
+  throw std::runtime_error("p4");
+}
+
+void p5(boost::fibers::unique_future<int>& f, int& value)
+{
+  value = f.get();
+}
+
 void test_then()
 {
     boost::fibers::round_robin ds;
@@ -49,12 +72,53 @@ void test_then()
     }
 }
 
+void test_then_fiber_executor()
+{
+    boost::fibers::round_robin ds;
+    boost::fibers::scheduling_algorithm( & ds);
+
+    boost::fibers::fiber_executor ex;
+    boost::fibers::promise<int> p;
+    boost::fibers::unique_future<int> f1 = p.get_future();
+    int value = 0;
+    boost::fibers::unique_future<void> f2 = f1.then(ex,
+        boost::bind(p5, _1, boost::ref(value)));
+    p.set_value(3);
+    // the continuation runs in a new fiber, not inside set_value()
+    BOOST_CHECK_EQUAL( 0, value);
+    f2.get();
+    BOOST_CHECK_EQUAL( 3, value);
+}
+
+void test_then_thread_executor()
+{
+    boost::fibers::round_robin ds;
+    boost::fibers::scheduling_algorithm( & ds);
+
+    boost::fibers::thread_executor ex;
+    boost::fibers::unique_future<boost::thread::id> f2 =
+        boost::fibers::async(p1).then(ex, p3);
+    BOOST_CHECK( boost::this_thread::get_id() != f2.get());
+}
+
+void test_then_exception()
+{
+    boost::fibers::round_robin ds;
+    boost::fibers::scheduling_algorithm( & ds);
+
+    boost::fibers::unique_future<int> f2 = boost::fibers::async(p1).then(p4).then(p2);
+    BOOST_CHECK_THROW( f2.get(), std::runtime_error);
+}
+
 boost::unit_test_framework::test_suite* init_unit_test_suite(int, char*[])
 {
     boost::unit_test_framework::test_suite* test =
         BOOST_TEST_SUITE("Boost.Fiber: unique_future::then() test suite");
 
     test->add(BOOST_TEST_CASE(test_then));
+    test->add(BOOST_TEST_CASE(test_then_fiber_executor));
+    test->add(BOOST_TEST_CASE(test_then_thread_executor));
+    test->add(BOOST_TEST_CASE(test_then_exception));
 
     return test;
 }
@@ -0,0 +1,275 @@
+//          Copyright Oliver Kowalke 2009.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <boost/bind.hpp>
+#include <boost/chrono/system_clocks.hpp>
+#include <boost/cstdint.hpp>
+#include <boost/optional.hpp>
+#include <boost/ref.hpp>
+#include <boost/test/unit_test.hpp>
+#include <boost/utility.hpp>
+
+#include <boost/fiber/all.hpp>
+
+typedef boost::fibers::unbounded_channel< int > channel_t;
+
+void consumer_fn( channel_t & ch, int & sum, int & count)
+{
+    channel_t::value_type va;
+    while ( ch.take( va) )
+    {
+        sum += * va;
+        ++count;
+    }
+}
+
+void batch_producer_fn( channel_t & ch, int n)
+{
+    std::vector< int > vec;
+    for ( int i = 0; i < n; ++i)
+        vec.push_back( i);
+    for ( int i = 0; i < n; i += 10)
+        ch.put_n( vec.begin() + i, vec.begin() + i + 10);
+}
+
+void batch_consumer_fn( channel_t & ch, int & sum, int & count)
+{
+    std::vector< int > vec;
+    while ( 0 < ch.take_n( std::back_inserter( vec), 7) );
+    for ( std::size_t i = 0; i < vec.size(); ++i)
+        sum += vec[i];
+    count += static_cast< int >( vec.size() );
+}
+
+void fn1()
+{
+    channel_t ch;
+    BOOST_CHECK( ch.empty() );
+
+    channel_t::value_type va;
+    ch.put( 1);
+    ch.put( 2);
+    BOOST_CHECK( ! ch.empty() );
+    BOOST_CHECK( ch.try_take( va) );
+    BOOST_CHECK_EQUAL( 1, * va);
+    BOOST_CHECK( ch.take( va) );
+    BOOST_CHECK_EQUAL( 2, * va);
+    BOOST_CHECK( ch.empty() );
+    BOOST_CHECK( ! ch.try_take( va) );
+
+    int items[] = { 0, 1, 2, 3, 4, 5 };
+    std::vector< int > vec;
+    ch.put_n( items, items + 3);
+    ch.put_n( items, items);
+    BOOST_CHECK_EQUAL( std::size_t( 2), ch.take_n( std::back_inserter( vec), 2) );
+    BOOST_CHECK_EQUAL( std::size_t( 1), ch.take_n( std::back_inserter( vec), 8) );
+    BOOST_CHECK( ch.empty() );
+    BOOST_CHECK_EQUAL( std::size_t( 0), ch.drain( std::back_inserter( vec) ) );
+    ch.put_n( items + 3, items + 6);
+    BOOST_CHECK_EQUAL( std::size_t( 3), ch.drain( std::back_inserter( vec) ) );
+    BOOST_CHECK_EQUAL( std::size_t( 6), vec.size() );
+    for ( int i = 0; i < 6; ++i)
+        BOOST_CHECK_EQUAL( i, vec[i]);
+
+    ch.put_n( items, items + 2);
+    ch.deactivate();
+    BOOST_CHECK( ! ch.active() );
+    BOOST_CHECK_THROW( ch.put_n( items, items + 1), std::runtime_error);
+    // remaining items are still delivered
+    BOOST_CHECK_EQUAL( std::size_t( 2), ch.take_n( std::back_inserter( vec), 8) );
+    BOOST_CHECK_EQUAL( std::size_t( 0), ch.take_n( std::back_inserter( vec), 8) );
+    BOOST_CHECK( ! ch.take( va) );
+}
+
+void test_case_1()
+{
+    boost::fibers::round_robin ds;
+    boost::fibers::scheduling_algorithm( & ds);
+
+    boost::fibers::fiber f( fn1);
+    f.join();
+}
+
+void test_case_2()
+{
+    boost::fibers::round_robin ds;
+    boost::fibers::scheduling_algorithm( & ds);
+
+    // one notification per batch is passed on to the other consumers
+    channel_t ch;
+    int sum[3] = { 0, 0, 0 }, count[3] = { 0, 0, 0 };
+    boost::fibers::fiber c1(
+        boost::bind( batch_consumer_fn, boost::ref( ch), boost::ref( sum[0]), boost::ref( count[0]) ) );
+    boost::fibers::fiber c2(
+        boost::bind( batch_consumer_fn, boost::ref( ch), boost::ref( sum[1]), boost::ref( count[1]) ) );
+    boost::fibers::fiber c3(
+        boost::bind( consumer_fn, boost::ref( ch), boost::ref( sum[2]), boost::ref( count[2]) ) );
+    boost::fibers::fiber p( boost::bind( batch_producer_fn, boost::ref( ch), 1000) );
+    p.join();
+    boost::fibers::fiber d( boost::bind( & channel_t::deactivate, boost::ref( ch) ) );
+    d.join();
+    c1.join();
+    c2.join();
+    c3.join();
+    BOOST_CHECK_EQUAL( 1000, count[0] + count[1] + count[2]);
+    BOOST_CHECK_EQUAL( 499500, sum[0] + sum[1] + sum[2]);
+}
+
+#ifndef BOOST_NO_RVALUE_REFERENCES
+void move_fn()
+{
+    // move-only items
+    boost::fibers::unbounded_channel< std::unique_ptr< int > > ch;
+    std::unique_ptr< int > p( new int( 1) );
+    ch.put( std::move( p) );
+    BOOST_CHECK( ! p);
+#ifndef BOOST_NO_VARIADIC_TEMPLATES
+    ch.emplace( new int( 2) );
+#else
+    ch.put( std::unique_ptr< int >( new int( 2) ) );
+#endif
+    boost::optional< std::unique_ptr< int > > va( ch.take() );
+    BOOST_CHECK( va);
+    BOOST_CHECK_EQUAL( 1, * * va);
+    BOOST_CHECK( ch.take( va) );
+    BOOST_CHECK_EQUAL( 2, * * va);
+
+    // items are not copied
+    boost::fibers::unbounded_channel< std::string > str_ch;
+    std::string str( 64, 'a');
+    char const* data = str.data();
+    str_ch.put( std::move( str) );
+#ifndef BOOST_NO_VARIADIC_TEMPLATES
+    str_ch.emplace( std::size_t( 3), 'b');
+#else
+    str_ch.put( std::string( 3, 'b') );
+#endif
+    boost::optional< std::string > s( str_ch.take() );
+    BOOST_CHECK( s);
+    BOOST_CHECK_EQUAL( data, s->data() );
+    s = str_ch.take();
+    BOOST_CHECK_EQUAL( std::string( "bbb"), * s);
+
+    str_ch.deactivate();
+    BOOST_CHECK( ! str_ch.take() );
+}
+#endif
+
+void test_case_3()
+{
+#ifndef BOOST_NO_RVALUE_REFERENCES
+    boost::fibers::round_robin ds;
+    boost::fibers::scheduling_algorithm( & ds);
+
+    boost::fibers::fiber f( move_fn);
+    f.join();
+#endif
+}
+
+void delayed_put_fn( channel_t & ch, int i, boost::chrono::milliseconds const& ms)
+{
+    boost::chrono::system_clock::time_point abs_time(
+        boost::chrono::system_clock::now() + ms);
+    while ( boost::chrono::system_clock::now() < abs_time)
+        boost::this_fiber::yield();
+    ch.put( i);
+}
+
+void timed_fn()
+{
+    channel_t ch;
+    channel_t::value_type va;
+
+    boost::chrono::system_clock::time_point abs_time(
+        boost::chrono::system_clock::now() + boost::chrono::milliseconds( 20) );
+    BOOST_CHECK( ! ch.take_until( va, abs_time) );
+    BOOST_CHECK( boost::chrono::system_clock::now() >= abs_time);
+    BOOST_CHECK( ch.active() );
+
+    // periodic flushing while waiting for items
+    boost::fibers::fiber p(
+        boost::bind( delayed_put_fn, boost::ref( ch), 3, boost::chrono::milliseconds( 50) ) );
+    int timeouts = 0;
+    while ( ! ch.take_for( va, boost::chrono::milliseconds( 5) ) )
+        ++timeouts;
+    BOOST_CHECK_EQUAL( 3, * va);
+    BOOST_CHECK( 0 < timeouts);
+    p.join();
+
+    ch.deactivate();
+    BOOST_CHECK( ! ch.take_for( va, boost::chrono::milliseconds( 10) ) );
+}
+
+void test_case_4()
+{
+    boost::fibers::round_robin ds;
+    boost::fibers::scheduling_algorithm( & ds);
+
+    boost::fibers::fiber f( timed_fn);
+    f.join();
+}
+
+typedef boost::fibers::unbounded_channel<
+    int, boost::fibers::channel_statistics
+> stats_channel_t;
+
+void stats_consumer_fn( stats_channel_t & ch, int & count)
+{
+    stats_channel_t::value_type va;
+    while ( ch.take( va) )
+        ++count;
+}
+
+void stats_fn()
+{
+    stats_channel_t ch;
+    int count = 0;
+    boost::fibers::fiber c( boost::bind( stats_consumer_fn, boost::ref( ch), boost::ref( count) ) );
+    boost::this_fiber::yield();
+    ch.put( 1);
+    std::vector< int > vec( 9, 1);
+    ch.put_n( vec.begin(), vec.end() );
+    boost::this_fiber::yield();
+    ch.deactivate();
+    c.join();
+    BOOST_CHECK_EQUAL( 10, count);
+
+    boost::fibers::channel_statistics::snapshot s( ch.statistics().get_snapshot() );
+    BOOST_CHECK_EQUAL( boost::uint64_t( 10), s.puts);
+    BOOST_CHECK_EQUAL( boost::uint64_t( 10), s.takes);
+    BOOST_CHECK_EQUAL( std::size_t( 0), s.depth);
+    BOOST_CHECK( 1 <= s.max_depth && 10 >= s.max_depth);
+    BOOST_CHECK( 0 < s.consumers.count);
+    BOOST_CHECK_EQUAL( boost::uint64_t( 0), s.producers.count);
+}
+
+void test_case_5()
+{
+    boost::fibers::round_robin ds;
+    boost::fibers::scheduling_algorithm( & ds);
+
+    boost::fibers::fiber f( stats_fn);
+    f.join();
+}
+
+boost::unit_test::test_suite * init_unit_test_suite( int, char* [])
+{
+    boost::unit_test::test_suite * test =
+        BOOST_TEST_SUITE("Boost.Fiber: unbounded_channel test suite");
+
+    test->add( BOOST_TEST_CASE( & test_case_1) );
+    test->add( BOOST_TEST_CASE( & test_case_2) );
+    test->add( BOOST_TEST_CASE( & test_case_3) );
+    test->add( BOOST_TEST_CASE( & test_case_4) );
+    test->add( BOOST_TEST_CASE( & test_case_5) );
+
+    return test;
+}
@@ -0,0 +1,115 @@
+//          Copyright Oliver Kowalke 2009.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include <boost/atomic.hpp>
+#include <boost/bind.hpp>
+#include <boost/ref.hpp>
+#include <boost/test/unit_test.hpp>
+#include <boost/thread.hpp>
+#include <boost/utility.hpp>
+
+#include <boost/fiber/all.hpp>
+
+int value = 0;
+
+void child_fn( boost::fibers::wait_group & wg)
+{
+    boost::this_fiber::yield();
+    ++value;
+    wg.done();
+}
+
+void wait_fn( boost::fibers::wait_group & wg, int & result)
+{
+    wg.wait();
+    result = value;
+}
+
+void test_case_1()
+{
+    boost::fibers::wait_group wg;
+    BOOST_CHECK( wg.try_wait() );
+    // does not block
+    wg.wait();
+
+    wg.add( 2);
+    BOOST_CHECK( ! wg.try_wait() );
+    wg.done();
+    BOOST_CHECK( ! wg.try_wait() );
+    wg.done();
+    BOOST_CHECK( wg.try_wait() );
+}
+
+void test_case_2()
+{
+    boost::fibers::round_robin ds;
+    boost::fibers::scheduling_algorithm( & ds);
+
+    value = 0;
+    boost::fibers::wait_group wg;
+
+    // scatter/gather from main-fiber
+    for ( int i = 0; i < 10; ++i)
+    {
+        wg.add();
+        boost::fibers::fiber(
+            boost::bind( child_fn, boost::ref( wg) ) ).detach();
+    }
+    wg.wait();
+    BOOST_CHECK_EQUAL( 10, value);
+
+    // wait_group can be reused
+    int result = 0;
+    wg.add( 3);
+    boost::fibers::fiber s(
+        boost::bind( wait_fn, boost::ref( wg), boost::ref( result) ) );
+    for ( int i = 0; i < 3; ++i)
+        boost::fibers::fiber(
+            boost::bind( child_fn, boost::ref( wg) ) ).detach();
+    s.join();
+    BOOST_CHECK_EQUAL( 13, result);
+}
+
+boost::atomic< int > counter( 0);
+
+void worker_fn( boost::fibers::wait_group * wg, int n)
+{
+    boost::fibers::round_robin ds;
+    boost::fibers::scheduling_algorithm( & ds);
+
+    for ( int i = 0; i < n; ++i)
+    {
+        ++counter;
+        wg->done();
+    }
+}
+
+void test_case_3()
+{
+    boost::fibers::round_robin ds;
+    boost::fibers::scheduling_algorithm( & ds);
+
+    counter = 0;
+    boost::fibers::wait_group wg( 200);
+
+    boost::thread t1( boost::bind( worker_fn, & wg, 100) );
+    boost::thread t2( boost::bind( worker_fn, & wg, 100) );
+    wg.wait();
+    BOOST_CHECK_EQUAL( 200, counter);
+    t1.join();
+    t2.join();
+}
+
+boost::unit_test::test_suite * init_unit_test_suite( int, char* [])
+{
+    boost::unit_test::test_suite * test =
+        BOOST_TEST_SUITE("Boost.Fiber: wait_group test suite");
+
+    test->add( BOOST_TEST_CASE( & test_case_1) );
+    test->add( BOOST_TEST_CASE( & test_case_2) );
+    test->add( BOOST_TEST_CASE( & test_case_3) );
+
+    return test;
+}